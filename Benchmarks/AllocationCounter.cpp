@@ -0,0 +1,52 @@
+#include "AllocationCounter.hpp"
+
+#include <atomic>
+#include <new>
+#include <stdlib.h>
+
+#ifdef __GLIBC__
+#include <malloc.h>
+#define CL_HAS_MALLOC_USABLE_SIZE 1
+#else
+#define CL_HAS_MALLOC_USABLE_SIZE 0
+#endif
+
+// Replace the global allocation functions so the benchmarks can report allocations per operation
+namespace
+{
+std::atomic_size_t allocations_count{ 0 };
+std::atomic_size_t allocated_bytes{ 0 };
+
+void* counted_alloc(size_t size)
+{
+    allocations_count.fetch_add(1, std::memory_order_relaxed);
+    void* ptr = malloc(size ? size : 1);
+    if(ptr == nullptr) {
+        throw std::bad_alloc();
+    }
+#if CL_HAS_MALLOC_USABLE_SIZE
+    allocated_bytes.fetch_add(malloc_usable_size(ptr), std::memory_order_relaxed);
+#endif
+    return ptr;
+}
+
+void counted_free(void* ptr)
+{
+#if CL_HAS_MALLOC_USABLE_SIZE
+    if(ptr) {
+        allocated_bytes.fetch_sub(malloc_usable_size(ptr), std::memory_order_relaxed);
+    }
+#endif
+    free(ptr);
+}
+} // namespace
+
+size_t GetAllocationsCount() { return allocations_count.load(std::memory_order_relaxed); }
+size_t GetAllocatedBytes() { return allocated_bytes.load(std::memory_order_relaxed); }
+
+void* operator new(size_t size) { return counted_alloc(size); }
+void* operator new[](size_t size) { return counted_alloc(size); }
+void operator delete(void* ptr) noexcept { counted_free(ptr); }
+void operator delete[](void* ptr) noexcept { counted_free(ptr); }
+void operator delete(void* ptr, size_t) noexcept { counted_free(ptr); }
+void operator delete[](void* ptr, size_t) noexcept { counted_free(ptr); }
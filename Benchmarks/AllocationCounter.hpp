@@ -0,0 +1,17 @@
+#ifndef ALLOCATIONCOUNTER_HPP
+#define ALLOCATIONCOUNTER_HPP
+
+#include <stddef.h>
+
+/**
+ * @brief the number of calls to the global `operator new` made by the benchmarks executable so far
+ */
+size_t GetAllocationsCount();
+
+/**
+ * @brief the number of bytes currently allocated with the global `operator new` (including the allocator's
+ * per-block rounding). Only available with glibc, returns 0 elsewhere
+ */
+size_t GetAllocatedBytes();
+
+#endif // ALLOCATIONCOUNTER_HPP
@@ -0,0 +1,260 @@
+#include "benchmark.hpp"
+#include "clBuildOutputMatcher.hpp"
+#include "clMappedFile.hpp"
+#include "compiler.h"
+
+#include <memory>
+#include <wx/regex.h>
+#include <wx/tokenzr.h>
+#include <wx/utils.h>
+
+namespace
+{
+size_t get_lines_count()
+{
+    // allow overriding the number of lines from the environment
+    wxString count_str;
+    unsigned long count = 200000;
+    if(::wxGetEnv("CL_BENCHMARK_BUILD_LINES", &count_str)) {
+        count_str.ToCULong(&count);
+    }
+    return count;
+}
+
+/// a tiny deterministic generator, so every run replays the same log
+struct Random {
+    unsigned int seed = 42;
+    unsigned int next(unsigned int max)
+    {
+        seed = seed * 1103515245 + 12345;
+        return (seed >> 8) % max;
+    }
+};
+
+enum class eLogKind { kGCC, kClang, kMSVC };
+
+/**
+ * @brief build a log that looks like a parallel build: mostly compiler invocations and progress lines, with a few
+ * diagnostics (and their context lines) sprinkled in
+ */
+std::vector<wxString> create_log(eLogKind kind, size_t count)
+{
+    Random random;
+    std::vector<wxString> lines;
+    lines.reserve(count);
+    for(size_t i = 0; lines.size() < count; ++i) {
+        wxString file;
+        file << "src/module_" << (i % 97) << "/file_" << i << ".cpp";
+        unsigned int what = random.next(100);
+        switch(kind) {
+        case eLogKind::kGCC:
+        case eLogKind::kClang: {
+            wxString cxx = kind == eLogKind::kGCC ? "/usr/bin/g++" : "/usr/bin/clang++";
+            if(what < 80) {
+                lines.push_back(wxString() << "[" << (i % 1000) << "/1000] " << cxx
+                                           << " -DNDEBUG -Iinclude -O2 -g -Wall -std=c++20 -MD -MT " << file
+                                           << ".o -c " << file);
+            } else if(what < 90) {
+                lines.push_back(wxString() << "In file included from " << file << ":12:");
+                lines.push_back(wxString() << file << ":" << (i % 500) << ":" << (i % 80)
+                                           << ": warning: unused variable 'count' [-Wunused-variable]");
+                lines.push_back(wxString() << "   " << (i % 500) << " |     int count = 0;");
+                lines.push_back("      |         ^~~~~");
+            } else if(what < 93) {
+                lines.push_back(wxString() << file << ":" << (i % 500) << ":" << (i % 80)
+                                           << ": error: use of undeclared identifier 'foo'");
+                lines.push_back(wxString() << file << ":" << (i % 500) << ":" << (i % 80)
+                                           << ": note: in instantiation of function template specialization");
+            } else if(what < 94) {
+                lines.push_back(wxString() << "/usr/bin/ld: " << file << ".o: in function `main':");
+                lines.push_back("main.cpp:(.text+0x1f): undefined reference to `foo()'");
+            } else if(what < 95) {
+                lines.push_back("make[2]: *** [CMakeFiles/app.dir/build.make:76: app] Error 1");
+            } else {
+                lines.push_back(wxString() << "[" << (i % 1000) << "/1000] Linking CXX shared library libmodule_"
+                                           << (i % 97) << ".so");
+            }
+        } break;
+        case eLogKind::kMSVC: {
+            wxString msvc_file = file;
+            msvc_file.Replace("/", "\\");
+            if(what < 80) {
+                lines.push_back(wxString() << (i % 16) << ">" << "file_" << i << ".cpp");
+            } else if(what < 90) {
+                lines.push_back(wxString() << (i % 16) << ">C:\\work\\" << msvc_file << "(" << (i % 500)
+                                           << "): warning C4101: 'count': unreferenced local variable");
+            } else if(what < 93) {
+                lines.push_back(wxString() << (i % 16) << ">C:\\work\\" << msvc_file << "(" << (i % 500)
+                                           << "): error C2065: 'foo': undeclared identifier");
+            } else if(what < 94) {
+                lines.push_back("LINK : fatal error LNK1104: cannot open file 'module.lib'");
+            } else {
+                lines.push_back(wxString() << (i % 16) << ">  Generating Code...");
+            }
+        } break;
+        }
+    }
+    return lines;
+}
+
+/// read a captured build log
+bool load_log(const wxString& env_name, std::vector<wxString>& lines)
+{
+    wxString path;
+    clMappedFile file;
+    if(!::wxGetEnv(env_name, &path) || !file.Open(path, (size_t)-1)) {
+        return false;
+    }
+
+    wxString content = wxString::FromUTF8(file.GetData(), file.GetSize());
+    wxArrayString arr = ::wxStringTokenize(content, "\n", wxTOKEN_STRTOK);
+    lines.clear();
+    lines.reserve(arr.size());
+    for(auto& line : arr) {
+        lines.push_back(line.Trim());
+    }
+    return true;
+}
+
+/// this is how `Compiler::Matches()` used to work: every warning pattern and then every error pattern on each line
+class LegacyMatcher
+{
+    struct Pattern {
+        Compiler::CmpInfoPattern info;
+        Compiler::eSeverity severity;
+        std::shared_ptr<wxRegEx> re;
+    };
+    std::vector<Pattern> m_patterns;
+
+    bool IsMatchesPattern(Pattern& pattern, const wxString& line, Compiler::PatternMatch* match_result) const
+    {
+        if(!pattern.re) {
+            // compile the regex
+            pattern.re.reset(new wxRegEx);
+            pattern.re->Compile(pattern.info.pattern, wxRE_ADVANCED | wxRE_ICASE);
+        }
+
+        if(!pattern.re->IsValid()) {
+            return false;
+        }
+
+        long colIndex = wxNOT_FOUND;
+        long lineIndex = wxNOT_FOUND;
+        long fileIndex = wxNOT_FOUND;
+        if(!pattern.info.columnIndex.ToCLong(&colIndex) || !pattern.info.lineNumberIndex.ToCLong(&lineIndex) ||
+           !pattern.info.fileNameIndex.ToCLong(&fileIndex)) {
+            return false;
+        }
+
+        if(!pattern.re->Matches(line)) {
+            return false;
+        }
+
+        match_result->sev = pattern.severity;
+        if(pattern.re->GetMatchCount() > (size_t)fileIndex) {
+            match_result->file_path = pattern.re->GetMatch(line, fileIndex);
+        }
+
+        if(pattern.re->GetMatchCount() > (size_t)lineIndex) {
+            long lineNumber;
+            wxString strLine = pattern.re->GetMatch(line, lineIndex);
+            strLine.ToCLong(&lineNumber);
+            match_result->line_number = lineNumber;
+        }
+
+        if(pattern.re->GetMatchCount() > (size_t)colIndex) {
+            long column;
+            wxString strCol = pattern.re->GetMatch(line, colIndex);
+            if(strCol.StartsWith(":")) {
+                strCol.Remove(0, 1);
+            }
+
+            if(!strCol.IsEmpty() && strCol.ToLong(&column)) {
+                match_result->column = column;
+            }
+        }
+        return true;
+    }
+
+public:
+    LegacyMatcher(const Compiler& compiler)
+    {
+        for(const auto& info : compiler.GetWarnPatterns()) {
+            m_patterns.push_back({ info, Compiler::kSevWarning, nullptr });
+        }
+        for(const auto& info : compiler.GetErrPatterns()) {
+            m_patterns.push_back({ info, Compiler::kSevError, nullptr });
+        }
+    }
+
+    bool Matches(const wxString& line, Compiler::PatternMatch* match_result)
+    {
+        for(auto& pattern : m_patterns) {
+            if(IsMatchesPattern(pattern, line, match_result)) {
+                return true;
+            }
+        }
+        return false;
+    }
+};
+
+struct Counts {
+    size_t errors = 0;
+    size_t warnings = 0;
+    long elapsed_ms = 0;
+};
+
+template <typename MatcherT> Counts classify(MatcherT& matcher, const std::vector<wxString>& lines)
+{
+    Counts counts;
+    wxStopWatch sw;
+    for(const auto& line : lines) {
+        Compiler::PatternMatch match;
+        if(matcher.Matches(line, &match)) {
+            (match.sev == Compiler::kSevError ? counts.errors : counts.warnings)++;
+        }
+    }
+    counts.elapsed_ms = sw.Time();
+    return counts;
+}
+} // namespace
+
+BENCHMARK_FUNC(BuildOutputMatcher)
+{
+    struct Log {
+        wxString name;
+        eLogKind kind;
+        const char* env_name;
+    };
+
+    // replay captured logs when they are provided (one line per build output line)
+    const std::vector<Log> logs = { { "gcc", eLogKind::kGCC, "CL_BENCHMARK_BUILD_LOG_GCC" },
+                                    { "clang", eLogKind::kClang, "CL_BENCHMARK_BUILD_LOG_CLANG" },
+                                    { "msvc", eLogKind::kMSVC, "CL_BENCHMARK_BUILD_LOG_MSVC" } };
+    for(const auto& log : logs) {
+        std::vector<wxString> lines;
+        if(!load_log(log.env_name, lines)) {
+            lines = create_log(log.kind, get_lines_count());
+        }
+        report(log.name + " lines", lines.size(), "lines");
+
+        Compiler compiler(nullptr, log.kind == eLogKind::kMSVC ? Compiler::kRegexVC : Compiler::kRegexGNU);
+        LegacyMatcher legacy(compiler);
+        auto matcher = compiler.CreateOutputMatcher();
+
+        // compile the patterns before we measure
+        Compiler::PatternMatch warmup;
+        legacy.Matches("warmup", &warmup);
+
+        auto legacy_counts = classify(legacy, lines);
+        auto counts = classify(*matcher, lines);
+        report_rate(log.name + " legacy Matches()", lines.size(), legacy_counts.elapsed_ms, "lines");
+        report_rate(log.name + " clBuildOutputMatcher", lines.size(), counts.elapsed_ms, "lines");
+        report(log.name + " errors", counts.errors, "lines");
+        report(log.name + " warnings", counts.warnings, "lines");
+        if(legacy_counts.errors != counts.errors || legacy_counts.warnings != counts.warnings) {
+            report(log.name + " MISMATCH legacy errors", legacy_counts.errors, "lines");
+            report(log.name + " MISMATCH legacy warnings", legacy_counts.warnings, "lines");
+        }
+    }
+}
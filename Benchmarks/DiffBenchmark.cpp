@@ -0,0 +1,111 @@
+#include "AllocationCounter.hpp"
+#include "Diff/clDTL.h"
+#include "Diff/clLineDiff.h"
+#include "benchmark.hpp"
+
+#include <wx/utils.h>
+
+namespace
+{
+size_t get_lines_count()
+{
+    // allow overriding the number of lines from the environment
+    wxString count_str;
+    unsigned long count = 200000;
+    if(::wxGetEnv("CL_BENCHMARK_DIFF_LINES", &count_str)) {
+        count_str.ToCULong(&count);
+    }
+    return count;
+}
+
+/**
+ * @brief generate a file that looks like generated code: many unique lines, and some very frequent ones (braces,
+ * empty lines). `seed` selects the content: files generated with different seeds have almost no unique line in
+ * common
+ */
+wxString generate_file(size_t lines, size_t seed)
+{
+    wxString content;
+    content.reserve(lines * 40);
+    for(size_t i = 0; i < lines; ++i) {
+        switch(i % 8) {
+        case 0:
+            content << "struct Generated_" << seed << "_" << i << " {\n";
+            break;
+        case 6:
+            content << "};\n";
+            break;
+        case 7:
+            content << "\n";
+            break;
+        default:
+            content << "    int field_" << (i * 2654435761u + seed) % 1000003 << " = " << i % 97 << ";\n";
+            break;
+        }
+    }
+    return content;
+}
+
+/**
+ * @brief insert a block at the top and remove one from the middle: every line moves
+ */
+wxString shift_file(const wxString& content, size_t lines)
+{
+    wxString shifted = generate_file(lines / 100, 1) + content;
+    size_t middle = shifted.length() / 2;
+    shifted.erase(middle, shifted.length() / 100);
+    return shifted;
+}
+} // namespace
+
+BENCHMARK_FUNC(Diff)
+{
+    size_t lines = get_lines_count();
+    report("lines", lines, "lines");
+
+    wxString original = generate_file(lines, 0);
+    wxString shifted = shift_file(original, lines);
+    wxString rewritten = generate_file(lines, 7);
+
+    struct Case {
+        wxString name;
+        const wxString* after;
+    };
+    std::vector<Case> cases = { { "identical", &original }, { "shifted", &shifted }, { "rewritten", &rewritten } };
+
+    for(const auto& c : cases) {
+        for(auto algorithm : { clLineDiff::Algorithm::kHistogram, clLineDiff::Algorithm::kPatience }) {
+            wxString label;
+            label << c.name << " (" << (algorithm == clLineDiff::Algorithm::kHistogram ? "histogram" : "patience")
+                  << ")";
+
+            size_t bytes_before = GetAllocatedBytes();
+            wxStopWatch sw;
+            clLineDiff diff(algorithm);
+            diff.SetInputs(original, *c.after);
+            size_t hunks = 0;
+            size_t changed_lines = 0;
+            diff.Run([&](const clLineDiff::Hunk& hunk) {
+                ++hunks;
+                changed_lines += hunk.left_count + hunk.right_count;
+            });
+            report_rate(label, lines, sw.Time(), "lines");
+            report(label + " memory", (GetAllocatedBytes() - bytes_before) / (1024.0 * 1024.0), "MB");
+            report(label + " hunks", hunks, "hunks");
+            report(label + " changed lines", changed_lines, "lines");
+        }
+
+        // the complete result, as displayed by the diff viewer
+        wxStopWatch sw;
+        clDTL dtl;
+        size_t result_lines = 0;
+        dtl.DiffStrings(original, *c.after, clDTL::kTwoPanes,
+                        [&result_lines](clDTL::LineInfoVec_t& left, clDTL::LineInfoVec_t& right, bool is_change) {
+                            wxUnusedVar(right);
+                            wxUnusedVar(is_change);
+                            result_lines += left.size();
+                        });
+        report_rate(c.name + " (clDTL two panes)", lines, sw.Time(), "lines");
+        report(c.name + " (clDTL two panes) result", result_lines, "lines");
+    }
+}
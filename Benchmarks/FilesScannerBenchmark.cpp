@@ -0,0 +1,96 @@
+#include "benchmark.hpp"
+#include "clFilesCollector.h"
+#include "cl_standard_paths.h"
+
+#include <wx/file.h>
+#include <wx/filename.h>
+#include <wx/utils.h>
+
+namespace
+{
+constexpr size_t FILES_PER_FOLDER = 50;
+constexpr size_t FOLDERS_PER_FOLDER = 20;
+
+size_t get_files_count()
+{
+    // allow overriding the number of files from the environment
+    wxString count_str;
+    unsigned long count = 500000;
+    if(::wxGetEnv("CL_BENCHMARK_SCAN_FILES", &count_str)) {
+        count_str.ToCULong(&count);
+    }
+    return count;
+}
+
+/**
+ * @brief create a tree of empty files: FOLDERS_PER_FOLDER folders per level, FILES_PER_FOLDER files in each folder.
+ * Every 5th file is a header, every 10th folder is named `build-N` (excluded by the scan)
+ * @return the number of files created
+ */
+size_t create_tree(const wxString& root, size_t count)
+{
+    size_t created = 0;
+    size_t folder_index = 0;
+    std::vector<wxString> queue = { root };
+    for(size_t i = 0; i < queue.size() && created < count; ++i) {
+        const wxString& folder = queue[i];
+        wxFileName::Mkdir(folder, wxS_DIR_DEFAULT, wxPATH_MKDIR_FULL);
+        for(size_t f = 0; f < FILES_PER_FOLDER && created < count; ++f, ++created) {
+            wxString path;
+            path << folder << "/file_" << f << (f % 5 == 0 ? ".h" : ".cpp");
+            wxFile file;
+            file.Create(path, true);
+        }
+
+        for(size_t d = 0; d < FOLDERS_PER_FOLDER; ++d, ++folder_index) {
+            wxString subfolder;
+            subfolder << folder << "/" << (folder_index % 10 == 9 ? "build-" : "src_") << folder_index;
+            queue.push_back(subfolder);
+        }
+    }
+    return created;
+}
+} // namespace
+
+BENCHMARK_FUNC(FilesScanner)
+{
+    wxString root;
+    root << clStandardPaths::Get().GetTempDir() << "/codelite-scan-benchmark";
+    wxFileName::Rmdir(root, wxPATH_RMDIR_RECURSIVE);
+
+    wxStopWatch sw;
+    size_t files_count = create_tree(root, get_files_count());
+    report("files created", files_count, "files");
+    report("tree creation", sw.Time(), "ms");
+
+    const wxString filespec = "*.cpp;*.h";
+    const wxString exclude_folders = "build-*;.git";
+
+    // warm up the file system cache
+    clFilesScanner scanner;
+    scanner.Scan(root, filespec, wxEmptyString, exclude_folders, [](const wxString&) -> bool { return true; });
+
+    size_t found = 0;
+    auto on_file = [&found](const wxString&) -> bool {
+        ++found;
+        return true;
+    };
+
+    sw.Start();
+    scanner.Scan(root, filespec, wxEmptyString, exclude_folders, on_file);
+    report_rate("Scan()", found, sw.Time(), "files");
+    report("Scan() files found", found, "files");
+
+    for(size_t threads : { 1, 2, 4, 8 }) {
+        found = 0;
+        sw.Start();
+        scanner.ScanParallel(root, filespec, wxEmptyString, exclude_folders, on_file, threads);
+
+        wxString label;
+        label << "ScanParallel() " << threads << " threads";
+        report_rate(label, found, sw.Time(), "files");
+    }
+    report("ScanParallel() files found", found, "files");
+
+    wxFileName::Rmdir(root, wxPATH_RMDIR_RECURSIVE);
+}
@@ -0,0 +1,117 @@
+#include "Diff/clFolderCompare.h"
+#include "benchmark.hpp"
+#include "cl_standard_paths.h"
+
+#include <mutex>
+#include <wx/ffile.h>
+#include <wx/filename.h>
+#include <wx/utils.h>
+
+namespace
+{
+constexpr size_t FILES_PER_FOLDER = 40;
+constexpr size_t FOLDERS_PER_FOLDER = 10;
+constexpr size_t FILE_SIZE = 16 * 1024;
+
+size_t get_files_count()
+{
+    // allow overriding the number of files from the environment
+    wxString count_str;
+    unsigned long count = 20000;
+    if(::wxGetEnv("CL_BENCHMARK_COMPARE_FILES", &count_str)) {
+        count_str.ToCULong(&count);
+    }
+    return count;
+}
+
+/**
+ * @brief create the same tree of files under `left` and `right`. Every 10th file is different on the right side
+ * (same size, last byte changed), so its content has to be hashed to find it
+ * @return the number of files created on each side
+ */
+size_t create_trees(const wxString& left, const wxString& right, size_t count)
+{
+    std::string content(FILE_SIZE, 'x');
+    for(size_t i = 0; i < content.size(); ++i) {
+        content[i] = 'a' + (i * 7) % 26;
+    }
+
+    size_t created = 0;
+    size_t folder_index = 0;
+    std::vector<wxString> queue = { wxEmptyString };
+    for(size_t i = 0; i < queue.size() && created < count; ++i) {
+        const wxString& folder = queue[i];
+        wxFileName::Mkdir(left + folder, wxS_DIR_DEFAULT, wxPATH_MKDIR_FULL);
+        wxFileName::Mkdir(right + folder, wxS_DIR_DEFAULT, wxPATH_MKDIR_FULL);
+        for(size_t f = 0; f < FILES_PER_FOLDER && created < count; ++f, ++created) {
+            wxString name;
+            name << folder << "/file_" << f << ".cpp";
+
+            wxFFile left_file(left + name, "wb");
+            left_file.Write(content.data(), content.size());
+
+            std::string right_content = content;
+            if(created % 10 == 0) {
+                right_content.back() = '!';
+            }
+            wxFFile right_file(right + name, "wb");
+            right_file.Write(right_content.data(), right_content.size());
+        }
+
+        for(size_t d = 0; d < FOLDERS_PER_FOLDER; ++d, ++folder_index) {
+            wxString subfolder;
+            subfolder << folder << "/src_" << folder_index;
+            queue.push_back(subfolder);
+        }
+    }
+    return created;
+}
+} // namespace
+
+BENCHMARK_FUNC(FolderCompare)
+{
+    wxString root;
+    root << clStandardPaths::Get().GetTempDir() << "/codelite-compare-benchmark";
+    wxFileName::Rmdir(root, wxPATH_RMDIR_RECURSIVE);
+
+    wxString left = root + "/left";
+    wxString right = root + "/right";
+
+    wxStopWatch sw;
+    size_t files_count = create_trees(left, right, get_files_count());
+    report("files created", files_count, "files");
+    report("trees creation", sw.Time(), "ms");
+
+    auto cache = std::make_shared<clFileHashCache>();
+    auto run = [&](const wxString& label, size_t threads) {
+        std::mutex m;
+        size_t folders = 0;
+        size_t different = 0;
+        sw.Start();
+        clFolderCompare compare(cache);
+        compare.Run(
+            left, right,
+            [&](clFolderCompare::DirSummary&& summary) {
+                std::unique_lock<std::mutex> lk{ m };
+                ++folders;
+                different += summary.different;
+            },
+            threads);
+        report_rate(label, files_count, sw.Time(), "files");
+        report(label + " folders", folders, "folders");
+        report(label + " different", different, "files");
+    };
+
+    // the file system cache is warm: the files were just written
+    for(size_t threads : { 1, 2, 4, 8 }) {
+        cache->Clear();
+        wxString label;
+        label << "Run() " << threads << " threads";
+        run(label, threads);
+    }
+
+    // nothing changed since the last run: every hash comes from the cache
+    run("Run() cached hashes", 0);
+
+    wxFileName::Rmdir(root, wxPATH_RMDIR_RECURSIVE);
+}
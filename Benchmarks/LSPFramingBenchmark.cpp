@@ -0,0 +1,209 @@
+#include "AllocationCounter.hpp"
+#include "LSP/Message.h"
+#include "LSP/MessageDecoder.hpp"
+#include "benchmark.hpp"
+#include "clMappedFile.hpp"
+
+#include <unordered_map>
+#include <wx/tokenzr.h>
+#include <wx/utils.h>
+
+namespace
+{
+constexpr size_t CHUNK_SIZE = 4096;
+
+size_t get_messages_count()
+{
+    // allow overriding the number of messages from the environment
+    wxString count_str;
+    unsigned long count = 10000;
+    if(::wxGetEnv("CL_BENCHMARK_LSP_MESSAGES", &count_str)) {
+        count_str.ToCULong(&count);
+    }
+    return count;
+}
+
+/// a tiny deterministic generator, so every run replays the same session
+struct Random {
+    unsigned int seed = 42;
+    unsigned int next(unsigned int max)
+    {
+        seed = seed * 1103515245 + 12345;
+        return (seed >> 8) % max;
+    }
+};
+
+void append_frame(std::string& stream, const std::string& payload)
+{
+    stream += "Content-Length: " + std::to_string(payload.length()) + "\r\n\r\n";
+    stream += payload;
+}
+
+/**
+ * @brief build a stream that looks like a clangd session: mostly diagnostics, some large completion and semantic
+ * tokens replies, and log/progress notifications
+ */
+std::string create_session(size_t count)
+{
+    Random random;
+    std::string stream;
+    for(size_t i = 0; i < count; ++i) {
+        std::string payload;
+        unsigned int kind = random.next(10);
+        if(kind < 6) {
+            payload = R"({"jsonrpc":"2.0","method":"textDocument/publishDiagnostics","params":{"uri":"file:///src/)"
+                      R"(generated/module_)" +
+                      std::to_string(i % 50) + R"(.cpp","version":)" + std::to_string(i) + R"(,"diagnostics":[)";
+            unsigned int diags = random.next(12);
+            for(unsigned int d = 0; d < diags; ++d) {
+                payload += d ? "," : "";
+                payload += R"({"range":{"start":{"line":)" + std::to_string(random.next(20000)) +
+                           R"(,"character":4},"end":{"line":12,"character":18}},"severity":2,"code":"-Wunused",)"
+                           R"("source":"clang","message":"unused variable 'résultat' [-Wunused-variable]"})";
+            }
+            payload += "]}}";
+
+        } else if(kind < 8) {
+            payload = R"({"jsonrpc":"2.0","id":)" + std::to_string(i) + R"(,"result":{"isIncomplete":true,"items":[)";
+            unsigned int items = 50 + random.next(300);
+            for(unsigned int n = 0; n < items; ++n) {
+                payload += n ? "," : "";
+                payload += R"({"label":" symbol_)" + std::to_string(n) +
+                           R"((int, const std::string &)","kind":3,"detail":"void","sortText":"3f7d0a2b",)"
+                           R"("filterText":"symbol_)" +
+                           std::to_string(n) + R"(","insertTextFormat":2,"textEdit":{"newText":"symbol_)" +
+                           std::to_string(n) + R"(","range":{"start":{"line":10,"character":4},"end":{"line":10,)"
+                           R"("character":6}}}})";
+            }
+            payload += "]}}";
+
+        } else if(kind < 9) {
+            payload = R"({"jsonrpc":"2.0","id":)" + std::to_string(i) + R"(,"result":{"resultId":")" +
+                      std::to_string(i) + R"(","data":[)";
+            unsigned int tokens = 500 + random.next(3000);
+            for(unsigned int t = 0; t < tokens * 5; ++t) {
+                payload += t ? "," : "";
+                payload += std::to_string(random.next(40));
+            }
+            payload += "]}}";
+
+        } else {
+            payload = R"({"jsonrpc":"2.0","method":"$/progress","params":{"token":"backgroundIndexProgress",)"
+                      R"("value":{"kind":"report","message":")" +
+                      std::to_string(i) + R"(/10000","percentage":)" + std::to_string(i % 100) + "}}}";
+        }
+        append_frame(stream, payload);
+    }
+    return stream;
+}
+
+/**
+ * @brief `LSP::Message::GetJSONPayload` as it was before the frame decoder: tokenize the headers with wxWidgets,
+ * erase the headers and the payload from the front of the buffer and parse the payload through a wxString
+ */
+std::unique_ptr<JSON> legacy_get_json_payload(std::string& network_buffer)
+{
+    size_t where = network_buffer.find("\r\n\r\n");
+    if(where == std::string::npos) {
+        return nullptr;
+    }
+
+    std::unordered_map<std::string, std::string> headers;
+    auto headerSection = network_buffer.substr(0, where);
+    wxArrayString lines = ::wxStringTokenize(headerSection, "\n", wxTOKEN_STRTOK);
+    for(wxString& header : lines) {
+        header.Trim().Trim(false);
+        wxString name = header.BeforeFirst(':');
+        wxString value = header.AfterFirst(':');
+        headers.insert(
+            { name.Trim().Trim(false).mb_str(wxConvUTF8).data(), value.Trim().Trim(false).mb_str(wxConvUTF8).data() });
+    }
+
+    unsigned long contentLength = 0;
+    wxString contentLengthValue = headers["Content-Length"];
+    if(!contentLengthValue.ToCULong(&contentLength)) {
+        return nullptr;
+    }
+
+    size_t headersSize = where + 4;
+    if(network_buffer.length() < (contentLength + headersSize)) {
+        return nullptr;
+    }
+
+    network_buffer.erase(0, headersSize);
+    auto payload = network_buffer.substr(0, contentLength);
+    network_buffer.erase(0, contentLength);
+    wxString json_str = wxString::FromUTF8(payload);
+    return std::make_unique<JSON>(json_str);
+}
+
+struct RunResult {
+    size_t messages = 0;
+    long elapsed_ms = 0;
+    size_t allocations = 0;
+};
+
+/// feed `stream` in chunks of `chunk_size` bytes with `append`, drain the complete messages with `next` after each
+/// chunk
+template <typename Append, typename Next>
+RunResult replay(const std::string& stream, size_t chunk_size, Append append, Next next)
+{
+    RunResult result;
+    size_t allocations_before = GetAllocationsCount();
+    wxStopWatch sw;
+    for(size_t offset = 0; offset < stream.length(); offset += chunk_size) {
+        append(stream.data() + offset, std::min(chunk_size, stream.length() - offset));
+        while(auto json = next()) {
+            ++result.messages;
+        }
+    }
+    result.elapsed_ms = sw.Time();
+    result.allocations = GetAllocationsCount() - allocations_before;
+    return result;
+}
+} // namespace
+
+BENCHMARK_FUNC(LSPFraming)
+{
+    // replay a recorded session (the raw bytes sent by the server) when one is provided
+    std::string stream;
+    wxString session_file;
+    clMappedFile session;
+    if(::wxGetEnv("CL_BENCHMARK_LSP_SESSION", &session_file) && session.Open(session_file, (size_t)-1)) {
+        stream.assign(session.begin(), session.end());
+    } else {
+        stream = create_session(get_messages_count());
+    }
+    double megabytes = (double)stream.length() / (1024.0 * 1024.0);
+    report("session size", megabytes, "MB");
+
+    // a burst is what we get when the UI thread was busy and the whole backlog is delivered at once
+    for(size_t chunk_size : { CHUNK_SIZE, stream.length() }) {
+        wxString suffix = chunk_size == CHUNK_SIZE ? " (4KB reads)" : " (single burst)";
+
+        std::string legacy_buffer;
+        auto legacy = replay(
+            stream, chunk_size, [&](const char* data, size_t len) { legacy_buffer.append(data, len); },
+            [&]() { return legacy_get_json_payload(legacy_buffer); });
+
+        std::string buffer;
+        auto current = replay(
+            stream, chunk_size, [&](const char* data, size_t len) { buffer.append(data, len); },
+            [&]() { return LSP::Message::GetJSONPayload(buffer); });
+
+        LSP::MessageDecoder decoder;
+        auto decoded = replay(
+            stream, chunk_size, [&](const char* data, size_t len) { decoder.Append(data, len); },
+            [&]() { return decoder.Next(); });
+
+        for(const auto& [label, result] : { std::make_pair(wxString("legacy GetJSONPayload"), legacy),
+                                            std::make_pair(wxString("GetJSONPayload"), current),
+                                            std::make_pair(wxString("MessageDecoder"), decoded) }) {
+            double seconds = result.elapsed_ms > 0 ? (double)result.elapsed_ms / 1000.0 : 0.001;
+            report(label + suffix, megabytes / seconds, "MB/s");
+            report(label + suffix + " allocations", (double)result.allocations / std::max<size_t>(result.messages, 1),
+                   "per message");
+        }
+        report("messages decoded" + suffix, decoded.messages, "messages");
+    }
+}
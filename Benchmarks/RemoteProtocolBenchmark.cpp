@@ -0,0 +1,406 @@
+#include "benchmark.hpp"
+#include "clRemoteFrameDecoder.hpp"
+#include "cl_standard_paths.h"
+
+#include <algorithm>
+#include <functional>
+#include <unordered_map>
+#include <wx/crt.h>
+#include <wx/filename.h>
+#include <wx/utils.h>
+
+#ifndef __WXMSW__
+#include <signal.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+constexpr size_t READ_SIZE = 64 * 1024;  // the size of a read from the ssh process
+constexpr size_t FRAME_SIZE = 64 * 1024; // the largest frame the helper sends
+constexpr size_t REQUESTS_COUNT = 4;
+const char msg_terminator[] = ">>codelite-remote-msg-end<<\n";
+
+size_t get_env_count(const wxString& name, unsigned long default_value)
+{
+    // allow overriding the benchmark size from the environment
+    wxString count_str;
+    unsigned long count = default_value;
+    if(::wxGetEnv(name, &count_str)) {
+        count_str.ToCULong(&count);
+    }
+    return count;
+}
+
+/// a reply that looks like the output of a remote "find in files"
+std::string create_reply(size_t request, size_t lines)
+{
+    std::string reply;
+    for(size_t i = 0; i < lines; ++i) {
+        reply += "/home/user/devl/codelite/Plugin/module_" + std::to_string(request) + "_" + std::to_string(i / 40) +
+                 ".cpp:" + std::to_string(i % 2000) + ":    wxString output = m_process->ReadAll(buffer); // " +
+                 std::to_string(i) + "\n";
+    }
+    return reply;
+}
+
+/// the replies as the framed helper sends them: chunks of the replies interleaved, then the end frames
+std::string create_framed_stream(const std::vector<std::string>& replies, bool compress)
+{
+    std::string stream;
+    for(size_t offset = 0;; offset += FRAME_SIZE) {
+        bool any = false;
+        for(size_t id = 0; id < replies.size(); ++id) {
+            if(offset >= replies[id].size()) {
+                continue;
+            }
+            any = true;
+            std::string_view chunk = std::string_view{ replies[id] }.substr(offset, FRAME_SIZE);
+            if(compress) {
+                stream += clRemoteFrameDecoder::Encode(id + 1, clRemoteFrameDecoder::eFrameType::kCompressedData,
+                                                       clRemoteFrameDecoder::Compress(chunk));
+            } else {
+                stream += clRemoteFrameDecoder::Encode(id + 1, clRemoteFrameDecoder::eFrameType::kData, chunk);
+            }
+        }
+        if(!any) {
+            break;
+        }
+    }
+    for(size_t id = 0; id < replies.size(); ++id) {
+        stream += clRemoteFrameDecoder::Encode(id + 1, clRemoteFrameDecoder::eFrameType::kEnd, {});
+    }
+    return stream;
+}
+
+/// the replies as the legacy helper sends them: one after the other, each followed by the terminator
+std::string create_legacy_stream(const std::vector<std::string>& replies)
+{
+    std::string stream;
+    for(const auto& reply : replies) {
+        stream += reply;
+        stream += msg_terminator;
+    }
+    return stream;
+}
+
+/**
+ * @brief `clCodeLiteRemoteProcess::GetNextBuffer` as it was before the framed protocol: search the terminator in the
+ * wxString buffer and erase what was consumed from its front
+ */
+bool legacy_get_next_buffer(wxString& raw_input_buffer, wxString& buffer, bool& is_completed)
+{
+    size_t separator_len = sizeof(msg_terminator) - 1;
+    size_t where = raw_input_buffer.find(msg_terminator);
+    if(where == wxString::npos) {
+        is_completed = false;
+        where = raw_input_buffer.rfind("\n");
+        separator_len = 1;
+    } else {
+        is_completed = true;
+    }
+
+    if(where != wxString::npos) {
+        size_t length_to_take = where;
+        if(separator_len == 1) {
+            length_to_take += 1;
+        }
+        buffer = raw_input_buffer.Mid(0, length_to_take);
+        raw_input_buffer.erase(0, where + separator_len);
+    }
+    return where != wxString::npos;
+}
+
+struct RunResult {
+    size_t replies = 0;
+    size_t chars = 0;
+    long elapsed_ms = 0;
+};
+
+RunResult run_legacy(const std::string& stream, size_t read_size)
+{
+    RunResult result;
+    wxString output_read;
+    wxString buffer;
+    bool is_completed = false;
+    wxStopWatch sw;
+    for(size_t offset = 0; offset < stream.size(); offset += read_size) {
+        // every read is converted to a wxString by the process reader
+        output_read << wxString::FromUTF8(stream.data() + offset, std::min(read_size, stream.size() - offset));
+        while(legacy_get_next_buffer(output_read, buffer, is_completed)) {
+            result.chars += buffer.length();
+            result.replies += is_completed ? 1 : 0;
+        }
+    }
+    result.elapsed_ms = sw.Time();
+    return result;
+}
+
+/// what `clCodeLiteRemoteProcess` does with the frames: collect each reply and pass on its complete lines
+RunResult run_framed(const std::string& stream, size_t read_size)
+{
+    RunResult result;
+    clRemoteFrameDecoder decoder;
+    std::unordered_map<size_t, std::string> pending;
+    auto deliver = [&](std::string& reply, size_t count) {
+        wxString buffer = wxString::FromUTF8(reply.data(), count);
+        reply.erase(0, count);
+        result.chars += buffer.length();
+    };
+
+    wxStopWatch sw;
+    for(size_t offset = 0; offset < stream.size(); offset += read_size) {
+        decoder.Feed(stream.data() + offset, std::min(read_size, stream.size() - offset),
+                     [&](size_t id, clRemoteFrameDecoder::eFrameType type, std::string_view payload) {
+                         std::string& reply = pending[id];
+                         switch(type) {
+                         case clRemoteFrameDecoder::eFrameType::kEnd:
+                             deliver(reply, reply.size());
+                             pending.erase(id);
+                             ++result.replies;
+                             return;
+                         case clRemoteFrameDecoder::eFrameType::kCompressedData:
+                             clRemoteFrameDecoder::Decompress(payload, reply);
+                             break;
+                         case clRemoteFrameDecoder::eFrameType::kData:
+                             reply.append(payload);
+                             break;
+                         case clRemoteFrameDecoder::eFrameType::kText:
+                             return;
+                         }
+                         size_t where = reply.rfind('\n');
+                         if(where != std::string::npos) {
+                             deliver(reply, where + 1);
+                         }
+                     });
+    }
+    result.elapsed_ms = sw.Time();
+    return result;
+}
+
+#ifndef __WXMSW__
+/**
+ * @class LoopbackHelper
+ * @brief run codelite-remote on the local machine in framed mode, connected with pipes instead of ssh
+ */
+class LoopbackHelper
+{
+    pid_t m_pid = -1;
+    int m_stdin = -1;
+    int m_stdout = -1;
+    clRemoteFrameDecoder m_decoder;
+
+public:
+    ~LoopbackHelper()
+    {
+        if(m_stdin != -1) {
+            Send("exit");
+            ::close(m_stdin);
+        }
+        if(m_stdout != -1) {
+            ::close(m_stdout);
+        }
+        if(m_pid != -1) {
+            ::kill(m_pid, SIGTERM);
+            ::waitpid(m_pid, nullptr, 0);
+        }
+    }
+
+    bool Start(const wxString& script)
+    {
+        int to_child[2];
+        int from_child[2];
+        if(::pipe(to_child) != 0) {
+            return false;
+        }
+        if(::pipe(from_child) != 0) {
+            ::close(to_child[0]);
+            ::close(to_child[1]);
+            return false;
+        }
+
+        // don't let a helper that exits early kill the benchmark
+        ::signal(SIGPIPE, SIG_IGN);
+
+        std::string script_path = script.ToStdString(wxConvUTF8);
+        m_pid = ::fork();
+        if(m_pid == 0) {
+            ::dup2(to_child[0], STDIN_FILENO);
+            ::dup2(from_child[1], STDOUT_FILENO);
+            ::close(to_child[0]);
+            ::close(to_child[1]);
+            ::close(from_child[0]);
+            ::close(from_child[1]);
+            ::execlp("python3", "python3", script_path.c_str(), "--context", "benchmark", "--framed", nullptr);
+            ::_exit(127);
+        }
+
+        ::close(to_child[0]);
+        ::close(from_child[1]);
+        m_stdin = to_child[1];
+        m_stdout = from_child[0];
+        return m_pid != -1;
+    }
+
+    bool Send(const std::string& command)
+    {
+        std::string line = command + "\n";
+        size_t written = 0;
+        while(written < line.size()) {
+            ssize_t rc = ::write(m_stdin, line.data() + written, line.size() - written);
+            if(rc <= 0) {
+                return false;
+            }
+            written += rc;
+        }
+        return true;
+    }
+
+    /**
+     * @brief read the helper output and pass the frames to `on_frame` until `done` returns true
+     * @return false if the helper exited first
+     */
+    bool ReadUntil(const clRemoteFrameDecoder::FrameCallback& on_frame, const std::function<bool()>& done)
+    {
+        char buffer[READ_SIZE];
+        while(!done()) {
+            ssize_t count = ::read(m_stdout, buffer, sizeof(buffer));
+            if(count <= 0) {
+                return false;
+            }
+            m_decoder.Feed(buffer, count, on_frame);
+        }
+        return true;
+    }
+};
+
+/// the requests of the loopback runs, as clCodeLiteRemoteProcess sends them
+std::string find_path_command(size_t id)
+{
+    return R"({"command":"find_path","path":"/usr/bin/env","id":)" + std::to_string(id) + "}";
+}
+
+std::string exec_command(size_t id, const std::string& cmd, bool compress)
+{
+    return R"({"command":"exec","wd":"","env":[],"cmd":")" + cmd + R"(","id":)" + std::to_string(id) +
+           (compress ? R"(,"compress":true})" : "}");
+}
+#endif
+} // namespace
+
+BENCHMARK_FUNC(RemoteProtocol)
+{
+    size_t lines = get_env_count("CL_BENCHMARK_REMOTE_LINES", 200000);
+    std::vector<std::string> replies;
+    size_t reply_bytes = 0;
+    for(size_t i = 0; i < REQUESTS_COUNT; ++i) {
+        replies.push_back(create_reply(i, lines / REQUESTS_COUNT));
+        reply_bytes += replies.back().size();
+    }
+    double megabytes = (double)reply_bytes / (1024.0 * 1024.0);
+    report("replies size", megabytes, "MB");
+
+    // large replies, read 64KB at a time
+    std::string legacy_stream = create_legacy_stream(replies);
+    std::string framed_stream = create_framed_stream(replies, false);
+    std::string compressed_stream = create_framed_stream(replies, true);
+    report("compressed stream size", (double)compressed_stream.size() / (1024.0 * 1024.0), "MB");
+
+    auto report_run = [&](const wxString& label, const RunResult& result) {
+        double seconds = result.elapsed_ms > 0 ? (double)result.elapsed_ms / 1000.0 : 0.001;
+        report(label, megabytes / seconds, "MB/s");
+    };
+    report_run("legacy GetNextBuffer", run_legacy(legacy_stream, READ_SIZE));
+    report_run("clRemoteFrameDecoder", run_framed(framed_stream, READ_SIZE));
+    report_run("clRemoteFrameDecoder compressed", run_framed(compressed_stream, READ_SIZE));
+
+    // many small replies delivered at once, e.g. after the UI thread was busy
+    std::vector<std::string> small_replies(get_env_count("CL_BENCHMARK_REMOTE_SMALL_REPLIES", 20000),
+                                           "/home/user/devl/codelite/.git\n");
+    std::string legacy_burst = create_legacy_stream(small_replies);
+    std::string framed_burst = create_framed_stream(small_replies, false);
+    auto legacy_result = run_legacy(legacy_burst, legacy_burst.size());
+    auto framed_result = run_framed(framed_burst, framed_burst.size());
+    report_rate("legacy GetNextBuffer (single burst)", legacy_result.replies, legacy_result.elapsed_ms, "replies");
+    report_rate("clRemoteFrameDecoder (single burst)", framed_result.replies, framed_result.elapsed_ms, "replies");
+
+#ifndef __WXMSW__
+    // the same, end to end, against the helper script running locally
+    wxString script;
+    if(!::wxGetEnv("CL_BENCHMARK_REMOTE_SCRIPT", &script)) {
+        script = clStandardPaths::Get().GetBinFolder() + "/codelite-remote";
+    }
+    if(!wxFileName::FileExists(script)) {
+        wxPrintf("%s: %s not found, skipping the loopback runs\n", name(), script);
+        return;
+    }
+
+    LoopbackHelper helper;
+    if(!helper.Start(script)) {
+        wxPrintf("%s: failed to start %s, skipping the loopback runs\n", name(), script);
+        return;
+    }
+
+    size_t next_id = 0;
+    std::unordered_map<size_t, bool> completed;
+    size_t received = 0;
+    auto on_frame = [&](size_t id, clRemoteFrameDecoder::eFrameType type, std::string_view payload) {
+        if(type == clRemoteFrameDecoder::eFrameType::kEnd) {
+            completed[id] = true;
+        } else if(type == clRemoteFrameDecoder::eFrameType::kCompressedData) {
+            std::string output;
+            clRemoteFrameDecoder::Decompress(payload, output);
+            received += output.size();
+        } else {
+            received += payload.size();
+        }
+    };
+    auto find_path = [&]() {
+        size_t id = ++next_id;
+        helper.Send(find_path_command(id));
+        return id;
+    };
+    auto exec = [&](const std::string& cmd, bool compress) {
+        size_t id = ++next_id;
+        helper.Send(exec_command(id, cmd, compress));
+        return id;
+    };
+    auto wait_for = [&](size_t id) { return helper.ReadUntil(on_frame, [&]() { return completed[id]; }); };
+
+    // round trips
+    size_t round_trips = get_env_count("CL_BENCHMARK_REMOTE_ROUND_TRIPS", 200);
+    wxStopWatch sw;
+    for(size_t i = 0; i < round_trips; ++i) {
+        if(!wait_for(find_path())) {
+            wxPrintf("%s: the helper exited\n", name());
+            return;
+        }
+    }
+    report("find_path round trip", (double)sw.Time() / (double)round_trips, "ms");
+
+    // a large exec output, with and without compression
+    std::string seq_command = "seq 1 " + std::to_string(get_env_count("CL_BENCHMARK_REMOTE_SEQ", 2000000));
+    for(bool compress : { false, true }) {
+        received = 0;
+        sw.Start();
+        wait_for(exec(seq_command, compress));
+        long elapsed_ms = sw.Time();
+        double seconds = elapsed_ms > 0 ? (double)elapsed_ms / 1000.0 : 0.001;
+        report(compress ? "exec output (compressed)" : "exec output", (double)received / (1024.0 * 1024.0) / seconds,
+               "MB/s");
+    }
+
+    // a small request sent behind a slow one is no longer blocked by it
+    size_t slow_id = exec("sleep 1", false);
+    sw.Start();
+    wait_for(find_path());
+    report("find_path behind a 1s exec", sw.Time(), "ms");
+
+    // cancelling a request kills its command
+    sw.Start();
+    helper.Send(R"({"command":"cancel","id":)" + std::to_string(slow_id) + "}");
+    wait_for(slow_id);
+    report("exec cancelled after", sw.Time(), "ms");
+#endif
+}
@@ -0,0 +1,42 @@
+#include "SyntheticTags.hpp"
+
+#include <wx/utils.h>
+
+namespace synthetic_tags
+{
+std::vector<TagEntryPtr> generate_tags(size_t count)
+{
+    std::vector<TagEntryPtr> tags;
+    tags.reserve(count);
+    for(size_t i = 0; i < count; ++i) {
+        size_t file_index = i / TAGS_PER_FILE;
+        wxString scope;
+        scope << "ns_" << (file_index % 50) << "::Class_" << file_index;
+
+        TagEntryPtr tag(new TagEntry());
+        tag->SetName(wxString() << "Method_" << i);
+        tag->SetFile(wxString() << "/tmp/benchmark/src/file_" << file_index << ".cpp");
+        tag->SetLine(i % TAGS_PER_FILE + 1);
+        tag->SetKind(i % 10 == 0 ? "class" : "function");
+        tag->SetAccess("public");
+        tag->SetSignature("(int a, const wxString& b)");
+        tag->SetPattern(wxString() << "/^ void Method_" << i << "(int a, const wxString& b) {$/");
+        tag->SetParent(wxString() << "Class_" << file_index);
+        tag->SetScope(scope);
+        tag->SetPath(scope + "::" + tag->GetName());
+        tags.push_back(tag);
+    }
+    return tags;
+}
+
+size_t get_rows_count()
+{
+    // allow overriding the number of rows from the environment
+    wxString rows_str;
+    unsigned long rows = 1000000;
+    if(::wxGetEnv("CL_BENCHMARK_TAGS_COUNT", &rows_str)) {
+        rows_str.ToCULong(&rows);
+    }
+    return rows;
+}
+} // namespace synthetic_tags
@@ -0,0 +1,27 @@
+#ifndef SYNTHETICTAGS_HPP
+#define SYNTHETICTAGS_HPP
+
+#include "entry.h"
+
+#include <vector>
+
+namespace synthetic_tags
+{
+/// number of tags generated per file
+constexpr size_t TAGS_PER_FILE = 100;
+
+/**
+ * @brief generate `count` synthetic tags, `TAGS_PER_FILE` tags per file.
+ * Tag `i` is named "Method_<i>", it lives in file "file_<i / TAGS_PER_FILE>.cpp" under
+ * the scope "ns_<file % 50>::Class_<file>"
+ */
+std::vector<TagEntryPtr> generate_tags(size_t count);
+
+/**
+ * @brief return the number of tags to generate. Defaults to 1M, can be overridden
+ * with the environment variable CL_BENCHMARK_TAGS_COUNT
+ */
+size_t get_rows_count();
+} // namespace synthetic_tags
+
+#endif // SYNTHETICTAGS_HPP
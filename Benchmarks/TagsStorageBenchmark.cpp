@@ -0,0 +1,75 @@
+#include "SyntheticTags.hpp"
+#include "benchmark.hpp"
+#include "clTempFile.hpp"
+#include "database/tags_storage_sqlite3.h"
+
+namespace
+{
+/**
+ * @brief the storing method used before the bulk ingestion path: delete by file using
+ * a concatenated SQL and a freshly prepared INSERT statement for every row
+ */
+void store_row_by_row(TagsStorageSQLite& db, const std::vector<TagEntryPtr>& tags)
+{
+    wxStringSet_t files;
+    for(auto tag : tags) {
+        files.insert(tag->GetFile());
+    }
+
+    db.Begin();
+    for(const wxString& file : files) {
+        db.ExecuteUpdate(wxString() << "delete from tags where File='" << file << "'");
+    }
+
+    for(auto tag : tags) {
+        wxSQLite3Statement statement =
+            db.PrepareStatement("INSERT OR REPLACE INTO TAGS VALUES (NULL, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)");
+        statement.Bind(1, tag->GetName());
+        statement.Bind(2, wxFileName(tag->GetFile()).GetFullPath());
+        statement.Bind(3, tag->GetLine());
+        statement.Bind(4, tag->GetKind());
+        statement.Bind(5, tag->GetAccess());
+        statement.Bind(6, tag->GetSignature());
+        statement.Bind(7, tag->GetPattern());
+        statement.Bind(8, tag->GetParent());
+        statement.Bind(9, tag->GetInheritsAsString());
+        statement.Bind(10, tag->GetPath());
+        statement.Bind(11, tag->GetTypename());
+        statement.Bind(12, tag->GetScope());
+        statement.Bind(13, tag->GetTemplateDefinition());
+        statement.Bind(14, tag->GetTagProperties());
+        statement.Bind(15, tag->GetMacrodef());
+        statement.ExecuteUpdate();
+    }
+    db.Commit();
+}
+} // namespace
+
+BENCHMARK_FUNC(TagsStorageStore)
+{
+    size_t rows = synthetic_tags::get_rows_count();
+    std::vector<TagEntryPtr> tags = synthetic_tags::generate_tags(rows);
+    report("rows", rows, "tags");
+
+    // run each method twice: once on an empty database and once when all the files already exist
+    // in the database (i.e. re-indexing)
+    for(int method = 0; method < 2; ++method) {
+        clTempFile db_file("db");
+        TagsStorageSQLite db;
+        db.OpenDatabase(db_file.GetFileName());
+        db.SetUseCache(false);
+
+        for(int pass = 0; pass < 2; ++pass) {
+            wxString label;
+            label << (method == 0 ? "row-by-row insert" : "Store()") << (pass == 0 ? " (new db)" : " (re-index)");
+
+            wxStopWatch sw;
+            if(method == 0) {
+                store_row_by_row(db, tags);
+            } else {
+                db.Store(tags, true);
+            }
+            report_rate(label, rows, sw.Time(), "rows");
+        }
+    }
+}
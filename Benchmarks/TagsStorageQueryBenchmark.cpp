@@ -0,0 +1,120 @@
+#include "SyntheticTags.hpp"
+#include "benchmark.hpp"
+#include "clTempFile.hpp"
+#include "database/tags_storage_sqlite3.h"
+
+#include <memory>
+#include <random>
+
+namespace
+{
+constexpr size_t QUERIES_COUNT = 30000;
+
+/// the code-completion lookups, see `run_query_mix`
+enum class eQuery { kPrefix, kScopeAndName, kPathAndKind };
+
+/**
+ * @brief run a single lookup using SQL with the values concatenated into it (the way the queries were
+ * built before they were parameterized): every query is compiled by SQLite from scratch
+ */
+size_t run_concatenated_query(TagsStorageSQLite& db, eQuery type, const TagEntryPtr& tag)
+{
+    wxString sql;
+    switch(type) {
+    case eQuery::kPrefix:
+        sql << "select * from tags where  name LIKE '" << tag->GetName() << "%' ESCAPE '^'  LIMIT "
+            << db.GetSingleSearchLimit();
+        break;
+    case eQuery::kScopeAndName:
+        sql << "select * from tags where  scope = '" << tag->GetScope() << "'  AND  name ='" << tag->GetName()
+            << "'  LIMIT " << db.GetSingleSearchLimit();
+        break;
+    case eQuery::kPathAndKind:
+        sql << "select * from tags where path='" << tag->GetPath()
+            << "' and kind in ('function','class') order by ID asc limit 10";
+        break;
+    }
+
+    size_t count = 0;
+    wxSQLite3ResultSet rs = db.Query(sql);
+    while(rs.NextRow()) {
+        std::unique_ptr<TagEntry> entry(TagsStorageSQLite::FromSQLite3ResultSet(rs));
+        ++count;
+    }
+    rs.Finalize();
+    return count;
+}
+
+/**
+ * @brief run a single lookup using the storage API (bound parameters + cached statements, or the symbol index
+ * once it is loaded)
+ */
+size_t run_query(TagsStorageSQLite& db, eQuery type, const TagEntryPtr& tag)
+{
+    std::vector<TagEntryPtr> tags;
+    switch(type) {
+    case eQuery::kPrefix:
+        db.GetTagsByName(tag->GetName(), tags, false);
+        break;
+    case eQuery::kScopeAndName:
+        db.GetTagsByScopeAndName(tag->GetScope(), tag->GetName(), false, tags);
+        break;
+    case eQuery::kPathAndKind:
+        db.GetTagsByPathAndKind(tag->GetPath(), tags, { "function", "class" }, 10);
+        break;
+    }
+    return tags.size();
+}
+} // namespace
+
+BENCHMARK_FUNC(TagsStorageQuery)
+{
+    size_t rows = synthetic_tags::get_rows_count();
+    std::vector<TagEntryPtr> tags = synthetic_tags::generate_tags(rows);
+    report("rows", rows, "tags");
+
+    clTempFile db_file("db");
+    TagsStorageSQLite db;
+    db.OpenDatabase(db_file.GetFileName());
+    db.Store(tags, true);
+
+    // measure the database, not the results cache
+    db.SetUseCache(false);
+
+    // a fixed seed, so both methods run the exact same lookups
+    std::vector<TagEntryPtr> lookups;
+    std::mt19937 rng(1234);
+    std::uniform_int_distribution<size_t> dist(0, tags.empty() ? 0 : tags.size() - 1);
+    lookups.reserve(QUERIES_COUNT);
+    for(size_t i = 0; i < QUERIES_COUNT && !tags.empty(); ++i) {
+        lookups.push_back(tags[dist(rng)]);
+    }
+
+    const std::vector<std::pair<eQuery, wxString>> query_types = {
+        { eQuery::kPrefix, "prefix" },
+        { eQuery::kScopeAndName, "scope+name" },
+        { eQuery::kPathAndKind, "path+kind" },
+    };
+
+    const std::vector<wxString> methods = { " (concatenated SQL)", " (bound parameters)", " (symbol index)" };
+    for(size_t method = 0; method < methods.size(); ++method) {
+        if(method == 2) {
+            wxStopWatch sw;
+            db.LoadSymbolIndex();
+            report("symbol index load time", sw.Time(), "ms");
+        }
+
+        for(const auto& query_type : query_types) {
+            wxString label = query_type.second + methods[method];
+            size_t matches = 0;
+            wxStopWatch sw;
+            for(const auto& tag : lookups) {
+                matches += method == 0 ? run_concatenated_query(db, query_type.first, tag)
+                                       : run_query(db, query_type.first, tag);
+            }
+            report_rate(label, lookups.size(), sw.Time(), "queries");
+            report(label + " matches", matches, "tags");
+        }
+    }
+    TagsSymbolIndex::Release(db_file.GetFileName().GetFullPath());
+}
@@ -0,0 +1,74 @@
+#ifndef BENCHMARK_HPP
+#define BENCHMARK_HPP
+
+#include <vector>
+#include <wx/stopwatch.h>
+#include <wx/string.h>
+
+class IBenchmark;
+
+/**
+ * @class BenchmarkRunner
+ * @brief holds the list of registered benchmarks and runs them
+ */
+class BenchmarkRunner
+{
+    std::vector<IBenchmark*> m_benchmarks;
+
+public:
+    static BenchmarkRunner& Get();
+
+    void Add(IBenchmark* benchmark) { m_benchmarks.push_back(benchmark); }
+    /**
+     * @brief run all the benchmarks whose name contains one of `filters`. Run all if `filters` is empty
+     */
+    void Run(const std::vector<wxString>& filters);
+};
+
+/**
+ * @class IBenchmark
+ * @brief the benchmark interface
+ */
+class IBenchmark
+{
+protected:
+    wxString m_name;
+
+public:
+    IBenchmark(const wxString& name)
+        : m_name(name)
+    {
+        BenchmarkRunner::Get().Add(this);
+    }
+    virtual ~IBenchmark() = default;
+    virtual void run() = 0;
+    const wxString& name() const { return m_name; }
+
+    /**
+     * @brief print a single measurement line: "<name>: <label> <value> <unit>"
+     */
+    void report(const wxString& label, double value, const wxString& unit) const;
+    /**
+     * @brief print the throughput of `count` items processed in `elapsed_ms` milliseconds
+     */
+    void report_rate(const wxString& label, size_t count, long elapsed_ms, const wxString& unit) const;
+};
+
+///////////////////////////////////////////////////////////
+// Helper macros:
+///////////////////////////////////////////////////////////
+
+#define BENCHMARK_FUNC(Name)                           \
+    class Benchmark_##Name : public IBenchmark         \
+    {                                                  \
+    public:                                            \
+        Benchmark_##Name()                             \
+            : IBenchmark(#Name)                        \
+        {                                              \
+        }                                              \
+        void run() override;                           \
+    };                                                 \
+    Benchmark_##Name theBenchmark##Name;               \
+    void Benchmark_##Name::run()
+
+#endif // BENCHMARK_HPP
@@ -0,0 +1,59 @@
+#include "benchmark.hpp"
+#include "cl_standard_paths.h"
+
+#include <wx/crt.h>
+#include <wx/filename.h>
+#include <wx/init.h>
+#include <wx/log.h>
+
+BenchmarkRunner& BenchmarkRunner::Get()
+{
+    static BenchmarkRunner runner;
+    return runner;
+}
+
+void BenchmarkRunner::Run(const std::vector<wxString>& filters)
+{
+    for(IBenchmark* benchmark : m_benchmarks) {
+        bool should_run = filters.empty();
+        for(const wxString& filter : filters) {
+            if(benchmark->name().Contains(filter)) {
+                should_run = true;
+                break;
+            }
+        }
+
+        if(!should_run) {
+            continue;
+        }
+        wxPrintf("==> %s\n", benchmark->name());
+        benchmark->run();
+    }
+}
+
+void IBenchmark::report(const wxString& label, double value, const wxString& unit) const
+{
+    wxPrintf("%s: %-40s %12.2f %s\n", m_name, label, value, unit);
+}
+
+void IBenchmark::report_rate(const wxString& label, size_t count, long elapsed_ms, const wxString& unit) const
+{
+    double seconds = elapsed_ms > 0 ? (double)elapsed_ms / 1000.0 : 0.001;
+    report(label, (double)count / seconds, unit + "/sec");
+}
+
+int main(int argc, char** argv)
+{
+    wxInitializer initializer(argc, argv);
+    wxLogNull NOLOG;
+
+    // ensure that the user data dir exists
+    wxFileName::Mkdir(clStandardPaths::Get().GetUserDataDir(), wxPosixPermissions::wxS_DIR_DEFAULT, wxPATH_MKDIR_FULL);
+
+    std::vector<wxString> filters;
+    for(int i = 1; i < argc; ++i) {
+        filters.push_back(argv[i]);
+    }
+    BenchmarkRunner::Get().Run(filters);
+    return 0;
+}
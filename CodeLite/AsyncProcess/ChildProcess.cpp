@@ -32,7 +32,7 @@ wxString& wrap_with_quotes(wxString& str)
 }
 } // namespace
 
-void ChildProcess::Start(const wxArrayString& args)
+void ChildProcess::Start(const wxArrayString& args, size_t flags)
 {
     if(args.IsEmpty()) {
         return;
@@ -50,12 +50,12 @@ void ChildProcess::Start(const wxArrayString& args)
     }
 
     // Launch the process
-    m_process.reset(::CreateAsyncProcess(this, command, IProcessCreateDefault | IProcessStderrEvent));
+    m_process.reset(::CreateAsyncProcess(this, command, flags));
     if(!m_process) {
         throw clException(wxString() << "Failed to execute process: " << command);
     };
 #else
-    m_childProcess = std::make_unique<UnixProcess>(this, args);
+    m_childProcess = std::make_unique<UnixProcess>(this, args, flags);
 #endif
 }
 
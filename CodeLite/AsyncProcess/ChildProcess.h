@@ -26,7 +26,10 @@ public:
     ChildProcess() = default;
     ~ChildProcess() override;
 
-    void Start(const wxArrayString& args);
+    /**
+     * @brief start the process. `flags` are the `IProcessCreateFlags` to use
+     */
+    void Start(const wxArrayString& args, size_t flags = IProcessCreateDefault | IProcessStderrEvent);
     void Write(const wxString& message);
     void Write(const std::string& message);
     bool IsOk() const;
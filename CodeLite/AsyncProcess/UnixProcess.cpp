@@ -11,7 +11,7 @@
 #include <sys/types.h>
 #include <sys/syscall.h>
 
-UnixProcess::UnixProcess(wxEvtHandler* owner, const wxArrayString& args)
+UnixProcess::UnixProcess(wxEvtHandler* owner, const wxArrayString& args, size_t flags)
     : m_owner(owner)
 {
     m_goingDown.store(false);
@@ -74,9 +74,12 @@ UnixProcess::UnixProcess(wxEvtHandler* owner, const wxArrayString& args)
         m_childStdout.CloseWriteFd();
         m_childStderr.CloseWriteFd();
 
-        // Start the reader and writer threads
-        StartWriterThread();
-        StartReaderThread();
+        bool use_reactor = (flags & IProcessReactor) && clProcessReactor::IsSupported();
+        if(!use_reactor || !StartReactor()) {
+            // Start the reader and writer threads
+            StartWriterThread();
+            StartReaderThread();
+        }
     }
 }
 
@@ -163,6 +166,11 @@ void UnixProcess::Stop()
 
 void UnixProcess::Write(const std::string& message)
 {
+    if(m_reactorChannel) {
+        clProcessReactor::Get().Write(m_reactorChannel, message);
+        return;
+    }
+
     if(!m_writerThread) {
         return;
     }
@@ -224,9 +232,36 @@ void UnixProcess::StartReaderThread()
         this, m_childStdout.GetReadFd(), m_childStderr.GetReadFd());
 }
 
+bool UnixProcess::StartReactor()
+{
+    auto on_output = [this](const std::string& data, bool is_stderr) {
+        clProcessEvent evt(is_stderr ? wxEVT_ASYNC_PROCESS_STDERR : wxEVT_ASYNC_PROCESS_OUTPUT);
+        evt.SetOutput(wxString() << data);
+        evt.SetOutputRaw(data);
+        m_owner->AddPendingEvent(evt);
+    };
+
+    auto on_terminated = [this]() {
+        clProcessEvent evt(wxEVT_ASYNC_PROCESS_TERMINATED);
+        wxString error_message;
+        int exit_code = Wait();
+        error_message << "Process exit code (" << exit_code << "):" << strerror(exit_code);
+        evt.SetString(error_message);
+        m_owner->AddPendingEvent(evt);
+    };
+
+    m_reactorChannel = clProcessReactor::Get().Add(m_childStdout.GetReadFd(), m_childStderr.GetReadFd(),
+                                                   m_childStdin.GetWriteFd(), on_output, on_terminated);
+    return m_reactorChannel != 0;
+}
+
 void UnixProcess::Detach()
 {
     m_goingDown.store(true);
+    if(m_reactorChannel) {
+        clProcessReactor::Get().Remove(m_reactorChannel);
+        m_reactorChannel = 0;
+    }
     if(m_writerThread) {
         m_writerThread->join();
         wxDELETE(m_writerThread);
@@ -13,6 +13,9 @@
 #include <atomic>
 #include <wx/event.h>
 
+#include "asyncprocess.h"
+#include "clProcessReactor.h"
+
 // Wrapping pipe in a class makes sure they are closed when we leave scope
 #define CLOSE_FD(fd)        \
     if(fd != wxNOT_FOUND) { \
@@ -61,6 +64,7 @@ private:
     wxMessageQueue<std::string> m_outgoingQueue;
     std::atomic_bool m_goingDown;
     wxEvtHandler* m_owner = nullptr;
+    clProcessReactor::ChannelId m_reactorChannel = 0;
 
 protected:
     // sync operations
@@ -69,11 +73,16 @@ protected:
 
     void StartWriterThread();
     void StartReaderThread();
+    bool StartReactor();
 
 public:
     int child_pid = -1;
 
-    UnixProcess(wxEvtHandler* owner, const wxArrayString& args);
+    /**
+     * @brief start the process. Pass `IProcessReactor` in `flags` to use the shared I/O reactor instead of a reader
+     * and a writer thread (when the reactor is not supported, the threads are used)
+     */
+    UnixProcess(wxEvtHandler* owner, const wxArrayString& args, size_t flags = IProcessCreateDefault);
     ~UnixProcess();
 
     // wait for process termination
@@ -56,6 +56,8 @@ enum IProcessCreateFlags {
     IProcessWrapInShell = (1 << 10),   // wrap the command in the OS shell (CMD, BASH)
     IProcessPseudoConsole = (1 << 11), // MSW only: use CreatePseudoConsole API for creating the process
     IProcessNoPty = (1 << 12),        // Unix only: do not use forkpty, use normal fork()
+    IProcessReactor = (1 << 13), // Linux only: read the process output on the shared I/O reactor (clProcessReactor)
+                                 // instead of starting a reader thread for this process
 };
 
 class WXDLLIMPEXP_CL IProcess;
@@ -172,11 +174,11 @@ public:
     /**
      * @brief stop reading process output in the background thread
      */
-    void SuspendAsyncReads();
+    virtual void SuspendAsyncReads();
     /**
      * @brief resume reading process output in the background
      */
-    void ResumeAsyncReads();
+    virtual void ResumeAsyncReads();
 };
 
 // Help method
@@ -0,0 +1,383 @@
+#include "clProcessReactor.h"
+
+#include "file_logger.h"
+
+#ifdef __linux__
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+constexpr size_t READ_BUFFER_SIZE = 64 * 1024;
+constexpr int MAX_EVENTS = 64;
+} // namespace
+
+clProcessReactor& clProcessReactor::Get()
+{
+    static clProcessReactor reactor;
+    return reactor;
+}
+
+#ifdef __linux__
+
+bool clProcessReactor::IsSupported() { return true; }
+
+clProcessReactor::clProcessReactor() {}
+
+clProcessReactor::~clProcessReactor()
+{
+    if(m_thread) {
+        uint64_t value = 1;
+        if(::write(m_wakeup, &value, sizeof(value)) < 0) {
+            clWARNING() << "clProcessReactor: failed to wakeup the reactor thread." << strerror(errno) << endl;
+        }
+        m_thread->join();
+        wxDELETE(m_thread);
+    }
+
+    if(m_wakeup != -1) {
+        ::close(m_wakeup);
+    }
+
+    if(m_epoll != -1) {
+        ::close(m_epoll);
+    }
+}
+
+bool clProcessReactor::EnsureStarted()
+{
+    if(m_thread) {
+        return true;
+    }
+
+    m_epoll = ::epoll_create1(EPOLL_CLOEXEC);
+    if(m_epoll == -1) {
+        clERROR() << "clProcessReactor: epoll_create1() error." << strerror(errno) << endl;
+        return false;
+    }
+
+    m_wakeup = ::eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if(m_wakeup == -1) {
+        clERROR() << "clProcessReactor: eventfd() error." << strerror(errno) << endl;
+        ::close(m_epoll);
+        m_epoll = -1;
+        return false;
+    }
+
+    struct epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN;
+    ev.data.fd = m_wakeup;
+    ::epoll_ctl(m_epoll, EPOLL_CTL_ADD, m_wakeup, &ev);
+
+    m_thread = new std::thread([this]() { Run(); });
+    clDEBUG() << "clProcessReactor: started" << endl;
+    return true;
+}
+
+void clProcessReactor::Run()
+{
+    struct epoll_event events[MAX_EVENTS];
+    while(true) {
+        int count = ::epoll_wait(m_epoll, events, MAX_EVENTS, -1);
+        if(count < 0) {
+            if(errno == EINTR) {
+                continue;
+            }
+            clERROR() << "clProcessReactor: epoll_wait() error." << strerror(errno) << endl;
+            break;
+        }
+
+        for(int i = 0; i < count; ++i) {
+            int fd = events[i].data.fd;
+            if(fd == m_wakeup) {
+                // we only wake up the reactor to shut it down
+                clDEBUG() << "clProcessReactor: going down" << endl;
+                return;
+            }
+
+            std::lock_guard<std::mutex> lock{ m_mutex };
+            // the channel might have been removed or suspended since epoll_wait() returned
+            auto iter = m_fds.find(fd);
+            if(iter == m_fds.end()) {
+                continue;
+            }
+
+            ChannelPtr channel = iter->second;
+            if(channel->terminated) {
+                continue;
+            }
+
+            uint32_t flags = events[i].events;
+            if((flags & EPOLLOUT) && fd == channel->stdin_fd && !DoFlush(channel)) {
+                // the process closed its stdin, drop whatever we still have for it
+                channel->pending_write.clear();
+                UpdateInterest(channel, fd);
+            }
+
+            if(!(flags & (EPOLLIN | EPOLLHUP | EPOLLERR)) || channel->suspended) {
+                continue;
+            }
+
+            if(fd == channel->stdout_fd) {
+                if(!DoRead(channel, fd)) {
+                    DoTerminate(channel);
+                }
+            } else if(fd == channel->stderr_fd) {
+                if(!DoRead(channel, fd)) {
+                    // stderr closed, keep reading stdout until the process terminates
+                    channel->stderr_fd = -1;
+                    UpdateInterest(channel, fd);
+                    m_fds.erase(fd);
+                }
+            }
+        }
+    }
+}
+
+void clProcessReactor::UpdateInterest(const ChannelPtr& channel, int fd)
+{
+    uint32_t events = 0;
+    if(!channel->suspended && (fd == channel->stdout_fd || fd == channel->stderr_fd)) {
+        events |= EPOLLIN;
+    }
+
+    if(fd == channel->stdin_fd && !channel->pending_write.empty()) {
+        events |= EPOLLOUT;
+    }
+
+    // EPOLLHUP and EPOLLERR are always reported, even with an empty mask. So an fd we are not interested in is removed
+    // from the set, otherwise a suspended process that exits would keep the reactor spinning
+    auto iter = m_registered.find(fd);
+    uint32_t current = iter == m_registered.end() ? 0 : iter->second;
+    if(events == current) {
+        return;
+    }
+
+    int op = EPOLL_CTL_MOD;
+    if(events == 0) {
+        op = EPOLL_CTL_DEL;
+        m_registered.erase(iter);
+    } else {
+        op = current == 0 ? EPOLL_CTL_ADD : EPOLL_CTL_MOD;
+        m_registered[fd] = events;
+    }
+
+    struct epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = events;
+    ev.data.fd = fd;
+    if(::epoll_ctl(m_epoll, op, fd, &ev) < 0) {
+        clWARNING() << "clProcessReactor: epoll_ctl() error for fd:" << fd << "." << strerror(errno) << endl;
+    }
+}
+
+void clProcessReactor::Unregister(const ChannelPtr& channel)
+{
+    for(int fd : { channel->stdout_fd, channel->stderr_fd, channel->stdin_fd }) {
+        auto iter = m_fds.find(fd);
+        if(fd == -1 || iter == m_fds.end() || iter->second != channel) {
+            continue;
+        }
+        if(m_registered.erase(fd)) {
+            ::epoll_ctl(m_epoll, EPOLL_CTL_DEL, fd, nullptr);
+        }
+        m_fds.erase(iter);
+    }
+}
+
+bool clProcessReactor::DoRead(const ChannelPtr& channel, int fd)
+{
+    // a single read per wakeup: epoll is level triggered, so a chatty process can not starve the others
+    char buffer[READ_BUFFER_SIZE];
+    ssize_t bytes = 0;
+    do {
+        bytes = ::read(fd, buffer, sizeof(buffer));
+    } while(bytes < 0 && errno == EINTR);
+
+    if(bytes > 0) {
+        channel->on_output(std::string(buffer, bytes), fd != channel->stdout_fd);
+        return true;
+    }
+    // EAGAIN: nothing to read. 0 or any other error (EIO for a pty) means that the other end was closed
+    return bytes < 0 && (errno == EAGAIN || errno == EWOULDBLOCK);
+}
+
+bool clProcessReactor::DoFlush(const ChannelPtr& channel)
+{
+    std::string& pending = channel->pending_write;
+    size_t offset = 0;
+    bool is_ok = true;
+    while(offset < pending.size()) {
+        ssize_t bytes = ::write(channel->stdin_fd, pending.data() + offset, pending.size() - offset);
+        if(bytes > 0) {
+            offset += bytes;
+            continue;
+        }
+
+        if(bytes < 0 && errno == EINTR) {
+            continue;
+        }
+        is_ok = bytes < 0 && (errno == EAGAIN || errno == EWOULDBLOCK);
+        break;
+    }
+
+    pending.erase(0, offset);
+    if(is_ok) {
+        // poll for EPOLLOUT only while we have something to write
+        UpdateInterest(channel, channel->stdin_fd);
+    }
+    return is_ok;
+}
+
+void clProcessReactor::DoTerminate(const ChannelPtr& channel)
+{
+    channel->terminated = true;
+    Unregister(channel);
+    if(channel->on_terminated) {
+        channel->on_terminated();
+    }
+}
+
+clProcessReactor::ChannelId clProcessReactor::Add(int stdout_fd, int stderr_fd, int stdin_fd, OnOutput_t on_output,
+                                                  OnTerminated_t on_terminated)
+{
+    if(stdout_fd == -1 || !on_output) {
+        return 0;
+    }
+
+    std::lock_guard<std::mutex> lock{ m_mutex };
+    if(!EnsureStarted()) {
+        return 0;
+    }
+
+    auto channel = std::make_shared<Channel>();
+    channel->id = m_nextId++;
+    channel->stdout_fd = stdout_fd;
+    channel->stderr_fd = stderr_fd;
+    channel->stdin_fd = stdin_fd;
+    channel->on_output = std::move(on_output);
+    channel->on_terminated = std::move(on_terminated);
+
+    for(int fd : { stdout_fd, stderr_fd, stdin_fd }) {
+        if(fd == -1 || m_fds.count(fd)) {
+            // not used, or the same as stdout (pty)
+            continue;
+        }
+        int fl = ::fcntl(fd, F_GETFL);
+        ::fcntl(fd, F_SETFL, fl | O_NONBLOCK);
+        m_fds.insert({ fd, channel });
+        UpdateInterest(channel, fd);
+    }
+    m_channels.insert({ channel->id, channel });
+    return channel->id;
+}
+
+void clProcessReactor::Remove(ChannelId id)
+{
+    std::lock_guard<std::mutex> lock{ m_mutex };
+    auto iter = m_channels.find(id);
+    if(iter == m_channels.end()) {
+        return;
+    }
+
+    ChannelPtr channel = iter->second;
+    m_channels.erase(iter);
+    if(!channel->terminated) {
+        channel->terminated = true;
+        Unregister(channel);
+    }
+}
+
+bool clProcessReactor::Write(ChannelId id, const std::string& data)
+{
+    std::lock_guard<std::mutex> lock{ m_mutex };
+    auto iter = m_channels.find(id);
+    if(iter == m_channels.end() || iter->second->stdin_fd == -1) {
+        return false;
+    }
+
+    ChannelPtr channel = iter->second;
+    if(channel->terminated) {
+        return false;
+    }
+
+    if(!channel->pending_write.empty()) {
+        // keep the order: the reactor thread will write it once the pipe is writable
+        channel->pending_write.append(data);
+        return true;
+    }
+
+    channel->pending_write = data;
+    if(!DoFlush(channel)) {
+        channel->pending_write.clear();
+        return false;
+    }
+    return true;
+}
+
+void clProcessReactor::Suspend(ChannelId id)
+{
+    std::lock_guard<std::mutex> lock{ m_mutex };
+    auto iter = m_channels.find(id);
+    if(iter == m_channels.end() || iter->second->suspended || iter->second->terminated) {
+        return;
+    }
+
+    ChannelPtr channel = iter->second;
+    channel->suspended = true;
+    for(int fd : { channel->stdout_fd, channel->stderr_fd }) {
+        if(fd != -1) {
+            UpdateInterest(channel, fd);
+        }
+    }
+}
+
+void clProcessReactor::Resume(ChannelId id)
+{
+    std::lock_guard<std::mutex> lock{ m_mutex };
+    auto iter = m_channels.find(id);
+    if(iter == m_channels.end() || !iter->second->suspended || iter->second->terminated) {
+        return;
+    }
+
+    ChannelPtr channel = iter->second;
+    channel->suspended = false;
+    for(int fd : { channel->stdout_fd, channel->stderr_fd }) {
+        if(fd != -1) {
+            UpdateInterest(channel, fd);
+        }
+    }
+}
+
+#else
+
+bool clProcessReactor::IsSupported() { return false; }
+
+clProcessReactor::clProcessReactor() {}
+clProcessReactor::~clProcessReactor() {}
+bool clProcessReactor::EnsureStarted() { return false; }
+void clProcessReactor::Run() {}
+void clProcessReactor::UpdateInterest(const ChannelPtr& channel, int fd) {}
+void clProcessReactor::Unregister(const ChannelPtr& channel) {}
+bool clProcessReactor::DoRead(const ChannelPtr& channel, int fd) { return false; }
+bool clProcessReactor::DoFlush(const ChannelPtr& channel) { return false; }
+void clProcessReactor::DoTerminate(const ChannelPtr& channel) {}
+
+clProcessReactor::ChannelId clProcessReactor::Add(int stdout_fd, int stderr_fd, int stdin_fd, OnOutput_t on_output,
+                                                  OnTerminated_t on_terminated)
+{
+    return 0;
+}
+
+void clProcessReactor::Remove(ChannelId id) {}
+bool clProcessReactor::Write(ChannelId id, const std::string& data) { return false; }
+void clProcessReactor::Suspend(ChannelId id) {}
+void clProcessReactor::Resume(ChannelId id) {}
+
+#endif
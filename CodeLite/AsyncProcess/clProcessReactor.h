@@ -0,0 +1,109 @@
+#ifndef CLPROCESSREACTOR_H
+#define CLPROCESSREACTOR_H
+
+#include "codelite_exports.h"
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+
+/**
+ * @class clProcessReactor
+ * @brief a single I/O thread that multiplexes the stdout, stderr and stdin of all the child processes
+ *
+ * Instead of a reader thread per process, a process registers its file descriptors with the reactor and gets called
+ * back (on the reactor thread) when data arrives and when its stdout is closed. Writes to stdin are non blocking, the
+ * data that the child did not accept yet is kept and flushed when the pipe becomes writable again.
+ *
+ * The reactor uses epoll and an eventfd for wakeups, so it is only available on Linux. Use `IsSupported()` and fall
+ * back to a reader thread on other platforms
+ */
+class WXDLLIMPEXP_CL clProcessReactor
+{
+public:
+    typedef uint64_t ChannelId;
+    /// called with the raw bytes read from the process. `is_stderr` is true for data read from the stderr handle
+    typedef std::function<void(const std::string& data, bool is_stderr)> OnOutput_t;
+    /// called once, when the process stdout is closed (i.e. the process terminated)
+    typedef std::function<void()> OnTerminated_t;
+
+private:
+    struct Channel {
+        ChannelId id = 0;
+        int stdout_fd = -1;
+        int stderr_fd = -1;
+        int stdin_fd = -1;
+        bool suspended = false;
+        bool terminated = false;
+        std::string pending_write;
+        OnOutput_t on_output;
+        OnTerminated_t on_terminated;
+    };
+
+    typedef std::shared_ptr<Channel> ChannelPtr;
+
+    int m_epoll = -1;
+    int m_wakeup = -1;
+    std::thread* m_thread = nullptr;
+    std::mutex m_mutex;
+    ChannelId m_nextId = 1;
+    std::unordered_map<ChannelId, ChannelPtr> m_channels;
+    std::unordered_map<int, ChannelPtr> m_fds;
+    std::unordered_map<int, uint32_t> m_registered; // fd -> the events it is registered for
+
+private:
+    clProcessReactor();
+    ~clProcessReactor();
+
+    bool EnsureStarted();
+    void Run();
+    /// compute the events we want for `fd` and update the epoll set. Must be called with the mutex held
+    void UpdateInterest(const ChannelPtr& channel, int fd);
+    /// remove all the channel fds from the epoll set. Must be called with the mutex held
+    void Unregister(const ChannelPtr& channel);
+    /// read from `fd`, return false on EOF or error. Must be called with the mutex held
+    bool DoRead(const ChannelPtr& channel, int fd);
+    /// write the pending data, return false on error. Must be called with the mutex held
+    bool DoFlush(const ChannelPtr& channel);
+    void DoTerminate(const ChannelPtr& channel);
+
+public:
+    static clProcessReactor& Get();
+
+    /**
+     * @brief is the reactor available on this platform?
+     */
+    static bool IsSupported();
+
+    /**
+     * @brief register a process with the reactor. `stderr_fd` may be -1. `stdin_fd` may be -1 or the same as
+     * `stdout_fd` (pty). The descriptors are switched to non-blocking mode. They remain owned by the caller and must not
+     * be closed before calling `Remove()`
+     * @return the channel id or 0 on error
+     */
+    ChannelId Add(int stdout_fd, int stderr_fd, int stdin_fd, OnOutput_t on_output, OnTerminated_t on_terminated);
+
+    /**
+     * @brief unregister a channel. When this function returns, no more callbacks are made for this channel. Must not be
+     * called from within a callback
+     */
+    void Remove(ChannelId id);
+
+    /**
+     * @brief write `data` to the channel stdin. The data is queued if the process can not accept it right now
+     */
+    bool Write(ChannelId id, const std::string& data);
+
+    /**
+     * @brief stop reading from the channel. When this function returns, no output callback is in progress and no more
+     * are made until `Resume()` is called
+     */
+    void Suspend(ChannelId id);
+    void Resume(ChannelId id);
+};
+
+#endif // CLPROCESSREACTOR_H
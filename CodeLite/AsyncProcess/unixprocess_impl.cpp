@@ -139,19 +139,15 @@ UnixProcessImpl::~UnixProcessImpl() { Cleanup(); }
 
 void UnixProcessImpl::Cleanup()
 {
+    // stop reading before we close the handles
+    StopAsyncReads();
+
     close(GetReadHandle());
     close(GetWriteHandle());
     if (GetStderrHandle() != wxNOT_FOUND) {
         close(GetStderrHandle());
     }
 
-    if (m_thr) {
-        // Stop the reader thread
-        m_thr->Stop();
-        delete m_thr;
-    }
-    m_thr = NULL;
-
     if (GetPid() != wxNOT_FOUND) {
         wxKill(GetPid(), GetHardKill() ? wxSIGKILL : wxSIGTERM, NULL, wxKILL_CHILDREN);
         // The Zombie cleanup is done in app.cpp in ::ChildTerminatedSignalHandler() signal handler
@@ -175,27 +171,30 @@ bool UnixProcessImpl::ReadFromFd(int fd, fd_set& rset, wxString& output, std::st
 
             buffer[bytesRead] = 0; // always place a terminator
             raw_output = std::string(buffer, bytesRead);
-
-            // Remove coloring chars from the incomnig buffer
-            // colors are marked with ESC and terminates with lower case 'm'
-            if (!(this->m_flags & IProcessRawOutput)) {
-                std::string stripped_buffer;
-                StringUtils::StripTerminalColouring(raw_output, stripped_buffer);
-                raw_output.swap(stripped_buffer);
-            }
-
-            wxString convBuff = wxString(raw_output.c_str(), wxConvUTF8, raw_output.length());
-            if (convBuff.empty()) {
-                convBuff = wxString::From8BitData(raw_output.c_str(), raw_output.length());
-            }
-
-            output.swap(convBuff);
+            ConvertOutput(raw_output, output);
             return true;
         }
     }
     return false;
 }
 
+void UnixProcessImpl::ConvertOutput(std::string& raw_output, wxString& output) const
+{
+    // Remove coloring chars from the incomnig buffer
+    // colors are marked with ESC and terminates with lower case 'm'
+    if (!(this->m_flags & IProcessRawOutput)) {
+        std::string stripped_buffer;
+        StringUtils::StripTerminalColouring(raw_output, stripped_buffer);
+        raw_output.swap(stripped_buffer);
+    }
+
+    wxString convBuff = wxString(raw_output.c_str(), wxConvUTF8, raw_output.length());
+    if (convBuff.empty()) {
+        convBuff = wxString::From8BitData(raw_output.c_str(), raw_output.length());
+    }
+    output.swap(convBuff);
+}
+
 bool UnixProcessImpl::Read(wxString& buff, wxString& buffErr, std::string& raw_buff, std::string& raw_buffErr)
 {
     fd_set rs;
@@ -274,7 +273,11 @@ bool UnixProcessImpl::Write(const wxString& buff) { return Write(StringUtils::To
 bool UnixProcessImpl::WriteRaw(const wxString& buff) { return WriteRaw(StringUtils::ToStdString(buff)); }
 bool UnixProcessImpl::WriteRaw(const std::string& buff)
 {
-    int fd = GetWriteHandle();
+    if (m_reactorChannel) {
+        // the handle is non-blocking, let the reactor queue what the process can not accept yet
+        return clProcessReactor::Get().Write(m_reactorChannel, buff);
+    }
+
     wxMemoryBuffer mb;
     mb.AppendData(buff.c_str(), buff.length());
     return do_write(GetWriteHandle(), mb);
@@ -455,7 +458,12 @@ IProcess* UnixProcessImpl::Execute(wxEvtHandler* parent, const wxArrayString& ar
         proc->SetTty(pts_name);
 
         if (!(proc->m_flags & IProcessCreateSync)) {
-            proc->StartReaderThread();
+            // the reactor only reads redirected output, fallback to a reader thread otherwise
+            bool use_reactor =
+                (proc->m_flags & IProcessReactor) && proc->IsRedirect() && clProcessReactor::IsSupported();
+            if (!use_reactor || !proc->StartReactor()) {
+                proc->StartReaderThread();
+            }
         }
         return proc;
     }
@@ -479,6 +487,88 @@ void UnixProcessImpl::StartReaderThread()
     m_thr->Start();
 }
 
+bool UnixProcessImpl::StartReactor()
+{
+    m_reactorChannel = clProcessReactor::Get().Add(
+        GetReadHandle(), GetStderrHandle(), GetWriteHandle(),
+        [this](const std::string& data, bool is_stderr) { OnReactorOutput(data, is_stderr); },
+        [this]() { OnReactorTerminated(); });
+    return m_reactorChannel != 0;
+}
+
+void UnixProcessImpl::StopAsyncReads()
+{
+    if (m_reactorChannel) {
+        // when Remove() returns, the reactor no longer calls us
+        clProcessReactor::Get().Remove(m_reactorChannel);
+        m_reactorChannel = 0;
+    }
+
+    if (m_thr) {
+        // Stop the reader thread
+        m_thr->Stop();
+        delete m_thr;
+    }
+    m_thr = NULL;
+}
+
+void UnixProcessImpl::OnReactorOutput(const std::string& data, bool is_stderr)
+{
+    // called from the reactor thread
+    std::string raw_output = data;
+    wxString output;
+    ConvertOutput(raw_output, output);
+    if (output.empty()) {
+        return;
+    }
+
+    if (GetCallback()) {
+        if (!is_stderr) {
+            GetCallback()->CallAfter(&IProcessCallback::OnProcessOutput, output);
+        }
+        return;
+    }
+
+    if (m_parent) {
+        clProcessEvent e(is_stderr ? wxEVT_ASYNC_PROCESS_STDERR : wxEVT_ASYNC_PROCESS_OUTPUT);
+        e.SetOutput(output);
+        e.SetOutputRaw(raw_output);
+        e.SetProcess(this);
+        m_parent->QueueEvent(e.Clone());
+    }
+}
+
+void UnixProcessImpl::OnReactorTerminated()
+{
+    // called from the reactor thread
+    if (GetCallback()) {
+        GetCallback()->CallAfter(&IProcessCallback::OnProcessTerminated);
+
+    } else if (m_parent) {
+        clProcessEvent e(wxEVT_ASYNC_PROCESS_TERMINATED);
+        e.SetProcess(this);
+        m_parent->AddPendingEvent(e);
+    }
+}
+
+void UnixProcessImpl::SuspendAsyncReads()
+{
+    if (m_reactorChannel) {
+        clProcessReactor::Get().Suspend(m_reactorChannel);
+        return;
+    }
+    IProcess::SuspendAsyncReads();
+}
+
+void UnixProcessImpl::ResumeAsyncReads()
+{
+    if (m_reactorChannel) {
+        clProcessReactor::Get().Resume(m_reactorChannel);
+        return;
+    }
+    IProcess::ResumeAsyncReads();
+}
+
 void UnixProcessImpl::Terminate()
 {
     wxKill(GetPid(), GetHardKill() ? wxSIGKILL : wxSIGTERM, NULL, wxKILL_CHILDREN);
@@ -492,22 +582,17 @@ bool UnixProcessImpl::WriteToConsole(const wxString& buff)
     wxString tmpbuf = buff;
     tmpbuf.Trim().Trim(false);
     tmpbuf << "\n";
-    int fd = GetWriteHandle();
-    wxMemoryBuffer mb;
     wxCharBuffer cb = buff.mb_str(wxConvUTF8).data();
+    if (m_reactorChannel) {
+        return clProcessReactor::Get().Write(m_reactorChannel, std::string(cb.data(), cb.length()));
+    }
+
+    wxMemoryBuffer mb;
     mb.AppendData(cb.data(), cb.length());
     return do_write(GetWriteHandle(), mb);
 }
 
-void UnixProcessImpl::Detach()
-{
-    if (m_thr) {
-        // Stop the reader thread
-        m_thr->Stop();
-        delete m_thr;
-    }
-    m_thr = NULL;
-}
+void UnixProcessImpl::Detach() { StopAsyncReads(); }
 
 void UnixProcessImpl::Signal(wxSignal sig) { wxKill(GetPid(), sig, NULL, wxKILL_CHILDREN); }
 
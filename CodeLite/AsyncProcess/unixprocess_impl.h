@@ -27,6 +27,7 @@
 
 #if defined(__WXMAC__) || defined(__WXGTK__)
 #include "asyncprocess.h"
+#include "clProcessReactor.h"
 #include "codelite_exports.h"
 #include "processreaderthread.h"
 
@@ -38,11 +39,17 @@ class WXDLLIMPEXP_CL UnixProcessImpl : public IProcess
     int m_stderrHandle = wxNOT_FOUND;
     int m_writeHandle;
     wxString m_tty;
+    clProcessReactor::ChannelId m_reactorChannel = 0;
     friend class wxTerminal;
 
 private:
     void StartReaderThread();
+    bool StartReactor();
+    void StopAsyncReads();
     bool ReadFromFd(int fd, fd_set& rset, wxString& output, std::string& raw_output);
+    void ConvertOutput(std::string& raw_output, wxString& output) const;
+    void OnReactorOutput(const std::string& data, bool is_stderr);
+    void OnReactorTerminated();
 
 public:
     UnixProcessImpl(wxEvtHandler* parent);
@@ -76,5 +83,7 @@ public:
     bool WriteToConsole(const wxString& buff) override;
     void Detach() override;
     void Signal(wxSignal sig) override;
+    void SuspendAsyncReads() override;
+    void ResumeAsyncReads() override;
 };
 #endif // #if defined(__WXMAC )||defined(__WXGTK__)
@@ -1,18 +1,24 @@
 #include "CTags.hpp"
 
 #include "AsyncProcess/asyncprocess.h"
+#include "CTagsSession.hpp"
 #include "cl_standard_paths.h"
 #include "clTempFile.hpp"
 #include "file_logger.h"
 #include "fileutils.h"
 #include "procutils.h"
 
+#include <memory>
 #include <set>
+#include <unordered_map>
 #include <wx/stopwatch.h>
 #include <wx/tokenzr.h>
 
 thread_local bool is_initialised = false;
 thread_local bool is_macrodef_supported = false;
+thread_local bool is_interactive_supported = false;
+// persistent indexer sessions, one per kinds string
+thread_local std::unordered_map<wxString, std::unique_ptr<CTagsSession>> sessions;
 
 wxString CTags::WrapSpaces(const wxString& file)
 {
@@ -31,16 +37,40 @@ wxString fix_macro_entry(const wxString& macro)
     //fixed.Replace("\"", "\\\"");
     return fixed;
 }
-} // namespace
 
-bool CTags::DoGenerate(const wxString& filesContent, const wxString& codelite_indexer, const wxStringMap_t& macro_table,
-                       const wxString& ctags_kinds, wxString* output)
+/// ctags reports enumerators of a scoped enum with the enum name as the last part of the scope, remove it
+void fix_enumerator_scope(TagEntryPtr tag, TagEntryPtr& prev_scoped_tag)
 {
-    Initialise(codelite_indexer);
-    clDEBUG() << "Generating ctags files" << clEndl;
+    if(tag->IsEnumerator()                                // looking at an enumerator
+       && prev_scoped_tag                                 // we have a previously seen scope
+       && prev_scoped_tag->GetFile() == tag->GetFile()    /// and they are on the same file
+       && prev_scoped_tag->GetName() == tag->GetParent()) // and it belongs to it
+    {
+        // remove one part of the scope
+        wxArrayString scopes = ::wxStringTokenize(tag->GetScope(), ":", wxTOKEN_STRTOK);
+        if(scopes.size()) {
+            scopes.pop_back(); // remove the last part of the scope
+            wxString new_scope;
+            for(const wxString& scope : scopes) {
+                if(!new_scope.empty()) {
+                    new_scope << "::";
+                }
+                new_scope << scope;
+            }
+            // update the scope
+            tag->SetScope(new_scope.empty() ? "<global>" : new_scope);
+        }
+    }
 
-    // prepare the options file
-    // one option per line
+    if(tag->IsEnum()) {
+        prev_scoped_tag = tag;
+    }
+}
+} // namespace
+
+std::vector<wxString> CTags::GetOptions(const wxStringMap_t& macro_table, const wxString& ctags_kinds)
+{
+    // one option per entry
     std::vector<wxString> options_arr;
     options_arr.reserve(500);
     wxString fields_cxx = "--fields-c++=+{template}+{properties}";
@@ -51,12 +81,13 @@ bool CTags::DoGenerate(const wxString& filesContent, const wxString& codelite_in
     options_arr = { "--extras=-p",       "--excmd=pattern",      "--sort=no",
                     "--fields=aKmSsnit", "--language-force=c++", fields_cxx };
 
-    wxString kinds_string;
     if(ctags_kinds.empty()) {
         // default
-        kinds_string << " --c-kinds=+pxz --C++-kinds=+pxz ";
+        options_arr.push_back("--c-kinds=+pxz");
+        options_arr.push_back("--C++-kinds=+pxz");
     } else {
-        kinds_string << " --c-kinds=" << ctags_kinds << " --C++-kinds=" << ctags_kinds << " ";
+        options_arr.push_back("--c-kinds=" + ctags_kinds);
+        options_arr.push_back("--C++-kinds=" + ctags_kinds);
     }
 
     // we want the macros ordered, so we push them into std::set
@@ -70,12 +101,50 @@ bool CTags::DoGenerate(const wxString& filesContent, const wxString& codelite_in
             // simple -D
             macro_replacements << "-D" << fixed_macro_name;
         } else {
-            wxString fixed_macro_name = fix_macro_entry(vt.first);
-            wxString fixed_macro_value = fix_macro_entry(vt.second);
             macro_replacements << "-D" << fixed_macro_name << "=" << fixed_macro_value;
         }
         macros.insert(macro_replacements);
     }
+    options_arr.insert(options_arr.end(), macros.begin(), macros.end());
+    return options_arr;
+}
+
+CTagsSession* CTags::GetSession(const wxString& codelite_indexer, const wxStringMap_t& macro_table,
+                                const wxString& ctags_kinds)
+{
+    Initialise(codelite_indexer);
+    if(!is_interactive_supported) {
+        return nullptr;
+    }
+
+    std::vector<wxString> args = { "--_interactive", "--output-format=json" };
+    wxString key = codelite_indexer;
+    for(const auto& option : GetOptions(macro_table, ctags_kinds)) {
+        args.push_back(option);
+        key << "\n" << option;
+    }
+
+    auto& session = sessions[ctags_kinds];
+    if(session && session->IsOk() && session->GetKey() == key) {
+        return session.get();
+    }
+
+    // the options changed (or the previous indexer died): start a new indexer
+    session.reset(new CTagsSession(key, codelite_indexer, args));
+    if(!session->IsOk()) {
+        // don't try again on this thread, use the one-shot indexer instead
+        is_interactive_supported = false;
+        session.reset();
+        return nullptr;
+    }
+    return session.get();
+}
+
+bool CTags::DoGenerate(const wxString& filesContent, const wxString& codelite_indexer, const wxStringMap_t& macro_table,
+                       const wxString& ctags_kinds, wxString* output)
+{
+    Initialise(codelite_indexer);
+    clDEBUG() << "Generating ctags files" << clEndl;
 
     // write the options into a file
     wxFileName ctags_options_file(clStandardPaths::Get().GetUserDataDir(),
@@ -83,14 +152,9 @@ bool CTags::DoGenerate(const wxString& filesContent, const wxString& codelite_in
     FileUtils::Deleter d{ ctags_options_file };
 
     wxString ctags_options_file_content;
-    for(const wxString& option : options_arr) {
+    for(const wxString& option : GetOptions(macro_table, ctags_kinds)) {
         ctags_options_file_content << option << "\n";
     }
-
-    // append the macros
-    for(const auto& macro : macros) {
-        ctags_options_file_content << macro << "\n";
-    }
     ctags_options_file_content.Trim();
     FileUtils::WriteFileContent(ctags_options_file.GetFullPath(), ctags_options_file_content);
 
@@ -105,7 +169,7 @@ bool CTags::DoGenerate(const wxString& filesContent, const wxString& codelite_in
 
     wxString command_to_run;
     command_to_run << WrapSpaces(codelite_indexer) << " --options=" << WrapSpaces(ctags_options_file.GetFullPath())
-                   << kinds_string << " -L " << WrapSpaces(file_list.GetFullPath()) << " -f - ";
+                   << " -L " << WrapSpaces(file_list.GetFullPath()) << " -f - ";
     ProcUtils::WrapInShell(command_to_run);
     clDEBUG() << "Running command:" << command_to_run << endl;
 
@@ -120,6 +184,42 @@ bool CTags::DoGenerate(const wxString& filesContent, const wxString& codelite_in
 
 size_t CTags::ParseFiles(const std::vector<wxString>& files, const wxString& codelite_indexer,
                          const wxStringMap_t& macro_table, std::vector<TagEntryPtr>& tags)
+{
+    tags.clear();
+
+    // files that could not be sent to a persistent indexer are parsed with a one-shot indexer
+    std::vector<wxString> remaining;
+    CTagsSession* session = GetSession(codelite_indexer, macro_table, wxEmptyString);
+    TagEntryPtr prev_scoped_tag = nullptr;
+    for(size_t i = 0; i < files.size(); ++i) {
+        if(!session) {
+            remaining.insert(remaining.end(), files.begin() + i, files.end());
+            break;
+        }
+
+        size_t count = tags.size();
+        bool is_ok = session->ParseFile(files[i], [&](TagEntryPtr tag) {
+            fix_enumerator_scope(tag, prev_scoped_tag);
+            tags.push_back(tag);
+        });
+
+        if(!is_ok) {
+            // drop the partial output of this file and restart the indexer for the next one
+            clWARNING() << "codelite_indexer failed to parse file:" << files[i] << endl;
+            tags.resize(count);
+            prev_scoped_tag = nullptr;
+            session = GetSession(codelite_indexer, macro_table, wxEmptyString);
+        }
+    }
+
+    if(!remaining.empty()) {
+        DoParseFiles(remaining, codelite_indexer, macro_table, tags);
+    }
+    return tags.size();
+}
+
+size_t CTags::DoParseFiles(const std::vector<wxString>& files, const wxString& codelite_indexer,
+                           const wxStringMap_t& macro_table, std::vector<TagEntryPtr>& tags)
 {
     wxString filesList;
     for(const auto& file : files) {
@@ -130,9 +230,8 @@ size_t CTags::ParseFiles(const std::vector<wxString>& files, const wxString& cod
         return 0;
     }
 
-    tags.clear();
     wxArrayString lines = ::wxStringTokenize(content, "\n", wxTOKEN_STRTOK);
-    tags.reserve(lines.size());
+    tags.reserve(tags.size() + lines.size());
 
     // convert the lines into tags
     TagEntryPtr prev_scoped_tag = nullptr;
@@ -143,37 +242,13 @@ size_t CTags::ParseFiles(const std::vector<wxString>& files, const wxString& cod
         }
 
         // construct a tag from the line
-        tags.emplace_back(new TagEntry());
-        auto tag = tags.back();
+        TagEntryPtr tag(new TagEntry());
         tag->FromLine(line);
-
-        if(tag->IsEnumerator()                                // looking at an enumerator
-           && prev_scoped_tag                                 // we have a previously seen scope
-           && prev_scoped_tag->GetFile() == tag->GetFile()    /// and they are on the same file
-           && prev_scoped_tag->GetName() == tag->GetParent()) // and it belongs to it
-        {
-            // remove one part of the scope
-            wxArrayString scopes = ::wxStringTokenize(tag->GetScope(), ":", wxTOKEN_STRTOK);
-            if(scopes.size()) {
-                scopes.pop_back(); // remove the last part of the scope
-                wxString new_scope;
-                for(const wxString& scope : scopes) {
-                    if(!new_scope.empty()) {
-                        new_scope << "::";
-                    }
-                    new_scope << scope;
-                }
-                // update the scope
-                tag->SetScope(new_scope.empty() ? "<global>" : new_scope);
-            }
-        }
-
-        if(tag->IsEnum()) {
-            prev_scoped_tag = tag;
-        }
+        fix_enumerator_scope(tag, prev_scoped_tag);
+        tags.push_back(tag);
     }
 
-    if(tags.empty()) {
+    if(lines.empty()) {
         clDEBUG() << "0 tags, ctags output:" << content << endl;
     }
     return tags.size();
@@ -188,11 +263,27 @@ size_t CTags::ParseFile(const wxString& file, const wxString& codelite_indexer,
 size_t CTags::ParseBuffer(const wxFileName& filename, const wxString& buffer, const wxString& codelite_indexer,
                           const wxStringMap_t& macro_table, std::vector<TagEntryPtr>& tags)
 {
+    tags.clear();
+    CTagsSession* session = GetSession(codelite_indexer, macro_table, wxEmptyString);
+    if(session) {
+        // send the buffer directly to the indexer, the tags are reported with the real file name
+        TagEntryPtr prev_scoped_tag = nullptr;
+        bool is_ok = session->ParseBuffer(filename.GetFullPath(), buffer, [&](TagEntryPtr tag) {
+            fix_enumerator_scope(tag, prev_scoped_tag);
+            tags.push_back(tag);
+        });
+
+        if(is_ok) {
+            return tags.size();
+        }
+        tags.clear();
+    }
+
     // create a temporary file with the content we want to parse
     clTempFile temp_file("cpp");
     temp_file.Write(buffer);
     // parse the file
-    ParseFile(temp_file.GetFileName().GetFullPath(), codelite_indexer, macro_table, tags);
+    DoParseFiles({ temp_file.GetFileName().GetFullPath() }, codelite_indexer, macro_table, tags);
     // set the file name to the correct file
     for(TagEntryPtr tag : tags) {
         tag->SetFile(filename.GetFullPath());
@@ -203,6 +294,20 @@ size_t CTags::ParseBuffer(const wxFileName& filename, const wxString& buffer, co
 size_t CTags::ParseLocals(const wxFileName& filename, const wxString& buffer, const wxString& codelite_indexer,
                           const wxStringMap_t& macro_table, std::vector<TagEntryPtr>& tags)
 {
+    // we want locals + functions (to resolve the scope)
+    const wxString kinds = "lzpvfm";
+
+    tags.clear();
+    CTagsSession* session = GetSession(codelite_indexer, macro_table, kinds);
+    if(session) {
+        bool is_ok =
+            session->ParseBuffer(filename.GetFullPath(), buffer, [&](TagEntryPtr tag) { tags.push_back(tag); });
+        if(is_ok) {
+            return tags.size();
+        }
+        tags.clear();
+    }
+
     wxString content;
     {
         clTempFile temp_file("cpp");
@@ -211,13 +316,11 @@ size_t CTags::ParseLocals(const wxFileName& filename, const wxString& buffer, co
         wxString filesList;
         filesList << temp_file.GetFullPath() << "\n";
 
-        // we want locals + functions (to resolve the scope)
-        if(!DoGenerate(filesList, codelite_indexer, macro_table, "lzpvfm", &content)) {
+        if(!DoGenerate(filesList, codelite_indexer, macro_table, kinds, &content)) {
             return 0;
         }
     }
 
-    tags.clear();
     wxArrayString lines = ::wxStringTokenize(content, "\n", wxTOKEN_STRTOK);
     tags.reserve(lines.size());
 
@@ -254,6 +357,7 @@ void CTags::Initialise(const wxString& codelite_indexer)
     auto process = ::CreateAsyncProcess(nullptr, command, IProcessCreateSync, wxEmptyString, nullptr, wxEmptyString);
     if(process) {
         process->WaitForTerminate(output);
+        wxDELETE(process);
     }
 
     wxArrayString lines = ::wxStringTokenize(output, "\n", wxTOKEN_STRTOK);
@@ -263,4 +367,24 @@ void CTags::Initialise(const wxString& codelite_indexer)
             break;
         }
     }
+
+    // check whether the indexer can run as a persistent process (requires the json writer)
+    output.clear();
+    command = { codelite_indexer, "--list-features" };
+    process = ::CreateAsyncProcess(nullptr, command, IProcessCreateSync, wxEmptyString, nullptr, wxEmptyString);
+    if(process) {
+        process->WaitForTerminate(output);
+        wxDELETE(process);
+    }
+
+    bool has_interactive = false;
+    bool has_json = false;
+    lines = ::wxStringTokenize(output, "\n", wxTOKEN_STRTOK);
+    for(auto& line : lines) {
+        wxString feature = line.Trim(false).BeforeFirst(' ');
+        has_interactive = has_interactive || feature == "interactive";
+        has_json = has_json || feature == "json";
+    }
+    is_interactive_supported = has_interactive && has_json;
+    clDEBUG() << "codelite_indexer persistent session supported:" << is_interactive_supported << endl;
 }
@@ -9,6 +9,7 @@
 #include <wx/filename.h>
 #include <wx/textfile.h>
 
+class CTagsSession;
 class WXDLLIMPEXP_CL CTags
 {
 protected:
@@ -28,6 +29,24 @@ protected:
 
     static void Initialise(const wxString& codelite_indexer);
 
+    /**
+     * @brief return the command line options for parsing with `macro_table` and `ctags_kinds`
+     */
+    static std::vector<wxString> GetOptions(const wxStringMap_t& macro_table, const wxString& ctags_kinds);
+
+    /**
+     * @brief return this thread's persistent indexer for the given options, starting it if needed
+     * @return nullptr if the indexer does not support interactive mode
+     */
+    static CTagsSession* GetSession(const wxString& codelite_indexer, const wxStringMap_t& macro_table,
+                                    const wxString& ctags_kinds);
+
+    /**
+     * @brief parse `files` with a one-shot indexer process and append the tags to `tags`
+     */
+    static size_t DoParseFiles(const std::vector<wxString>& files, const wxString& codelite_indexer,
+                               const wxStringMap_t& macro_table, std::vector<TagEntryPtr>& tags);
+
 public:
     /**
      * @brief given a list of files, generate an output tags file and place it under 'path'
@@ -0,0 +1,432 @@
+#include "CTagsSession.hpp"
+
+#include "file_logger.h"
+
+#include <cJSON.h>
+#include <string.h>
+
+#ifndef __WXMSW__
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <signal.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <sys/syscall.h>
+#endif
+#endif
+
+namespace
+{
+const char* get_string(cJSON* json, const char* name)
+{
+    cJSON* item = cJSON_GetObjectItem(json, name);
+    if(item == nullptr || item->type != cJSON_String || item->valuestring == nullptr) {
+        return nullptr;
+    }
+    return item->valuestring;
+}
+
+/// append `value` to a ctags line. Tabs are the field separator, so we replace them
+void append_value(std::string& line, const char* value)
+{
+    for(const char* p = value; *p; ++p) {
+        line.push_back(*p == '\t' ? ' ' : *p);
+    }
+}
+
+void append_field(std::string& line, const char* key, const char* value)
+{
+    if(value == nullptr || *value == 0) {
+        return;
+    }
+    line.push_back('\t');
+    line.append(key);
+    line.push_back(':');
+    append_value(line, value);
+}
+
+/// the keys that are not extension fields: they are the fixed columns of the line, or the scope field
+bool is_fixed_key(const char* key)
+{
+    static const char* keys[] = { "_type", "name", "path", "pattern", "kind", "line", "scope", "scopeKind" };
+    for(const char* fixed : keys) {
+        if(strcmp(key, fixed) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/// convert a JSON tag object into a ctags line, so it can be loaded with `TagEntry::FromLine()`
+bool json_to_tag_line(cJSON* json, std::string& line)
+{
+    const char* name = get_string(json, "name");
+    const char* path = get_string(json, "path");
+    const char* kind = get_string(json, "kind");
+    if(name == nullptr || path == nullptr || kind == nullptr) {
+        return false;
+    }
+
+    long line_number = wxNOT_FOUND;
+    cJSON* line_item = cJSON_GetObjectItem(json, "line");
+    if(line_item && line_item->type == cJSON_Number) {
+        line_number = line_item->valueint;
+    }
+
+    line.clear();
+    append_value(line, name);
+    line.push_back('\t');
+    append_value(line, path);
+    line.push_back('\t');
+
+    const char* pattern = get_string(json, "pattern");
+    if(pattern) {
+        append_value(line, pattern);
+    } else {
+        line.append(std::to_string(line_number));
+    }
+    line.append(";\"\t");
+    append_value(line, kind);
+
+    if(line_number != wxNOT_FOUND) {
+        line.append("\tline:");
+        line.append(std::to_string(line_number));
+    }
+
+    const char* scope_kind = get_string(json, "scopeKind");
+    if(scope_kind) {
+        append_field(line, scope_kind, get_string(json, "scope"));
+    }
+
+    // every other key is an extension field, as it would appear in the tags file (e.g. "file:" or "end:42")
+    for(cJSON* item = json->child; item; item = item->next) {
+        if(item->string == nullptr || is_fixed_key(item->string)) {
+            continue;
+        }
+
+        switch(item->type) {
+        case cJSON_String:
+            if(item->valuestring && *item->valuestring) {
+                append_field(line, item->string, item->valuestring);
+            }
+            break;
+        case cJSON_Number:
+            append_field(line, item->string, std::to_string((long long)item->valuedouble).c_str());
+            break;
+        case cJSON_True:
+            line.push_back('\t');
+            line.append(item->string);
+            line.push_back(':');
+            break;
+        default:
+            break;
+        }
+    }
+    return true;
+}
+} // namespace
+
+CTagsSession::CTagsSession(const wxString& key, const wxString& codelite_indexer, const std::vector<wxString>& args)
+    : m_key(key)
+{
+    if(!DoStart(codelite_indexer, args)) {
+        Stop();
+    }
+}
+
+CTagsSession::~CTagsSession() { Stop(); }
+
+bool CTagsSession::ParseFile(const wxString& filename, const OnTag_t& on_tag)
+{
+    return DoRequest(filename, nullptr, on_tag);
+}
+
+bool CTagsSession::ParseBuffer(const wxString& filename, const wxString& content, const OnTag_t& on_tag)
+{
+    std::string buffer = content.ToStdString(wxConvUTF8);
+    return DoRequest(filename, &buffer, on_tag);
+}
+
+#ifdef __WXMSW__
+
+bool CTagsSession::DoStart(const wxString& codelite_indexer, const std::vector<wxString>& args)
+{
+    wxUnusedVar(codelite_indexer);
+    wxUnusedVar(args);
+    return false;
+}
+
+void CTagsSession::Stop() { m_pid = -1; }
+
+bool CTagsSession::DoWrite(const char* data, size_t len)
+{
+    wxUnusedVar(data);
+    wxUnusedVar(len);
+    return false;
+}
+
+bool CTagsSession::DoReadLines(const std::function<bool(char* line, bool& done)>& on_line)
+{
+    wxUnusedVar(on_line);
+    return false;
+}
+
+#else
+
+bool CTagsSession::DoStart(const wxString& codelite_indexer, const std::vector<wxString>& args)
+{
+    int stdin_fds[2] = { -1, -1 };
+    int stdout_fds[2] = { -1, -1 };
+    if(pipe(stdin_fds) != 0) {
+        clWARNING() << "CTagsSession: failed to create pipe." << strerror(errno) << endl;
+        return false;
+    }
+
+    if(pipe(stdout_fds) != 0) {
+        clWARNING() << "CTagsSession: failed to create pipe." << strerror(errno) << endl;
+        ::close(stdin_fds[0]);
+        ::close(stdin_fds[1]);
+        return false;
+    }
+
+    // prepare the command line before we fork
+    std::vector<std::string> argv_str;
+    argv_str.reserve(args.size() + 1);
+    argv_str.push_back(codelite_indexer.ToStdString(wxConvUTF8));
+    for(const auto& arg : args) {
+        argv_str.push_back(arg.ToStdString(wxConvUTF8));
+    }
+
+    std::vector<char*> argv;
+    argv.reserve(argv_str.size() + 1);
+    for(auto& arg : argv_str) {
+        argv.push_back(arg.data());
+    }
+    argv.push_back(nullptr);
+
+    pid_t pid = fork();
+    if(pid == -1) {
+        clWARNING() << "CTagsSession: failed to fork." << strerror(errno) << endl;
+        for(int fd : { stdin_fds[0], stdin_fds[1], stdout_fds[0], stdout_fds[1] }) {
+            ::close(fd);
+        }
+        return false;
+    }
+
+    if(pid == 0) {
+        // child process
+        dup2(stdin_fds[0], STDIN_FILENO);
+        dup2(stdout_fds[1], STDOUT_FILENO);
+        int null_fd = ::open("/dev/null", O_WRONLY);
+        if(null_fd != -1) {
+            dup2(null_fd, STDERR_FILENO);
+        }
+
+        // prevent descriptor leak into the child process
+#ifdef SYS_close_range
+        syscall(SYS_close_range, 3, ~0U, 0);
+#else
+        for(int fd = 3; fd < 1024; ++fd) {
+            ::close(fd);
+        }
+#endif
+        execvp(argv[0], argv.data());
+        _exit(127);
+    }
+
+    // parent process
+    ::close(stdin_fds[0]);
+    ::close(stdout_fds[1]);
+    m_pid = pid;
+    m_stdin = stdin_fds[1];
+    m_stdout = stdout_fds[0];
+    fcntl(m_stdin, F_SETFD, FD_CLOEXEC);
+    fcntl(m_stdout, F_SETFD, FD_CLOEXEC);
+
+    // the indexer starts by printing a `program` line
+    bool is_ok = DoReadLines([](char* line, bool& done) -> bool {
+        cJSON* json = cJSON_Parse(line);
+        if(json == nullptr) {
+            return false;
+        }
+        const char* type = get_string(json, "_type");
+        done = type && strcmp(type, "program") == 0;
+        cJSON_Delete(json);
+        return done;
+    });
+
+    if(!is_ok) {
+        clWARNING() << "CTagsSession:" << codelite_indexer << "does not support interactive mode" << endl;
+        return false;
+    }
+    clDEBUG() << "CTagsSession: started codelite_indexer, pid:" << m_pid << endl;
+    return true;
+}
+
+void CTagsSession::Stop()
+{
+    if(m_stdin != -1) {
+        ::close(m_stdin);
+        m_stdin = -1;
+    }
+
+    if(m_stdout != -1) {
+        ::close(m_stdout);
+        m_stdout = -1;
+    }
+
+    if(m_pid != -1) {
+        ::kill(m_pid, SIGKILL);
+        ::waitpid(m_pid, nullptr, 0);
+        m_pid = -1;
+    }
+    m_pending.clear();
+}
+
+bool CTagsSession::DoWrite(const char* data, size_t len)
+{
+    // a dead indexer must not kill us with SIGPIPE: block it for this thread while writing and discard any pending
+    // SIGPIPE before restoring the mask
+    sigset_t pipe_mask, old_mask;
+    sigemptyset(&pipe_mask);
+    sigaddset(&pipe_mask, SIGPIPE);
+    pthread_sigmask(SIG_BLOCK, &pipe_mask, &old_mask);
+
+    bool is_ok = true;
+    while(len > 0) {
+        ssize_t bytes = ::write(m_stdin, data, len);
+        if(bytes < 0) {
+            if(errno == EINTR) {
+                continue;
+            }
+            is_ok = false;
+            break;
+        }
+        data += bytes;
+        len -= bytes;
+    }
+
+    sigset_t pending;
+    if(!is_ok && errno == EPIPE && sigpending(&pending) == 0 && sigismember(&pending, SIGPIPE)) {
+        int sig = 0;
+        sigwait(&pipe_mask, &sig);
+    }
+    pthread_sigmask(SIG_SETMASK, &old_mask, nullptr);
+    return is_ok;
+}
+
+bool CTagsSession::DoReadLines(const std::function<bool(char* line, bool& done)>& on_line)
+{
+    char buffer[64 * 1024];
+    bool done = false;
+    while(!done) {
+        // process the complete lines we already have
+        size_t start = 0;
+        size_t pos = m_pending.find('\n');
+        while(pos != std::string::npos && !done) {
+            m_pending[pos] = 0;
+            if(pos > start && !on_line(m_pending.data() + start, done)) {
+                m_pending.clear();
+                return false;
+            }
+            start = pos + 1;
+            pos = done ? std::string::npos : m_pending.find('\n', start);
+        }
+        m_pending.erase(0, start);
+        if(done) {
+            break;
+        }
+
+        struct pollfd pfd = { m_stdout, POLLIN, 0 };
+        int rc = ::poll(&pfd, 1, m_timeout_ms);
+        if(rc < 0 && errno == EINTR) {
+            continue;
+        }
+
+        if(rc <= 0) {
+            clWARNING() << "CTagsSession: timed out waiting for codelite_indexer" << endl;
+            return false;
+        }
+
+        ssize_t bytes = ::read(m_stdout, buffer, sizeof(buffer));
+        if(bytes < 0 && errno == EINTR) {
+            continue;
+        }
+
+        if(bytes <= 0) {
+            // the indexer terminated
+            return false;
+        }
+        m_pending.append(buffer, bytes);
+    }
+    return true;
+}
+
+#endif
+
+bool CTagsSession::DoRequest(const wxString& filename, const std::string* content, const OnTag_t& on_tag)
+{
+    if(!IsOk()) {
+        return false;
+    }
+
+    cJSON* request = cJSON_CreateObject();
+    cJSON_AddStringToObject(request, "command", "generate-tags");
+    cJSON_AddStringToObject(request, "filename", filename.ToStdString(wxConvUTF8).c_str());
+    if(content) {
+        cJSON_AddNumberToObject(request, "size", content->size());
+    }
+    char* request_str = cJSON_PrintUnformatted(request);
+    cJSON_Delete(request);
+
+    std::string header = request_str;
+    header.push_back('\n');
+    free(request_str);
+
+    if(!DoWrite(header.c_str(), header.size()) || (content && !DoWrite(content->c_str(), content->size()))) {
+        clWARNING() << "CTagsSession: failed to send request to codelite_indexer" << endl;
+        Stop();
+        return false;
+    }
+
+    std::string tag_line;
+    bool is_ok = DoReadLines([&](char* line, bool& done) -> bool {
+        cJSON* json = cJSON_Parse(line);
+        if(json == nullptr) {
+            return false;
+        }
+
+        bool result = true;
+        const char* type = get_string(json, "_type");
+        if(type == nullptr) {
+            result = false;
+
+        } else if(strcmp(type, "tag") == 0) {
+            if(json_to_tag_line(json, tag_line)) {
+                TagEntryPtr tag(new TagEntry());
+                tag->FromLine(wxString::FromUTF8(tag_line.c_str(), tag_line.size()));
+                on_tag(tag);
+            }
+
+        } else if(strcmp(type, "completed") == 0) {
+            done = true;
+
+        } else if(strcmp(type, "error") == 0) {
+            const char* message = get_string(json, "message");
+            clWARNING() << "CTagsSession: codelite_indexer error:" << (message ? message : "") << endl;
+            result = false;
+        }
+        cJSON_Delete(json);
+        return result;
+    });
+
+    if(!is_ok) {
+        clWARNING() << "CTagsSession: failed to parse file:" << filename << endl;
+        Stop();
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,69 @@
+#ifndef CTAGSSESSION_HPP
+#define CTAGSSESSION_HPP
+
+#include "codelite_exports.h"
+#include "database/entry.h"
+
+#include <functional>
+#include <string>
+#include <vector>
+#include <wx/string.h>
+
+/**
+ * @class CTagsSession
+ * @brief a long running `codelite_indexer` process in interactive mode
+ *
+ * The indexer is started once with `--_interactive --output-format=json` and the parsing options, each request
+ * sends a file name (or a file name + its content) on the indexer's stdin. The tags are read from the indexer's stdout
+ * and converted into TagEntry objects as they arrive.
+ *
+ * A session is not thread safe, use one session per thread. Sessions are only available on POSIX systems, on other
+ * platforms `IsOk()` always returns false
+ */
+class WXDLLIMPEXP_CL CTagsSession
+{
+public:
+    typedef std::function<void(TagEntryPtr)> OnTag_t;
+
+private:
+    wxString m_key;
+    long m_pid = -1;
+    int m_stdin = -1;
+    int m_stdout = -1;
+    std::string m_pending;
+    int m_timeout_ms = 30000;
+
+    bool DoStart(const wxString& codelite_indexer, const std::vector<wxString>& args);
+    bool DoWrite(const char* data, size_t len);
+    bool DoReadLines(const std::function<bool(char* line, bool& done)>& on_line);
+    bool DoRequest(const wxString& filename, const std::string* content, const OnTag_t& on_tag);
+
+public:
+    /**
+     * @brief start `codelite_indexer` with `args`. `key` identifies the options this session was started with
+     */
+    CTagsSession(const wxString& key, const wxString& codelite_indexer, const std::vector<wxString>& args);
+    ~CTagsSession();
+
+    /**
+     * @brief terminate the indexer process
+     */
+    void Stop();
+
+    bool IsOk() const { return m_pid != -1; }
+    const wxString& GetKey() const { return m_key; }
+
+    /**
+     * @brief parse a file from the disk
+     * @return false if the indexer failed. The session is stopped and should be discarded
+     */
+    bool ParseFile(const wxString& filename, const OnTag_t& on_tag);
+
+    /**
+     * @brief parse `content`, the reported tags use `filename` as their file
+     * @return false if the indexer failed. The session is stopped and should be discarded
+     */
+    bool ParseBuffer(const wxString& filename, const wxString& content, const OnTag_t& on_tag);
+};
+
+#endif // CTAGSSESSION_HPP
@@ -140,6 +140,9 @@ TagEntryPtr CxxCodeCompletion::resolve_compound_expression(std::vector<CxxExpres
 
     TagEntryPtr resolved;
     for(CxxExpression& curexpr : expression) {
+        if(is_cancelled()) {
+            return nullptr;
+        }
         resolved = resolve_expression(curexpr, resolved, scopes);
         CHECK_PTR_RET_NULL(resolved);
         // once we resolved something we make it with this flag
@@ -323,7 +326,7 @@ TagEntryPtr CxxCodeCompletion::lookup_child_symbol(TagEntryPtr parent, TemplateM
     q.push_front(parent);
     wxStringSet_t visited;
 
-    while(!q.empty()) {
+    while(!q.empty() && !is_cancelled()) {
         auto t = q.front();
         q.pop_front();
 
@@ -993,16 +996,48 @@ std::vector<TagEntryPtr> CxxCodeCompletion::get_children_of_scope(TagEntryPtr pa
         return {};
     }
 
-    std::vector<TagEntryPtr> tags;
     auto parents = get_scopes(parent, visible_scopes);
+    std::vector<wxString> scopes;
+    scopes.reserve(parents.size());
     for(auto tag : parents) {
-        wxString scope = tag->GetPath();
-        if(tag->IsMethod()) {
-            scope = tag->GetScope();
+        scopes.push_back(tag->IsMethod() ? tag->GetScope() : tag->GetPath());
+    }
+
+    // the scopes are independent of each other: when possible, query them in parallel. The results are kept per
+    // scope, so the order of the tags is the same as in a sequential lookup (the parent first, then its parents)
+    wxArrayString kinds_arr = to_wx_array_string(kinds);
+    std::vector<std::vector<TagEntryPtr>> scopes_tags(scopes.size());
+    if(m_parallel_for && m_lookup_factory && scopes.size() > 1) {
+        m_parallel_for(scopes.size(), [&](size_t i) {
+            if(is_cancelled()) {
+                return;
+            }
+            ITagsStoragePtr lookup = m_lookup_factory();
+            if(lookup) {
+                // wxString keeps a (mutable) conversion buffer: give each task its own copies
+                wxArrayString task_kinds = kinds_arr;
+                wxString task_filter = filter;
+                lookup->GetTagsByScopeAndKind(scopes[i], task_kinds, task_filter, scopes_tags[i]);
+            }
+        });
+    } else {
+        for(size_t i = 0; i < scopes.size() && !is_cancelled(); ++i) {
+            m_lookup->GetTagsByScopeAndKind(scopes[i], kinds_arr, filter, scopes_tags[i]);
         }
-        std::vector<TagEntryPtr> parent_tags;
-        m_lookup->GetTagsByScopeAndKind(scope, to_wx_array_string(kinds), filter, parent_tags);
-        tags.reserve(tags.size() + parent_tags.size());
+    }
+
+    if(is_cancelled()) {
+        return {};
+    }
+
+    size_t count = 0;
+    for(const auto& parent_tags : scopes_tags) {
+        count += parent_tags.size();
+    }
+
+    std::vector<TagEntryPtr> tags;
+    tags.reserve(count);
+    for(auto& parent_tags : scopes_tags) {
         tags.insert(tags.end(), parent_tags.begin(), parent_tags.end());
     }
     return tags;
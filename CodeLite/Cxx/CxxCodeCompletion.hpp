@@ -7,6 +7,8 @@
 #include "database/istorage.h"
 #include "macros.h"
 
+#include <atomic>
+#include <functional>
 #include <memory>
 #include <vector>
 #include <wx/string.h>
@@ -107,6 +109,12 @@ class WXDLLIMPEXP_CL CxxCodeCompletion
 {
     friend struct TemplateManager;
 
+public:
+    /// call `task(i)` for every `i` in [0, count) and return once all the calls are done (possibly in parallel)
+    using ParallelFor = std::function<void(size_t count, const std::function<void(size_t)>& task)>;
+    /// return a lookup that can be used by the calling thread
+    using LookupFactory = std::function<ITagsStoragePtr()>;
+
 private:
     struct __local {
     private:
@@ -159,6 +167,9 @@ private:
     TemplateManager::ptr_t m_template_manager;
     bool m_first_time = true;
     wxString m_codelite_indexer;
+    std::shared_ptr<std::atomic_bool> m_cancellation_token;
+    ParallelFor m_parallel_for;
+    LookupFactory m_lookup_factory;
 
 private:
     /**
@@ -296,6 +307,24 @@ public:
      */
     void determine_current_scope();
 
+    /**
+     * @brief set the token checked by the long running methods (e.g. `code_complete()`). Once the token is set,
+     * they stop and return an empty result
+     */
+    void set_cancellation_token(std::shared_ptr<std::atomic_bool> token) { m_cancellation_token = std::move(token); }
+    bool is_cancelled() const { return m_cancellation_token && m_cancellation_token->load(); }
+
+    /**
+     * @brief run the independent lookups (e.g. the children of each parent class) using `parallel_for`. Each
+     * task gets its lookup from `lookup_factory` since a lookup can only be used by one thread at a time.
+     * Without this, the lookups run one after the other using the completer lookup
+     */
+    void set_parallel_lookups(ParallelFor parallel_for, LookupFactory lookup_factory)
+    {
+        m_parallel_for = std::move(parallel_for);
+        m_lookup_factory = std::move(lookup_factory);
+    }
+
     /**
      * @brief set the typedef helper table
      */
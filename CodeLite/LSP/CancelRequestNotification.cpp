@@ -0,0 +1,26 @@
+#include "CancelRequestNotification.hpp"
+
+namespace LSP
+{
+struct CancelParams : public Params {
+    int m_id = wxNOT_FOUND;
+
+    JSONItem ToJSON(const wxString& name) const override
+    {
+        JSONItem json = JSONItem::createObject(name);
+        json.addProperty("id", m_id);
+        return json;
+    }
+
+    void FromJSON(const JSONItem& json) override { m_id = json["id"].toInt(m_id); }
+};
+
+CancelRequestNotification::CancelRequestNotification(int request_id)
+{
+    SetMethod("$/cancelRequest");
+    CancelParams* params = new CancelParams();
+    params->m_id = request_id;
+    m_params.reset(params);
+}
+
+} // namespace LSP
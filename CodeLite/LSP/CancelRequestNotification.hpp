@@ -0,0 +1,21 @@
+#ifndef CANCELREQUESTNOTIFICATION_HPP
+#define CANCELREQUESTNOTIFICATION_HPP
+
+#include "LSP/Notification.h"
+
+namespace LSP
+{
+
+/**
+ * @brief `$/cancelRequest` notification: ask the server to cancel the request with the given ID
+ */
+class WXDLLIMPEXP_CL CancelRequestNotification : public Notification
+{
+public:
+    explicit CancelRequestNotification(int request_id);
+    virtual ~CancelRequestNotification() = default;
+};
+
+} // namespace LSP
+
+#endif // CANCELREQUESTNOTIFICATION_HPP
@@ -16,3 +16,16 @@ LSP::DidChangeTextDocumentRequest::DidChangeTextDocumentRequest(const wxString&
     changeEvent.SetText(fileContent);
     m_params->As<DidChangeTextDocumentParams>()->SetContentChanges({ changeEvent });
 }
+
+LSP::DidChangeTextDocumentRequest::DidChangeTextDocumentRequest(
+    const wxString& filename, const std::vector<TextDocumentContentChangeEvent>& changes)
+{
+    SetMethod("textDocument/didChange");
+    m_params.reset(new DidChangeTextDocumentParams());
+
+    VersionedTextDocumentIdentifier id;
+    id.SetVersion(++counter);
+    id.SetFilename(filename);
+    m_params->As<DidChangeTextDocumentParams>()->SetTextDocument(id);
+    m_params->As<DidChangeTextDocumentParams>()->SetContentChanges(changes);
+}
@@ -1,6 +1,7 @@
 #ifndef DIDCHANGE_TEXTDOCUMENTREQUEST_H
 #define DIDCHANGE_TEXTDOCUMENTREQUEST_H
 
+#include <vector>
 #include <wx/filename.h>
 #include "LSP/Notification.h"
 
@@ -10,7 +11,15 @@ namespace LSP
 class WXDLLIMPEXP_CL DidChangeTextDocumentRequest : public LSP::Notification
 {
 public:
+    /**
+     * @brief full synchronization: send the entire document
+     */
     explicit DidChangeTextDocumentRequest(const wxString& filename, const wxString& fileContent);
+    /**
+     * @brief incremental synchronization: send only the changed ranges. The changes are applied by the server in
+     * order, each one against the document produced by the previous change
+     */
+    DidChangeTextDocumentRequest(const wxString& filename, const std::vector<TextDocumentContentChangeEvent>& changes);
     virtual ~DidChangeTextDocumentRequest() = default;
 };
 
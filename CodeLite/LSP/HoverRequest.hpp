@@ -12,6 +12,7 @@ public:
     explicit HoverRequest(const wxString& filename, size_t line, size_t column);
     virtual ~HoverRequest() = default;
     void OnResponse(const LSP::ResponseMessage& response, wxEvtHandler* owner);
+    wxString GetSupersedeKey() const override { return GetMethod(); }
 };
 };     // namespace LSP
 #endif // HOVERREQUEST_HPP
@@ -37,6 +37,12 @@ JSONItem LSP::InitializeRequest::ToJSON(const wxString& name) const
     }
 
     auto textDocumentCapabilities = params.AddObject("capabilities").AddObject("textDocument");
+    // we send `didChange` using the sync kind advertised by the server (incremental when possible)
+    auto synchronization = textDocumentCapabilities.AddObject("synchronization");
+    synchronization.addProperty("dynamicRegistration", false);
+    synchronization.addProperty("willSave", false);
+    synchronization.addProperty("willSaveWaitUntil", false);
+    synchronization.addProperty("didSave", true);
     auto docFormat =
         textDocumentCapabilities.AddObject("completion").AddObject("completionItem").AddArray("documentationFormat");
     docFormat.arrayAppend("plaintext");
@@ -29,8 +29,9 @@ public:
     virtual std::string ToString() const = 0;
 
     /**
-     * @brief return the **first** JSON payload from the network buffer
+     * @brief return the **first** JSON payload from the network buffer and remove it from the buffer
      * @param network_buffer - network buffer (may contain multiple messages)
+     * @note every call moves the rest of the buffer to its front. To decode a stream, use `LSP::MessageDecoder`
      */
     static std::unique_ptr<JSON> GetJSONPayload(std::string& network_buffer);
 
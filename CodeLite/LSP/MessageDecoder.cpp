@@ -0,0 +1,149 @@
+#include "MessageDecoder.hpp"
+
+#include "LSP/basic_types.h"
+
+#include <cJSON.h>
+
+namespace
+{
+constexpr std::string_view HEADERS_END = "\r\n\r\n";
+constexpr std::string_view CONTENT_LENGTH = "content-length";
+
+// a larger Content-Length is a corrupted (or hostile) header: waiting for that many bytes would buffer the stream
+// forever, and adding it to the buffer offsets could overflow
+constexpr size_t MAX_CONTENT_LENGTH = 1024 * 1024 * 1024;
+constexpr size_t MAX_CONTENT_LENGTH_DIGITS = 10;
+
+inline char ascii_lower(char ch) { return (ch >= 'A' && ch <= 'Z') ? (ch | 0x20) : ch; }
+
+std::string_view trim(std::string_view str)
+{
+    while (!str.empty() && (str.front() == ' ' || str.front() == '\t')) {
+        str.remove_prefix(1);
+    }
+    while (!str.empty() && (str.back() == ' ' || str.back() == '\t' || str.back() == '\r')) {
+        str.remove_suffix(1);
+    }
+    return str;
+}
+
+bool is_content_length(std::string_view name)
+{
+    name = trim(name);
+    if (name.length() != CONTENT_LENGTH.length()) {
+        return false;
+    }
+
+    for (size_t i = 0; i < name.length(); ++i) {
+        if (ascii_lower(name[i]) != CONTENT_LENGTH[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool to_size_t(std::string_view str, size_t* value)
+{
+    str = trim(str);
+    if (str.empty() || str.length() > MAX_CONTENT_LENGTH_DIGITS) {
+        return false;
+    }
+
+    size_t result = 0;
+    for (char ch : str) {
+        if (ch < '0' || ch > '9') {
+            return false;
+        }
+        result = result * 10 + (ch - '0');
+    }
+    if (result > MAX_CONTENT_LENGTH) {
+        return false;
+    }
+    *value = result;
+    return true;
+}
+} // namespace
+
+LSP::MessageDecoder::eFrameHeader
+LSP::MessageDecoder::ParseFrameHeader(std::string_view data, size_t* headers_size, size_t* content_length)
+{
+    size_t where = data.find(HEADERS_END);
+    if (where == std::string_view::npos) {
+        return eFrameHeader::kIncomplete;
+    }
+
+    // the header block is a list of "Name: Value\r\n" lines
+    std::string_view headers = data.substr(0, where);
+    bool found = false;
+    while (!headers.empty()) {
+        size_t eol = headers.find('\n');
+        std::string_view line = headers.substr(0, eol);
+        headers.remove_prefix(eol == std::string_view::npos ? headers.length() : eol + 1);
+
+        size_t colon = line.find(':');
+        if (colon != std::string_view::npos && is_content_length(line.substr(0, colon))) {
+            found = to_size_t(line.substr(colon + 1), content_length);
+        }
+    }
+
+    *headers_size = where + HEADERS_END.length();
+    return found ? eFrameHeader::kOk : eFrameHeader::kInvalid;
+}
+
+void LSP::MessageDecoder::Append(const char* data, size_t len)
+{
+    // drop the consumed bytes once they take more than half of the buffer, this keeps the cost of the erase
+    // proportional to the number of bytes received
+    if (m_offset > 0 && m_offset >= (m_buffer.length() - m_offset)) {
+        m_buffer.erase(0, m_offset);
+        m_offset = 0;
+    }
+    m_buffer.append(data, len);
+}
+
+std::unique_ptr<JSON> LSP::MessageDecoder::Next()
+{
+    while (m_contentLength == std::string::npos) {
+        switch (ParseFrameHeader(GetPending(), &m_headersSize, &m_contentLength)) {
+        case eFrameHeader::kIncomplete:
+            return nullptr;
+        case eFrameHeader::kInvalid:
+            // skip this header block, and try the next one
+            LSP_WARNING() << "LSP message header does not contain a valid Content-Length header!" << endl;
+            m_offset += m_headersSize;
+            m_contentLength = std::string::npos;
+            break;
+        case eFrameHeader::kOk:
+            break;
+        }
+    }
+
+    if (GetPendingSize() < m_headersSize + m_contentLength) {
+        // wait for the rest of the payload
+        return nullptr;
+    }
+
+    const char* payload = m_buffer.data() + m_offset + m_headersSize;
+    cJSON* json = cJSON_ParseWithLength(payload, m_contentLength);
+    if (json == nullptr) {
+        LSP_ERROR() << "Unable to parse JSON object from response!" << endl;
+    }
+
+    m_offset += m_headersSize + m_contentLength;
+    m_headersSize = 0;
+    m_contentLength = std::string::npos;
+    if (m_offset == m_buffer.length()) {
+        // everything was consumed, keep the capacity
+        m_buffer.clear();
+        m_offset = 0;
+    }
+    return std::make_unique<JSON>(json);
+}
+
+void LSP::MessageDecoder::Clear()
+{
+    m_buffer.clear();
+    m_offset = 0;
+    m_headersSize = 0;
+    m_contentLength = std::string::npos;
+}
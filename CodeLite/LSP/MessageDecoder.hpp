@@ -0,0 +1,67 @@
+#ifndef LSP_MESSAGEDECODER_HPP
+#define LSP_MESSAGEDECODER_HPP
+
+#include "JSON.h"
+#include "codelite_exports.h"
+
+#include <memory>
+#include <string>
+#include <string_view>
+
+namespace LSP
+{
+/**
+ * @class MessageDecoder
+ * @brief decode LSP frames (`Content-Length: N\r\n\r\n<payload>`) from a stream of bytes
+ *
+ * Decoded frames are not erased from the front of the buffer one at a time: the read offset moves forward and the
+ * buffer is compacted only when the consumed part is larger than the unread part. The payload is handed to cJSON as
+ * UTF-8 bytes, straight from the buffer
+ */
+class WXDLLIMPEXP_CL MessageDecoder
+{
+public:
+    enum class eFrameHeader {
+        kIncomplete,
+        kOk,
+        kInvalid,
+    };
+
+private:
+    std::string m_buffer;
+    size_t m_offset = 0;
+    // the header of the frame at `m_offset`, kept while we wait for the rest of its payload
+    size_t m_headersSize = 0;
+    size_t m_contentLength = std::string::npos;
+
+public:
+    MessageDecoder() = default;
+    ~MessageDecoder() = default;
+
+    void Append(const char* data, size_t len);
+    void Append(const std::string& data) { Append(data.data(), data.length()); }
+
+    /**
+     * @brief decode the next complete frame. Returns nullptr when more data is needed. A frame whose payload is not
+     * a valid JSON is consumed and returned as a JSON object for which `isOk()` is false
+     */
+    std::unique_ptr<JSON> Next();
+
+    /**
+     * @brief the bytes that were received but not decoded yet
+     */
+    std::string_view GetPending() const { return std::string_view{ m_buffer }.substr(m_offset); }
+    size_t GetPendingSize() const { return m_buffer.length() - m_offset; }
+    bool IsEmpty() const { return GetPendingSize() == 0; }
+    void Clear();
+
+    /**
+     * @brief parse the frame header at the start of `data`
+     * @param headers_size [output] the size of the header block, including the empty line that ends it
+     * @param content_length [output] the value of the Content-Length header
+     */
+    static eFrameHeader ParseFrameHeader(std::string_view data, size_t* headers_size, size_t* content_length);
+};
+} // namespace LSP
+
+#endif // LSP_MESSAGEDECODER_HPP
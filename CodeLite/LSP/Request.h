@@ -43,6 +43,12 @@ public:
         return true;
     }
 
+    /**
+     * @brief requests that return the same non empty key supersede each other: when a new request is queued, older
+     * requests with the same key are dropped, or cancelled (`$/cancelRequest`) if they were already sent
+     */
+    virtual wxString GetSupersedeKey() const { return wxEmptyString; }
+
     /**
      * @brief this method will get called by the protocol for handling the response.
      * Override it in the various requests
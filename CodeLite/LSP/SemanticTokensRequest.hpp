@@ -17,6 +17,8 @@ public:
     ~SemanticTokensRequest() override = default;
 
     void OnResponse(const LSP::ResponseMessage& response, wxEvtHandler* owner) override;
+    /// only the latest request per file matters
+    wxString GetSupersedeKey() const override { return GetMethod() + ":" + m_filename; }
 };
 } // namespace LSP
 
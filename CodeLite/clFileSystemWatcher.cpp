@@ -1,10 +1,12 @@
 #include "clFileSystemWatcher.h"
 #include <algorithm>
 #include <set>
+#include "file_logger.h"
 #include "fileutils.h"
 
 wxDEFINE_EVENT(wxEVT_FILE_MODIFIED, clFileSystemEvent);
 wxDEFINE_EVENT(wxEVT_FILE_NOT_FOUND, clFileSystemEvent);
+wxDEFINE_EVENT(wxEVT_FILE_WATCHER_OVERFLOW, clFileSystemEvent);
 
 // In milliseconds
 #define FILE_CHECK_INTERVAL 500
@@ -17,26 +19,19 @@ clFileSystemWatcher::clFileSystemWatcher()
 {
 #if CL_FSW_USE_TIMER
     Bind(wxEVT_TIMER, &clFileSystemWatcher::OnTimer, this);
-#else
-    m_watcher.SetOwner(this);
-    Bind(wxEVT_FSWATCHER, &clFileSystemWatcher::OnFileModified, this);
 #endif
 }
 
 clFileSystemWatcher::~clFileSystemWatcher()
 {
-#if CL_FSW_USE_TIMER
     Stop();
+#if CL_FSW_USE_TIMER
     Unbind(wxEVT_TIMER, &clFileSystemWatcher::OnTimer, this);
-#else
-    m_watcher.RemoveAll();
-    Unbind(wxEVT_FSWATCHER, &clFileSystemWatcher::OnFileModified, this);
 #endif
 }
 
 void clFileSystemWatcher::SetFile(const wxFileName& filename)
 {
-#if CL_FSW_USE_TIMER
     if(filename.Exists()) {
         m_files.clear();
         File f;
@@ -44,24 +39,65 @@ void clFileSystemWatcher::SetFile(const wxFileName& filename)
         f.lastModified = FileUtils::GetFileModificationTime(filename);
         f.file_size = FileUtils::GetFileSize(filename);
         m_files.insert(std::make_pair(filename.GetFullPath(), f));
+#if CL_FSW_USE_INOTIFY
+        if(IsRunning()) {
+            m_watcher->AddFolder(filename.GetPath(), false);
+        }
+#endif
     }
+}
+
+bool clFileSystemWatcher::WatchTree(const wxString& dir, const wxStringSet_t& exclude)
+{
+#if CL_FSW_USE_TIMER
+    wxUnusedVar(dir);
+    wxUnusedVar(exclude);
+    return false;
 #else
-    m_watcher.RemoveAll();
-    wxFileName dironly = filename;
-    dironly.SetFullName(""); // must be directory only
-    m_watcher.Add(dironly);
-    m_watchedFile = filename; // but we keep the file name for later usage
+    wxFileName fn(dir, wxEmptyString);
+    wxString path = fn.GetPath();
+    if(!fn.DirExists()) {
+        return false;
+    }
+
+    m_trees.insert(path);
+    m_excludes.insert(exclude.begin(), exclude.end());
+    if(IsRunning()) {
+        return m_watcher->AddFolder(path, true);
+    }
+    return true;
 #endif
 }
 
 void clFileSystemWatcher::Start()
 {
-#if CL_FSW_USE_TIMER
     Stop();
-
+#if CL_FSW_USE_TIMER
     m_timer = new wxTimer(this);
     m_timer->Start(FILE_CHECK_INTERVAL, true);
 #else
+    m_watcher.reset(new clFileTreeWatcher());
+    m_watcher->SetExcludeFolders({ m_excludes.begin(), m_excludes.end() });
+
+    // the callback is called from the watcher thread
+    bool started = m_watcher->Start(
+        [this](const clFileTreeWatcher::Changes_t& changes) { CallAfter([this, changes]() { OnChanges(changes); }); });
+    if(!started) {
+        m_watcher.reset();
+        return;
+    }
+
+    // we can only watch folders, so watch the parent folder of every file
+    for(const auto& [_, f] : m_files) {
+        m_watcher->AddFolder(f.filename.GetPath(), false);
+    }
+
+    for(const wxString& tree : m_trees) {
+        if(!m_watcher->AddFolder(tree, true)) {
+            clWARNING() << "File system watcher: could not watch:" << tree << endl;
+        }
+    }
+    clDEBUG() << "File system watcher: watching" << m_watcher->GetWatchCount() << "folders" << endl;
 #endif
 }
 
@@ -73,101 +109,143 @@ void clFileSystemWatcher::Stop()
     }
     wxDELETE(m_timer);
 #else
-    m_watcher.RemoveAll();
+    m_watcher.reset();
 #endif
 }
 
 void clFileSystemWatcher::Clear()
 {
-#if CL_FSW_USE_TIMER
     Stop();
     m_files.clear();
-#else
-    m_watcher.RemoveAll();
+#if CL_FSW_USE_INOTIFY
+    m_trees.clear();
+    m_excludes.clear();
 #endif
 }
 
+void clFileSystemWatcher::Notify(const wxEventType& type, const wxArrayString& paths)
+{
+    if(!GetOwner()) {
+        return;
+    }
+
+    clFileSystemEvent evt(type);
+    if(!paths.empty()) {
+        evt.SetPath(paths.Item(0));
+    }
+    evt.SetPaths(paths);
+    GetOwner()->AddPendingEvent(evt);
+}
+
 #if CL_FSW_USE_TIMER
 void clFileSystemWatcher::OnTimer(wxTimerEvent& event)
 {
-    std::set<wxString> nonExistingFiles;
-    for (const auto& [_, f] : m_files) {
+    wxArrayString modifiedFiles;
+    wxArrayString nonExistingFiles;
+    for(auto& [_, f] : m_files) {
         const wxFileName& fn = f.filename;
         if(!fn.Exists()) {
+            // add the missing file to the list
+            nonExistingFiles.Add(fn.GetFullPath());
+            continue;
+        }
 
-            // fire file not found event
-            if(GetOwner()) {
-                clFileSystemEvent evt(wxEVT_FILE_NOT_FOUND);
-                evt.SetPath(fn.GetFullPath());
-                GetOwner()->AddPendingEvent(evt);
-            }
-
-            // add the missing file to a set
-            nonExistingFiles.insert(fn.GetFullPath());
-        } else {
-            
 #ifdef __WXMSW__
-            size_t prev_value = f.file_size;
-            size_t curr_value = FileUtils::GetFileSize(fn);
+        size_t prev_value = f.file_size;
+        size_t curr_value = FileUtils::GetFileSize(fn);
+        f.file_size = curr_value;
 #else
-            time_t prev_value = f.lastModified;
-            time_t curr_value = FileUtils::GetFileModificationTime(fn);
+        // Always update the last modified timestamp
+        time_t prev_value = f.lastModified;
+        time_t curr_value = FileUtils::GetFileModificationTime(fn);
+        f.lastModified = curr_value;
 #endif
 
-            if(prev_value != curr_value) {
-                // Fire a modified event
-                if(GetOwner()) {
-                    clFileSystemEvent evt(wxEVT_FILE_MODIFIED);
-                    evt.SetPath(fn.GetFullPath());
-                    GetOwner()->AddPendingEvent(evt);
-                }
-            }
-#ifdef __WXMSW__
-            File updatdFile = f;
-            updatdFile.file_size = curr_value;
-#else
-            // Always update the last modified timestamp
-            File updatdFile = f;
-            updatdFile.lastModified = curr_value;
-#endif
-            m_files[fn.GetFullPath()] = updatdFile;
+        if(prev_value != curr_value) {
+            modifiedFiles.Add(fn.GetFullPath());
         }
     }
 
     // Remove the non existing files
-    for (const wxString& fn : nonExistingFiles) {
+    for(const wxString& fn : nonExistingFiles) {
         m_files.erase(fn);
     }
 
+    if(!nonExistingFiles.empty()) {
+        Notify(wxEVT_FILE_NOT_FOUND, nonExistingFiles);
+    }
+
+    if(!modifiedFiles.empty()) {
+        Notify(wxEVT_FILE_MODIFIED, modifiedFiles);
+    }
+
     if(m_timer) {
         m_timer->Start(FILE_CHECK_INTERVAL, true);
     }
 }
-#endif
+#else
+bool clFileSystemWatcher::IsWatched(const wxString& path) const
+{
+    if(m_files.count(path)) {
+        return true;
+    }
+
+    for(const wxString& tree : m_trees) {
+        if(path.length() > tree.length() && path.StartsWith(tree) && path[tree.length()] == '/') {
+            return true;
+        }
+    }
+    return false;
+}
 
-#if !CL_FSW_USE_TIMER
-void clFileSystemWatcher::OnFileModified(wxFileSystemWatcherEvent& event)
+void clFileSystemWatcher::OnChanges(const clFileTreeWatcher::Changes_t& changes)
 {
-    if(event.GetChangeType() == wxFSW_EVENT_MODIFY) {
-        const wxFileName& modpath = event.GetPath();
-        if(modpath == m_watchedFile) {
-            if(GetOwner()) {
-                clFileSystemEvent evt(wxEVT_FILE_MODIFIED);
-                evt.SetPath(modpath.GetFullPath());
-                GetOwner()->AddPendingEvent(evt);
-            }
+    if(!IsRunning()) {
+        // stopped while the changes were queued
+        return;
+    }
+
+    bool overflow = false;
+    wxArrayString modifiedFiles;
+    wxArrayString deletedPaths;
+    for(const auto& change : changes) {
+        if(change.kind == clFileTreeWatcher::kOverflow) {
+            overflow = true;
+            continue;
+        }
+
+        // the parent folders of watched files report changes in their siblings as well
+        if(!IsWatched(change.path)) {
+            continue;
+        }
+
+        if(change.kind == clFileTreeWatcher::kDeleted) {
+            deletedPaths.Add(change.path);
+        } else {
+            modifiedFiles.Add(change.path);
         }
     }
+
+    if(!deletedPaths.empty()) {
+        Notify(wxEVT_FILE_NOT_FOUND, deletedPaths);
+    }
+
+    if(!modifiedFiles.empty()) {
+        Notify(wxEVT_FILE_MODIFIED, modifiedFiles);
+    }
+
+    if(overflow) {
+        clWARNING() << "File system watcher: events were lost" << endl;
+        Notify(wxEVT_FILE_WATCHER_OVERFLOW, {});
+    }
 }
 #endif
 
 void clFileSystemWatcher::RemoveFile(const wxFileName& filename)
 {
-#if CL_FSW_USE_TIMER
     if(m_files.count(filename.GetFullPath())) {
         m_files.erase(filename.GetFullPath());
     }
-#endif
 }
 
 bool clFileSystemWatcher::IsRunning() const
@@ -175,6 +253,6 @@ bool clFileSystemWatcher::IsRunning() const
 #if CL_FSW_USE_TIMER
     return m_timer;
 #else
-    return m_watcher.GetWatchedPathsCount();
+    return m_watcher && m_watcher->IsRunning();
 #endif
 }
@@ -2,23 +2,24 @@
 #define CLFILESYSTEMWATCHER_H
 
 #include "clFileSystemEvent.h"
+#include "clFileTreeWatcher.hpp"
 #include "codelite_exports.h"
+#include "macros.h"
 
 #include <map>
 #include <memory>
 #include <wx/filename.h>
 #include <wx/timer.h>
 
-#ifdef __WXMSW__
-#define CL_FSW_USE_TIMER 1
+// On Linux we are notified by the kernel (inotify), elsewhere we poll the files with a timer
+#ifdef __linux__
+#define CL_FSW_USE_INOTIFY 1
+#define CL_FSW_USE_TIMER 0
 #else
+#define CL_FSW_USE_INOTIFY 0
 #define CL_FSW_USE_TIMER 1
 #endif
 
-#if !CL_FSW_USE_TIMER
-#include <wx/fswatcher.h>
-#endif
-
 class WXDLLIMPEXP_CL clFileSystemWatcher : public wxEvtHandler
 {
 public:
@@ -30,12 +31,13 @@ public:
     };
 
     wxEvtHandler* m_owner;
-#if CL_FSW_USE_TIMER
     clFileSystemWatcher::File::Map_t m_files;
+#if CL_FSW_USE_TIMER
     wxTimer* m_timer;
 #else
-    wxFileSystemWatcher m_watcher;
-    wxFileName m_watchedFile;
+    std::unique_ptr<clFileTreeWatcher> m_watcher;
+    wxStringSet_t m_trees;
+    wxStringSet_t m_excludes;
 #endif
 
 public:
@@ -45,8 +47,10 @@ protected:
 #if CL_FSW_USE_TIMER
     void OnTimer(wxTimerEvent& event);
 #else
-    void OnFileModified(wxFileSystemWatcherEvent& event);
+    void OnChanges(const clFileTreeWatcher::Changes_t& changes);
+    bool IsWatched(const wxString& path) const;
 #endif
+    void Notify(const wxEventType& type, const wxArrayString& paths);
 
 public:
     clFileSystemWatcher();
@@ -65,10 +69,18 @@ public:
      */
     void RemoveFile(const wxFileName& filename);
 
+    /**
+     * @brief watch all the files under `dir`, recursively. Folders with a name (or full path) listed in `exclude` are
+     * skipped. Changes are reported in batches: created and modified files with wxEVT_FILE_MODIFIED, deleted files and
+     * folders with wxEVT_FILE_NOT_FOUND (use `GetPaths()`).
+     * Call this before `Start()`. Tree watching requires inotify, this returns false on other platforms
+     */
+    bool WatchTree(const wxString& dir, const wxStringSet_t& exclude = {});
+
     /**
      * @brief start to watching list of files.
      * This object fires the following events (clFileSystemEvent):
-     * wxEVT_FILE_MODIFIED, wxEVT_FILE_DELETED
+     * wxEVT_FILE_MODIFIED, wxEVT_FILE_NOT_FOUND and wxEVT_FILE_WATCHER_OVERFLOW
      */
     void Start();
 
@@ -90,5 +102,7 @@ public:
 
 wxDECLARE_EXPORTED_EVENT(WXDLLIMPEXP_CL, wxEVT_FILE_MODIFIED, clFileSystemEvent);
 wxDECLARE_EXPORTED_EVENT(WXDLLIMPEXP_CL, wxEVT_FILE_NOT_FOUND, clFileSystemEvent);
+/// some changes were lost (the kernel event queue overflowed), the watched trees should be re-scanned
+wxDECLARE_EXPORTED_EVENT(WXDLLIMPEXP_CL, wxEVT_FILE_WATCHER_OVERFLOW, clFileSystemEvent);
 
 #endif // CLFILESYSTEMWATCHER_H
@@ -0,0 +1,402 @@
+#include "clFileTreeWatcher.hpp"
+
+#include "file_logger.h"
+
+#include <algorithm>
+
+#ifdef __linux__
+#include <dirent.h>
+#include <errno.h>
+#include <poll.h>
+#include <string.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+// continuous activity is reported after this many coalescing windows
+constexpr int MAX_DELAY_FACTOR = 10;
+
+std::string normalize_path(const wxString& path)
+{
+    std::string str = path.ToStdString(wxConvUTF8);
+    while(str.length() > 1 && str.back() == '/') {
+        str.pop_back();
+    }
+    return str;
+}
+} // namespace
+
+clFileTreeWatcher::clFileTreeWatcher() {}
+
+clFileTreeWatcher::~clFileTreeWatcher() { Stop(); }
+
+void clFileTreeWatcher::SetExcludeFolders(const std::vector<wxString>& folders)
+{
+    m_excludes.clear();
+    for(const wxString& folder : folders) {
+        std::string str = normalize_path(folder);
+        if(!str.empty()) {
+            m_excludes.insert(str);
+        }
+    }
+}
+
+bool clFileTreeWatcher::IsExcluded(const std::string& path, const char* name) const
+{
+    return m_excludes.count(name) || m_excludes.count(path);
+}
+
+#ifdef __linux__
+
+namespace
+{
+constexpr uint32_t WATCH_MASK = IN_CREATE | IN_DELETE | IN_MODIFY | IN_CLOSE_WRITE | IN_MOVED_FROM | IN_MOVED_TO |
+                                IN_MOVE_SELF | IN_ONLYDIR | IN_EXCL_UNLINK;
+} // namespace
+
+bool clFileTreeWatcher::IsSupported() { return true; }
+
+bool clFileTreeWatcher::Start(Callback_t callback)
+{
+    Stop();
+    m_fd = ::inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if(m_fd == -1) {
+        clERROR() << "clFileTreeWatcher: inotify_init1() error." << strerror(errno) << endl;
+        return false;
+    }
+
+    m_wakeup = ::eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if(m_wakeup == -1) {
+        clERROR() << "clFileTreeWatcher: eventfd() error." << strerror(errno) << endl;
+        ::close(m_fd);
+        m_fd = -1;
+        return false;
+    }
+
+    m_callback = std::move(callback);
+    m_thread = new std::thread([this]() { Run(); });
+    return true;
+}
+
+void clFileTreeWatcher::Stop()
+{
+    if(m_thread) {
+        uint64_t value = 1;
+        if(::write(m_wakeup, &value, sizeof(value)) < 0) {
+            clWARNING() << "clFileTreeWatcher: failed to wakeup the watcher thread." << strerror(errno) << endl;
+        }
+        m_thread->join();
+        wxDELETE(m_thread);
+    }
+
+    if(m_wakeup != -1) {
+        ::close(m_wakeup);
+        m_wakeup = -1;
+    }
+
+    if(m_fd != -1) {
+        // closing the descriptor removes all its watches
+        ::close(m_fd);
+        m_fd = -1;
+    }
+
+    std::lock_guard<std::mutex> lock{ m_mutex };
+    m_watches.clear();
+    m_wds.clear();
+    m_pending.clear();
+    m_pendingIndex.clear();
+    m_callback = nullptr;
+}
+
+bool clFileTreeWatcher::AddFolder(const wxString& path, bool recursive)
+{
+    if(!IsRunning()) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock{ m_mutex };
+    return DoAddWatch(normalize_path(path), recursive, nullptr);
+}
+
+void clFileTreeWatcher::RemoveFolder(const wxString& path)
+{
+    if(!IsRunning()) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock{ m_mutex };
+    DoRemoveWatch(normalize_path(path));
+}
+
+size_t clFileTreeWatcher::GetWatchCount()
+{
+    std::lock_guard<std::mutex> lock{ m_mutex };
+    return m_watches.size();
+}
+
+bool clFileTreeWatcher::DoAddWatch(const std::string& path, bool recursive, std::vector<std::string>* files)
+{
+    int wd = ::inotify_add_watch(m_fd, path.c_str(), WATCH_MASK);
+    if(wd == -1) {
+        if(errno == ENOSPC) {
+            clWARNING() << "clFileTreeWatcher: reached the inotify watch limit (fs.inotify.max_user_watches), can not"
+                        << "watch:" << path << endl;
+        } else if(errno != ENOENT && errno != ENOTDIR) {
+            clWARNING() << "clFileTreeWatcher: inotify_add_watch() error for:" << path << "." << strerror(errno)
+                        << endl;
+        }
+        return false;
+    }
+
+    auto iter = m_watches.find(wd);
+    if(iter != m_watches.end() && iter->second.path != path) {
+        // the same folder under a different name (it was renamed)
+        m_wds.erase(iter->second.path);
+    }
+    m_watches[wd] = { path, recursive || (iter != m_watches.end() && iter->second.recursive) };
+    m_wds[path] = wd;
+
+    if(!recursive && !files) {
+        return true;
+    }
+
+    DIR* dir = ::opendir(path.c_str());
+    if(!dir) {
+        return true;
+    }
+
+    struct dirent* entry = nullptr;
+    while((entry = ::readdir(dir)) != nullptr) {
+        const char* name = entry->d_name;
+        if(strcmp(name, ".") == 0 || strcmp(name, "..") == 0) {
+            continue;
+        }
+
+        std::string fullpath = path == "/" ? path + name : path + "/" + name;
+        unsigned char type = entry->d_type;
+        if(type == DT_UNKNOWN) {
+            struct stat st;
+            if(::lstat(fullpath.c_str(), &st) != 0) {
+                continue;
+            }
+            type = S_ISDIR(st.st_mode) ? DT_DIR : (S_ISLNK(st.st_mode) ? DT_LNK : DT_REG);
+        }
+
+        if(type == DT_DIR) {
+            // symbolic links are not followed, so we never loop
+            if(recursive && !IsExcluded(fullpath, name)) {
+                DoAddWatch(fullpath, true, files);
+            }
+        } else if(files) {
+            files->push_back(fullpath);
+        }
+    }
+    ::closedir(dir);
+    return true;
+}
+
+void clFileTreeWatcher::DoRemoveWatch(const std::string& path)
+{
+    std::string prefix = path + "/";
+    for(auto iter = m_watches.begin(); iter != m_watches.end();) {
+        const std::string& watch_path = iter->second.path;
+        if(watch_path == path || watch_path.compare(0, prefix.length(), prefix) == 0) {
+            ::inotify_rm_watch(m_fd, iter->first);
+            m_wds.erase(watch_path);
+            iter = m_watches.erase(iter);
+        } else {
+            ++iter;
+        }
+    }
+}
+
+void clFileTreeWatcher::Run()
+{
+    struct pollfd fds[2];
+    fds[0].fd = m_fd;
+    fds[0].events = POLLIN;
+    fds[1].fd = m_wakeup;
+    fds[1].events = POLLIN;
+
+    while(true) {
+        int rc = ::poll(fds, 2, GetPollTimeout());
+        if(rc < 0) {
+            if(errno == EINTR) {
+                continue;
+            }
+            clERROR() << "clFileTreeWatcher: poll() error." << strerror(errno) << endl;
+            break;
+        }
+
+        if(fds[1].revents & POLLIN) {
+            // we only wake up the thread to shut it down
+            break;
+        }
+
+        if(fds[0].revents & POLLIN) {
+            ReadEvents();
+        }
+
+        if(!m_pending.empty() && GetPollTimeout() == 0) {
+            Flush();
+        }
+    }
+}
+
+int clFileTreeWatcher::GetPollTimeout() const
+{
+    if(m_pending.empty()) {
+        return -1;
+    }
+
+    auto latency = std::chrono::milliseconds((int)m_latency);
+    auto deadline = std::min(m_lastEvent + latency, m_firstEvent + latency * MAX_DELAY_FACTOR);
+    auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - Clock_t::now()).count();
+    return remaining > 0 ? (int)remaining : 0;
+}
+
+void clFileTreeWatcher::ReadEvents()
+{
+    alignas(struct inotify_event) char buffer[64 * 1024];
+    while(true) {
+        ssize_t len = ::read(m_fd, buffer, sizeof(buffer));
+        if(len <= 0) {
+            // EAGAIN: no more events
+            break;
+        }
+
+        std::lock_guard<std::mutex> lock{ m_mutex };
+        for(char* ptr = buffer; ptr < buffer + len;) {
+            const struct inotify_event* event = reinterpret_cast<const struct inotify_event*>(ptr);
+            ptr += sizeof(struct inotify_event) + event->len;
+
+            if(event->mask & IN_Q_OVERFLOW) {
+                AddPending(std::string(), kOverflow);
+                continue;
+            }
+
+            auto iter = m_watches.find(event->wd);
+            if(iter == m_watches.end()) {
+                continue;
+            }
+
+            if(event->mask & IN_IGNORED) {
+                // the folder was deleted or unmounted
+                m_wds.erase(iter->second.path);
+                m_watches.erase(iter);
+                continue;
+            }
+
+            if(event->mask & IN_MOVE_SELF) {
+                // the folder is gone from its watched path
+                std::string path = iter->second.path;
+                AddPending(path, kDeleted, true);
+                DoRemoveWatch(path);
+                continue;
+            }
+
+            if(event->len == 0) {
+                continue;
+            }
+
+            const char* name = event->name;
+            std::string fullpath = iter->second.path + "/" + name;
+            bool recursive = iter->second.recursive;
+            if(event->mask & IN_ISDIR) {
+                if(event->mask & (IN_CREATE | IN_MOVED_TO)) {
+                    if(recursive && !IsExcluded(fullpath, name)) {
+                        // watch the new folder, the files it already contains were never reported
+                        std::vector<std::string> files;
+                        DoAddWatch(fullpath, true, &files);
+                        for(const std::string& file : files) {
+                            AddPending(file, kCreated);
+                        }
+                    }
+                } else if(event->mask & (IN_DELETE | IN_MOVED_FROM)) {
+                    AddPending(fullpath, kDeleted, true);
+                    DoRemoveWatch(fullpath);
+                }
+                continue;
+            }
+
+            if(event->mask & (IN_CREATE | IN_MOVED_TO)) {
+                AddPending(fullpath, kCreated);
+            } else if(event->mask & (IN_MODIFY | IN_CLOSE_WRITE)) {
+                AddPending(fullpath, kModified);
+            } else if(event->mask & (IN_DELETE | IN_MOVED_FROM)) {
+                AddPending(fullpath, kDeleted);
+            }
+        }
+    }
+}
+
+#else
+
+bool clFileTreeWatcher::IsSupported() { return false; }
+bool clFileTreeWatcher::Start(Callback_t callback) { return false; }
+void clFileTreeWatcher::Stop() {}
+bool clFileTreeWatcher::AddFolder(const wxString& path, bool recursive) { return false; }
+void clFileTreeWatcher::RemoveFolder(const wxString& path) {}
+size_t clFileTreeWatcher::GetWatchCount() { return 0; }
+bool clFileTreeWatcher::DoAddWatch(const std::string& path, bool recursive, std::vector<std::string>* files)
+{
+    return false;
+}
+void clFileTreeWatcher::DoRemoveWatch(const std::string& path) {}
+void clFileTreeWatcher::Run() {}
+int clFileTreeWatcher::GetPollTimeout() const { return -1; }
+void clFileTreeWatcher::ReadEvents() {}
+
+#endif
+
+void clFileTreeWatcher::AddPending(const std::string& path, eChangeKind kind, bool is_dir)
+{
+    auto now = Clock_t::now();
+    if(m_pending.empty()) {
+        m_firstEvent = now;
+    }
+    m_lastEvent = now;
+
+    auto iter = m_pendingIndex.find(path);
+    if(iter == m_pendingIndex.end()) {
+        m_pendingIndex.insert({ path, m_pending.size() });
+        m_pending.push_back({ path, kind, is_dir });
+        return;
+    }
+
+    // merge with the change we already have for this path
+    Pending& pending = m_pending[iter->second];
+    if(pending.kind == kCreated && kind == kModified) {
+        // still a new file
+    } else if(pending.kind == kDeleted && kind == kCreated) {
+        // replaced
+        pending.kind = kModified;
+        pending.is_dir = false;
+    } else {
+        pending.kind = kind;
+        pending.is_dir = is_dir;
+    }
+}
+
+void clFileTreeWatcher::Flush()
+{
+    Changes_t changes;
+    changes.reserve(m_pending.size());
+    for(const Pending& pending : m_pending) {
+        Change change;
+        change.path = wxString::FromUTF8(pending.path.c_str());
+        change.kind = pending.kind;
+        change.is_dir = pending.is_dir;
+        changes.push_back(std::move(change));
+    }
+    m_pending.clear();
+    m_pendingIndex.clear();
+
+    if(m_callback) {
+        m_callback(changes);
+    }
+}
@@ -0,0 +1,142 @@
+#ifndef CLFILETREEWATCHER_HPP
+#define CLFILETREEWATCHER_HPP
+
+#include "codelite_exports.h"
+
+#include <chrono>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include <wx/string.h>
+
+/**
+ * @class clFileTreeWatcher
+ * @brief event driven file system watcher: reports the files created, modified and deleted under a set of folders
+ *
+ * The watcher owns an inotify descriptor serviced by a background thread. Events are coalesced: a burst of changes
+ * (a `git checkout`, a build writing many files, an editor saving with a temp file + rename) is reported once the
+ * folders are quiet for `latency` milliseconds (or after 10 x `latency` of continuous activity), and each path appears
+ * at most once in a batch.
+ *
+ * Folders can be watched alone or with all their sub folders. In the latter case, folders created (or moved into the
+ * tree) are watched as soon as they show up and the files they contain are reported as created.
+ *
+ * inotify is Linux only. Use `IsSupported()` and fall back to polling on other platforms
+ */
+class WXDLLIMPEXP_CL clFileTreeWatcher
+{
+public:
+    enum eChangeKind {
+        kCreated,
+        kModified,
+        kDeleted,
+        // the kernel queue overflowed and events were lost, the watched folders should be re-scanned
+        kOverflow,
+    };
+
+    struct Change {
+        wxString path;
+        eChangeKind kind = kModified;
+        bool is_dir = false; // only set for deleted folders
+    };
+
+    typedef std::vector<Change> Changes_t;
+    /// called on the watcher thread with a batch of changes
+    typedef std::function<void(const Changes_t& changes)> Callback_t;
+
+private:
+    struct Watch {
+        std::string path;
+        bool recursive = false;
+    };
+
+    struct Pending {
+        std::string path;
+        eChangeKind kind = kModified;
+        bool is_dir = false;
+    };
+
+    typedef std::chrono::steady_clock Clock_t;
+
+    int m_fd = -1;
+    int m_wakeup = -1;
+    std::thread* m_thread = nullptr;
+    std::mutex m_mutex;
+    std::unordered_map<int, Watch> m_watches;
+    std::unordered_map<std::string, int> m_wds;
+    std::unordered_set<std::string> m_excludes;
+    size_t m_latency = 100;
+    Callback_t m_callback;
+
+    // owned by the watcher thread
+    std::vector<Pending> m_pending;
+    std::unordered_map<std::string, size_t> m_pendingIndex;
+    Clock_t::time_point m_firstEvent;
+    Clock_t::time_point m_lastEvent;
+
+private:
+    void Run();
+    void ReadEvents();
+    void AddPending(const std::string& path, eChangeKind kind, bool is_dir = false);
+    void Flush();
+    int GetPollTimeout() const;
+    bool IsExcluded(const std::string& path, const char* name) const;
+    /// add a watch, recursively if requested. The files found in new sub folders are added to `files` (if not null).
+    /// Must be called with the mutex held
+    bool DoAddWatch(const std::string& path, bool recursive, std::vector<std::string>* files);
+    /// remove the watch of `path` and of all the folders below it. Must be called with the mutex held
+    void DoRemoveWatch(const std::string& path);
+
+public:
+    clFileTreeWatcher();
+    ~clFileTreeWatcher();
+
+    /**
+     * @brief is the watcher available on this platform?
+     */
+    static bool IsSupported();
+
+    /**
+     * @brief set the coalescing window, in milliseconds. Must be called before `Start()`
+     */
+    void SetLatency(size_t latency) { m_latency = latency; }
+
+    /**
+     * @brief folders that are never watched. An entry is either a folder name (e.g. ".git") or a full path. Must be
+     * called before `Start()`
+     */
+    void SetExcludeFolders(const std::vector<wxString>& folders);
+
+    /**
+     * @brief start the watcher thread, `callback` is called from that thread
+     */
+    bool Start(Callback_t callback);
+
+    /**
+     * @brief stop the watcher thread and remove all the watches. Pending changes are dropped
+     */
+    void Stop();
+
+    bool IsRunning() const { return m_thread != nullptr; }
+
+    /**
+     * @brief watch a folder. With `recursive`, all the folders below it are watched as well
+     */
+    bool AddFolder(const wxString& path, bool recursive);
+
+    /**
+     * @brief stop watching a folder (and all the folders below it)
+     */
+    void RemoveFolder(const wxString& path);
+
+    /**
+     * @brief return the number of folders being watched
+     */
+    size_t GetWatchCount();
+};
+
+#endif // CLFILETREEWATCHER_HPP
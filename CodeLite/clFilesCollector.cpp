@@ -3,13 +3,25 @@
 #include "file_logger.h"
 #include "fileutils.h"
 
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
 #include <queue>
+#include <set>
+#include <string_view>
+#include <thread>
 #include <unordered_set>
 #include <vector>
 #include <wx/dir.h>
 #include <wx/filename.h>
 #include <wx/tokenzr.h>
 
+#ifndef __WXMSW__
+#include <dirent.h>
+#include <sys/stat.h>
+#endif
+
 size_t clFilesScanner::Scan(const wxString& rootFolder,
                             std::vector<wxFileName>& filesOutput,
                             const wxString& filespec,
@@ -68,6 +80,98 @@ bool IsRelPathContainedInSpec(const wxString& rootPath, const wxString& fullPath
     }
     return false;
 }
+
+/// match `text` against a pattern with `*` and `?` wildcards. `?` matches a single (UTF-8) character
+bool glob_match(std::string_view pattern, std::string_view text)
+{
+    size_t p = 0;
+    size_t t = 0;
+    size_t star_p = std::string_view::npos;
+    size_t star_t = 0;
+    while (t < text.length()) {
+        if (p < pattern.length() && pattern[p] == '*') {
+            star_p = p++;
+            star_t = t;
+        } else if (p < pattern.length() && pattern[p] == '?') {
+            ++p;
+            // skip the continuation bytes
+            ++t;
+            while (t < text.length() && (static_cast<unsigned char>(text[t]) & 0xC0) == 0x80) {
+                ++t;
+            }
+        } else if (p < pattern.length() && pattern[p] == text[t]) {
+            ++p;
+            ++t;
+        } else if (star_p != std::string_view::npos) {
+            p = star_p + 1;
+            t = ++star_t;
+        } else {
+            return false;
+        }
+    }
+
+    while (p < pattern.length() && pattern[p] == '*') {
+        ++p;
+    }
+    return p == pattern.length();
+}
+
+/**
+ * @brief a files spec (e.g. "*.cpp;*.h;Makefile") compiled for matching UTF-8 names.
+ * Follows FileUtils::WildMatch(): the spec is lower-cased, a pattern without `*` must match exactly
+ */
+class SpecMatcher
+{
+    bool m_matchAll = false;
+    std::vector<std::string> m_exact;
+    std::vector<std::string> m_suffixes;
+    std::vector<std::string> m_globs;
+
+public:
+    SpecMatcher(const wxString& spec)
+    {
+        wxArrayString patterns = ::wxStringTokenize(spec.Lower(), ";,|", wxTOKEN_STRTOK);
+        for (const wxString& pattern : patterns) {
+            std::string str = pattern.ToStdString(wxConvUTF8);
+            if (str == "*") {
+                m_matchAll = true;
+            } else if (str.find('*') == std::string::npos) {
+                m_exact.push_back(str);
+            } else if (str[0] == '*' && str.find_first_of("*?", 1) == std::string::npos) {
+                // the common "*.ext" case
+                m_suffixes.push_back(str.substr(1));
+            } else {
+                m_globs.push_back(str);
+            }
+        }
+    }
+
+    bool Matches(std::string_view name) const
+    {
+        if (m_matchAll) {
+            return true;
+        }
+
+        for (const auto& exact : m_exact) {
+            if (name == exact) {
+                return true;
+            }
+        }
+
+        for (const auto& suffix : m_suffixes) {
+            if (name.length() >= suffix.length() && name.substr(name.length() - suffix.length()) == suffix) {
+                return true;
+            }
+        }
+
+        for (const auto& glob : m_globs) {
+            if (glob_match(glob, name)) {
+                return true;
+            }
+        }
+        return false;
+    }
+};
 } // namespace
 
 size_t clFilesScanner::Scan(const wxString& rootFolder,
@@ -208,6 +312,185 @@ size_t clFilesScanner::Scan(const wxString& rootFolder,
     return nCount;
 }
 
+size_t clFilesScanner::ScanParallel(const wxString& rootFolder,
+                                    const wxString& filespec,
+                                    const wxString& excludeFilespec,
+                                    const wxString& excludeFoldersSpec,
+                                    std::function<bool(const wxString&)>&& collect_cb,
+                                    size_t threads)
+{
+#ifdef __WXMSW__
+    wxUnusedVar(threads);
+    return Scan(rootFolder, filespec, excludeFilespec, excludeFoldersSpec, std::move(collect_cb));
+#else
+    if (!wxFileName::DirExists(rootFolder)) {
+        clDEBUG() << "clFilesScanner: No such directory:" << rootFolder << clEndl;
+        return 0;
+    }
+
+    const SpecMatcher include_files{ filespec };
+    const SpecMatcher exclude_files{ excludeFilespec };
+    const SpecMatcher exclude_folders{ excludeFoldersSpec };
+
+    if (threads == 0) {
+        threads = std::clamp<size_t>(std::thread::hardware_concurrency(), 2, 8);
+    }
+
+    // state shared between the workers and the calling thread. `pending` counts the folders that are queued or
+    // being read, the scan is complete when it drops to 0
+    std::mutex mutex;
+    std::condition_variable work_cv;
+    std::condition_variable results_cv;
+    std::deque<std::string> folders;
+    std::deque<std::vector<wxString>> batches;
+    std::set<std::pair<dev_t, ino_t>> visited;
+    size_t pending = 1;
+    bool stop = false;
+
+    std::string root = FileUtils::RealPath(rootFolder).ToStdString(wxConvFile);
+    while (root.length() > 1 && root.back() == '/') {
+        root.pop_back();
+    }
+    folders.push_back(root);
+
+    auto read_folder = [&](const std::string& path, std::vector<std::string>& subfolders, std::vector<wxString>& files) {
+        DIR* dir = ::opendir(path.c_str());
+        if (dir == nullptr) {
+            return;
+        }
+
+        // the same folder can be reached more than once via symlinks
+        struct stat st;
+        if (::fstat(::dirfd(dir), &st) == 0) {
+            std::lock_guard<std::mutex> lk{ mutex };
+            if (!visited.insert({ st.st_dev, st.st_ino }).second) {
+                ::closedir(dir);
+                return;
+            }
+        }
+
+        std::string fullpath = path;
+        if (fullpath.empty() || fullpath.back() != '/') {
+            fullpath.push_back('/');
+        }
+        const size_t prefix_len = fullpath.length();
+
+        while (struct dirent* entry = ::readdir(dir)) {
+            std::string_view name = entry->d_name;
+            if (name == "." || name == "..") {
+                continue;
+            }
+
+            fullpath.resize(prefix_len);
+            fullpath.append(name);
+
+            bool is_folder = false;
+#ifdef _DIRENT_HAVE_D_TYPE
+            if (entry->d_type == DT_DIR) {
+                is_folder = true;
+            } else if (entry->d_type == DT_LNK || entry->d_type == DT_UNKNOWN) {
+                // symlinks are followed, like wxFileName::DirExists() does
+                struct stat entry_st;
+                is_folder = ::stat(fullpath.c_str(), &entry_st) == 0 && S_ISDIR(entry_st.st_mode);
+            }
+#else
+            struct stat entry_st;
+            is_folder = ::stat(fullpath.c_str(), &entry_st) == 0 && S_ISDIR(entry_st.st_mode);
+#endif
+            if (is_folder) {
+                if (!exclude_folders.Matches(name)) {
+                    subfolders.push_back(fullpath);
+                }
+            } else if (!exclude_files.Matches(name) && include_files.Matches(name)) {
+                files.push_back(wxString(fullpath.c_str(), wxConvFile));
+            }
+        }
+        ::closedir(dir);
+    };
+
+    auto worker = [&]() {
+        while (true) {
+            std::string path;
+            {
+                std::unique_lock<std::mutex> lk{ mutex };
+                work_cv.wait(lk, [&]() { return stop || !folders.empty() || pending == 0; });
+                if (stop || folders.empty()) {
+                    break;
+                }
+                path = std::move(folders.front());
+                folders.pop_front();
+            }
+
+            std::vector<std::string> subfolders;
+            std::vector<wxString> files;
+            read_folder(path, subfolders, files);
+
+            std::lock_guard<std::mutex> lk{ mutex };
+            pending += subfolders.size();
+            for (auto& subfolder : subfolders) {
+                folders.push_back(std::move(subfolder));
+            }
+
+            if (!files.empty()) {
+                batches.push_back(std::move(files));
+                results_cv.notify_one();
+            }
+
+            --pending;
+            if (pending == 0) {
+                work_cv.notify_all();
+                results_cv.notify_all();
+            } else if (!subfolders.empty()) {
+                work_cv.notify_all();
+            }
+        }
+    };
+
+    std::vector<std::thread> workers;
+    workers.reserve(threads);
+    for (size_t i = 0; i < threads; ++i) {
+        workers.emplace_back(worker);
+    }
+
+    // report the files on the calling thread
+    size_t nCount = 0;
+    while (true) {
+        std::vector<wxString> batch;
+        {
+            std::unique_lock<std::mutex> lk{ mutex };
+            results_cv.wait(lk, [&]() { return !batches.empty() || pending == 0; });
+            if (batches.empty()) {
+                break;
+            }
+            batch = std::move(batches.front());
+            batches.pop_front();
+        }
+
+        bool cont = true;
+        for (const wxString& file : batch) {
+            if (!collect_cb(file)) {
+                // requested to stop
+                cont = false;
+                break;
+            }
+            ++nCount;
+        }
+
+        if (!cont) {
+            std::lock_guard<std::mutex> lk{ mutex };
+            stop = true;
+            work_cv.notify_all();
+            break;
+        }
+    }
+
+    for (auto& thr : workers) {
+        thr.join();
+    }
+    return nCount;
+#endif
+}
+
 size_t clFilesScanner::ScanNoRecurse(const wxString& rootFolder,
                                      clFilesScanner::EntryData::Vec_t& results,
                                      const wxString& matchSpec)
@@ -59,6 +59,16 @@ public:
      */
     size_t Scan(const wxString& rootFolder, const wxString& filespec, const wxString& excludeFilespec,
                 const wxString& excludeFoldersSpec, std::function<bool(const wxString&)>&& collect_cb);
+    /**
+     * @brief multi-threaded version of the above. Folders are read in parallel by `threads` workers (0: pick a number
+     * based on the number of cores), the entry type is taken from the directory listing so no `stat` is needed for
+     * regular files and folders. The specs are compiled once, folders are excluded by their name.
+     * `collect_cb` is called on the calling thread, the files are reported in no particular order.
+     * On Windows this falls back to the single threaded scan
+     */
+    size_t ScanParallel(const wxString& rootFolder, const wxString& filespec, const wxString& excludeFilespec,
+                        const wxString& excludeFoldersSpec, std::function<bool(const wxString&)>&& collect_cb,
+                        size_t threads = 0);
     /**
      * @brief scan folder for files and folders. This function does not recurse into folders. Everything that matches
      * "matchSpec" will get collected.
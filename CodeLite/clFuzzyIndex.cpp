@@ -0,0 +1,403 @@
+#include "clFuzzyIndex.hpp"
+
+#include <algorithm>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace
+{
+// scores, as used by fzf
+constexpr int SCORE_MATCH = 16;
+constexpr int SCORE_GAP_START = -3;
+constexpr int SCORE_GAP_EXTENSION = -1;
+constexpr int BONUS_BOUNDARY = SCORE_MATCH / 2;
+constexpr int BONUS_BOUNDARY_WHITE = BONUS_BOUNDARY + 2;
+constexpr int BONUS_BOUNDARY_DELIMITER = BONUS_BOUNDARY + 1;
+constexpr int BONUS_NON_WORD = SCORE_MATCH / 2;
+constexpr int BONUS_CAMEL = BONUS_BOUNDARY - 1;
+constexpr int BONUS_CONSECUTIVE = -(SCORE_GAP_START + SCORE_GAP_EXTENSION);
+constexpr int BONUS_FIRST_CHAR_MULTIPLIER = 2;
+// matching a file name is better than matching its folder
+constexpr int BONUS_NAME = 2;
+
+enum eCharClass { kWhite, kNonWord, kDelimiter, kLower, kUpper, kNumber };
+
+inline eCharClass char_class(unsigned char ch)
+{
+    if(ch >= 'a' && ch <= 'z') {
+        return kLower;
+    } else if(ch >= 'A' && ch <= 'Z') {
+        return kUpper;
+    } else if(ch >= '0' && ch <= '9') {
+        return kNumber;
+    } else if(ch >= 0x80) {
+        // part of a UTF-8 sequence, count it as a letter
+        return kLower;
+    }
+
+    switch(ch) {
+    case ' ':
+    case '\t':
+        return kWhite;
+    case '/':
+    case '\\':
+    case ':':
+    case ';':
+    case ',':
+    case '|':
+        return kDelimiter;
+    default:
+        return kNonWord;
+    }
+}
+
+inline int bonus_for(eCharClass prev, eCharClass current)
+{
+    if(current > kDelimiter) {
+        // a word character
+        switch(prev) {
+        case kWhite:
+            return BONUS_BOUNDARY_WHITE;
+        case kDelimiter:
+            return BONUS_BOUNDARY_DELIMITER;
+        case kNonWord:
+            return BONUS_BOUNDARY;
+        default:
+            break;
+        }
+    }
+
+    if((prev == kLower && current == kUpper) || (prev != kNumber && current == kNumber)) {
+        return BONUS_CAMEL;
+    }
+
+    switch(current) {
+    case kNonWord:
+    case kDelimiter:
+        return BONUS_NON_WORD;
+    case kWhite:
+        return BONUS_BOUNDARY_WHITE;
+    default:
+        return 0;
+    }
+}
+
+inline int count_trailing_zeros(uint64_t mask)
+{
+#if defined(_MSC_VER)
+    unsigned long index = 0;
+    _BitScanForward64(&index, mask);
+    return (int)index;
+#else
+    return __builtin_ctzll(mask);
+#endif
+}
+
+inline char to_lower(char ch) { return (ch >= 'A' && ch <= 'Z') ? (ch - 'A' + 'a') : ch; }
+
+/// the character bag bit of a lower case character
+inline uint64_t char_bit(unsigned char ch)
+{
+    if(ch >= 'a' && ch <= 'z') {
+        return 1ULL << (ch - 'a');
+    } else if(ch >= '0' && ch <= '9') {
+        return 1ULL << (26 + ch - '0');
+    } else if(ch >= 0x80) {
+        return 1ULL << 63;
+    }
+    // punctuation shares the remaining 27 bits
+    return 1ULL << (36 + (ch % 27));
+}
+
+std::string to_lower_utf8(const wxString& str)
+{
+    std::string lower = str.ToStdString(wxConvUTF8);
+    for(char& ch : lower) {
+        ch = to_lower(ch);
+    }
+    return lower;
+}
+
+/// split the query into lower case words, return the character bag of all the words
+uint64_t parse_query(const std::string& query, std::vector<std::string>& words)
+{
+    uint64_t mask = 0;
+    std::string word;
+    for(char ch : query) {
+        if(ch == ' ' || ch == '\t') {
+            if(!word.empty()) {
+                words.push_back(std::move(word));
+                word.clear();
+            }
+            continue;
+        }
+        word.push_back(ch);
+        mask |= char_bit(ch);
+    }
+
+    if(!word.empty()) {
+        words.push_back(std::move(word));
+    }
+    return mask;
+}
+
+size_t find_name_offset(const std::string& text)
+{
+    size_t where = text.find_last_of("/\\");
+    return where == std::string::npos ? 0 : where + 1;
+}
+
+/**
+ * @brief score `word` against [text, text + len). Find the first occurrence of the word as a subsequence, shrink it
+ * from the end (fzf "v1" algorithm) and score the characters in that range
+ */
+int score_word(const char* text, const char* lower, size_t len, size_t name_offset, const std::string& word)
+{
+    const size_t word_len = word.length();
+    size_t pidx = 0;
+    size_t start = std::string::npos;
+    size_t end = std::string::npos;
+    for(size_t idx = 0; idx < len; ++idx) {
+        if(lower[idx] != word[pidx]) {
+            continue;
+        }
+
+        if(start == std::string::npos) {
+            start = idx;
+        }
+
+        if(++pidx == word_len) {
+            end = idx + 1;
+            break;
+        }
+    }
+
+    if(end == std::string::npos) {
+        return -1;
+    }
+
+    // walk backward to find the shortest match that ends at `end`
+    pidx = word_len;
+    for(size_t idx = end; idx > start; --idx) {
+        if(lower[idx - 1] == word[pidx - 1]) {
+            if(--pidx == 0) {
+                start = idx - 1;
+                break;
+            }
+        }
+    }
+
+    int score = 0;
+    int first_bonus = 0;
+    size_t consecutive = 0;
+    bool in_gap = false;
+    eCharClass prev_class = start == 0 ? kWhite : char_class(text[start - 1]);
+    pidx = 0;
+    for(size_t idx = start; idx < end; ++idx) {
+        eCharClass current_class = char_class(text[idx]);
+        if(lower[idx] == word[pidx]) {
+            int bonus = bonus_for(prev_class, current_class);
+            if(consecutive == 0) {
+                first_bonus = bonus;
+            } else {
+                // a chunk that starts at a word boundary keeps its bonus for the following characters
+                if(bonus >= BONUS_BOUNDARY && bonus > first_bonus) {
+                    first_bonus = bonus;
+                }
+                bonus = std::max(std::max(bonus, first_bonus), BONUS_CONSECUTIVE);
+            }
+
+            score += SCORE_MATCH + (pidx == 0 ? bonus * BONUS_FIRST_CHAR_MULTIPLIER : bonus);
+            if(idx >= name_offset) {
+                score += BONUS_NAME;
+            }
+            in_gap = false;
+            ++consecutive;
+            ++pidx;
+        } else {
+            score += in_gap ? SCORE_GAP_EXTENSION : SCORE_GAP_START;
+            in_gap = true;
+            consecutive = 0;
+            first_bonus = 0;
+        }
+        prev_class = current_class;
+    }
+    return std::max(score, 0);
+}
+} // namespace
+
+clFuzzyIndex::clFuzzyIndex() { m_offsets.push_back(0); }
+
+void clFuzzyIndex::Reserve(size_t count)
+{
+    m_offsets.reserve(count + 1);
+    m_names.reserve(count);
+    m_masks.reserve(count);
+}
+
+size_t clFuzzyIndex::Add(const wxString& text)
+{
+    std::string utf8 = text.ToStdString(wxConvUTF8);
+    uint64_t mask = 0;
+    size_t offset = m_text.length();
+    m_text.append(utf8);
+    for(char ch : utf8) {
+        char lower = to_lower(ch);
+        m_lower.push_back(lower);
+        mask |= char_bit(lower);
+    }
+
+    m_names.push_back(offset + find_name_offset(utf8));
+    m_masks.push_back(mask);
+    m_offsets.push_back(m_text.length());
+
+    // the new entry was never checked against the previous query
+    m_hasLastQuery = false;
+    return m_masks.size() - 1;
+}
+
+void clFuzzyIndex::Clear()
+{
+    m_text.clear();
+    m_lower.clear();
+    m_offsets.clear();
+    m_offsets.push_back(0);
+    m_names.clear();
+    m_masks.clear();
+    m_lastQuery.clear();
+    m_lastMatches.clear();
+    m_hasLastQuery = false;
+}
+
+void clFuzzyIndex::Prefilter(uint64_t mask, std::vector<uint32_t>& candidates) const
+{
+    // check the bags 64 at a time into a bitmap: the inner loop has no branches and vectorizes
+    const size_t count = m_masks.size();
+    const uint64_t* masks = m_masks.data();
+    for(size_t block = 0; block < count; block += 64) {
+        const size_t block_size = std::min<size_t>(64, count - block);
+        uint64_t bits = 0;
+        for(size_t i = 0; i < block_size; ++i) {
+            bits |= (uint64_t)((masks[block + i] & mask) == mask) << i;
+        }
+
+        while(bits) {
+            candidates.push_back(block + count_trailing_zeros(bits));
+            bits &= bits - 1;
+        }
+    }
+}
+
+int clFuzzyIndex::ScoreWord(size_t index, const std::string& word) const
+{
+    size_t start = m_offsets[index];
+    size_t len = m_offsets[index + 1] - start;
+    size_t name_offset = m_names[index] - start;
+    return score_word(m_text.data() + start, m_lower.data() + start, len, name_offset, word);
+}
+
+bool clFuzzyIndex::ScoreEntry(size_t index, const std::vector<std::string>& words, int* score) const
+{
+    int total = 0;
+    for(const auto& word : words) {
+        int word_score = ScoreWord(index, word);
+        if(word_score < 0) {
+            return false;
+        }
+        total += word_score;
+    }
+    *score = total;
+    return true;
+}
+
+clFuzzyIndex::Matches_t clFuzzyIndex::Search(const wxString& query, size_t limit)
+{
+    std::string lower_query = to_lower_utf8(query);
+    std::vector<std::string> words;
+    uint64_t mask = parse_query(lower_query, words);
+    if(words.empty()) {
+        m_hasLastQuery = false;
+        return {};
+    }
+
+    // typing more characters can only narrow the result: start from the previous matches
+    std::vector<uint32_t> candidates;
+    if(m_hasLastQuery && lower_query.length() > m_lastQuery.length() &&
+       lower_query.compare(0, m_lastQuery.length(), m_lastQuery) == 0) {
+        candidates.reserve(m_lastMatches.size());
+        for(uint32_t index : m_lastMatches) {
+            if((m_masks[index] & mask) == mask) {
+                candidates.push_back(index);
+            }
+        }
+    } else if(lower_query == m_lastQuery && m_hasLastQuery) {
+        candidates = m_lastMatches;
+    } else {
+        Prefilter(mask, candidates);
+    }
+
+    Matches_t matches;
+    m_lastMatches.clear();
+    for(uint32_t index : candidates) {
+        int score = 0;
+        if(ScoreEntry(index, words, &score)) {
+            m_lastMatches.push_back(index);
+            matches.push_back({ index, score });
+        }
+    }
+    m_lastQuery.swap(lower_query);
+    m_hasLastQuery = true;
+
+    auto compare = [this](const Match& a, const Match& b) {
+        if(a.score != b.score) {
+            return a.score > b.score;
+        }
+        size_t len_a = m_offsets[a.index + 1] - m_offsets[a.index];
+        size_t len_b = m_offsets[b.index + 1] - m_offsets[b.index];
+        if(len_a != len_b) {
+            return len_a < len_b;
+        }
+        return a.index < b.index;
+    };
+
+    // we only need the best `limit` matches sorted
+    if(limit > 0 && matches.size() > limit) {
+        std::partial_sort(matches.begin(), matches.begin() + limit, matches.end(), compare);
+        matches.resize(limit);
+    } else {
+        std::sort(matches.begin(), matches.end(), compare);
+    }
+    return matches;
+}
+
+bool clFuzzyIndex::Score(const wxString& query, const wxString& text, int* score)
+{
+    std::vector<std::string> words;
+    parse_query(to_lower_utf8(query), words);
+    if(words.empty()) {
+        return false;
+    }
+
+    std::string utf8 = text.ToStdString(wxConvUTF8);
+    std::string lower = utf8;
+    for(char& ch : lower) {
+        ch = to_lower(ch);
+    }
+
+    size_t name_offset = find_name_offset(utf8);
+    int total = 0;
+    for(const auto& word : words) {
+        int word_score = score_word(utf8.data(), lower.data(), utf8.length(), name_offset, word);
+        if(word_score < 0) {
+            return false;
+        }
+        total += word_score;
+    }
+
+    if(score) {
+        *score = total;
+    }
+    return true;
+}
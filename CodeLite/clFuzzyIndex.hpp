@@ -0,0 +1,87 @@
+#ifndef CLFUZZYINDEX_HPP
+#define CLFUZZYINDEX_HPP
+
+#include "codelite_exports.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <wx/string.h>
+
+/**
+ * @class clFuzzyIndex
+ * @brief a ranked fuzzy matcher over a fixed list of strings (file paths, symbol names, menu entries...)
+ *
+ * The entries are kept lower case (ASCII only) and back to back in a single buffer. Every entry also keeps a 64 bit
+ * "character bag": a cheap prefilter that rejects entries that do not contain all the query characters before the
+ * subsequence match runs.
+ *
+ * A query is a list of words separated by whitespace. An entry matches if every word is a (case insensitive)
+ * subsequence of it. Matches are scored like fzf: consecutive characters, characters at the start of a word (after a
+ * separator or a camelCase hump) and characters in the last path component score higher, gaps are penalized.
+ *
+ * When the query extends the previous one (the user typed more characters), only the entries that matched the previous
+ * query are checked.
+ */
+class WXDLLIMPEXP_CL clFuzzyIndex
+{
+public:
+    struct Match {
+        size_t index = 0; // the entry index, as returned by Add()
+        int score = 0;
+    };
+    typedef std::vector<Match> Matches_t;
+
+private:
+    std::string m_text;             // the entries as UTF-8
+    std::string m_lower;            // same as m_text, lower case
+    std::vector<uint32_t> m_offsets; // entry `i` is [m_offsets[i], m_offsets[i + 1])
+    std::vector<uint32_t> m_names;   // offset of the last path component of every entry
+    std::vector<uint64_t> m_masks;   // the character bag of every entry
+
+    // the previous query and all the entries that matched it
+    std::string m_lastQuery;
+    std::vector<uint32_t> m_lastMatches;
+    bool m_hasLastQuery = false;
+
+private:
+    void Prefilter(uint64_t mask, std::vector<uint32_t>& candidates) const;
+    bool ScoreEntry(size_t index, const std::vector<std::string>& words, int* score) const;
+    int ScoreWord(size_t index, const std::string& word) const;
+
+public:
+    clFuzzyIndex();
+    ~clFuzzyIndex() = default;
+
+    /**
+     * @brief reserve room for `count` entries
+     */
+    void Reserve(size_t count);
+
+    /**
+     * @brief add an entry, return its index
+     */
+    size_t Add(const wxString& text);
+
+    /**
+     * @brief remove all the entries
+     */
+    void Clear();
+
+    size_t GetCount() const { return m_offsets.size() - 1; }
+    bool IsEmpty() const { return GetCount() == 0; }
+
+    /**
+     * @brief return the entries that match `query`, best match first. Ties are broken by the entry length and then by
+     * the insertion order. Return at most `limit` matches, 0 means no limit. An empty query matches nothing
+     */
+    Matches_t Search(const wxString& query, size_t limit = 0);
+
+    /**
+     * @brief score a single string against `query`. Return false if it does not match. Use this for one off checks,
+     * `Search()` is much faster when the same strings are searched repeatedly
+     */
+    static bool Score(const wxString& query, const wxString& text, int* score = nullptr);
+};
+
+#endif // CLFUZZYINDEX_HPP
@@ -0,0 +1,129 @@
+#include "clLiteralSearcher.hpp"
+
+#include <string.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define CL_LITERAL_SEARCHER_SSE2 1
+#include <emmintrin.h>
+#endif
+
+namespace
+{
+inline unsigned char ascii_lower(unsigned char ch) { return (ch >= 'A' && ch <= 'Z') ? (ch | 0x20) : ch; }
+inline unsigned char ascii_upper(unsigned char ch) { return (ch >= 'a' && ch <= 'z') ? (ch & ~0x20) : ch; }
+
+#ifdef CL_LITERAL_SEARCHER_SSE2
+inline int count_trailing_zeros(unsigned int mask)
+{
+#if defined(_MSC_VER)
+    unsigned long index = 0;
+    _BitScanForward(&index, mask);
+    return (int)index;
+#else
+    return __builtin_ctz(mask);
+#endif
+}
+#endif
+} // namespace
+
+clLiteralSearcher::clLiteralSearcher(const std::string& needle, bool match_case)
+    : m_needle(needle)
+    , m_matchCase(match_case)
+{
+    if(m_needle.empty()) {
+        return;
+    }
+
+    unsigned char first = m_needle.front();
+    unsigned char last = m_needle.back();
+    if(m_matchCase) {
+        m_first[0] = m_first[1] = first;
+        m_last[0] = m_last[1] = last;
+    } else {
+        m_first[0] = ascii_lower(first);
+        m_first[1] = ascii_upper(first);
+        m_last[0] = ascii_lower(last);
+        m_last[1] = ascii_upper(last);
+    }
+}
+
+bool clLiteralSearcher::Equals(const char* p) const
+{
+    if(m_matchCase) {
+        return memcmp(p, m_needle.data(), m_needle.length()) == 0;
+    }
+
+    for(size_t i = 0; i < m_needle.length(); ++i) {
+        if(ascii_lower(p[i]) != ascii_lower(m_needle[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+const char* clLiteralSearcher::FindScalar(const char* begin, const char* end) const
+{
+    const size_t len = m_needle.length();
+    if(m_matchCase && m_first[0] == m_first[1]) {
+        // memchr is vectorised by the C library
+        const char* p = begin;
+        while(p + len <= end) {
+            p = static_cast<const char*>(memchr(p, m_first[0], (end - p) - len + 1));
+            if(p == nullptr) {
+                return nullptr;
+            }
+            if(Equals(p)) {
+                return p;
+            }
+            ++p;
+        }
+        return nullptr;
+    }
+
+    for(const char* p = begin; p + len <= end; ++p) {
+        unsigned char ch = *p;
+        if((ch == m_first[0] || ch == m_first[1]) && Equals(p)) {
+            return p;
+        }
+    }
+    return nullptr;
+}
+
+const char* clLiteralSearcher::Find(const char* begin, const char* end) const
+{
+    const size_t len = m_needle.length();
+    if(len == 0 || begin == nullptr || end < begin || (size_t)(end - begin) < len) {
+        return nullptr;
+    }
+
+#ifdef CL_LITERAL_SEARCHER_SSE2
+    const __m128i first0 = _mm_set1_epi8((char)m_first[0]);
+    const __m128i first1 = _mm_set1_epi8((char)m_first[1]);
+    const __m128i last0 = _mm_set1_epi8((char)m_last[0]);
+    const __m128i last1 = _mm_set1_epi8((char)m_last[1]);
+
+    // compare 16 candidate positions at once: a position is a candidate when both the first and the last bytes of
+    // the needle match
+    const char* p = begin;
+    for(; p + len - 1 + 16 <= end; p += 16) {
+        __m128i block_first = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        __m128i block_last = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + len - 1));
+
+        __m128i eq_first =
+            _mm_or_si128(_mm_cmpeq_epi8(block_first, first0), _mm_cmpeq_epi8(block_first, first1));
+        __m128i eq_last = _mm_or_si128(_mm_cmpeq_epi8(block_last, last0), _mm_cmpeq_epi8(block_last, last1));
+        unsigned int mask = (unsigned int)_mm_movemask_epi8(_mm_and_si128(eq_first, eq_last));
+        while(mask) {
+            int bit = count_trailing_zeros(mask);
+            if(Equals(p + bit)) {
+                return p + bit;
+            }
+            mask &= mask - 1;
+        }
+    }
+    // the tail
+    return FindScalar(p, end);
+#else
+    return FindScalar(begin, end);
+#endif
+}
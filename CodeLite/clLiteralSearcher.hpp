@@ -0,0 +1,39 @@
+#ifndef CLLITERALSEARCHER_HPP
+#define CLLITERALSEARCHER_HPP
+
+#include "codelite_exports.h"
+
+#include <string>
+
+/**
+ * @class clLiteralSearcher
+ * @brief search for a literal string in a raw byte buffer
+ *
+ * The first and the last bytes of the needle are used as a filter (16 bytes at a time when SSE2 is available), only
+ * the positions that pass the filter are compared with the whole needle. When the search is not case sensitive, only
+ * ASCII letters are folded
+ */
+class WXDLLIMPEXP_CL clLiteralSearcher
+{
+    std::string m_needle;
+    bool m_matchCase = true;
+    unsigned char m_first[2] = { 0, 0 };
+    unsigned char m_last[2] = { 0, 0 };
+
+    bool Equals(const char* p) const;
+    const char* FindScalar(const char* begin, const char* end) const;
+
+public:
+    clLiteralSearcher(const std::string& needle, bool match_case);
+    ~clLiteralSearcher() = default;
+
+    /**
+     * @brief return the first occurrence of the needle in the range [begin, end) or nullptr
+     */
+    const char* Find(const char* begin, const char* end) const;
+
+    bool IsEmpty() const { return m_needle.empty(); }
+    size_t GetLength() const { return m_needle.length(); }
+};
+
+#endif // CLLITERALSEARCHER_HPP
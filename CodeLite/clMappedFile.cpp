@@ -0,0 +1,69 @@
+#include "clMappedFile.hpp"
+
+#include <wx/ffile.h>
+
+#ifndef __WXMSW__
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+clMappedFile::~clMappedFile() { Close(); }
+
+void clMappedFile::Close()
+{
+    // keep the buffer, the next Open() re-uses it
+    m_data = nullptr;
+    m_size = 0;
+}
+
+bool clMappedFile::Open(const wxString& path, size_t max_size)
+{
+    Close();
+
+#ifndef __WXMSW__
+    int fd = ::open(path.mb_str(wxConvUTF8).data(), O_RDONLY | O_CLOEXEC);
+    if(fd < 0) {
+        return false;
+    }
+
+    struct stat st;
+    if(::fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || (size_t)st.st_size > max_size) {
+        ::close(fd);
+        return false;
+    }
+
+    // read what the file has now: if it is truncated while we read it, we get less bytes (a mapping would raise
+    // SIGBUS instead)
+    size_t size = st.st_size;
+    if(m_buffer.size() < size) {
+        m_buffer.resize(size);
+    }
+    size_t total = 0;
+    while(total < size) {
+        ssize_t bytes = ::read(fd, &m_buffer[total], size - total);
+        if(bytes < 0 && errno == EINTR) {
+            continue;
+        }
+        if(bytes <= 0) {
+            break;
+        }
+        total += bytes;
+    }
+    ::close(fd);
+#else
+    wxFFile fp(path, "rb");
+    if(!fp.IsOpened() || (size_t)fp.Length() > max_size) {
+        return false;
+    }
+    size_t size = fp.Length();
+    if(m_buffer.size() < size) {
+        m_buffer.resize(size);
+    }
+    size_t total = fp.Read(&m_buffer[0], size);
+#endif
+    m_data = m_buffer.data();
+    m_size = total;
+    return true;
+}
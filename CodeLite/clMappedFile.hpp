@@ -0,0 +1,46 @@
+#ifndef CLMAPPEDFILE_HPP
+#define CLMAPPEDFILE_HPP
+
+#include "codelite_exports.h"
+
+#include <string>
+#include <wx/string.h>
+
+/**
+ * @class clMappedFile
+ * @brief a read-only view of a file's content
+ *
+ * The file is read into a buffer that is kept by Close() and re-used by the next Open(): a single instance used for
+ * many files allocates only when a file is larger than the ones before it. The files are not memory mapped, reading
+ * a mapping of a file that was truncated by another process raises SIGBUS.
+ * The content is the raw bytes of the file, no encoding conversion is done
+ */
+class WXDLLIMPEXP_CL clMappedFile
+{
+    const char* m_data = nullptr;
+    size_t m_size = 0;
+    std::string m_buffer;
+
+    clMappedFile(const clMappedFile&) = delete;
+    clMappedFile& operator=(const clMappedFile&) = delete;
+
+public:
+    clMappedFile() = default;
+    ~clMappedFile();
+
+    /**
+     * @brief open `path`. Files larger than `max_size` are not opened
+     */
+    bool Open(const wxString& path, size_t max_size = (100 << 20));
+    /**
+     * @brief drop the content. The memory is kept for the next Open()
+     */
+    void Close();
+
+    const char* GetData() const { return m_data; }
+    size_t GetSize() const { return m_size; }
+    const char* begin() const { return m_data; }
+    const char* end() const { return m_data + m_size; }
+};
+
+#endif // CLMAPPEDFILE_HPP
@@ -30,10 +30,165 @@
 #include "precompiled_header.h"
 
 #include <algorithm>
+#include <atomic>
+#include <deque>
 #include <unordered_set>
 #include <wx/longlong.h>
+#include <wx/stopwatch.h>
 #include <wx/tokenzr.h>
 
+namespace
+{
+std::atomic_bool g_walMode{ false };
+std::atomic_bool g_crashSafe{ false };
+
+// how long a writer waits for another writer before giving up (ms)
+constexpr int WAL_BUSY_TIMEOUT_MS = 2000;
+constexpr int DEFAULT_BUSY_TIMEOUT_MS = 10;
+
+int GetBusyTimeout() { return g_walMode ? WAL_BUSY_TIMEOUT_MS : DEFAULT_BUSY_TIMEOUT_MS; }
+
+constexpr size_t MAX_INVALIDATION_EVENTS = 4096;
+
+// above this number of files, a Store() simply invalidates everything
+constexpr size_t MAX_FILES_FOR_PARTIAL_INVALIDATION = 50;
+} // namespace
+
+// Cache invalidation log of a database file. Every TagsStorageSQLite instance has its own results cache, but the
+// database may be written by other instances (e.g. ctagsd's parser thread). Writers publish the files they changed
+// here, readers apply them to their cache before using it. Each database has its own sequence, so the writes to
+// one database never invalidate the caches of another
+struct TagsCacheInvalidationLog {
+    struct Event {
+        uint64_t seq = 0;
+        wxString file; // empty file means: "invalidate everything"
+    };
+
+    std::mutex mutex;
+    std::atomic<uint64_t> seq{ 0 };
+    std::deque<Event> events;
+};
+
+namespace
+{
+std::mutex g_invalidationLogsMutex;
+std::unordered_map<wxString, std::shared_ptr<TagsCacheInvalidationLog>> g_invalidationLogs; // db path -> log
+
+std::shared_ptr<TagsCacheInvalidationLog> get_invalidation_log(const wxString& db_path)
+{
+    std::lock_guard<std::mutex> lk{ g_invalidationLogsMutex };
+    auto& log = g_invalidationLogs[db_path];
+    if(!log) {
+        log = std::make_shared<TagsCacheInvalidationLog>();
+    }
+    return log;
+}
+} // namespace
+
+//-------------------------------------------------
+// Read connections pool
+//-------------------------------------------------
+namespace
+{
+void close_connection(clSqliteDB* db)
+{
+    try {
+        db->Close();
+    } catch (const wxSQLite3Exception& e) {
+        wxUnusedVar(e);
+    }
+}
+
+/// the pools that opened a connection for the current thread. When the thread exits, its connections are closed
+/// so short-lived worker threads don't leave them behind (and a recycled thread id does not pick up a stale one)
+struct ReadPoolThreadExit {
+    std::vector<std::weak_ptr<clSqliteReadPool::Connections>> pools;
+    ~ReadPoolThreadExit()
+    {
+        wxThreadIdType thread_id = wxThread::GetCurrentId();
+        for(auto& weak_pool : pools) {
+            auto pool = weak_pool.lock();
+            if(!pool) {
+                continue;
+            }
+
+            std::unique_ptr<clSqliteDB> db;
+            {
+                std::lock_guard<std::mutex> lk{ pool->mutex };
+                auto where = pool->by_thread.find(thread_id);
+                if(where == pool->by_thread.end()) {
+                    continue;
+                }
+                db = std::move(where->second);
+                pool->by_thread.erase(where);
+            }
+            close_connection(db.get());
+        }
+    }
+};
+
+thread_local ReadPoolThreadExit g_readPoolThreadExit;
+} // namespace
+
+clSqliteReadPool::clSqliteReadPool(const wxString& path, int busy_timeout)
+    : m_path(path)
+    , m_busyTimeout(busy_timeout)
+    , m_connections(std::make_shared<Connections>())
+{
+}
+
+clSqliteReadPool::~clSqliteReadPool() { Close(); }
+
+clSqliteDB* clSqliteReadPool::Get()
+{
+    wxThreadIdType thread_id = wxThread::GetCurrentId();
+    {
+        std::lock_guard<std::mutex> lk{ m_connections->mutex };
+        auto where = m_connections->by_thread.find(thread_id);
+        if(where != m_connections->by_thread.end()) {
+            return where->second.get();
+        }
+    }
+
+    std::unique_ptr<clSqliteDB> db(new clSqliteDB());
+    try {
+        db->Open(m_path);
+        db->SetBusyTimeout(m_busyTimeout);
+        db->ExecuteUpdate("PRAGMA query_only = ON;");
+        db->ExecuteUpdate("PRAGMA temp_store = MEMORY;");
+        db->ExecuteUpdate("PRAGMA case_sensitive_like = 0;");
+    } catch (const wxSQLite3Exception& e) {
+        clWARNING() << "Failed to open read connection for:" << m_path << "." << e.GetMessage() << endl;
+        return nullptr;
+    }
+
+    // drop the pools that are gone before registering this one
+    auto& pools = g_readPoolThreadExit.pools;
+    pools.erase(std::remove_if(pools.begin(), pools.end(), [](const auto& pool) { return pool.expired(); }),
+                pools.end());
+    pools.push_back(m_connections);
+
+    clSqliteDB* conn = db.get();
+    std::lock_guard<std::mutex> lk{ m_connections->mutex };
+    m_connections->by_thread.insert({ thread_id, std::move(db) });
+    return conn;
+}
+
+void clSqliteReadPool::Close()
+{
+    std::lock_guard<std::mutex> lk{ m_connections->mutex };
+    for(auto& vt : m_connections->by_thread) {
+        close_connection(vt.second.get());
+    }
+    m_connections->by_thread.clear();
+}
+
+size_t clSqliteReadPool::GetCount() const
+{
+    std::lock_guard<std::mutex> lk{ m_connections->mutex };
+    return m_connections->by_thread.size();
+}
+
 //-------------------------------------------------
 // Tags database class implementation
 //-------------------------------------------------
@@ -47,12 +202,270 @@ TagsStorageSQLite::TagsStorageSQLite()
 TagsStorageSQLite::~TagsStorageSQLite()
 {
     if(m_db) {
-        m_db->Close();
+        DoClose();
         delete m_db;
         m_db = NULL;
     }
 }
 
+void TagsStorageSQLite::SetWALMode(bool b) { g_walMode = b; }
+bool TagsStorageSQLite::IsWALMode() { return g_walMode; }
+void TagsStorageSQLite::SetCrashSafe(bool b) { g_crashSafe = b; }
+bool TagsStorageSQLite::IsCrashSafe() { return g_crashSafe; }
+
+void TagsStorageSQLite::DoOpen(const wxFileName& fileName)
+{
+    m_db->Open(fileName.GetFullPath());
+    m_db->SetBusyTimeout(GetBusyTimeout());
+    CreateSchema();
+    m_fileName = fileName;
+
+    if(g_walMode) {
+        m_readPool.reset(new clSqliteReadPool(fileName.GetFullPath(), GetBusyTimeout()));
+    }
+
+    // attach to the symbol index of this database, if someone loaded it
+    m_symbolIndex = TagsSymbolIndex::Get(fileName.GetFullPath());
+
+    // a different database: start with an empty cache
+    m_cache.Clear();
+    m_invalidationLog = get_invalidation_log(fileName.GetFullPath());
+    m_cacheSeq = m_invalidationLog->seq;
+}
+
+void TagsStorageSQLite::DoSyncCache()
+{
+    if(!m_invalidationLog || m_cacheSeq == m_invalidationLog->seq) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lk{ m_invalidationLog->mutex };
+    const auto& events = m_invalidationLog->events;
+    if(!events.empty() && events.front().seq > m_cacheSeq + 1) {
+        // we missed some events
+        m_cache.Clear();
+    } else {
+        for(const auto& event : events) {
+            if(event.seq <= m_cacheSeq) {
+                continue;
+            }
+
+            if(event.file.empty()) {
+                m_cache.Clear();
+            } else {
+                m_cache.InvalidateFile(event.file);
+            }
+        }
+    }
+    m_cacheSeq = m_invalidationLog->seq;
+}
+
+void TagsStorageSQLite::DoPublishCacheInvalidation(const wxStringSet_t& files, bool everything)
+{
+    if(!m_invalidationLog) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lk{ m_invalidationLog->mutex };
+    auto& events = m_invalidationLog->events;
+    if(everything) {
+        events.push_back({ ++m_invalidationLog->seq, wxEmptyString });
+    } else {
+        for(const wxString& file : files) {
+            events.push_back({ ++m_invalidationLog->seq, file });
+        }
+    }
+
+    while(events.size() > MAX_INVALIDATION_EVENTS) {
+        events.pop_front();
+    }
+}
+
+bool TagsStorageSQLite::DoHasNewSymbols(const wxStringSet_t& files, const std::vector<TagEntryPtr>& tags)
+{
+    if(files.size() > MAX_FILES_FOR_PARTIAL_INVALIDATION) {
+        return true;
+    }
+
+    // the "shape" of the files: which symbols they define
+    wxStringSet_t new_symbols;
+    for(const auto& tag : tags) {
+        if(tag->IsLocalVariable() || !tag->IsOk())
+            continue;
+        new_symbols.insert(tag->GetKind() + "|" + tag->GetPath());
+    }
+
+    try {
+        wxSQLite3Statement& statement = m_db->GetCachedStatement("select kind, path from tags where file=?");
+        for(const wxString& file : files) {
+            statement.Bind(1, file);
+            wxSQLite3ResultSet rs = statement.ExecuteQuery();
+            while(rs.NextRow() && !new_symbols.empty()) {
+                new_symbols.erase(rs.GetString(0) + "|" + rs.GetString(1));
+            }
+            statement.Reset();
+        }
+    } catch (const wxSQLite3Exception& e) {
+        wxUnusedVar(e);
+        return true;
+    }
+
+    // if all the symbols already existed, only the cached results that include these files are affected
+    return !new_symbols.empty();
+}
+
+void TagsStorageSQLite::DoClose()
+{
+    // close the readers before the writer, so the last connection can checkpoint the WAL file
+    if(m_readPool) {
+        m_readPool->Close();
+        m_readPool.reset();
+    }
+    m_symbolIndex.reset();
+    DoClearPendingChanges();
+    m_invalidationLog.reset();
+    m_db->Close();
+}
+
+clSqliteDB* TagsStorageSQLite::GetReadDb()
+{
+    if(!m_readPool || !m_db->IsOpen() || !m_db->GetAutoCommit()) {
+        return m_db;
+    }
+
+    clSqliteDB* db = m_readPool->Get();
+    return db ? db : m_db;
+}
+
+size_t TagsStorageSQLite::LoadSymbolIndex()
+{
+    if(!m_db->IsOpen()) {
+        return 0;
+    }
+
+    wxStopWatch sw;
+    TagsSymbolIndex::ptr_t index = TagsSymbolIndex::Create(m_fileName.GetFullPath());
+    try {
+        wxSQLite3ResultSet rs = GetReadDb()->ExecuteQuery("select ID, name, scope, path, kind, file from tags");
+        index->Load([&rs](TagsSymbolIndex::Entry& entry, wxString& file) {
+            if(!rs.NextRow()) {
+                return false;
+            }
+            entry.id = rs.GetInt(0);
+            entry.name = rs.GetString(1);
+            entry.scope = rs.GetString(2);
+            entry.path = rs.GetString(3);
+            entry.kind = rs.GetString(4);
+            file = rs.GetString(5);
+            return true;
+        });
+        rs.Finalize();
+    } catch (const wxSQLite3Exception& e) {
+        clWARNING() << "Failed to load the symbol index." << e.GetMessage() << endl;
+        TagsSymbolIndex::Release(m_fileName.GetFullPath());
+        m_symbolIndex.reset();
+        return 0;
+    }
+
+    m_symbolIndex = index;
+    clDEBUG() << "Symbol index loaded:" << index->GetCount() << "symbols," << index->GetStringsBytes()
+              << "bytes of strings. Time:" << sw.Time() << "ms" << endl;
+    return index->GetCount();
+}
+
+void TagsStorageSQLite::DoUpdateSymbolIndex(const wxString& file)
+{
+    // use the write connection, a reader may still see the database as it was before the last commit
+    std::vector<TagsSymbolIndex::Entry> entries;
+    wxSQLite3Statement& statement = m_db->GetCachedStatement("select ID, name, scope, path, kind from tags where file=?");
+    statement.Bind(1, file);
+    wxSQLite3ResultSet rs = statement.ExecuteQuery();
+    while(rs.NextRow()) {
+        TagsSymbolIndex::Entry entry;
+        entry.id = rs.GetInt(0);
+        entry.name = rs.GetString(1);
+        entry.scope = rs.GetString(2);
+        entry.path = rs.GetString(3);
+        entry.kind = rs.GetString(4);
+        entries.push_back(entry);
+    }
+    statement.Reset();
+    m_symbolIndex->UpdateFile(file, entries);
+}
+
+void TagsStorageSQLite::DoApplyCommittedChanges()
+{
+    if(m_symbolIndex && !m_pendingIndexFiles.empty()) {
+        // read the new IDs back (the tags.file column is indexed). A file without rows is removed from the index
+        try {
+            for(const wxString& file : m_pendingIndexFiles) {
+                DoUpdateSymbolIndex(file);
+            }
+        } catch (const wxSQLite3Exception& e) {
+            clWARNING() << "TagsStorageSQLite: failed to update the symbol index." << e.GetMessage() << endl;
+        }
+    }
+
+    if(m_pendingInvalidateAll || !m_pendingInvalidatedFiles.empty()) {
+        DoPublishCacheInvalidation(m_pendingInvalidatedFiles, m_pendingInvalidateAll);
+    }
+    DoClearPendingChanges();
+}
+
+void TagsStorageSQLite::DoClearPendingChanges()
+{
+    m_pendingIndexFiles.clear();
+    m_pendingInvalidatedFiles.clear();
+    m_pendingInvalidateAll = false;
+}
+
+void TagsStorageSQLite::DoFetchTagsByIds(const std::vector<long>& ids, std::vector<TagEntryPtr>& tags)
+{
+    // lookups by the primary key, a batch of IDs per statement. The statements are cached by their SQL text, so
+    // a short batch is padded (by repeating its last ID) to one of two fixed sizes
+    constexpr size_t SMALL_BATCH_SIZE = 16;
+    constexpr size_t BATCH_SIZE = 256;
+
+    std::unordered_map<long, TagEntryPtr> tags_by_id;
+    tags_by_id.reserve(ids.size());
+    for(size_t first = 0; first < ids.size(); first += BATCH_SIZE) {
+        size_t count = std::min(BATCH_SIZE, ids.size() - first);
+        size_t batch_size = count <= SMALL_BATCH_SIZE ? SMALL_BATCH_SIZE : BATCH_SIZE;
+
+        TagsStorageSQLiteQuery query;
+        query.Sql("select * from tags where ID in (");
+        for(size_t i = 0; i < batch_size; ++i) {
+            if(i > 0) {
+                query.Sql(",");
+            }
+            query.Value((int)ids[first + std::min(i, count - 1)]);
+        }
+        query.Sql(")");
+        DoQuery(query, [&tags_by_id](wxSQLite3ResultSet& rs) {
+            TagEntryPtr tag = FromSQLite3ResultSet(rs);
+            tags_by_id.insert({ tag->GetId(), tag });
+            return true;
+        });
+    }
+
+    // keep the order of the index
+    tags.reserve(tags.size() + ids.size());
+    for(long id : ids) {
+        auto where = tags_by_id.find(id);
+        if(where != tags_by_id.end()) {
+            tags.push_back(where->second);
+        }
+    }
+}
+
+size_t TagsStorageSQLite::GetRemainingLimit(const std::vector<TagEntryPtr>& tags) const
+{
+    if(tags.size() >= (size_t)GetSingleSearchLimit()) {
+        return 1;
+    }
+    return (size_t)GetSingleSearchLimit() - tags.size();
+}
+
 void TagsStorageSQLite::OpenDatabase(const wxFileName& fileName)
 {
     if(m_fileName.GetFullPath() == fileName.GetFullPath())
@@ -70,19 +483,13 @@ void TagsStorageSQLite::OpenDatabase(const wxFileName& fileName)
     try {
         if(!m_fileName.IsOk()) {
             // First time we open the db
-            m_db->Open(fileName.GetFullPath());
-            m_db->SetBusyTimeout(10);
-            CreateSchema();
-            m_fileName = fileName;
+            DoOpen(fileName);
 
         } else {
             // We have both fileName & m_fileName and they
             // are different, Close previous db
-            m_db->Close();
-            m_db->Open(fileName.GetFullPath());
-            m_db->SetBusyTimeout(10);
-            CreateSchema();
-            m_fileName = fileName;
+            DoClose();
+            DoOpen(fileName);
         }
 
     } catch (const wxSQLite3Exception& e) {
@@ -97,19 +504,33 @@ void TagsStorageSQLite::CreateSchema()
     // improve performance by using pragma command:
     // (this needs to be done before the creation of the
     // tables and indices)
-    try {
-        sql = wxT("PRAGMA journal_mode= OFF;");
-        m_db->ExecuteUpdate(sql);
-
-        sql = wxT("PRAGMA synchronous = OFF;");
-        m_db->ExecuteUpdate(sql);
+    // A pragma that fails (e.g. journal_mode=WAL on a busy database, or on a network file system) leaves the database
+    // in its previous mode, which still works: log it and carry on with the schema
+    auto execute_pragma = [this](const wxString& pragma) {
+        try {
+            m_db->ExecuteUpdate(pragma);
+        } catch (const wxSQLite3Exception& e) {
+            clWARNING() << "TagsStorageSQLite:" << pragma << "failed." << e.GetMessage() << endl;
+        }
+    };
 
-        sql = wxT("PRAGMA temp_store = MEMORY;");
-        m_db->ExecuteUpdate(sql);
+    // journal_mode=WAL is persistent (stored in the database file), so we always set it explicitly
+    if(g_walMode) {
+        execute_pragma(wxT("PRAGMA journal_mode = WAL;"));
+    } else {
+        execute_pragma(g_crashSafe ? wxT("PRAGMA journal_mode = DELETE;") : wxT("PRAGMA journal_mode = OFF;"));
+    }
 
-        sql = wxT("PRAGMA case_sensitive_like = 0;");
-        m_db->ExecuteUpdate(sql);
+    // in WAL mode, synchronous=NORMAL is enough to guarantee consistency after a crash
+    if(g_crashSafe) {
+        execute_pragma(g_walMode ? wxT("PRAGMA synchronous = NORMAL;") : wxT("PRAGMA synchronous = FULL;"));
+    } else {
+        execute_pragma(wxT("PRAGMA synchronous = OFF;"));
+    }
+    execute_pragma(wxT("PRAGMA temp_store = MEMORY;"));
+    execute_pragma(wxT("PRAGMA case_sensitive_like = 0;"));
 
+    try {
         sql = wxT("create  table if not exists tags (ID INTEGER PRIMARY KEY AUTOINCREMENT, name string, file string, "
                   "line integer, kind string, access string, signature string, pattern string, parent string, inherits "
                   "string, path string, typeref string, scope string, template_definition string, tag_properties "
@@ -230,6 +651,28 @@ wxString TagsStorageSQLite::GetSchemaVersion() const
     } catch (const wxSQLite3Exception&) {    \
     }
 
+namespace
+{
+// number of rows inserted by a single INSERT statement. Each row binds 15 parameters,
+// so we keep it below the default SQLITE_MAX_VARIABLE_NUMBER (999)
+constexpr size_t INSERT_BATCH_SIZE = 64;
+constexpr int TAG_COLUMNS_COUNT = 15;
+
+wxString BuildInsertTagsSQL(size_t rows)
+{
+    wxString sql;
+    sql.reserve(64 + rows * 40);
+    sql << "INSERT OR REPLACE INTO TAGS VALUES ";
+    for(size_t i = 0; i < rows; ++i) {
+        if(i > 0) {
+            sql << ",";
+        }
+        sql << "(NULL, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)";
+    }
+    return sql;
+}
+} // namespace
+
 void TagsStorageSQLite::Store(const std::vector<TagEntryPtr>& tags, bool auto_commit)
 {
     try {
@@ -247,10 +690,13 @@ void TagsStorageSQLite::Store(const std::vector<TagEntryPtr>& tags, bool auto_co
         files.insert(tag->GetFile());
     }
 
+    // new symbols may be added to the results of any cached query
+    bool has_new_symbols = DoHasNewSymbols(files, tags);
+
     try {
         // delete all tags owned by these files
         for(const wxString& file : files) {
-            DeleteByFileName({}, file, false);
+            DoDeleteByFileName(file);
         }
     } catch (const wxSQLite3Exception& e) {
         clWARNING() << "TagsStorageSQLite::Store() error:" << e.GetMessage() << endl;
@@ -258,28 +704,121 @@ void TagsStorageSQLite::Store(const std::vector<TagEntryPtr>& tags, bool auto_co
         return;
     }
 
+    // file name -> normalized full path
+    wxStringMap_t normalized_files;
+    normalized_files.reserve(files.size());
+
     // store the tags
     try {
+
+        std::vector<const TagEntry*> batch;
+        batch.reserve(INSERT_BATCH_SIZE);
         for(auto tag : tags) {
             // we don't store local variables
-            if(tag->IsLocalVariable())
+            // If this node is a dummy, (IsOk() == false) we don't insert it to database
+            if(tag->IsLocalVariable() || !tag->IsOk())
                 continue;
-            DoInsertTagEntry(*tag);
+            batch.push_back(tag.get());
+            if(batch.size() == INSERT_BATCH_SIZE) {
+                DoInsertTagEntries(batch, normalized_files);
+                batch.clear();
+            }
+        }
+
+        if(!batch.empty()) {
+            DoInsertTagEntries(batch, normalized_files);
         }
     } catch (const wxSQLite3Exception& e) {
         clWARNING() << "TagsStorageSQLite::Store(): failed to insert entries into the db. " << e.GetMessage() << endl;
         SAFE_ROLLBACK_IF_NEEDED(auto_commit);
+        return;
+    }
+
+    // cached results depend on the file names as stored in the database and as passed by the callers
+    m_pendingInvalidateAll = m_pendingInvalidateAll || has_new_symbols;
+    if(!m_pendingInvalidateAll) {
+        m_pendingInvalidatedFiles.insert(files.begin(), files.end());
+        for(const auto& vt : normalized_files) {
+            m_pendingInvalidatedFiles.insert(vt.second);
+        }
+    }
+
+    if(m_symbolIndex) {
+        // the index is keyed by the normalized path, as stored in the database
+        for(const wxString& file : files) {
+            auto where = normalized_files.find(file);
+            m_pendingIndexFiles.insert(where == normalized_files.end() ? wxFileName(file).GetFullPath()
+                                                                       : where->second);
+        }
+    }
+
+    if(!auto_commit) {
+        // the caller commits, see Commit()
+        return;
     }
 
     // commit
     try {
-        if(auto_commit)
-            m_db->Commit();
+        m_db->Commit();
     } catch (const wxSQLite3Exception& e) {
         clWARNING() << "failed to commit tx." << e.GetMessage() << endl;
+        DoClearPendingChanges();
         SAFE_ROLLBACK_IF_NEEDED(auto_commit);
         return;
     }
+    DoApplyCommittedChanges();
+}
+
+void TagsStorageSQLite::DoInsertTagEntries(const std::vector<const TagEntry*>& tags, wxStringMap_t& normalized_files)
+{
+    // statements are cached by their SQL, so there are at most 2 variations here:
+    // a full batch and the remainder
+    wxSQLite3Statement& statement = m_db->GetCachedStatement(BuildInsertTagsSQL(tags.size()));
+
+    int index = 1;
+    for(const TagEntry* tag : tags) {
+        // normalize each file only once
+        auto where = normalized_files.find(tag->GetFile());
+        if(where == normalized_files.end()) {
+            where = normalized_files.insert({ tag->GetFile(), wxFileName(tag->GetFile()).GetFullPath() }).first;
+        }
+
+        statement.Bind(index + 0, tag->GetName());
+        statement.Bind(index + 1, where->second);
+        statement.Bind(index + 2, tag->GetLine());
+        statement.Bind(index + 3, tag->GetKind());
+        statement.Bind(index + 4, tag->GetAccess());
+        statement.Bind(index + 5, tag->GetSignature());
+        statement.Bind(index + 6, tag->GetPattern());
+        statement.Bind(index + 7, tag->GetParent());
+        statement.Bind(index + 8, tag->GetInheritsAsString());
+        statement.Bind(index + 9, tag->GetPath());
+        statement.Bind(index + 10, tag->GetTypename());
+        statement.Bind(index + 11, tag->GetScope());
+        statement.Bind(index + 12, tag->GetTemplateDefinition());
+        statement.Bind(index + 13, tag->GetTagProperties());
+        statement.Bind(index + 14, tag->GetMacrodef());
+        index += TAG_COLUMNS_COUNT;
+    }
+
+    try {
+        statement.ExecuteUpdate();
+    } catch (const wxSQLite3Exception& e) {
+        // a single bad row fails the entire batch, fallback to row-by-row insertion
+        LOG_IF_DEBUG { clDEBUG() << "Batch insert failed:" << e.GetMessage() << ". Inserting rows one by one" << endl; }
+        for(const TagEntry* tag : tags) {
+            DoInsertTagEntry(*tag);
+        }
+    }
+}
+
+void TagsStorageSQLite::DoDeleteByFileName(const wxString& fileName)
+{
+    // the `tags.file` column is indexed (FILE_IDX)
+    wxSQLite3Statement& statement = m_db->GetCachedStatement("DELETE FROM TAGS WHERE FILE=?");
+    statement.Bind(1, fileName);
+    statement.ExecuteUpdate();
+    DeleteFileEntry(fileName);
 }
 
 void TagsStorageSQLite::SelectTagsByFile(const wxString& file, std::vector<TagEntryPtr>& tags, const wxFileName& path)
@@ -289,15 +828,15 @@ void TagsStorageSQLite::SelectTagsByFile(const wxString& file, std::vector<TagEn
     path.IsOk() == false ? databaseFileName = m_fileName : databaseFileName = path;
     OpenDatabase(databaseFileName);
 
-    wxString query;
-    query << wxT("select * from tags where file='") << file << "' ";
+    TagsStorageSQLiteQuery query;
+    query.Sql("select * from tags where file=").File(file);
     // #ifdef __WXMSW__
     //     // Under Windows, the file-crawler changes the file path
     //     // to lowercase. However, the database matches the file name
     //     // by case-sensitive
     //     query << "COLLATE NOCASE ";
     // #endif
-    query << wxT("order by line asc");
+    query.Sql(" order by line asc");
     DoFetchTags(query, tags);
 }
 
@@ -311,14 +850,24 @@ void TagsStorageSQLite::DeleteByFileName(const wxFileName& path, const wxString&
             m_db->Begin();
         }
 
-        wxString sql;
-        sql << "delete from tags where File='" << fileName << "'";
-        m_db->ExecuteUpdate(sql);
-        if(autoCommit)
+        wxSQLite3Statement& statement = m_db->GetCachedStatement("DELETE FROM TAGS WHERE FILE=?");
+        statement.Bind(1, fileName);
+        statement.ExecuteUpdate();
+
+        if(m_symbolIndex) {
+            // Store() keys the index by the normalized path
+            m_pendingIndexFiles.insert(wxFileName(fileName).GetFullPath());
+        }
+        m_pendingInvalidatedFiles.insert(fileName);
+
+        if(autoCommit) {
             m_db->Commit();
+            DoApplyCommittedChanges();
+        }
     } catch (const wxSQLite3Exception& e) {
         wxUnusedVar(e);
         if(autoCommit) {
+            DoClearPendingChanges();
             m_db->Rollback();
         }
     }
@@ -331,7 +880,7 @@ wxSQLite3ResultSet TagsStorageSQLite::Query(const wxString& sql, const wxFileNam
     // make sure database is open
     try {
         OpenDatabase(path);
-        return m_db->ExecuteQuery(sql);
+        return GetReadDb()->ExecuteQuery(sql);
     } catch (const wxSQLite3Exception& e) {
         clWARNING() << "Query error:" << sql << "." << e.GetMessage();
         if(e.GetMessage().Contains("disk I/O error")) {
@@ -355,7 +904,6 @@ const bool TagsStorageSQLite::IsOpen() const { return m_db->IsOpen(); }
 void TagsStorageSQLite::GetFilesForCC(const wxString& userTyped, wxArrayString& matches)
 {
     try {
-        wxString query;
         wxString tmpName(userTyped);
 
         // Files are kept in native format in the database
@@ -364,24 +912,26 @@ void TagsStorageSQLite::GetFilesForCC(const wxString& userTyped, wxArrayString&
         tmpName.Replace("\\", "/");
         tmpName.Replace("/", wxString() << wxFILE_SEP_PATH);
         tmpName.Replace(wxT("_"), wxT("^_"));
-        query << wxT("select * from files where file like '%%") << tmpName << wxT("%%' ESCAPE '^' ")
-              << wxT("order by file");
+
+        TagsStorageSQLiteQuery query;
+        query.Sql("select * from files where file like ")
+            .Value(wxString() << "%" << tmpName << "%")
+            .Sql(" ESCAPE '^' order by file");
 
         wxString pattern = userTyped;
         pattern.Replace("\\", "/");
 
-        wxSQLite3ResultSet res = m_db->ExecuteQuery(query);
-        while(res.NextRow()) {
+        DoQuery(query, [&](wxSQLite3ResultSet& res) {
             // Keep the part from where the user typed and until the end of the file name
             wxString matchedFile = res.GetString(1);
             matchedFile.Replace("\\", "/");
 
             int where = matchedFile.Find(pattern);
-            if(where == wxNOT_FOUND)
-                continue;
-            matchedFile = matchedFile.Mid(where);
-            matches.Add(matchedFile);
-        }
+            if(where != wxNOT_FOUND) {
+                matches.Add(matchedFile.Mid(where));
+            }
+            return true;
+        });
 
     } catch (const wxSQLite3Exception& e) {
         wxUnusedVar(e);
@@ -393,15 +943,15 @@ void TagsStorageSQLite::GetFiles(const wxString& partialName, std::vector<FileEn
     try {
         bool match_path = (!partialName.IsEmpty() && partialName.Last() == wxFileName::GetPathSeparator());
 
-        wxString query;
         wxString tmpName(partialName);
         tmpName.Replace(wxT("_"), wxT("^_"));
-        query << wxT("select * from files where file like '%%") << tmpName << wxT("%%' ESCAPE '^' ")
-              << wxT("order by file");
 
-        wxSQLite3ResultSet res = m_db->ExecuteQuery(query);
-        while(res.NextRow()) {
+        TagsStorageSQLiteQuery query;
+        query.Sql("select * from files where file like ")
+            .Value(wxString() << "%" << tmpName << "%")
+            .Sql(" ESCAPE '^' order by file");
 
+        DoQuery(query, [&](wxSQLite3ResultSet& res) {
             FileEntryPtr fe(new FileEntry());
             fe->SetId(res.GetInt(0));
             fe->SetFile(res.GetString(1));
@@ -422,7 +972,8 @@ void TagsStorageSQLite::GetFiles(const wxString& partialName, std::vector<FileEn
             if(match.StartsWith(lowerCasePartialName)) {
                 files.emplace_back(std::move(fe));
             }
-        }
+            return true;
+        });
     } catch (const wxSQLite3Exception& e) {
         wxUnusedVar(e);
     }
@@ -432,7 +983,7 @@ void TagsStorageSQLite::GetFiles(std::vector<FileEntryPtr>& files)
 {
     try {
         wxString query(wxT("select * from files order by file"));
-        wxSQLite3ResultSet res = m_db->ExecuteQuery(query);
+        wxSQLite3ResultSet res = GetReadDb()->ExecuteQuery(query);
 
         // Pre allocate a reasonable amount of entries
         files.reserve(5000);
@@ -496,79 +1047,99 @@ TagEntry* TagsStorageSQLite::FromSQLite3ResultSet(wxSQLite3ResultSet& rs)
     return entry;
 }
 
-void TagsStorageSQLite::DoFetchTags(const wxString& sql, std::vector<TagEntryPtr>& tags)
+void TagsStorageSQLite::DoQuery(const TagsStorageSQLiteQuery& query,
+                                const std::function<bool(wxSQLite3ResultSet&)>& on_row)
 {
-    if(GetUseCache() && m_cache.Get(sql, tags)) {
-        return;
-    }
-
-    LOG_IF_TRACE { clDEBUG1() << "Fetching from disk:" << sql << clEndl; }
-    tags.reserve(1000);
-
+    LOG_IF_TRACE { clDEBUG1() << "Running SQL:" << query.GetSQL() << clEndl; }
+    wxSQLite3Statement* statement = nullptr;
     try {
-        wxSQLite3ResultSet ex_rs;
-        ex_rs = Query(sql);
-
-        // add results from external database to the workspace database
-        while(ex_rs.NextRow()) {
-            // Construct a TagEntry from the record set
-            TagEntryPtr tag(FromSQLite3ResultSet(ex_rs));
-            // convert the path to be real path
-            tags.push_back(tag);
+        statement = &GetReadDb()->GetCachedStatement(query.GetSQL());
+        query.Bind(*statement);
+        wxSQLite3ResultSet rs = statement->ExecuteQuery();
+        while(rs.NextRow()) {
+            if(!on_row(rs)) {
+                break;
+            }
         }
-        ex_rs.Finalize();
     } catch (const wxSQLite3Exception& e) {
-        LOG_IF_DEBUG
-        {
-            clDEBUG() << "SQLite exception!" << endl;
-            clDEBUG() << e.GetMessage() << endl;
+        clWARNING() << "Query error:" << query.GetSQL() << "." << e.GetMessage() << endl;
+        if(e.GetMessage().Contains("disk I/O error")) {
+            // this also finalizes the cached statements
+            ReOpenDatabase();
+            return;
         }
     }
 
-    LOG_IF_TRACE { clDEBUG1() << "Fetching from disk...done" << tags.size() << "matches found" << clEndl; }
-    if(GetUseCache()) {
-        m_cache.Store(sql, tags);
+    if(statement) {
+        // cached statements are re-used: reset it so it won't keep the read transaction open
+        try {
+            statement->Reset();
+        } catch (const wxSQLite3Exception& e) {
+            wxUnusedVar(e);
+        }
     }
 }
 
-void TagsStorageSQLite::DoFetchTags(const wxString& sql, std::vector<TagEntryPtr>& tags, const wxArrayString& kinds)
+void TagsStorageSQLite::DoFetchTags(const TagsStorageSQLiteQuery& query, std::vector<TagEntryPtr>& tags)
 {
-    if(GetUseCache() && m_cache.Get(sql, kinds, tags))
-        return;
+    wxString cache_key;
+    if(GetUseCache()) {
+        DoSyncCache();
+        cache_key = query.GetCacheKey();
+        if(m_cache.Get(cache_key, tags)) {
+            return;
+        }
+    }
 
-    wxStringSet_t set_kinds;
-    set_kinds.insert(kinds.begin(), kinds.end());
+    LOG_IF_TRACE { clDEBUG1() << "Fetching from disk:" << query.GetSQL() << clEndl; }
     tags.reserve(1000);
 
-    LOG_IF_TRACE { clDEBUG1() << "Fetching from disk:" << sql << endl; }
-    try {
-        wxSQLite3ResultSet ex_rs;
-        ex_rs = Query(sql);
-
-        // add results from external database to the workspace database
-        while(ex_rs.NextRow()) {
-            // check if this kind is acceptable
-            if(set_kinds.count(ex_rs.GetString(4))) {
+    // the results are appended to `tags`, but only the new ones are cached
+    std::vector<TagEntryPtr> results;
+    DoQuery(query, [&](wxSQLite3ResultSet& rs) {
+        // Construct a TagEntry from the record set
+        results.emplace_back(FromSQLite3ResultSet(rs));
+        return true;
+    });
 
-                // Construct a TagEntry from the record set
-                TagEntryPtr tag(FromSQLite3ResultSet(ex_rs));
+    LOG_IF_TRACE { clDEBUG1() << "Fetching from disk...done" << results.size() << "matches found" << clEndl; }
+    tags.insert(tags.end(), results.begin(), results.end());
+    if(GetUseCache()) {
+        m_cache.Store(cache_key, results, query.GetFiles());
+    }
+}
 
-                // convert the path to be real path
-                tags.push_back(tag);
-            }
+void TagsStorageSQLite::DoFetchTags(const TagsStorageSQLiteQuery& query, std::vector<TagEntryPtr>& tags,
+                                    const wxArrayString& kinds)
+{
+    wxString cache_key;
+    if(GetUseCache()) {
+        DoSyncCache();
+        cache_key = query.GetCacheKey();
+        if(m_cache.Get(cache_key, kinds, tags)) {
+            return;
         }
-        ex_rs.Finalize();
+    }
 
-    } catch (const wxSQLite3Exception& e) {
-        LOG_IF_DEBUG
-        {
-            clDEBUG() << e.GetMessage() << endl;
-            clDEBUG() << "SQLite exception!" << endl;
+    wxStringSet_t set_kinds;
+    set_kinds.insert(kinds.begin(), kinds.end());
+    tags.reserve(1000);
+
+    LOG_IF_TRACE { clDEBUG1() << "Fetching from disk:" << query.GetSQL() << endl; }
+    std::vector<TagEntryPtr> results;
+    DoQuery(query, [&](wxSQLite3ResultSet& rs) {
+        // check if this kind is acceptable
+        if(set_kinds.count(rs.GetString(4))) {
+            // Construct a TagEntry from the record set
+            results.emplace_back(FromSQLite3ResultSet(rs));
         }
-    }
-    LOG_IF_TRACE { clDEBUG1() << "Fetching from disk...done" << tags.size() << "matches found" << endl; }
+        return true;
+    });
+
+    LOG_IF_TRACE { clDEBUG1() << "Fetching from disk...done" << results.size() << "matches found" << endl; }
+    tags.insert(tags.end(), results.begin(), results.end());
     if(GetUseCache()) {
-        m_cache.Store(sql, kinds, tags);
+        m_cache.Store(cache_key, kinds, results, query.GetFiles());
     }
 }
 
@@ -578,55 +1149,57 @@ void TagsStorageSQLite::GetTagsByScopeAndName(const wxString& scope, const wxStr
     if(name.IsEmpty())
         return;
 
-    wxString sql;
-    sql << wxT("select * from tags where ");
+    if(m_symbolIndex) {
+        std::vector<wxString> scopes = { (scope.IsEmpty() ? wxString("<global>") : scope) };
+        std::vector<long> ids;
+        m_symbolIndex->FindByName(name, partialNameAllowed, !m_enableCaseInsensitive, &scopes, nullptr,
+                                  GetSingleSearchLimit(), ids);
+        DoFetchTagsByIds(ids, tags);
+        return;
+    }
+
+    TagsStorageSQLiteQuery query;
+    query.Sql("select * from tags where ");
 
     // did we get scope?
     if(scope.IsEmpty() || scope == wxT("<global>")) {
-        sql << wxT("ID IN (select tag_id from global_tags where ");
-        DoAddNamePartToQuery(sql, name, partialNameAllowed, false);
-        sql << wxT(" ) ");
+        query.Sql("ID IN (select tag_id from global_tags where ");
+        DoAddNamePartToQuery(query, name, partialNameAllowed, false);
+        query.Sql(" ) ");
 
     } else {
-        sql << " scope = '" << scope << "' ";
-        DoAddNamePartToQuery(sql, name, partialNameAllowed, true);
+        query.Sql(" scope = ").Value(scope);
+        DoAddNamePartToQuery(query, name, partialNameAllowed, true);
     }
 
-    sql << wxT(" LIMIT ") << this->GetSingleSearchLimit();
+    query.Sql(" LIMIT ").Value(GetSingleSearchLimit());
 
     // get get the tags
-    DoFetchTags(sql, tags);
+    DoFetchTags(query, tags);
 }
 
 void TagsStorageSQLite::GetTagsByScope(const wxString& scope, std::vector<TagEntryPtr>& tags)
 {
-    wxString sql;
-
     // Build the SQL statement
-    sql << wxT("select * from tags where scope='") << scope << wxT("' ORDER BY NAME limit ") << GetSingleSearchLimit();
-
-    DoFetchTags(sql, tags);
+    TagsStorageSQLiteQuery query;
+    query.Sql("select * from tags where scope=").Value(scope).Sql(" ORDER BY NAME limit ").Value(GetSingleSearchLimit());
+    DoFetchTags(query, tags);
 }
 
 void TagsStorageSQLite::GetTagsByKind(const wxArrayString& kinds, const wxString& orderingColumn, int order,
                                       std::vector<TagEntryPtr>& tags)
 {
-    wxString sql;
-    sql << wxT("select * from tags where kind in (");
-    for(size_t i = 0; i < kinds.GetCount(); i++) {
-        sql << wxT("'") << kinds.Item(i) << wxT("',");
-    }
-    sql.RemoveLast();
-    sql << wxT(") ");
-
+    TagsStorageSQLiteQuery query;
+    query.Sql("select * from tags where kind in ").Values(kinds);
     if(orderingColumn.IsEmpty() == false) {
-        sql << wxT("order by ") << orderingColumn;
+        // column names can not be bound
+        query.Sql(" order by ").Sql(orderingColumn);
         switch(order) {
         case ITagsStorage::OrderAsc:
-            sql << wxT(" ASC");
+            query.Sql(" ASC");
             break;
         case ITagsStorage::OrderDesc:
-            sql << wxT(" DESC");
+            query.Sql(" DESC");
             break;
         case ITagsStorage::OrderNone:
         default:
@@ -634,7 +1207,7 @@ void TagsStorageSQLite::GetTagsByKind(const wxArrayString& kinds, const wxString
         }
     }
 
-    DoFetchTags(sql, tags);
+    DoFetchTags(query, tags);
 }
 
 void TagsStorageSQLite::GetTagsByPath(const wxArrayString& path, std::vector<TagEntryPtr>& tags)
@@ -642,25 +1215,19 @@ void TagsStorageSQLite::GetTagsByPath(const wxArrayString& path, std::vector<Tag
     if(path.empty())
         return;
 
-    wxString sql;
-
-    sql << wxT("select * from tags where path IN(");
-    for(size_t i = 0; i < path.GetCount(); i++) {
-        sql << wxT("'") << path.Item(i) << wxT("',");
-    }
-    sql.RemoveLast();
-    sql << wxT(")");
-    DoFetchTags(sql, tags);
+    TagsStorageSQLiteQuery query;
+    query.Sql("select * from tags where path IN ").Values(path);
+    DoFetchTags(query, tags);
 }
 
 void TagsStorageSQLite::GetTagsByNameAndParent(const wxString& name, const wxString& parent,
                                                std::vector<TagEntryPtr>& tags)
 {
-    wxString sql;
-    sql << wxT("select * from tags where name='") << name << wxT("' LIMIT ") << GetSingleSearchLimit();
+    TagsStorageSQLiteQuery query;
+    query.Sql("select * from tags where name=").Value(name).Sql(" LIMIT ").Value(GetSingleSearchLimit());
 
     std::vector<TagEntryPtr> tmpResults;
-    DoFetchTags(sql, tmpResults);
+    DoFetchTags(query, tmpResults);
 
     // Filter by parent
     for(size_t i = 0; i < tmpResults.size(); i++) {
@@ -677,17 +1244,16 @@ void TagsStorageSQLite::GetTagsByKindAndPath(const wxArrayString& kinds, const w
         return;
     }
 
-    wxString sql;
-    sql << wxT("select * from tags where path='") << path << wxT("' LIMIT ") << GetSingleSearchLimit();
-
-    DoFetchTags(sql, tags, kinds);
+    TagsStorageSQLiteQuery query;
+    query.Sql("select * from tags where path=").Value(path).Sql(" LIMIT ").Value(GetSingleSearchLimit());
+    DoFetchTags(query, tags, kinds);
 }
 
 void TagsStorageSQLite::GetTagsByFileAndLine(const wxString& file, int line, std::vector<TagEntryPtr>& tags)
 {
-    wxString sql;
-    sql << wxT("select * from tags where file='") << file << wxT("' and line=") << line << wxT(" ");
-    DoFetchTags(sql, tags);
+    TagsStorageSQLiteQuery query;
+    query.Sql("select * from tags where file=").File(file).Sql(" and line=").Value(line);
+    DoFetchTags(query, tags);
 }
 
 void TagsStorageSQLite::GetTagsByKindAndFile(const wxArrayString& kind, const wxString& fileName,
@@ -697,36 +1263,30 @@ void TagsStorageSQLite::GetTagsByKindAndFile(const wxArrayString& kind, const wx
         return;
     }
 
-    wxString sql;
-    sql << wxT("select * from tags where file='") << fileName << wxT("' and kind in (");
-
-    for(size_t i = 0; i < kind.GetCount(); i++) {
-        sql << wxT("'") << kind.Item(i) << wxT("',");
-    }
-    sql.RemoveLast();
-    sql << wxT(")");
-
+    TagsStorageSQLiteQuery query;
+    query.Sql("select * from tags where file=").File(fileName).Sql(" and kind in ").Values(kind);
     if(orderingColumn.IsEmpty() == false) {
-        sql << wxT("order by ") << orderingColumn;
+        // column names can not be bound
+        query.Sql(" order by ").Sql(orderingColumn);
         switch(order) {
         case ITagsStorage::OrderAsc:
-            sql << wxT(" ASC");
+            query.Sql(" ASC");
             break;
         case ITagsStorage::OrderDesc:
-            sql << wxT(" DESC");
+            query.Sql(" DESC");
             break;
         case ITagsStorage::OrderNone:
         default:
             break;
         }
     }
-    DoFetchTags(sql, tags);
+    DoFetchTags(query, tags);
 }
 
 int TagsStorageSQLite::DeleteFileEntry(const wxString& filename)
 {
     try {
-        wxSQLite3Statement statement = m_db->GetPrepareStatement(wxT("DELETE FROM FILES WHERE FILE=?"));
+        wxSQLite3Statement& statement = m_db->GetCachedStatement(wxT("DELETE FROM FILES WHERE FILE=?"));
         statement.Bind(1, filename);
         statement.ExecuteUpdate();
 
@@ -741,8 +1301,8 @@ int TagsStorageSQLite::DeleteFileEntry(const wxString& filename)
 int TagsStorageSQLite::InsertFileEntry(const wxString& filename, int timestamp)
 {
     try {
-        wxSQLite3Statement statement =
-            m_db->GetPrepareStatement(wxT("INSERT OR REPLACE INTO FILES VALUES(NULL, ?, ?)"));
+        wxSQLite3Statement& statement =
+            m_db->GetCachedStatement(wxT("INSERT OR REPLACE INTO FILES VALUES(NULL, ?, ?)"));
         statement.Bind(1, filename);
         statement.Bind(2, timestamp);
         statement.ExecuteUpdate();
@@ -756,8 +1316,8 @@ int TagsStorageSQLite::InsertFileEntry(const wxString& filename, int timestamp)
 int TagsStorageSQLite::UpdateFileEntry(const wxString& filename, int timestamp)
 {
     try {
-        wxSQLite3Statement statement =
-            m_db->GetPrepareStatement(wxT("UPDATE OR REPLACE FILES SET last_retagged=? WHERE file=?"));
+        wxSQLite3Statement& statement =
+            m_db->GetCachedStatement(wxT("UPDATE OR REPLACE FILES SET last_retagged=? WHERE file=?"));
         statement.Bind(1, timestamp);
         statement.Bind(2, filename);
         statement.ExecuteUpdate();
@@ -774,14 +1334,8 @@ int TagsStorageSQLite::DoInsertTagEntry(const TagEntry& tag)
     if(!tag.IsOk())
         return TagOk;
 
-    // does not matter if we insert or update, the cache must be cleared for any related tags
-    if(GetUseCache()) {
-        ClearCache();
-    }
-
     try {
-        wxSQLite3Statement statement = m_db->GetPrepareStatement(
-            wxT("INSERT OR REPLACE INTO TAGS VALUES (NULL, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)"));
+        wxSQLite3Statement& statement = m_db->GetCachedStatement(BuildInsertTagsSQL(1));
         statement.Bind(1, tag.GetName());
         statement.Bind(2, wxFileName(tag.GetFile()).GetFullPath());
         statement.Bind(3, tag.GetLine());
@@ -806,7 +1360,6 @@ int TagsStorageSQLite::DoInsertTagEntry(const TagEntry& tag)
 
 bool TagsStorageSQLite::IsTypeAndScopeExist(wxString& typeName, wxString& scope)
 {
-    wxString sql;
     wxString strippedName;
     wxString secondScope;
     wxString bestScope;
@@ -822,8 +1375,10 @@ bool TagsStorageSQLite::IsTypeAndScopeExist(wxString& typeName, wxString& scope)
     if(strippedName.IsEmpty())
         return false;
 
-    sql << wxT("select scope,parent from tags where name='") << strippedName
-        << wxT("' and kind in ('class', 'struct', 'typedef') LIMIT 50");
+    TagsStorageSQLiteQuery query;
+    query.Sql("select scope,parent from tags where name=")
+        .Value(strippedName)
+        .Sql(" and kind in ('class', 'struct', 'typedef') LIMIT 50");
     int foundOther(0);
     wxString scopeFounded;
     wxString parentFounded;
@@ -833,29 +1388,29 @@ bool TagsStorageSQLite::IsTypeAndScopeExist(wxString& typeName, wxString& scope)
 
     parent = tmpScope.AfterLast(wxT(':'));
 
-    try {
-        wxSQLite3ResultSet rs = Query(sql);
-        while(rs.NextRow()) {
+    bool exact_match = false;
+    DoQuery(query, [&](wxSQLite3ResultSet& rs) {
+        scopeFounded = rs.GetString(0);
+        parentFounded = rs.GetString(1);
 
-            scopeFounded = rs.GetString(0);
-            parentFounded = rs.GetString(1);
+        if(scopeFounded == tmpScope) {
+            // exact match
+            exact_match = true;
+            return false;
 
-            if(scopeFounded == tmpScope) {
-                // exact match
-                scope = scopeFounded;
-                typeName = strippedName;
-                return true;
+        } else if(parentFounded == parent) {
+            bestScope = scopeFounded;
 
-            } else if(parentFounded == parent) {
-                bestScope = scopeFounded;
-
-            } else {
-                foundOther++;
-            }
+        } else {
+            foundOther++;
         }
+        return true;
+    });
 
-    } catch (const wxSQLite3Exception& e) {
-        wxUnusedVar(e);
+    if(exact_match) {
+        scope = scopeFounded;
+        typeName = strippedName;
+        return true;
     }
 
     // if we reached here, it means we did not find any exact match
@@ -881,12 +1436,12 @@ void TagsStorageSQLite::GetTagsByScopesAndKind(const wxArrayString& scopes, cons
 
     // fetch from the scopes, in-order (i.e. first scope tags and so on)
     for(const wxString& scope : scopes) {
-        wxString sql;
-        sql << "select * from tags where scope = '" << scope << "' ORDER BY NAME";
-        DoAddLimitPartToQuery(sql, tags);
+        TagsStorageSQLiteQuery query;
+        query.Sql("select * from tags where scope = ").Value(scope).Sql(" ORDER BY NAME");
+        DoAddLimitPartToQuery(query, tags);
 
         std::vector<TagEntryPtr> scope_results;
-        DoFetchTags(sql, scope_results, kinds);
+        DoFetchTags(query, scope_results, kinds);
         tags.reserve(tags.size() + scope_results.size());
         tags.insert(tags.end(), scope_results.begin(), scope_results.end());
         if((GetSingleSearchLimit() > 0) && (static_cast<int>(tags.size()) > GetSingleSearchLimit())) {
@@ -900,9 +1455,9 @@ void TagsStorageSQLite::GetTagsByPath(const wxString& path, std::vector<TagEntry
     if(path.empty())
         return;
 
-    wxString sql;
-    sql << wxT("select * from tags where path ='") << path << wxT("' LIMIT ") << limit;
-    DoFetchTags(sql, tags);
+    TagsStorageSQLiteQuery query;
+    query.Sql("select * from tags where path =").Value(path).Sql(" LIMIT ").Value(limit);
+    DoFetchTags(query, tags);
 }
 
 void TagsStorageSQLite::GetTagsByScopeAndName(const wxArrayString& scope, const wxString& name, bool partialNameAllowed,
@@ -924,20 +1479,20 @@ void TagsStorageSQLite::GetTagsByScopeAndName(const wxArrayString& scope, const
         GetTagsByScopeAndName(wxString(wxT("<global>")), name, partialNameAllowed, tags);
     }
 
-    if(scopes.IsEmpty() == false) {
-        wxString sql;
-        sql << wxT("select * from tags where scope in(");
-
-        for(size_t i = 0; i < scopes.GetCount(); i++) {
-            sql << wxT("'") << scopes.Item(i) << wxT("',");
-        }
-        sql.RemoveLast();
-        sql << wxT(") ");
+    if(scopes.IsEmpty() == false && m_symbolIndex) {
+        std::vector<wxString> scopes_vec{ scopes.begin(), scopes.end() };
+        std::vector<long> ids;
+        m_symbolIndex->FindByName(name, partialNameAllowed, !m_enableCaseInsensitive, &scopes_vec, nullptr,
+                                  GetRemainingLimit(tags), ids);
+        DoFetchTagsByIds(ids, tags);
 
-        DoAddNamePartToQuery(sql, name, partialNameAllowed, true);
-        DoAddLimitPartToQuery(sql, tags);
+    } else if(scopes.IsEmpty() == false) {
+        TagsStorageSQLiteQuery query;
+        query.Sql("select * from tags where scope in ").Values(scopes);
+        DoAddNamePartToQuery(query, name, partialNameAllowed, true);
+        DoAddLimitPartToQuery(query, tags);
         // get get the tags
-        DoFetchTags(sql, tags);
+        DoFetchTags(query, tags);
     }
 }
 
@@ -948,32 +1503,28 @@ void TagsStorageSQLite::GetTagsByScopeAndKind(const wxString& scope, const wxArr
         return;
     }
 
-    wxString sql;
-    sql << "select * from tags where scope='" << scope << "' ";
-    if(!filter.empty()) {
-        sql << "and name LIKE '" << filter << "%%' ESCAPE '^' ";
+    if(m_symbolIndex && !filter.empty()) {
+        std::vector<wxString> scopes = { scope };
+        std::vector<wxString> kinds_vec{ kinds.begin(), kinds.end() };
+        std::vector<long> ids;
+        m_symbolIndex->FindByName(filter, true, false, &scopes, &kinds_vec, GetSingleSearchLimit(), ids);
+        DoFetchTagsByIds(ids, tags);
+        return;
     }
 
-    if(!kinds.empty()) {
-        sql << " and KIND IN(";
-        wxString kinds_buffer;
-        for(const wxString& kind : kinds) {
-            if(!kinds_buffer.empty()) {
-                kinds_buffer << ",";
-            }
-            kinds_buffer << "'" << kind << "'";
-        }
-        kinds_buffer << ") ";
-        sql << kinds_buffer;
+    TagsStorageSQLiteQuery query;
+    query.Sql("select * from tags where scope=").Value(scope);
+    if(!filter.empty()) {
+        query.Sql(" and name LIKE ").Value(filter + "%").Sql(" ESCAPE '^' ");
     }
 
-    sql << " LIMIT " << GetSingleSearchLimit();
-    DoFetchTags(sql, tags);
+    query.Sql(" and KIND IN ").Values(kinds);
+    query.Sql(" LIMIT ").Value(GetSingleSearchLimit());
+    DoFetchTags(query, tags);
 }
 
 bool TagsStorageSQLite::IsTypeAndScopeExistLimitOne(const wxString& typeName, const wxString& scope)
 {
-    wxString sql;
     wxString path;
 
     // Build the path
@@ -981,102 +1532,271 @@ bool TagsStorageSQLite::IsTypeAndScopeExistLimitOne(const wxString& typeName, co
         path << scope << wxT("::");
 
     path << typeName;
-    sql << wxT("select ID from tags where path='") << path
-        << wxT("' and kind in ('class', 'struct', 'typedef') LIMIT 1");
+    TagsStorageSQLiteQuery query;
+    query.Sql("select ID from tags where path=").Value(path).Sql(" and kind in ('class', 'struct', 'typedef') LIMIT 1");
 
-    try {
-        wxSQLite3ResultSet rs = Query(sql);
-        if(rs.NextRow()) {
-            return true;
-        }
-
-    } catch (const wxSQLite3Exception& e) {
-        wxUnusedVar(e);
-    }
-    return false;
+    bool found = false;
+    DoQuery(query, [&](wxSQLite3ResultSet& rs) {
+        wxUnusedVar(rs);
+        found = true;
+        return false;
+    });
+    return found;
 }
 
 void TagsStorageSQLite::GetDereferenceOperator(const wxString& scope, std::vector<TagEntryPtr>& tags)
 {
-    wxString sql;
-    sql << wxT("select * from tags where scope ='") << scope << wxT("' and name like 'operator%->%' LIMIT 1");
-    DoFetchTags(sql, tags);
+    TagsStorageSQLiteQuery query;
+    query.Sql("select * from tags where scope =").Value(scope).Sql(" and name like 'operator%->%' LIMIT 1");
+    DoFetchTags(query, tags);
 }
 
 void TagsStorageSQLite::GetSubscriptOperator(const wxString& scope, std::vector<TagEntryPtr>& tags)
 {
-    wxString sql;
-    sql << wxT("select * from tags where scope ='") << scope << wxT("' and name like 'operator%[%]%' LIMIT 1");
-    DoFetchTags(sql, tags);
+    TagsStorageSQLiteQuery query;
+    query.Sql("select * from tags where scope =").Value(scope).Sql(" and name like 'operator%[%]%' LIMIT 1");
+    DoFetchTags(query, tags);
 }
 
 //---------------------------------------------------------------------
-//-----------------------------TagsStorageSQLiteCache -----------------
+//-----------------------------TagsStorageSQLiteQuery -----------------
 //---------------------------------------------------------------------
 
-TagsStorageSQLiteCache::~TagsStorageSQLiteCache() { m_cache.clear(); }
+TagsStorageSQLiteQuery& TagsStorageSQLiteQuery::Value(const wxString& value)
+{
+    m_sql << "?";
+    Param param;
+    param.str = value;
+    m_params.push_back(param);
+    return *this;
+}
 
-bool TagsStorageSQLiteCache::Get(const wxString& sql, std::vector<TagEntryPtr>& tags) { return DoGet(sql, tags); }
+TagsStorageSQLiteQuery& TagsStorageSQLiteQuery::Value(int value)
+{
+    m_sql << "?";
+    Param param;
+    param.is_int = true;
+    param.num = value;
+    m_params.push_back(param);
+    return *this;
+}
 
-bool TagsStorageSQLiteCache::Get(const wxString& sql, const wxArrayString& kind, std::vector<TagEntryPtr>& tags)
+TagsStorageSQLiteQuery& TagsStorageSQLiteQuery::File(const wxString& file)
 {
-    wxString key;
-    key << sql;
-    for(size_t i = 0; i < kind.GetCount(); i++) {
-        key << wxT("@") << kind.Item(i);
+    m_files.insert(file);
+    return Value(file);
+}
+
+TagsStorageSQLiteQuery& TagsStorageSQLiteQuery::Values(const wxArrayString& values)
+{
+    return Values(std::vector<wxString>{ values.begin(), values.end() });
+}
+
+TagsStorageSQLiteQuery& TagsStorageSQLiteQuery::Values(const std::vector<wxString>& values)
+{
+    m_sql << "(";
+    for(size_t i = 0; i < values.size(); ++i) {
+        if(i > 0) {
+            m_sql << ",";
+        }
+        Value(values[i]);
     }
+    m_sql << ")";
+    return *this;
+}
 
-    return DoGet(key, tags);
+wxString TagsStorageSQLiteQuery::GetCacheKey() const
+{
+    // use a separator that can not appear in the SQL or in the values
+    wxString key = m_sql;
+    for(const auto& param : m_params) {
+        key << '\x01';
+        if(param.is_int) {
+            key << param.num;
+        } else {
+            key << param.str;
+        }
+    }
+    return key;
 }
 
-void TagsStorageSQLiteCache::Store(const wxString& sql, const std::vector<TagEntryPtr>& tags) { DoStore(sql, tags); }
+void TagsStorageSQLiteQuery::Bind(wxSQLite3Statement& statement) const
+{
+    for(size_t i = 0; i < m_params.size(); ++i) {
+        if(m_params[i].is_int) {
+            statement.Bind((int)i + 1, m_params[i].num);
+        } else {
+            statement.Bind((int)i + 1, m_params[i].str);
+        }
+    }
+}
+
+//---------------------------------------------------------------------
+//-----------------------------TagsStorageSQLiteCache -----------------
+//---------------------------------------------------------------------
 
-void TagsStorageSQLiteCache::Clear() { m_cache.clear(); }
+TagsStorageSQLiteCache::~TagsStorageSQLiteCache() { Clear(); }
 
-void TagsStorageSQLiteCache::Store(const wxString& sql, const wxArrayString& kind, const std::vector<TagEntryPtr>& tags)
+namespace
+{
+wxString make_kinds_key(const wxString& sql, const wxArrayString& kind)
 {
     wxString key;
     key << sql;
     for(size_t i = 0; i < kind.GetCount(); i++) {
         key << wxT("@") << kind.Item(i);
     }
-    DoStore(key, tags);
+    return key;
+}
+
+/// a rough estimation of the memory used by a tag
+size_t estimate_tag_bytes(const TagEntry& tag)
+{
+    size_t chars = tag.GetName().length() + tag.GetFile().length() + tag.GetPath().length() +
+                   tag.GetPattern().length() + tag.GetSignature().length() + tag.GetScope().length() +
+                   tag.GetParent().length();
+    return sizeof(TagEntry) + chars * sizeof(wxChar);
+}
+} // namespace
+
+bool TagsStorageSQLiteCache::Get(const wxString& sql, std::vector<TagEntryPtr>& tags) { return DoGet(sql, tags); }
+
+bool TagsStorageSQLiteCache::Get(const wxString& sql, const wxArrayString& kind, std::vector<TagEntryPtr>& tags)
+{
+    return DoGet(make_kinds_key(sql, kind), tags);
+}
+
+void TagsStorageSQLiteCache::Store(const wxString& sql, const std::vector<TagEntryPtr>& tags,
+                                   const wxStringSet_t& files)
+{
+    DoStore(sql, tags, files);
+}
+
+void TagsStorageSQLiteCache::Clear()
+{
+    m_cache.clear();
+    m_fileEntries.clear();
+    m_lru.clear();
+    m_stats.entries = 0;
+    m_stats.bytes = 0;
+}
+
+void TagsStorageSQLiteCache::Store(const wxString& sql, const wxArrayString& kind, const std::vector<TagEntryPtr>& tags,
+                                   const wxStringSet_t& files)
+{
+    DoStore(make_kinds_key(sql, kind), tags, files);
 }
 
 bool TagsStorageSQLiteCache::DoGet(const wxString& key, std::vector<TagEntryPtr>& tags)
 {
     auto iter = m_cache.find(key);
-    if(iter != m_cache.end()) {
-        // Append the results to the output tags
-        tags.reserve(tags.size() + iter->second.size());
-        tags.insert(tags.end(), iter->second.begin(), iter->second.end());
-        return true;
+    if(iter == m_cache.end()) {
+        m_stats.misses++;
+        return false;
     }
-    return false;
+
+    // move the entry to the front of the LRU list
+    m_lru.splice(m_lru.begin(), m_lru, iter->second);
+    m_stats.hits++;
+
+    // Append the results to the output tags
+    const auto& cached_tags = iter->second->tags;
+    tags.reserve(tags.size() + cached_tags.size());
+    tags.insert(tags.end(), cached_tags.begin(), cached_tags.end());
+    return true;
 }
 
-void TagsStorageSQLiteCache::DoStore(const wxString& key, const std::vector<TagEntryPtr>& tags)
+void TagsStorageSQLiteCache::DoStore(const wxString& key, const std::vector<TagEntryPtr>& tags,
+                                     const wxStringSet_t& files)
 {
-    if(m_cache.count(key)) {
-        m_cache.erase(key);
+    auto iter = m_cache.find(key);
+    if(iter != m_cache.end()) {
+        DoErase(iter->second);
     }
 
-    // avoid storing entries with __anon entries
-    // since these tags will change their anonymous space
-    // each time we save the file
-    bool can_cache = true;
-    for(auto tag : tags) {
-        if(tag->GetScope().StartsWith("__anon")) {
-            can_cache = false;
-            break;
+    // tags with __anon scopes are renamed every time their file is re-indexed: since the entry depends
+    // on their file, it will be invalidated when this happens
+    wxStringSet_t entry_files = files;
+    Entry entry;
+    entry.key = key;
+    entry.tags = tags;
+    entry.bytes = sizeof(Entry) + key.length() * sizeof(wxChar) + tags.size() * sizeof(TagEntryPtr);
+    for(const auto& tag : tags) {
+        entry.bytes += estimate_tag_bytes(*tag);
+        entry_files.insert(tag->GetFile());
+    }
+
+    if(entry.bytes > m_maxBytes) {
+        // too big to cache
+        return;
+    }
+
+    entry.files.reserve(entry_files.size());
+    for(const wxString& file : entry_files) {
+        m_fileEntries[file].insert(key);
+        entry.files.push_back(file);
+    }
+
+    m_stats.bytes += entry.bytes;
+    m_stats.entries++;
+    m_lru.push_front(std::move(entry));
+    m_cache.insert({ key, m_lru.begin() });
+    DoShrink();
+}
+
+void TagsStorageSQLiteCache::DoErase(EntryIter iter)
+{
+    for(const wxString& file : iter->files) {
+        auto where = m_fileEntries.find(file);
+        if(where == m_fileEntries.end()) {
+            continue;
+        }
+        where->second.erase(iter->key);
+        if(where->second.empty()) {
+            m_fileEntries.erase(where);
         }
     }
 
-    if(can_cache) {
-        m_cache.insert({ key, tags });
+    m_stats.bytes -= iter->bytes;
+    m_stats.entries--;
+    m_cache.erase(iter->key);
+    m_lru.erase(iter);
+}
+
+void TagsStorageSQLiteCache::DoShrink()
+{
+    while(m_stats.bytes > m_maxBytes && !m_lru.empty()) {
+        DoErase(std::prev(m_lru.end()));
+        m_stats.evictions++;
     }
 }
 
+void TagsStorageSQLiteCache::InvalidateFile(const wxString& file)
+{
+    auto where = m_fileEntries.find(file);
+    if(where == m_fileEntries.end()) {
+        return;
+    }
+
+    // DoErase() modifies the set, so work on a copy
+    wxStringSet_t keys;
+    keys.swap(where->second);
+    for(const wxString& key : keys) {
+        auto iter = m_cache.find(key);
+        if(iter != m_cache.end()) {
+            DoErase(iter->second);
+            m_stats.invalidations++;
+        }
+    }
+    m_fileEntries.erase(file);
+}
+
+void TagsStorageSQLiteCache::SetMaxBytes(size_t max_bytes)
+{
+    m_maxBytes = max_bytes;
+    DoShrink();
+}
+
 void TagsStorageSQLite::ClearCache()
 {
     // clear the cache
@@ -1086,18 +1806,12 @@ void TagsStorageSQLite::ClearCache()
 PPToken TagsStorageSQLite::GetMacro(const wxString& name)
 {
     PPToken token;
-    try {
-        wxString sql;
-        sql << wxT("select * from MACROS where name = '") << name << wxT("'");
-        wxSQLite3ResultSet res = m_db->ExecuteQuery(sql);
-        if(res.NextRow()) {
-            PPTokenFromSQlite3ResultSet(res, token);
-            return token;
-        }
-    } catch (const wxSQLite3Exception& exc) {
-        wxUnusedVar(exc);
-    }
-
+    TagsStorageSQLiteQuery query;
+    query.Sql("select * from MACROS where name = ").Value(name);
+    DoQuery(query, [&](wxSQLite3ResultSet& res) {
+        PPTokenFromSQlite3ResultSet(res, token);
+        return false;
+    });
     return token;
 }
 
@@ -1105,36 +1819,40 @@ void TagsStorageSQLite::SetUseCache(bool useCache) { ITagsStorage::SetUseCache(u
 
 void TagsStorageSQLite::GetTagsByName(const wxString& prefix, std::vector<TagEntryPtr>& tags, bool exactMatch)
 {
-    try {
-        if(prefix.IsEmpty())
-            return;
-
-        wxString sql;
-        sql << wxT("select * from tags where ");
-        DoAddNamePartToQuery(sql, prefix, !exactMatch, false);
-        DoAddLimitPartToQuery(sql, tags);
-        DoFetchTags(sql, tags);
+    if(prefix.IsEmpty())
+        return;
 
-    } catch (const wxSQLite3Exception& e) {
-        clDEBUG() << e.GetMessage() << endl;
+    if(m_symbolIndex) {
+        std::vector<long> ids;
+        m_symbolIndex->FindByName(prefix, !exactMatch, !m_enableCaseInsensitive, nullptr, nullptr,
+                                  GetRemainingLimit(tags), ids);
+        DoFetchTagsByIds(ids, tags);
+        return;
     }
+
+    TagsStorageSQLiteQuery query;
+    query.Sql("select * from tags where ");
+    DoAddNamePartToQuery(query, prefix, !exactMatch, false);
+    DoAddLimitPartToQuery(query, tags);
+    DoFetchTags(query, tags);
 }
 
-void TagsStorageSQLite::DoAddNamePartToQuery(wxString& sql, const wxString& name, bool partial, bool prependAnd)
+void TagsStorageSQLite::DoAddNamePartToQuery(TagsStorageSQLiteQuery& query, const wxString& name, bool partial,
+                                             bool prependAnd)
 {
     if(name.empty())
         return;
     if(prependAnd) {
-        sql << wxT(" AND ");
+        query.Sql(" AND ");
     }
 
     if(m_enableCaseInsensitive) {
         wxString tmpName(name);
         tmpName.Replace(wxT("_"), wxT("^_"));
         if(partial) {
-            sql << wxT(" name LIKE '") << tmpName << wxT("%%' ESCAPE '^' ");
+            query.Sql(" name LIKE ").Value(tmpName + "%").Sql(" ESCAPE '^' ");
         } else {
-            sql << wxT(" name ='") << name << wxT("' ");
+            query.Sql(" name =").Value(name).Sql(" ");
         }
     } else {
         // Don't use LIKE
@@ -1146,63 +1864,48 @@ void TagsStorageSQLite::DoAddNamePartToQuery(wxString& sql, const wxString& name
 
         // add the name condition
         if(partial) {
-            sql << wxT(" name >= '") << from << wxT("' AND  name < '") << until << wxT("'");
+            query.Sql(" name >= ").Value(from).Sql(" AND  name < ").Value(until);
         } else {
-            sql << wxT(" name ='") << name << wxT("' ");
+            query.Sql(" name =").Value(name).Sql(" ");
         }
     }
 }
 
-void TagsStorageSQLite::DoAddLimitPartToQuery(wxString& sql, const std::vector<TagEntryPtr>& tags)
+void TagsStorageSQLite::DoAddLimitPartToQuery(TagsStorageSQLiteQuery& query, const std::vector<TagEntryPtr>& tags)
 {
-    if(tags.size() >= (size_t)GetSingleSearchLimit()) {
-        sql << wxT(" LIMIT 1 ");
-    } else {
-        sql << wxT(" LIMIT ") << (size_t)GetSingleSearchLimit() - tags.size();
-    }
+    query.Sql(" LIMIT ").Value((int)GetRemainingLimit(tags));
 }
 
 TagEntryPtr TagsStorageSQLite::GetTagsByNameLimitOne(const wxString& name)
 {
-    try {
-        if(name.IsEmpty())
-            return NULL;
-
-        std::vector<TagEntryPtr> tags;
-        wxString sql;
-        sql << wxT("select * from tags where ");
-        DoAddNamePartToQuery(sql, name, false, false);
-        sql << wxT(" LIMIT 1 ");
+    if(name.IsEmpty())
+        return NULL;
 
-        DoFetchTags(sql, tags);
-        if(tags.size() == 1)
-            return tags.at(0);
-        else
-            return NULL;
+    std::vector<TagEntryPtr> tags;
+    TagsStorageSQLiteQuery query;
+    query.Sql("select * from tags where ");
+    DoAddNamePartToQuery(query, name, false, false);
+    query.Sql(" LIMIT 1 ");
 
-    } catch (const wxSQLite3Exception& e) {
-        clDEBUG() << e.GetMessage() << endl;
-    }
-    return NULL;
+    DoFetchTags(query, tags);
+    if(tags.size() == 1)
+        return tags.at(0);
+    else
+        return NULL;
 }
 
 void TagsStorageSQLite::GetTagsByPartName(const wxString& partname, std::vector<TagEntryPtr>& tags)
 {
-    try {
-        if(partname.IsEmpty())
-            return;
-
-        wxString tmpName(partname);
-        tmpName.Replace(wxT("_"), wxT("^_"));
+    if(partname.IsEmpty())
+        return;
 
-        wxString sql;
-        sql << wxT("select * from tags where name like '%%") << tmpName << wxT("%%' ESCAPE '^' ");
-        DoAddLimitPartToQuery(sql, tags);
-        DoFetchTags(sql, tags);
+    wxString tmpName(partname);
+    tmpName.Replace(wxT("_"), wxT("^_"));
 
-    } catch (const wxSQLite3Exception& e) {
-        clDEBUG() << e.GetMessage() << endl;
-    }
+    TagsStorageSQLiteQuery query;
+    query.Sql("select * from tags where name like ").Value("%" + tmpName + "%").Sql(" ESCAPE '^' ");
+    DoAddLimitPartToQuery(query, tags);
+    DoFetchTags(query, tags);
 }
 
 const wxString& TagsStorageSQLite::GetVersion() const
@@ -1213,26 +1916,30 @@ const wxString& TagsStorageSQLite::GetVersion() const
 
 void TagsStorageSQLite::GetTagsByPartName(const wxArrayString& parts, std::vector<TagEntryPtr>& tags)
 {
-    wxString sql;
-    try {
-        if(parts.IsEmpty()) {
-            return;
-        }
-
-        wxString filterQuery = "where ";
-        for(size_t i = 0; i < parts.size(); ++i) {
-            wxString tmpName = parts.Item(i);
-            tmpName.Replace(wxT("_"), wxT("^_"));
-            filterQuery << "path like '%%" << tmpName << "%%' " << ((i == (parts.size() - 1)) ? "" : "AND ");
-        }
+    if(parts.IsEmpty()) {
+        return;
+    }
 
-        sql << "select * from tags " << filterQuery << " ESCAPE '^' ";
-        DoAddLimitPartToQuery(sql, tags);
-        DoFetchTags(sql, tags);
+    if(m_symbolIndex) {
+        std::vector<long> ids;
+        m_symbolIndex->FindByPathParts(parts, GetRemainingLimit(tags), ids);
+        DoFetchTagsByIds(ids, tags);
+        return;
+    }
 
-    } catch (const wxSQLite3Exception& e) {
-        clWARNING() << sql << ":" << e.GetMessage() << clEndl;
+    TagsStorageSQLiteQuery query;
+    query.Sql("select * from tags where ");
+    for(size_t i = 0; i < parts.size(); ++i) {
+        wxString tmpName = parts.Item(i);
+        tmpName.Replace(wxT("_"), wxT("^_"));
+        query.Sql("path like ").Value("%" + tmpName + "%").Sql(" ESCAPE '^' ");
+        if(i != (parts.size() - 1)) {
+            query.Sql("AND ");
+        }
     }
+
+    DoAddLimitPartToQuery(query, tags);
+    DoFetchTags(query, tags);
 }
 
 void TagsStorageSQLite::ReOpenDatabase()
@@ -1245,20 +1952,13 @@ void TagsStorageSQLite::ReOpenDatabase()
     // Close database first
     clDEBUG() << "Closing database first";
     try {
-        if(m_db) {
-            m_db->Close();
-            delete m_db;
-            m_db = nullptr;
-        }
+        DoClose();
     } catch (...) {
     }
 
     clDEBUG() << "Open is called for file:" << m_fileName;
     try {
-        // First time we open the db
-        m_db->Open(m_fileName.GetFullPath());
-        m_db->SetBusyTimeout(10);
-        CreateSchema();
+        DoOpen(m_fileName);
     } catch (const wxSQLite3Exception& e) {
         clWARNING() << "Failed to reopen file:" << m_fileName.GetFullPath() << "." << e.GetMessage();
     }
@@ -1271,22 +1971,14 @@ void TagsStorageSQLite::GetTagsByPathAndKind(const wxString& path, std::vector<T
     if(path.empty())
         return;
 
-    wxString sql;
-
-    sql << "select * from tags where path='" << path << "'";
+    TagsStorageSQLiteQuery query;
+    query.Sql("select * from tags where path=").Value(path);
     if(!kinds.empty()) {
-        sql << " and kind in (";
-        for(const wxString& kind : kinds) {
-            sql << "'" << kind << "',";
-        }
-        sql.RemoveLast();
-        sql << ")";
+        query.Sql(" and kind in ").Values(kinds);
     }
     // to avoid any kind of specialization, sort the entries by DBid
-    sql << " order by ID asc";
-    sql << " limit " << limit;
-    LOG_IF_TRACE { clDEBUG1() << "Running SQL:" << sql << endl; }
-    DoFetchTags(sql, tags);
+    query.Sql(" order by ID asc limit ").Value(limit);
+    DoFetchTags(query, tags);
 }
 
 TagEntryPtr TagsStorageSQLite::GetScope(const wxString& filename, int line_number)
@@ -1294,13 +1986,15 @@ TagEntryPtr TagsStorageSQLite::GetScope(const wxString& filename, int line_numbe
     if(filename.empty() || line_number == wxNOT_FOUND)
         return nullptr;
 
-    wxString sql;
-    sql << "select * from tags where file='" << filename << "' and line <= " << line_number
-        << " and name NOT LIKE '__anon%' and KIND IN ('function', 'class', 'struct', 'namespace') order by line desc "
-           "limit 1";
-    LOG_IF_TRACE { clDEBUG1() << "Running SQL:" << sql << endl; }
+    TagsStorageSQLiteQuery query;
+    query.Sql("select * from tags where file=")
+        .File(filename)
+        .Sql(" and line <= ")
+        .Value(line_number)
+        .Sql(" and name NOT LIKE '__anon%' and KIND IN ('function', 'class', 'struct', 'namespace') order by line desc "
+             "limit 1");
     std::vector<TagEntryPtr> tags;
-    DoFetchTags(sql, tags);
+    DoFetchTags(query, tags);
 
     if(tags.size() == 1) {
         return tags[0];
@@ -1315,27 +2009,26 @@ size_t TagsStorageSQLite::GetFileScopedTags(const wxString& filepath, const wxSt
         return 0;
 
     // get anonymous tags first
-    wxString sql;
     std::vector<TagEntryPtr> tags_1;
     std::vector<TagEntryPtr> tags_2;
-    sql << "select * from tags where file='" << filepath << "' and scope like '__anon%'";
+    TagsStorageSQLiteQuery query_1;
+    query_1.Sql("select * from tags where file=").File(filepath).Sql(" and scope like '__anon%'");
     if(!name.empty()) {
-        sql << " and name like '" << name << "%'";
+        query_1.Sql(" and name like ").Value(name + "%");
     }
-    LOG_IF_TRACE { clDEBUG1() << "Running SQL:" << sql << endl; }
     tags_1.reserve(100);
-    DoFetchTags(sql, tags_1, kinds);
+    DoFetchTags(query_1, tags_1, kinds);
 
     // get static members
-    sql.Clear();
-    sql << "select * from tags where file='" << filepath
-        << "' and kind in ('member','variable','class','struct','enum')";
+    TagsStorageSQLiteQuery query_2;
+    query_2.Sql("select * from tags where file=")
+        .File(filepath)
+        .Sql(" and kind in ('member','variable','class','struct','enum')");
     if(!name.empty()) {
-        sql << " and name like '" << name << "%'";
+        query_2.Sql(" and name like ").Value(name + "%");
     }
-    LOG_IF_TRACE { clDEBUG1() << "Running SQL:" << sql << endl; }
     tags_2.reserve(100);
-    DoFetchTags(sql, tags_2);
+    DoFetchTags(query_2, tags_2);
 
     // filter duplicate
     tags.reserve(tags_2.size() + tags_1.size());
@@ -1362,17 +2055,17 @@ size_t TagsStorageSQLite::GetFileScopedTags(const wxString& filepath, const wxSt
 
 size_t TagsStorageSQLite::GetParameters(const wxString& function_path, std::vector<TagEntryPtr>& tags)
 {
-    wxString sql;
-    sql << "select * from tags where kind = 'parameter' and scope = '" << function_path << "' order by ID asc";
-    DoFetchTags(sql, tags);
+    TagsStorageSQLiteQuery query;
+    query.Sql("select * from tags where kind = 'parameter' and scope = ").Value(function_path).Sql(" order by ID asc");
+    DoFetchTags(query, tags);
     return tags.size();
 }
 
 size_t TagsStorageSQLite::GetLambdas(const wxString& parent_function, std::vector<TagEntryPtr>& tags)
 {
-    wxString sql;
     // assuming `parent_function` is a function, this will return all the lambda children
-    sql << "select * from tags where kind = 'function' and scope = '" << parent_function << "' order by ID asc";
-    DoFetchTags(sql, tags);
+    TagsStorageSQLiteQuery query;
+    query.Sql("select * from tags where kind = 'function' and scope = ").Value(parent_function).Sql(" order by ID asc");
+    DoFetchTags(query, tags);
     return tags.size();
 }
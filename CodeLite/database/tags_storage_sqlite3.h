@@ -30,10 +30,16 @@
 #include "fileentry.h"
 #include "istorage.h"
 #include "tag_tree.h"
+#include "tags_symbol_index.h"
 #include "wxStringHash.h"
 
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
 #include <unordered_map>
 #include <wx/filename.h>
+#include <wx/thread.h>
 #include <wx/wxsqlite3.h>
 
 /**
@@ -91,13 +97,92 @@
  * @ingroup CodeLite
  */
 
-class TagsStorageSQLiteCache
+/**
+ * @class TagsStorageSQLiteQuery
+ * @brief a parameterized SQL query. Values are never concatenated into the SQL text, they are
+ * added as `?` placeholders and bound when the query is executed. This way, the SQL text only describes
+ * the "shape" of the query and its prepared statement can be cached and re-used by SQLite
+ */
+class WXDLLIMPEXP_CL TagsStorageSQLiteQuery
 {
-    std::unordered_map<wxString, std::vector<TagEntryPtr>> m_cache;
+    struct Param {
+        bool is_int = false;
+        wxString str;
+        int num = 0;
+    };
+    wxString m_sql;
+    std::vector<Param> m_params;
+    wxStringSet_t m_files;
+
+public:
+    TagsStorageSQLiteQuery() = default;
+    TagsStorageSQLiteQuery(const wxString& sql)
+        : m_sql(sql)
+    {
+    }
+
+    /// append raw SQL text. Must not contain any value
+    TagsStorageSQLiteQuery& Sql(const wxString& sql)
+    {
+        m_sql << sql;
+        return *this;
+    }
+    /// append a `?` placeholder and bind it to `value`
+    TagsStorageSQLiteQuery& Value(const wxString& value);
+    TagsStorageSQLiteQuery& Value(int value);
+    /// append a list of placeholders, e.g. "(?,?,?)" and bind them to `values`
+    TagsStorageSQLiteQuery& Values(const wxArrayString& values);
+    TagsStorageSQLiteQuery& Values(const std::vector<wxString>& values);
+    /// same as `Value(file)`, but also marks the results of this query as depending on `file`
+    /// (re-indexing `file` invalidates the cached results, even when they are empty)
+    TagsStorageSQLiteQuery& File(const wxString& file);
+
+    const wxString& GetSQL() const { return m_sql; }
+    const wxStringSet_t& GetFiles() const { return m_files; }
+    /// return a key that identifies both the query shape and its values
+    wxString GetCacheKey() const;
+    /// bind the values to a statement prepared from `GetSQL()`
+    void Bind(wxSQLite3Statement& statement) const;
+};
+
+/**
+ * @class TagsStorageSQLiteCache
+ * @brief query results cache. An LRU bounded by the (estimated) number of bytes it holds.
+ * Every entry records the files its tags came from, so re-indexing a file only invalidates the entries
+ * that touch it
+ */
+class WXDLLIMPEXP_CL TagsStorageSQLiteCache
+{
+public:
+    struct Stats {
+        size_t hits = 0;
+        size_t misses = 0;
+        size_t evictions = 0;     // entries removed to stay within the size limit
+        size_t invalidations = 0; // entries removed because a file they depend on was re-indexed
+        size_t entries = 0;
+        size_t bytes = 0;
+    };
+
+private:
+    struct Entry {
+        wxString key;
+        std::vector<TagEntryPtr> tags;
+        std::vector<wxString> files;
+        size_t bytes = 0;
+    };
+    typedef std::list<Entry>::iterator EntryIter;
+
+    std::list<Entry> m_lru; // most recently used first
+    std::unordered_map<wxString, EntryIter> m_cache;
+    std::unordered_map<wxString, wxStringSet_t> m_fileEntries; // file -> keys of the entries depending on it
+    size_t m_maxBytes = 64 * 1024 * 1024;
+    Stats m_stats;
 
 protected:
     bool DoGet(const wxString& key, std::vector<TagEntryPtr>& tags);
-    void DoStore(const wxString& key, const std::vector<TagEntryPtr>& tags);
+    void DoStore(const wxString& key, const std::vector<TagEntryPtr>& tags, const wxStringSet_t& files);
+    void DoErase(EntryIter iter);
+    void DoShrink();
 
 public:
     TagsStorageSQLiteCache() = default;
@@ -105,9 +190,22 @@ public:
 
     bool Get(const wxString& sql, std::vector<TagEntryPtr>& tags);
     bool Get(const wxString& sql, const wxArrayString& kind, std::vector<TagEntryPtr>& tags);
-    void Store(const wxString& sql, const std::vector<TagEntryPtr>& tags);
-    void Store(const wxString& sql, const wxArrayString& kind, const std::vector<TagEntryPtr>& tags);
+    /**
+     * @brief cache `tags` as the result of `sql`. The entry depends on the files of `tags` and on `files`
+     */
+    void Store(const wxString& sql, const std::vector<TagEntryPtr>& tags, const wxStringSet_t& files = {});
+    void Store(const wxString& sql, const wxArrayString& kind, const std::vector<TagEntryPtr>& tags,
+               const wxStringSet_t& files = {});
+    /**
+     * @brief remove all the entries depending on `file`
+     */
+    void InvalidateFile(const wxString& file);
     void Clear();
+    bool IsEmpty() const { return m_cache.empty(); }
+
+    void SetMaxBytes(size_t max_bytes);
+    size_t GetMaxBytes() const { return m_maxBytes; }
+    const Stats& GetStats() const { return m_stats; }
 };
 
 class WXDLLIMPEXP_CL clSqliteDB : public wxSQLite3Database
@@ -122,19 +220,92 @@ public:
 
     void Close()
     {
+        // the statements must be finalized before the database is closed
+        m_statements.clear();
         if(IsOpen())
             wxSQLite3Database::Close();
-
-        m_statements.clear();
     }
 
     wxSQLite3Statement GetPrepareStatement(const wxString& sql) { return wxSQLite3Database::PrepareStatement(sql); }
+
+    /**
+     * @brief return a prepared statement for `sql` from the statements cache. The statement is prepared on the first
+     * call and re-used afterwards (its bindings are cleared before it is returned).
+     * Note: the returned statement is owned by the cache, do not copy it (copying a wxSQLite3Statement transfers its
+     * ownership)
+     */
+    wxSQLite3Statement& GetCachedStatement(const wxString& sql)
+    {
+        auto where = m_statements.find(sql);
+        if(where == m_statements.end()) {
+            where = m_statements.insert({ sql, wxSQLite3Statement() }).first;
+            where->second = wxSQLite3Database::PrepareStatement(sql);
+        } else {
+            where->second.Reset();
+            where->second.ClearBindings();
+        }
+        return where->second;
+    }
+};
+
+/**
+ * @class clSqliteReadPool
+ * @brief a pool of read-only connections to a database, one connection per thread (a wxSQLite3Database
+ * can only be used by the thread that created it). When the database is in WAL mode, readers using these
+ * connections never wait for a writer that holds an open transaction on another connection
+ */
+class WXDLLIMPEXP_CL clSqliteReadPool
+{
+public:
+    /// the connections, shared with the threads that use them: a thread closes its connection when it exits
+    struct Connections {
+        std::mutex mutex;
+        std::unordered_map<wxThreadIdType, std::unique_ptr<clSqliteDB>> by_thread;
+    };
+
+private:
+    wxString m_path;
+    int m_busyTimeout = 0;
+    std::shared_ptr<Connections> m_connections;
+
+public:
+    clSqliteReadPool(const wxString& path, int busy_timeout);
+    ~clSqliteReadPool();
+
+    /**
+     * @brief return the read connection for the calling thread, opening it if needed.
+     * Return nullptr on error
+     */
+    clSqliteDB* Get();
+
+    /**
+     * @brief close all the connections
+     */
+    void Close();
+
+    /**
+     * @brief the number of open connections
+     */
+    size_t GetCount() const;
 };
 
+struct TagsCacheInvalidationLog;
 class WXDLLIMPEXP_CL TagsStorageSQLite : public ITagsStorage
 {
     clSqliteDB* m_db;
     TagsStorageSQLiteCache m_cache;
+    std::unique_ptr<clSqliteReadPool> m_readPool;
+    TagsSymbolIndex::ptr_t m_symbolIndex;
+    // the cache invalidation events of the open database, shared by all the instances that open it
+    std::shared_ptr<TagsCacheInvalidationLog> m_invalidationLog;
+    uint64_t m_cacheSeq = 0;
+
+    // the files changed by the current transaction. The symbol index and the other instances' caches are updated
+    // only once the transaction commits: otherwise they could hold rows that were rolled back, or a reader could
+    // re-cache the old rows right after the invalidation
+    wxStringSet_t m_pendingIndexFiles;
+    wxStringSet_t m_pendingInvalidatedFiles;
+    bool m_pendingInvalidateAll = false;
 
 private:
     /**
@@ -142,18 +313,77 @@ private:
      * @param sql
      * @param tags
      */
-    void DoFetchTags(const wxString& sql, std::vector<TagEntryPtr>& tags);
+    void DoFetchTags(const TagsStorageSQLiteQuery& query, std::vector<TagEntryPtr>& tags);
 
     /**
-     * @brief
+     * @brief fetch tags from the database, keeping only tags of the given kinds
      * @param sql
      * @param tags
      */
-    void DoFetchTags(const wxString& sql, std::vector<TagEntryPtr>& tags, const wxArrayString& kinds);
+    void DoFetchTags(const TagsStorageSQLiteQuery& query, std::vector<TagEntryPtr>& tags, const wxArrayString& kinds);
+
+    /**
+     * @brief execute a query using a cached statement and call `on_row` for every row. Stops when `on_row`
+     * returns false. The statement is reset when done so it does not keep a read transaction open
+     */
+    void DoQuery(const TagsStorageSQLiteQuery& query, const std::function<bool(wxSQLite3ResultSet&)>& on_row);
 
-    void DoAddNamePartToQuery(wxString& sql, const wxString& name, bool partial, bool prependAnd);
-    void DoAddLimitPartToQuery(wxString& sql, const std::vector<TagEntryPtr>& tags);
+    void DoAddNamePartToQuery(TagsStorageSQLiteQuery& query, const wxString& name, bool partial, bool prependAnd);
+    void DoAddLimitPartToQuery(TagsStorageSQLiteQuery& query, const std::vector<TagEntryPtr>& tags);
     int DoInsertTagEntry(const TagEntry& tag);
+    /**
+     * @brief insert a batch of tags using a single multi-row INSERT statement
+     */
+    void DoInsertTagEntries(const std::vector<const TagEntry*>& tags, wxStringMap_t& normalized_files);
+    void DoDeleteByFileName(const wxString& fileName);
+    void DoOpen(const wxFileName& fileName);
+    void DoClose();
+
+    /**
+     * @brief return the connection to use for read-only queries. In WAL mode, this is a connection taken
+     * from the read pool, unless this storage is in the middle of a transaction (in which case we must read
+     * from the write connection to see the uncommitted changes)
+     */
+    clSqliteDB* GetReadDb();
+
+    /**
+     * @brief fetch tags by their IDs, keeping the order of `ids`
+     */
+    void DoFetchTagsByIds(const std::vector<long>& ids, std::vector<TagEntryPtr>& tags);
+
+    /**
+     * @brief re-read the symbols of `file` from the database into the symbol index
+     */
+    void DoUpdateSymbolIndex(const wxString& file);
+
+    /**
+     * @brief called after a successful commit: apply the changes of the transaction to the symbol index and
+     * publish the cache invalidation
+     */
+    void DoApplyCommittedChanges();
+    void DoClearPendingChanges();
+
+    /**
+     * @brief the number of results a query may still add to `tags` (at least 1)
+     */
+    size_t GetRemainingLimit(const std::vector<TagEntryPtr>& tags) const;
+
+    /**
+     * @brief apply to the results cache the changes made to the database by other instances
+     */
+    void DoSyncCache();
+
+    /**
+     * @brief let all the instances (including this one) know that `files` were changed. Call it only once the
+     * change is committed
+     * @param everything when true, all the cached results are invalidated
+     */
+    void DoPublishCacheInvalidation(const wxStringSet_t& files, bool everything);
+
+    /**
+     * @brief return true if `tags` define symbols that `files` do not define in the database yet
+     */
+    bool DoHasNewSymbols(const wxStringSet_t& files, const std::vector<TagEntryPtr>& tags);
 
 public:
     static TagEntry* FromSQLite3ResultSet(wxSQLite3ResultSet& rs);
@@ -181,6 +411,35 @@ public:
 
     virtual void SetUseCache(bool useCache);
 
+    /**
+     * @brief use write-ahead-log journal mode for databases opened from now on. In this mode, queries are
+     * executed on read-only connections and never block behind an indexing transaction.
+     * Default: false
+     */
+    static void SetWALMode(bool b);
+    static bool IsWALMode();
+
+    /**
+     * @brief when enabled, the database is protected against corruption if the process (or the machine) crashes
+     * in the middle of a transaction, at the cost of slower writes. When disabled, a crash might require
+     * re-indexing the workspace. Applies to databases opened from now on. Default: false
+     */
+    static void SetCrashSafe(bool b);
+    static bool IsCrashSafe();
+
+    /**
+     * @brief load all the symbols of the open database into an in-memory index, shared with all the
+     * other instances opening the same database file. Once loaded, name lookups (completion, workspace symbols)
+     * are answered by the index and the other instances keep it up to date when storing tags
+     * @return the number of symbols loaded
+     */
+    size_t LoadSymbolIndex();
+
+    /**
+     * @brief return the symbol index attached to this database (may be null)
+     */
+    TagsSymbolIndex::ptr_t GetSymbolIndex() const { return m_symbolIndex; }
+
     /**
      * Return the currently opened database.
      * @return Currently open database
@@ -266,13 +525,19 @@ public:
             m_db->Commit();
         } catch (const wxSQLite3Exception& e) {
             wxUnusedVar(e);
+            return;
         }
+        DoApplyCommittedChanges();
     }
 
     /**
      * Rollback transaction.
      */
-    void Rollback() { return m_db->Rollback(); }
+    void Rollback()
+    {
+        DoClearPendingChanges();
+        m_db->Rollback();
+    }
 
     /**
      * Test whether the database is opened
@@ -477,6 +742,15 @@ public:
      */
     virtual void ClearCache();
 
+    /**
+     * @brief set the maximum size (in bytes) of the query results cache
+     */
+    void SetCacheMaxBytes(size_t max_bytes) { m_cache.SetMaxBytes(max_bytes); }
+    /**
+     * @brief return the query results cache statistics
+     */
+    const TagsStorageSQLiteCache::Stats& GetCacheStats() const { return m_cache.GetStats(); }
+
     /**
      * @brief
      * @param name
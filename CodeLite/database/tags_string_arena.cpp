@@ -0,0 +1,126 @@
+#include "tags_string_arena.h"
+
+#include <cstring>
+#include <functional>
+
+namespace
+{
+constexpr size_t ARENA_BLOCK_SIZE = 64 * 1024;
+constexpr size_t MIN_SLOTS_COUNT = 1024;
+
+inline size_t hash_of(std::string_view str) { return std::hash<std::string_view>{}(str); }
+
+/// the smallest power of 2 table that keeps `count` strings at a load factor <= 0.5
+size_t slots_for(size_t count)
+{
+    size_t slots = MIN_SLOTS_COUNT;
+    while(slots < count * 2) {
+        slots <<= 1;
+    }
+    return slots;
+}
+} // namespace
+
+size_t TagsStringArena::FindSlot(std::string_view str) const
+{
+    // linear probing, the table is never more than half full so there is always an empty slot
+    size_t mask = m_slots.size() - 1;
+    size_t slot = hash_of(str) & mask;
+    while(true) {
+        uint32_t handle = m_slots[slot];
+        if(handle == NPOS || m_strings[handle] == str) {
+            return slot;
+        }
+        slot = (slot + 1) & mask;
+    }
+}
+
+void TagsStringArena::Rehash(size_t slots_count)
+{
+    m_slots.assign(slots_count, NPOS);
+    size_t mask = slots_count - 1;
+    for(uint32_t handle = 0; handle < m_strings.size(); ++handle) {
+        size_t slot = hash_of(m_strings[handle]) & mask;
+        while(m_slots[slot] != NPOS) {
+            slot = (slot + 1) & mask;
+        }
+        m_slots[slot] = handle;
+    }
+}
+
+void TagsStringArena::Reserve(size_t count)
+{
+    m_strings.reserve(count);
+    size_t slots = slots_for(count);
+    if(slots > m_slots.size()) {
+        Rehash(slots);
+    }
+}
+
+uint32_t TagsStringArena::Intern(std::string_view str)
+{
+    if(m_slots.empty()) {
+        Rehash(MIN_SLOTS_COUNT);
+    }
+
+    size_t slot = FindSlot(str);
+    if(m_slots[slot] != NPOS) {
+        return m_slots[slot];
+    }
+
+    // strings never cross blocks, so the views we hand out remain valid
+    size_t len = str.length();
+    char* dest = nullptr;
+    if(len > ARENA_BLOCK_SIZE) {
+        // long string: give it its own block, but keep filling the current one
+        std::unique_ptr<char[]> block(new char[len]);
+        dest = block.get();
+        m_blocks.insert(m_blocks.empty() ? m_blocks.end() : m_blocks.end() - 1, std::move(block));
+        m_blocks_bytes += len;
+    } else {
+        if(m_blocks.empty() || (m_block_used + len) > ARENA_BLOCK_SIZE) {
+            m_blocks.emplace_back(new char[ARENA_BLOCK_SIZE]);
+            m_blocks_bytes += ARENA_BLOCK_SIZE;
+            m_block_used = 0;
+        }
+        dest = m_blocks.back().get() + m_block_used;
+        m_block_used += len;
+    }
+
+    if(len) {
+        memcpy(dest, str.data(), len);
+    }
+    m_bytes += len;
+
+    uint32_t handle = static_cast<uint32_t>(m_strings.size());
+    m_strings.push_back(std::string_view{ dest, len });
+    m_slots[slot] = handle;
+    if(m_strings.size() * 2 > m_slots.size()) {
+        Rehash(m_slots.size() * 2);
+    }
+    return handle;
+}
+
+uint32_t TagsStringArena::Find(std::string_view str) const
+{
+    if(m_slots.empty()) {
+        return NPOS;
+    }
+    return m_slots[FindSlot(str)];
+}
+
+size_t TagsStringArena::GetMemoryUsage() const
+{
+    return m_blocks_bytes + m_strings.capacity() * sizeof(std::string_view) + m_slots.capacity() * sizeof(uint32_t) +
+           m_blocks.capacity() * sizeof(std::unique_ptr<char[]>);
+}
+
+void TagsStringArena::Clear()
+{
+    m_slots.clear();
+    m_strings.clear();
+    m_blocks.clear();
+    m_block_used = 0;
+    m_bytes = 0;
+    m_blocks_bytes = 0;
+}
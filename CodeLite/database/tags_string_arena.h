@@ -0,0 +1,58 @@
+#ifndef TAGS_STRING_ARENA_H
+#define TAGS_STRING_ARENA_H
+
+#include "codelite_exports.h"
+
+#include <cstdint>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+/**
+ * @class TagsStringArena
+ * @brief append only storage of interned strings. Strings are stored as UTF-8 in large blocks and never move once
+ * added, each unique string is identified by a 32-bit handle.
+ *
+ * The lookup table is an open addressing table of handles (4 bytes per slot), so interning costs ~24 bytes per unique
+ * string on top of the string bytes themselves
+ */
+class WXDLLIMPEXP_CL TagsStringArena
+{
+public:
+    static constexpr uint32_t NPOS = static_cast<uint32_t>(-1);
+
+private:
+    std::vector<std::unique_ptr<char[]>> m_blocks;
+    size_t m_block_used = 0;
+    size_t m_bytes = 0;
+    size_t m_blocks_bytes = 0;
+    std::vector<std::string_view> m_strings;
+    std::vector<uint32_t> m_slots; // power of 2 sized, NPOS marks an empty slot
+
+    /// return the slot of `str`: either the slot holding its handle or the empty slot where it should be added
+    size_t FindSlot(std::string_view str) const;
+    void Rehash(size_t slots_count);
+
+public:
+    TagsStringArena() = default;
+    ~TagsStringArena() = default;
+    // moving the arena keeps the views it handed out valid: the blocks themselves don't move
+    TagsStringArena(TagsStringArena&&) = default;
+    TagsStringArena& operator=(TagsStringArena&&) = default;
+
+    /// add `str` and return its handle. Adding the same string twice returns the same handle
+    uint32_t Intern(std::string_view str);
+    /// return the handle of `str` or `NPOS`
+    uint32_t Find(std::string_view str) const;
+    std::string_view Get(uint32_t handle) const { return m_strings[handle]; }
+    /// prepare for `count` unique strings
+    void Reserve(size_t count);
+    /// number of bytes used by the strings
+    size_t GetBytes() const { return m_bytes; }
+    /// number of bytes allocated by the arena: blocks, handles and lookup table
+    size_t GetMemoryUsage() const;
+    size_t GetCount() const { return m_strings.size(); }
+    void Clear();
+};
+
+#endif // TAGS_STRING_ARENA_H
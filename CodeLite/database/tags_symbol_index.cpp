@@ -0,0 +1,507 @@
+#include "tags_symbol_index.h"
+
+#include "wxStringHash.h"
+
+#include <algorithm>
+#include <mutex>
+#include <unordered_set>
+
+namespace
+{
+std::mutex g_registry_mutex;
+std::unordered_map<wxString, TagsSymbolIndex::ptr_t> g_registry;
+
+/// convert `str` to UTF-8. The returned buffer must outlive any view taken from it
+inline wxScopedCharBuffer to_utf8(const wxString& str) { return str.ToUTF8(); }
+
+inline std::string_view as_view(const wxScopedCharBuffer& buffer)
+{
+    return std::string_view{ buffer.data(), buffer.length() };
+}
+
+inline bool starts_with(std::string_view str, std::string_view prefix)
+{
+    return str.length() >= prefix.length() && str.compare(0, prefix.length(), prefix) == 0;
+}
+
+/// the arena is rebuilt when it grows past twice its live size, and by at least this many bytes
+constexpr size_t COMPACT_MIN_DEAD_BYTES = 1024 * 1024;
+
+/// return the unique trigrams of `str`, each packed into an integer
+std::vector<uint32_t> get_trigrams(std::string_view str)
+{
+    std::vector<uint32_t> trigrams;
+    if(str.length() < 3) {
+        return trigrams;
+    }
+
+    trigrams.reserve(str.length() - 2);
+    for(size_t i = 0; i + 2 < str.length(); ++i) {
+        trigrams.push_back((uint32_t)(unsigned char)str[i] << 16 | (uint32_t)(unsigned char)str[i + 1] << 8 |
+                           (uint32_t)(unsigned char)str[i + 2]);
+    }
+    std::sort(trigrams.begin(), trigrams.end());
+    trigrams.erase(std::unique(trigrams.begin(), trigrams.end()), trigrams.end());
+    return trigrams;
+}
+} // namespace
+
+//-------------------------------------------------
+// Registry
+//-------------------------------------------------
+TagsSymbolIndex::ptr_t TagsSymbolIndex::Get(const wxString& db_path)
+{
+    std::lock_guard<std::mutex> lk{ g_registry_mutex };
+    auto where = g_registry.find(db_path);
+    return where == g_registry.end() ? nullptr : where->second;
+}
+
+TagsSymbolIndex::ptr_t TagsSymbolIndex::Create(const wxString& db_path)
+{
+    std::lock_guard<std::mutex> lk{ g_registry_mutex };
+    ptr_t index = std::make_shared<TagsSymbolIndex>();
+    g_registry.erase(db_path);
+    g_registry.insert({ db_path, index });
+    return index;
+}
+
+void TagsSymbolIndex::Release(const wxString& db_path)
+{
+    std::lock_guard<std::mutex> lk{ g_registry_mutex };
+    g_registry.erase(db_path);
+}
+
+//-------------------------------------------------
+// Index
+//-------------------------------------------------
+void TagsSymbolIndex::DoRemoveFile(uint32_t file)
+{
+    auto where = m_file_symbols.find(file);
+    if(where == m_file_symbols.end()) {
+        return;
+    }
+
+    for(uint32_t slot : where->second) {
+        Symbol& symbol = m_symbols[slot];
+        auto& name_slots = m_name_symbols[symbol.lower_name];
+        auto iter = std::find(name_slots.begin(), name_slots.end(), slot);
+        if(iter != name_slots.end()) {
+            *iter = name_slots.back();
+            name_slots.pop_back();
+        }
+        m_has_empty_names = m_has_empty_names || name_slots.empty();
+
+        auto& path_slots = m_path_symbols[symbol.lower_path];
+        iter = std::find(path_slots.begin(), path_slots.end(), slot);
+        if(iter != path_slots.end()) {
+            *iter = path_slots.back();
+            path_slots.pop_back();
+        }
+        if(path_slots.empty()) {
+            // unless a symbol with this path is added before the commit
+            m_dead_paths.push_back(symbol.lower_path);
+        }
+        symbol = Symbol{};
+        m_free_slots.push_back(slot);
+        --m_count;
+    }
+    m_file_symbols.erase(where);
+}
+
+void TagsSymbolIndex::DoAdd(long id, const wxString& name, const wxString& scope, const wxString& path,
+                            const wxString& kind, uint32_t file)
+{
+    Symbol symbol;
+    symbol.id = id;
+    symbol.name = m_strings.Intern(as_view(to_utf8(name)));
+    symbol.lower_name = m_strings.Intern(as_view(to_utf8(name.Lower())));
+    symbol.scope = m_strings.Intern(as_view(to_utf8(scope)));
+    symbol.lower_path = m_strings.Intern(as_view(to_utf8(path.Lower())));
+    symbol.kind = m_strings.Intern(as_view(to_utf8(kind)));
+    symbol.file = file;
+
+    uint32_t slot = 0;
+    if(!m_free_slots.empty()) {
+        slot = m_free_slots.back();
+        m_free_slots.pop_back();
+        m_symbols[slot] = symbol;
+    } else {
+        slot = static_cast<uint32_t>(m_symbols.size());
+        m_symbols.push_back(symbol);
+    }
+    ++m_count;
+
+    m_file_symbols[file].push_back(slot);
+    auto res = m_name_symbols.try_emplace(symbol.lower_name);
+    res.first->second.push_back(slot);
+    if(res.second) {
+        // a new name, add it to the sorted list on commit
+        m_pending_names.push_back(symbol.lower_name);
+    }
+
+    res = m_path_symbols.try_emplace(symbol.lower_path);
+    res.first->second.push_back(slot);
+    if(res.second) {
+        for(uint32_t trigram : get_trigrams(m_strings.Get(symbol.lower_path))) {
+            m_trigram_paths[trigram].push_back(symbol.lower_path);
+        }
+    }
+}
+
+void TagsSymbolIndex::DoCommit()
+{
+    DoRemoveDeadPaths();
+
+    if(!m_pending_names.empty() || m_has_empty_names) {
+        auto less = [this](uint32_t a, uint32_t b) { return m_strings.Get(a) < m_strings.Get(b); };
+        std::sort(m_pending_names.begin(), m_pending_names.end(), less);
+
+        // merge the new names and drop the names that no longer have symbols
+        std::vector<uint32_t> merged;
+        merged.reserve(m_sorted_names.size() + m_pending_names.size());
+        std::merge(m_sorted_names.begin(), m_sorted_names.end(), m_pending_names.begin(), m_pending_names.end(),
+                   std::back_inserter(merged), less);
+        m_pending_names.clear();
+        m_has_empty_names = false;
+
+        m_sorted_names.clear();
+        m_sorted_names.reserve(merged.size());
+        for(uint32_t name : merged) {
+            auto where = m_name_symbols.find(name);
+            if(where->second.empty()) {
+                m_name_symbols.erase(where);
+                continue;
+            }
+            m_sorted_names.push_back(name);
+        }
+    }
+
+    // every update interns the strings of the file again, the ones that are gone are only dropped by a rebuild
+    if(m_strings.GetBytes() > std::max(m_live_strings_bytes * 2, m_live_strings_bytes + COMPACT_MIN_DEAD_BYTES)) {
+        DoCompactStrings();
+    }
+}
+
+void TagsSymbolIndex::DoRemoveDeadPaths()
+{
+    std::unordered_set<uint32_t> dead;
+    for(uint32_t path : m_dead_paths) {
+        auto where = m_path_symbols.find(path);
+        if(where != m_path_symbols.end() && where->second.empty()) {
+            m_path_symbols.erase(where);
+            dead.insert(path);
+        }
+    }
+    m_dead_paths.clear();
+    if(dead.empty()) {
+        return;
+    }
+
+    // a single pass over each posting list that holds one of the dead paths
+    std::unordered_set<uint32_t> trigrams;
+    for(uint32_t path : dead) {
+        for(uint32_t trigram : get_trigrams(m_strings.Get(path))) {
+            trigrams.insert(trigram);
+        }
+    }
+
+    for(uint32_t trigram : trigrams) {
+        auto where = m_trigram_paths.find(trigram);
+        if(where == m_trigram_paths.end()) {
+            continue;
+        }
+        auto& paths = where->second;
+        paths.erase(std::remove_if(paths.begin(), paths.end(), [&dead](uint32_t path) { return dead.count(path); }),
+                    paths.end());
+        if(paths.empty()) {
+            m_trigram_paths.erase(where);
+        }
+    }
+}
+
+void TagsSymbolIndex::DoCompactStrings()
+{
+    TagsStringArena strings;
+    std::vector<uint32_t> handles(m_strings.GetCount(), NPOS);
+    auto move_string = [&](uint32_t handle) -> uint32_t {
+        if(handle == NPOS) {
+            return NPOS;
+        }
+        uint32_t& new_handle = handles[handle];
+        if(new_handle == NPOS) {
+            new_handle = strings.Intern(m_strings.Get(handle));
+        }
+        return new_handle;
+    };
+
+    for(Symbol& symbol : m_symbols) {
+        if(!IsAlive(symbol)) {
+            continue;
+        }
+        symbol.name = move_string(symbol.name);
+        symbol.lower_name = move_string(symbol.lower_name);
+        symbol.scope = move_string(symbol.scope);
+        symbol.lower_path = move_string(symbol.lower_path);
+        symbol.kind = move_string(symbol.kind);
+        symbol.file = move_string(symbol.file);
+    }
+
+    auto move_keys = [&](std::unordered_map<uint32_t, std::vector<uint32_t>>& map) {
+        std::unordered_map<uint32_t, std::vector<uint32_t>> moved;
+        moved.reserve(map.size());
+        for(auto& [handle, slots] : map) {
+            moved.insert({ move_string(handle), std::move(slots) });
+        }
+        map.swap(moved);
+    };
+    move_keys(m_file_symbols);
+    move_keys(m_name_symbols);
+    move_keys(m_path_symbols);
+
+    // the strings are the same, so the names remain sorted
+    for(uint32_t& name : m_sorted_names) {
+        name = move_string(name);
+    }
+    for(uint32_t& name : m_pending_names) {
+        name = move_string(name);
+    }
+    for(auto& [trigram, paths] : m_trigram_paths) {
+        for(uint32_t& path : paths) {
+            path = move_string(path);
+        }
+    }
+
+    m_strings = std::move(strings);
+    m_live_strings_bytes = m_strings.GetBytes();
+}
+
+void TagsSymbolIndex::UpdateFile(const wxString& file, const std::vector<Entry>& entries)
+{
+    std::unique_lock<std::shared_mutex> lk{ m_mutex };
+    uint32_t file_handle = m_strings.Intern(as_view(to_utf8(file)));
+    DoRemoveFile(file_handle);
+    for(const Entry& entry : entries) {
+        DoAdd(entry.id, entry.name, entry.scope, entry.path, entry.kind, file_handle);
+    }
+    DoCommit();
+}
+
+void TagsSymbolIndex::RemoveFile(const wxString& file)
+{
+    std::unique_lock<std::shared_mutex> lk{ m_mutex };
+    uint32_t file_handle = m_strings.Find(as_view(to_utf8(file)));
+    if(file_handle != NPOS) {
+        DoRemoveFile(file_handle);
+        DoCommit();
+    }
+}
+
+void TagsSymbolIndex::Load(const std::function<bool(Entry&, wxString&)>& next)
+{
+    std::unique_lock<std::shared_mutex> lk{ m_mutex };
+    Entry entry;
+    wxString file;
+    while(next(entry, file)) {
+        DoAdd(entry.id, entry.name, entry.scope, entry.path, entry.kind,
+              m_strings.Intern(as_view(to_utf8(file))));
+    }
+    DoCommit();
+    m_live_strings_bytes = m_strings.GetBytes();
+}
+
+void TagsSymbolIndex::Clear()
+{
+    std::unique_lock<std::shared_mutex> lk{ m_mutex };
+    m_symbols.clear();
+    m_free_slots.clear();
+    m_file_symbols.clear();
+    m_name_symbols.clear();
+    m_sorted_names.clear();
+    m_pending_names.clear();
+    m_has_empty_names = false;
+    m_path_symbols.clear();
+    m_trigram_paths.clear();
+    m_dead_paths.clear();
+    m_strings.Clear();
+    m_live_strings_bytes = 0;
+    m_count = 0;
+}
+
+size_t TagsSymbolIndex::FindByName(const wxString& name, bool partial, bool case_sensitive,
+                                   const std::vector<wxString>* scopes, const std::vector<wxString>* kinds,
+                                   size_t limit, std::vector<long>& ids) const
+{
+    std::shared_lock<std::shared_mutex> lk{ m_mutex };
+
+    auto to_handles = [this](const std::vector<wxString>* strings, std::unordered_set<uint32_t>& handles) {
+        for(const wxString& str : *strings) {
+            uint32_t handle = m_strings.Find(as_view(to_utf8(str)));
+            if(handle != NPOS) {
+                handles.insert(handle);
+            }
+        }
+    };
+
+    std::unordered_set<uint32_t> scope_handles;
+    std::unordered_set<uint32_t> kind_handles;
+    if(scopes) {
+        to_handles(scopes, scope_handles);
+        if(scope_handles.empty()) {
+            return 0;
+        }
+    }
+
+    if(kinds) {
+        to_handles(kinds, kind_handles);
+        if(kind_handles.empty()) {
+            return 0;
+        }
+    }
+
+    auto name_buffer = to_utf8(name);
+    auto lower_buffer = to_utf8(name.Lower());
+    std::string_view name_view = as_view(name_buffer);
+    std::string_view lower_view = as_view(lower_buffer);
+
+    size_t count = 0;
+    // collect the matching symbols of a single name. Return false when the limit is reached
+    auto add_matches = [&](uint32_t lower_name) -> bool {
+        auto where = m_name_symbols.find(lower_name);
+        if(where == m_name_symbols.end()) {
+            return true;
+        }
+
+        for(uint32_t slot : where->second) {
+            const Symbol& symbol = m_symbols[slot];
+            if(!IsAlive(symbol)) {
+                continue;
+            }
+
+            if(!partial && m_strings.Get(symbol.name) != name_view) {
+                // exact match is always case sensitive
+                continue;
+            }
+
+            if(partial && case_sensitive && !starts_with(m_strings.Get(symbol.name), name_view)) {
+                continue;
+            }
+
+            if(scopes && scope_handles.count(symbol.scope) == 0) {
+                continue;
+            }
+
+            if(kinds && kind_handles.count(symbol.kind) == 0) {
+                continue;
+            }
+
+            ids.push_back(symbol.id);
+            if(++count >= limit) {
+                return false;
+            }
+        }
+        return true;
+    };
+
+    if(!partial) {
+        uint32_t handle = m_strings.Find(lower_view);
+        if(handle != NPOS) {
+            add_matches(handle);
+        }
+        return count;
+    }
+
+    auto iter = std::lower_bound(m_sorted_names.begin(), m_sorted_names.end(), lower_view,
+                                 [this](uint32_t a, std::string_view b) { return m_strings.Get(a) < b; });
+    for(; iter != m_sorted_names.end(); ++iter) {
+        if(!starts_with(m_strings.Get(*iter), lower_view) || !add_matches(*iter)) {
+            break;
+        }
+    }
+    return count;
+}
+
+size_t TagsSymbolIndex::FindByPathParts(const wxArrayString& parts, size_t limit, std::vector<long>& ids) const
+{
+    if(parts.empty()) {
+        return 0;
+    }
+
+    std::vector<std::string> lower_parts;
+    lower_parts.reserve(parts.size());
+    for(const wxString& part : parts) {
+        auto buffer = to_utf8(part.Lower());
+        lower_parts.emplace_back(buffer.data(), buffer.length());
+    }
+
+    std::shared_lock<std::shared_mutex> lk{ m_mutex };
+
+    // the candidates are the paths of the shortest posting list among the trigrams of the parts. Only when all the
+    // parts are shorter than 3 bytes, all the paths are candidates
+    const std::vector<uint32_t>* candidates = nullptr;
+    for(const std::string& part : lower_parts) {
+        for(uint32_t trigram : get_trigrams(part)) {
+            auto where = m_trigram_paths.find(trigram);
+            if(where == m_trigram_paths.end()) {
+                // no path contains this part
+                return 0;
+            }
+            if(candidates == nullptr || where->second.size() < candidates->size()) {
+                candidates = &where->second;
+            }
+        }
+    }
+
+    size_t count = 0;
+    // collect the symbols of `path` if it contains all the parts. Return false when the limit is reached
+    auto add_matches = [&](uint32_t path, const std::vector<uint32_t>& slots) -> bool {
+        std::string_view path_view = m_strings.Get(path);
+        bool match = std::all_of(lower_parts.begin(), lower_parts.end(), [path_view](const std::string& part) {
+            return path_view.find(part) != std::string_view::npos;
+        });
+        if(!match) {
+            return true;
+        }
+
+        for(uint32_t slot : slots) {
+            ids.push_back(m_symbols[slot].id);
+            if(++count >= limit) {
+                return false;
+            }
+        }
+        return true;
+    };
+
+    if(candidates) {
+        for(uint32_t path : *candidates) {
+            auto where = m_path_symbols.find(path);
+            if(where != m_path_symbols.end() && !add_matches(path, where->second)) {
+                break;
+            }
+        }
+    } else {
+        for(const auto& [path, slots] : m_path_symbols) {
+            if(!add_matches(path, slots)) {
+                break;
+            }
+        }
+    }
+    return count;
+}
+
+size_t TagsSymbolIndex::GetCount() const
+{
+    std::shared_lock<std::shared_mutex> lk{ m_mutex };
+    return m_count;
+}
+
+size_t TagsSymbolIndex::GetStringsBytes() const
+{
+    std::shared_lock<std::shared_mutex> lk{ m_mutex };
+    return m_strings.GetBytes();
+}
+
+size_t TagsSymbolIndex::GetStringsCount() const
+{
+    std::shared_lock<std::shared_mutex> lk{ m_mutex };
+    return m_strings.GetCount();
+}
@@ -0,0 +1,143 @@
+#ifndef TAGS_SYMBOL_INDEX_H
+#define TAGS_SYMBOL_INDEX_H
+
+#include "codelite_exports.h"
+#include "tags_string_arena.h"
+
+#include <functional>
+#include <memory>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include <wx/arrstr.h>
+#include <wx/string.h>
+
+/**
+ * @class TagsSymbolIndex
+ * @brief an in-memory index over the symbols stored in a tags database.
+ *
+ * The index keeps only what is needed to match a symbol (name, scope, path, kind and file), all the strings are
+ * interned into an arena. Lookups return the database IDs of the matching tags, the tags themselves are
+ * fetched from the database by their primary key. Substring searches on the path go through trigram posting lists
+ * of the unique paths. The arena is rebuilt once most of its bytes belong to strings that are no longer used.
+ *
+ * The index is shared by all the TagsStorageSQLite instances that open the same database file: instances that write
+ * to the database keep it up to date, see `TagsStorageSQLite::Store()`
+ */
+class WXDLLIMPEXP_CL TagsSymbolIndex
+{
+public:
+    typedef std::shared_ptr<TagsSymbolIndex> ptr_t;
+
+private:
+    static constexpr uint32_t NPOS = TagsStringArena::NPOS;
+
+    struct Symbol {
+        long id = wxNOT_FOUND;
+        uint32_t name = NPOS;
+        uint32_t lower_name = NPOS;
+        uint32_t scope = NPOS;
+        uint32_t lower_path = NPOS;
+        uint32_t kind = NPOS;
+        uint32_t file = NPOS;
+    };
+
+    mutable std::shared_mutex m_mutex;
+    TagsStringArena m_strings;
+    std::vector<Symbol> m_symbols;
+    std::vector<uint32_t> m_free_slots;
+    std::unordered_map<uint32_t, std::vector<uint32_t>> m_file_symbols;
+    std::unordered_map<uint32_t, std::vector<uint32_t>> m_name_symbols;
+    std::vector<uint32_t> m_sorted_names;
+    std::vector<uint32_t> m_pending_names;
+    bool m_has_empty_names = false;
+    // the symbols of each unique (lower case) path, and the paths that contain each trigram
+    std::unordered_map<uint32_t, std::vector<uint32_t>> m_path_symbols;
+    std::unordered_map<uint32_t, std::vector<uint32_t>> m_trigram_paths;
+    std::vector<uint32_t> m_dead_paths;
+    // the arena size after it was last rebuilt
+    size_t m_live_strings_bytes = 0;
+    size_t m_count = 0;
+
+    void DoRemoveFile(uint32_t file);
+    void DoAdd(long id, const wxString& name, const wxString& scope, const wxString& path, const wxString& kind,
+               uint32_t file);
+    void DoCommit();
+    void DoRemoveDeadPaths();
+    /**
+     * @brief copy the strings still in use to a new arena, and update all the handles
+     */
+    void DoCompactStrings();
+    bool IsAlive(const Symbol& symbol) const { return symbol.id != wxNOT_FOUND; }
+
+public:
+    /**
+     * @brief a symbol as read from the database
+     */
+    struct Entry {
+        long id = wxNOT_FOUND;
+        wxString name;
+        wxString scope;
+        wxString path;
+        wxString kind;
+    };
+
+    /**
+     * @brief return the index for `db_path` or nullptr if no index was created for it
+     */
+    static ptr_t Get(const wxString& db_path);
+    /**
+     * @brief create a new, empty, index for `db_path` replacing any existing one
+     */
+    static ptr_t Create(const wxString& db_path);
+    /**
+     * @brief drop the index of `db_path`. Instances already holding it keep a valid (but detached) index
+     */
+    static void Release(const wxString& db_path);
+
+    TagsSymbolIndex() = default;
+    ~TagsSymbolIndex() = default;
+
+    /**
+     * @brief replace all the symbols of `file` with `entries`
+     */
+    void UpdateFile(const wxString& file, const std::vector<Entry>& entries);
+    /**
+     * @brief remove all the symbols of `file`
+     */
+    void RemoveFile(const wxString& file);
+    /**
+     * @brief bulk load. Calls `next` until it returns false. Each call fills one entry and its file
+     */
+    void Load(const std::function<bool(Entry&, wxString&)>& next);
+    void Clear();
+
+    /**
+     * @brief find symbols by name
+     * @param name the name or the name prefix to search for
+     * @param partial when true, `name` is treated as a prefix
+     * @param case_sensitive compare the names case-sensitive
+     * @param scopes if not null, return only symbols from these scopes
+     * @param kinds if not null, return only symbols of these kinds
+     * @param limit maximum number of results
+     * @param ids [output] the database IDs of the matches, ordered by name
+     */
+    size_t FindByName(const wxString& name, bool partial, bool case_sensitive, const std::vector<wxString>* scopes,
+                      const std::vector<wxString>* kinds, size_t limit, std::vector<long>& ids) const;
+
+    /**
+     * @brief find symbols whose path contains all of `parts` (case-insensitive)
+     */
+    size_t FindByPathParts(const wxArrayString& parts, size_t limit, std::vector<long>& ids) const;
+
+    /// number of symbols in the index
+    size_t GetCount() const;
+    /// number of bytes used by the string arena
+    size_t GetStringsBytes() const;
+    /// number of strings in the string arena
+    size_t GetStringsCount() const;
+};
+
+#endif // TAGS_SYMBOL_INDEX_H
@@ -25,13 +25,23 @@
 #include "search_thread.h"
 
 #include "clFilesCollector.h"
+#include "clLiteralSearcher.hpp"
+#include "clMappedFile.hpp"
 #include "clWildMatch.hpp"
 #include "StringUtils.h"
 #include "file_logger.h"
 #include "fileutils.h"
 #include "macros.h"
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
 #include <set>
+#include <string.h>
+#include <thread>
 #include <wx/event.h>
 #include <wx/fontmap.h>
 #include <wx/stopwatch.h>
@@ -64,8 +74,130 @@ bool is_word_char(wxChar ch) { return ch == '_' || wxIsalnum(ch); }
 constexpr long MIN_SEND_INTERVAL_MS = 1;
 size_t send_count = 0;
 
+// number of files a search worker takes at once
+constexpr size_t FILES_PER_CHUNK = 16;
+// maximum number of search workers
+constexpr size_t MAX_WORKERS = 16;
+
+int get_regex_flags(bool matchCase)
+{
+#ifndef __WXMAC__
+    int flags = wxRE_ADVANCED;
+#else
+    int flags = wxRE_DEFAULT;
+#endif
+
+    if (!matchCase)
+        flags |= wxRE_ICASE;
+    return flags;
+}
+
+bool is_ascii(const wxString& str)
+{
+    for (wxUniChar ch : str) {
+        if (!ch.IsAscii()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/// encodings where an ASCII string is encoded as is and can not appear as part of a multibyte sequence
+bool is_ascii_compatible(wxFontEncoding enc)
+{
+    return enc == wxFONTENCODING_UTF8 || (enc >= wxFONTENCODING_ISO8859_1 && enc < wxFONTENCODING_ISO8859_MAX) ||
+           (enc >= wxFONTENCODING_CP1250 && enc < wxFONTENCODING_CP12_MAX);
+}
+
+bool is_binary_executable(const wxString& fileName, const char* data, size_t size)
+{
+#ifdef __WXMSW__
+    wxUnusedVar(data);
+    wxUnusedVar(size);
+    return FileUtils::IsBinaryExecutable(fileName);
+#else
+    // ELF magic
+    static const char ELF_MAGIC[] = { 0x7f, 'E', 'L', 'F' };
+    wxUnusedVar(fileName);
+    return size >= 4 && ::memcmp(data, ELF_MAGIC, 4) == 0;
+#endif
+}
+
+/// number of wxString characters the UTF-8 sequence [begin, end) decodes into
+size_t utf8_chars_count(const char* begin, const char* end)
+{
+    size_t count = 0;
+    for (const char* p = begin; p < end; ++p) {
+        unsigned char ch = *p;
+        if ((ch & 0xC0) != 0x80) {
+            ++count;
+            // a code point outside the BMP requires a surrogate pair
+            if (sizeof(wchar_t) == 2 && ch >= 0xF0) {
+                ++count;
+            }
+        }
+    }
+    return count;
+}
+
 } // namespace
 
+/// search options, computed once per search and shared (read-only) by all the search workers
+struct SearchThread::SearchParams {
+    const SearchData* data = nullptr;
+    wxString findString;
+    wxArrayString filters;
+    wxFontEncoding encoding = wxFONTENCODING_SYSTEM;
+    bool utf8 = false;
+    /// raw bytes pre-filter. When null, every file is decoded and searched line by line
+    std::unique_ptr<clLiteralSearcher> searcher;
+
+    SearchParams(const SearchData* d)
+        : data(d)
+    {
+#if wxUSE_GUI
+        encoding = wxFontMapper::GetEncodingFromName(data->GetEncoding().c_str());
+#endif
+        utf8 = encoding == wxFONTENCODING_UTF8;
+        if (data->IsRegularExpression()) {
+            return;
+        }
+
+        // simple search
+        findString = data->GetFindString();
+        if (data->IsEnablePipeSupport()) {
+            if (data->GetFindString().Find('|') != wxNOT_FOUND) {
+                findString = data->GetFindString().BeforeFirst('|');
+
+                wxString filtersString = data->GetFindString().AfterFirst('|');
+                filters = ::wxStringTokenize(filtersString, "|", wxTOKEN_STRTOK);
+                if (!data->IsMatchCase()) {
+                    for (size_t i = 0; i < filters.size(); ++i) {
+                        filters.Item(i).MakeLower();
+                    }
+                }
+            }
+        }
+
+        if (findString.empty()) {
+            return;
+        }
+
+        // every line that matches must contain the bytes of the search string. This holds when the string is encoded
+        // the same way in the file. Case folding is done by the searcher for ASCII only
+        bool ascii = is_ascii(findString);
+        bool can_prefilter = (utf8 && (ascii || data->IsMatchCase())) ||
+                             (ascii && (is_ascii_compatible(encoding) || encoding == wxFONTENCODING_SYSTEM));
+        if (can_prefilter) {
+            searcher.reset(new clLiteralSearcher(findString.ToStdString(wxConvUTF8), data->IsMatchCase()));
+        }
+
+        if (!data->IsMatchCase()) {
+            findString.MakeLower();
+        }
+    }
+};
+
 const wxString& SearchData::GetExtensions() const { return m_validExt; }
 SearchData& SearchData::operator=(const SearchData& rhs) { return Copy(rhs); }
 SearchData& SearchData::Copy(const SearchData& other)
@@ -98,31 +230,10 @@ SearchData& SearchData::Copy(const SearchData& other)
 
 SearchThread::SearchThread()
     : WorkerThread()
-    , m_reExpr(wxT(""))
 {
     m_stopWatch.Start();
 }
 
-wxRegEx& SearchThread::GetRegex(const wxString& expr, bool matchCase)
-{
-    if (m_reExpr == expr && matchCase == m_matchCase) {
-        return m_regex;
-    } else {
-        m_reExpr = expr;
-        m_matchCase = matchCase;
-#ifndef __WXMAC__
-        int flags = wxRE_ADVANCED;
-#else
-        int flags = wxRE_DEFAULT;
-#endif
-
-        if (!matchCase)
-            flags |= wxRE_ICASE;
-        m_regex.Compile(m_reExpr, flags);
-    }
-    return m_regex;
-}
-
 void SearchThread::PerformSearch(const SearchData& data) { Add(new SearchData(data)); }
 
 void SearchThread::ProcessRequest(ThreadRequest* req)
@@ -234,18 +345,92 @@ void SearchThread::DoSearchFiles(ThreadRequest* req)
         }
     }
 
-    for (size_t i = 0; i < fileList.Count(); i++) {
+    SearchParams params(data);
+    const size_t count = fileList.size();
+
+    // the files are split between the workers, the results are collected here in the files order
+    std::vector<FileResult> slots(count);
+    std::atomic_size_t next_file{ 0 };
+    std::atomic_bool cancelled{ false };
+    std::mutex slots_mutex;
+    std::condition_variable slots_cv;
+
+    auto worker = [&]() {
+        wxRegEx re;
+        if (data->IsRegularExpression()) {
+            re.Compile(data->GetFindString(), get_regex_flags(data->IsMatchCase()));
+        }
+
+        clMappedFile file;
+        while (!cancelled.load()) {
+            size_t first = next_file.fetch_add(FILES_PER_CHUNK);
+            if (first >= count) {
+                break;
+            }
+
+            size_t last = std::min(count, first + FILES_PER_CHUNK);
+            for (size_t i = first; i < last && !cancelled.load(); ++i) {
+                FileResult result;
+                DoSearchFile(fileList.Item(i), params, re, file, result);
+                {
+                    std::lock_guard<std::mutex> lk{ slots_mutex };
+                    slots[i] = std::move(result);
+                    slots[i].done = true;
+                }
+                slots_cv.notify_one();
+            }
+        }
+    };
+
+    size_t workers_count = std::max(1u, std::thread::hardware_concurrency());
+    workers_count = std::min({ workers_count, MAX_WORKERS, (count + FILES_PER_CHUNK - 1) / FILES_PER_CHUNK });
+    std::vector<std::thread> workers;
+    workers.reserve(workers_count);
+    for (size_t i = 0; i < workers_count; ++i) {
+        workers.emplace_back(worker);
+    }
+    clDEBUG() << "Searching" << count << "files using" << workers_count << "workers" << endl;
+
+    for (size_t i = 0; i < count; i++) {
+        // wait for the file to be searched, checking whether the user asked to cancel the search
+        bool stop = false;
+        {
+            std::unique_lock<std::mutex> lk{ slots_mutex };
+            while (!slots[i].done && !(stop = TestStopSearch())) {
+                slots_cv.wait_for(lk, std::chrono::milliseconds(50));
+            }
+        }
+
         m_summary.SetNumFileScanned((int)i + 1);
 
         // give user chance to cancel the search ...
-        if (TestStopSearch()) {
+        if (stop || TestStopSearch()) {
             // Send cancel event
+            cancelled.store(true);
             SendEvent(wxEVT_SEARCH_THREAD_SEARCHCANCELED, data->GetOwner());
             StopSearch(false);
             break;
         }
-        DoSearchFile(fileList.Item(i), data);
+
+        FileResult& result = slots[i];
+        if (result.failed) {
+            m_summary.GetFailedFiles().Add(fileList.Item(i));
+        }
+
+        if (!result.results.empty()) {
+            m_summary.SetNumMatchesFound(m_summary.GetNumMatchesFound() + (int)result.results.size());
+            m_results.insert(m_results.end(), std::make_move_iterator(result.results.begin()),
+                             std::make_move_iterator(result.results.end()));
+            result.results = {};
+            SendEvent(wxEVT_SEARCH_THREAD_MATCHFOUND, data->GetOwner());
+        }
     }
+
+    cancelled.store(true);
+    for (auto& thr : workers) {
+        thr.join();
+    }
+    clDEBUG() << "Search completed in" << sw.Time() << "ms" << endl;
 }
 
 bool SearchThread::TestStopSearch()
@@ -264,94 +449,136 @@ void SearchThread::StopSearch(bool stop)
     m_stopSearch = stop;
 }
 
-void SearchThread::DoSearchFile(const wxString& fileName, const SearchData* data)
+void SearchThread::DoSearchFile(const wxString& fileName, const SearchParams& params, wxRegEx& re, clMappedFile& file,
+                                FileResult& result)
 {
-    // Process single lines
-    int lineNumber = 1;
-    if (!wxFileName::FileExists(fileName)) {
+    if (!file.Open(fileName)) {
+        // missing files are silently ignored
+        result.failed = wxFileName::FileExists(fileName);
+        return;
+    }
+
+    if (file.GetSize() == 0) {
         return;
     }
 
     // ignore binary executables
-    if (FileUtils::IsBinaryExecutable(fileName)) {
+    if (is_binary_executable(fileName, file.GetData(), file.GetSize())) {
         return;
     }
 
-    size_t size = FileUtils::GetFileSize(fileName);
-    if (size == 0) {
+    const SearchData* data = params.data;
+    if (!data->IsRegularExpression() && params.findString.empty()) {
+        // Don't search for empty strings
         return;
     }
-    wxString fileData;
-    fileData.Alloc(size);
 
+    if (params.searcher) {
+        // files that do not contain the search string are not decoded at all
+        if (params.searcher->Find(file.begin(), file.end()) == nullptr) {
+            return;
+        }
+
+        if (params.utf8 && DoSearchBytes(file.begin(), file.end(), fileName, params, result.results)) {
+            return;
+        }
+        result.results.clear();
+    }
+
+    wxString fileData;
 #if wxUSE_GUI
     // support for other encoding
-    wxFontEncoding enc = wxFontMapper::GetEncodingFromName(data->GetEncoding().c_str());
-    wxCSConv fontEncConv(enc);
-    if (!FileUtils::ReadFileContent(fileName, fileData, fontEncConv)) {
-        m_summary.GetFailedFiles().Add(fileName);
-        return;
-    }
+    wxCSConv fontEncConv(params.encoding);
+    fileData = wxString(file.GetData(), fontEncConv, file.GetSize());
 #else
-    if (!FileUtils::ReadFileContent(fileName, fileData, wxConvLibc)) {
-        m_summary.GetFailedFiles().Add(fileName);
+    fileData = wxString(file.GetData(), wxConvLibc, file.GetSize());
+#endif
+    if (fileData.empty()) {
+        result.failed = true;
         return;
     }
-#endif
+    DoSearchContent(fileData, fileName, params, re, result.results);
+}
+
+bool SearchThread::DoSearchBytes(const char* begin, const char* end, const wxString& fileName,
+                                 const SearchParams& params, SearchResultList& results)
+{
+    // the start of the current line, its line number and its offset (in characters) from the start of the file
+    const char* line_start = begin;
+    int lineNumber = 1;
+    size_t lineOffset = 0;
+
+    const char* match = params.searcher->Find(line_start, end);
+    while (match) {
+        // move to the line that contains the match
+        const char* p = line_start;
+        while (true) {
+            const char* eol = static_cast<const char*>(::memchr(p, '\n', match - p));
+            if (eol == nullptr) {
+                break;
+            }
+            ++lineNumber;
+            p = eol + 1;
+        }
+        lineOffset += utf8_chars_count(line_start, p);
+        line_start = p;
+
+        const char* line_end = static_cast<const char*>(::memchr(match, '\n', end - match));
+        if (line_end == nullptr) {
+            line_end = end;
+        }
+
+        // decode only this line
+        wxString line = wxString::FromUTF8(line_start, line_end - line_start);
+        if (line.empty()) {
+            // not a valid UTF-8 content
+            return false;
+        }
+        DoSearchLine(line, lineNumber, (int)lineOffset, fileName, params.data, params.findString, params.filters,
+                     results);
+
+        if (line_end == end) {
+            break;
+        }
+        lineOffset += line.length() + 1;
+        ++lineNumber;
+        line_start = line_end + 1;
+        match = params.searcher->Find(line_start, end);
+    }
+    return true;
+}
+
+void SearchThread::DoSearchContent(const wxString& fileData, const wxString& fileName, const SearchParams& params,
+                                   wxRegEx& re, SearchResultList& results)
+{
+    // Process single lines
+    int lineNumber = 1;
     wxArrayString lines = ::wxStringTokenize(fileData, wxT("\n"), wxTOKEN_RET_EMPTY_ALL);
 
     int lineOffset = 0;
-    if (data->IsRegularExpression()) {
+    if (params.data->IsRegularExpression()) {
         // regular expression search
         for (const wxString& line : lines) {
             // Read the next line
-            DoSearchLineRE(line, lineNumber, lineOffset, fileName, data);
+            DoSearchLineRE(line, lineNumber, lineOffset, fileName, params.data, re, results);
             lineOffset += line.Length() + 1;
             lineNumber++;
         }
     } else {
         // simple search
-        wxString findString;
-        wxArrayString filters;
-        findString = data->GetFindString();
-        if (data->IsEnablePipeSupport()) {
-            if (data->GetFindString().Find('|') != wxNOT_FOUND) {
-                findString = data->GetFindString().BeforeFirst('|');
-
-                wxString filtersString = data->GetFindString().AfterFirst('|');
-                filters = ::wxStringTokenize(filtersString, "|", wxTOKEN_STRTOK);
-                if (!data->IsMatchCase()) {
-                    for (size_t i = 0; i < filters.size(); ++i) {
-                        filters.Item(i).MakeLower();
-                    }
-                }
-            }
-        }
-
-        // Don't search for empty strings
-        if (findString.empty()) {
-            return;
-        }
-
-        if (!data->IsMatchCase()) {
-            findString.MakeLower();
-        }
         for (const wxString& line : lines) {
-            DoSearchLine(line, lineNumber, lineOffset, fileName, data, findString, filters);
+            DoSearchLine(line, lineNumber, lineOffset, fileName, params.data, params.findString, params.filters,
+                         results);
             lineOffset += line.Length() + 1;
             lineNumber++;
         }
     }
-
-    if (m_results.empty() == false) {
-        SendEvent(wxEVT_SEARCH_THREAD_MATCHFOUND, data->GetOwner());
-    }
 }
 
-void SearchThread::DoSearchLineRE(
-    const wxString& line, const int lineNum, const int lineOffset, const wxString& fileName, const SearchData* data)
+void SearchThread::DoSearchLineRE(const wxString& line, const int lineNum, const int lineOffset,
+                                  const wxString& fileName, const SearchData* data, wxRegEx& re,
+                                  SearchResultList& results)
 {
-    wxRegEx& re = GetRegex(data->GetFindString(), data->IsMatchCase());
     size_t col = 0;
     int iCorrectedCol = 0;
     int iCorrectedLen = 0;
@@ -384,8 +611,7 @@ void SearchThread::DoSearchLineRE(
             result.SetRegexCaptures(regexCaptures);
 
             // Make sure our match is not on a comment
-            m_results.push_back(result);
-            m_summary.SetNumMatchesFound(m_summary.GetNumMatchesFound() + 1);
+            results.push_back(result);
 
             col += len;
 
@@ -403,7 +629,8 @@ void SearchThread::DoSearchLine(const wxString& line,
                                 const wxString& fileName,
                                 const SearchData* data,
                                 const wxString& findWhat,
-                                const wxArrayString& filters)
+                                const wxArrayString& filters,
+                                SearchResultList& results)
 {
     wxString modLine = line;
 
@@ -477,8 +704,7 @@ void SearchThread::DoSearchLine(const wxString& line,
             result.SetFindWhat(data->GetFindString());
             result.SetFlags(data->m_flags);
 
-            m_results.push_back(result);
-            m_summary.SetNumMatchesFound(m_summary.GetNumMatchesFound() + 1);
+            results.push_back(result);
 
             if (!AdjustLine(modLine, pos, findWhat)) {
                 break;
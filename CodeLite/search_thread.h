@@ -45,6 +45,7 @@
 class wxEvtHandler;
 class SearchResult;
 class SearchThread;
+class clMappedFile;
 
 //----------------------------------------------------------
 // The searched data class to be passed to the search thread
@@ -347,9 +348,6 @@ class WXDLLIMPEXP_CL SearchThread : public WorkerThread
     SearchResultList m_results;
     bool m_stopSearch;
     SearchSummary m_summary;
-    wxString m_reExpr;
-    wxRegEx m_regex;
-    bool m_matchCase;
     wxCriticalSection m_cs;
     wxStopWatch m_stopWatch;
 
@@ -398,23 +396,39 @@ private:
      */
     void DoSearchFiles(ThreadRequest* data);
 
-    // Perform search on a single file
-    void DoSearchFile(const wxString& fileName, const SearchData* data);
+    // search options shared by all the search workers, see search_thread.cpp
+    struct SearchParams;
+    // the outcome of searching a single file
+    struct FileResult {
+        SearchResultList results;
+        bool failed = false;
+        bool done = false;
+    };
+
+    // Perform search on a single file. Called from the search workers, each worker re-uses its own `file`
+    void DoSearchFile(const wxString& fileName, const SearchParams& params, wxRegEx& re, clMappedFile& file,
+                      FileResult& result);
+
+    // Search the raw (UTF-8) bytes of a file, only the lines that contain a match are decoded
+    bool DoSearchBytes(const char* begin, const char* end, const wxString& fileName, const SearchParams& params,
+                       SearchResultList& results);
+
+    // Search the decoded content of a file
+    void DoSearchContent(const wxString& fileData, const wxString& fileName, const SearchParams& params, wxRegEx& re,
+                         SearchResultList& results);
 
     // Perform search on a line
     void DoSearchLine(const wxString& line, const int lineNum, const int lineOffset, const wxString& fileName,
-                      const SearchData* data, const wxString& findWhat, const wxArrayString& filters);
+                      const SearchData* data, const wxString& findWhat, const wxArrayString& filters,
+                      SearchResultList& results);
 
     // Perform search on a line using regular expression
     void DoSearchLineRE(const wxString& line, const int lineNum, const int lineOffset, const wxString& fileName,
-                        const SearchData* data);
+                        const SearchData* data, wxRegEx& re, SearchResultList& results);
 
     // Send an event to the notified window
     void SendEvent(wxEventType type, wxEvtHandler* owner);
 
-    // return a compiled regex object for the expression
-    wxRegEx& GetRegex(const wxString& expr, bool matchCase);
-
     // Internal function
     bool AdjustLine(wxString& line, int& pos, const wxString& findString);
 
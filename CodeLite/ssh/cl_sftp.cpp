@@ -28,15 +28,183 @@
 
 #include "cl_standard_paths.h"
 #include "file_logger.h"
+#include "fileutils.h"
 
+#include <algorithm>
 #include <atomic>
+#include <deque>
 #include <libssh/sftp.h>
 #include <string.h>
 #include <sys/stat.h>
+#include <vector>
 #include <wx/ffile.h>
 #include <wx/filefn.h>
+#include <wx/log.h>
+#include <wx/stopwatch.h>
 #include <wx/tokenzr.h>
 
+// libssh 0.11 replaced sftp_async_read* with the sftp_aio_* API, which can also write asynchronously
+#if LIBSSH_VERSION_INT >= SSH_VERSION_INT(0, 11, 0)
+#define SFTP_HAS_AIO 1
+#else
+#define SFTP_HAS_AIO 0
+#endif
+
+namespace
+{
+// the size of a single read or write request
+constexpr size_t TRANSFER_CHUNK_SIZE = 64 * 1024;
+// the number of requests sent before waiting for the first reply: up to 1MB in flight per file
+constexpr size_t TRANSFER_MAX_REQUESTS = 16;
+// the number of bytes compared before resuming a transfer
+constexpr size_t RESUME_CHECK_SIZE = 64 * 1024;
+const wxString PARTIAL_FILE_SUFFIX = ".codelitesftp-part";
+// written next to the partial file of a resumable transfer: the size and modification time of the source file
+const wxString PARTIAL_INFO_SUFFIX = ".codelitesftp-part-info";
+
+/// a request that was sent to the server, and whose reply was not read yet
+struct PendingRequest {
+    size_t offset = 0;
+    size_t len = 0;
+#if SFTP_HAS_AIO
+    sftp_aio aio = nullptr;
+#else
+    uint32_t id = 0;
+#endif
+};
+
+/// discard the requests that are still in flight when a transfer fails or is cancelled
+class PendingRequestsCleaner
+{
+    sftp_file m_file;
+    std::deque<PendingRequest>& m_requests;
+
+public:
+    PendingRequestsCleaner(sftp_file file, std::deque<PendingRequest>& requests)
+        : m_file(file)
+        , m_requests(requests)
+    {
+    }
+    ~PendingRequestsCleaner()
+    {
+#if SFTP_HAS_AIO
+        wxUnusedVar(m_file);
+        for (auto& req : m_requests) {
+            sftp_aio_free(req.aio);
+        }
+#else
+        // libssh keeps the replies until they are read
+        std::vector<char> buffer(m_requests.empty() ? 0 : TRANSFER_CHUNK_SIZE);
+        for (const auto& req : m_requests) {
+            sftp_async_read(m_file, buffer.data(), req.len, req.id);
+        }
+#endif
+        m_requests.clear();
+    }
+};
+
+size_t GetChunkSize(sftp_session sftp, bool read)
+{
+    size_t chunkSize = TRANSFER_CHUNK_SIZE;
+#if SFTP_HAS_AIO
+    // the server may accept less
+    sftp_limits_t limits = sftp_limits(sftp);
+    if (limits) {
+        size_t maxLength = read ? limits->max_read_length : limits->max_write_length;
+        if (maxLength > 0) {
+            chunkSize = std::min<size_t>(chunkSize, maxLength);
+        }
+        sftp_limits_free(limits);
+    }
+#else
+    wxUnusedVar(sftp);
+    wxUnusedVar(read);
+#endif
+    return chunkSize;
+}
+
+/**
+ * @brief return the size of the local file, or wxInvalidOffset
+ */
+wxFileOffset GetLocalFileSize(const wxString& path)
+{
+    wxStructStat st;
+    if (wxStat(path, &st) != 0) {
+        return wxInvalidOffset;
+    }
+    return st.st_size;
+}
+
+/**
+ * @brief identify the version of a file. A partial transfer is resumed only if its source has the same id
+ */
+wxString GetSourceId(uint64_t size, uint64_t mtime) { return wxString() << size << " " << mtime; }
+
+wxString GetLocalSourceId(const wxString& path)
+{
+    wxStructStat st;
+    if (wxStat(path, &st) != 0) {
+        return wxEmptyString;
+    }
+    return GetSourceId(st.st_size, st.st_mtime);
+}
+
+wxString ReadLocalText(const wxString& path)
+{
+    wxLogNull no_log;
+    wxString content;
+    wxFFile fp(path, "rb");
+    if (!fp.IsOpened() || !fp.ReadAll(&content, wxConvUTF8)) {
+        return wxEmptyString;
+    }
+    return content;
+}
+
+bool WriteLocalText(const wxString& path, const wxString& content)
+{
+    wxLogNull no_log;
+    wxFFile fp(path, "wb");
+    return fp.IsOpened() && fp.Write(content, wxConvUTF8) && fp.Close();
+}
+
+void RemoveLocalFile(const wxString& path)
+{
+    wxLogNull no_log;
+    if (wxFileExists(path)) {
+        ::wxRemoveFile(path);
+    }
+}
+
+/**
+ * @brief give `path` the permissions of `source`, if `source` exists
+ */
+void CopyLocalFileMode(const wxString& source, const wxString& path)
+{
+#ifndef __WXMSW__
+    wxStructStat st;
+    if (wxStat(source, &st) == 0 && ::chmod(path.mb_str(wxConvUTF8).data(), st.st_mode & 07777) != 0) {
+        clDEBUG() << "SFTP: failed to set the permissions of" << path << ::strerror(errno) << endl;
+    }
+#else
+    wxUnusedVar(source);
+    wxUnusedVar(path);
+#endif
+}
+
+/**
+ * @brief read `len` bytes at `offset` of a local file
+ */
+bool ReadLocalRange(const wxString& path, size_t offset, size_t len, std::string& data)
+{
+    wxFFile fp(path, "rb");
+    if (!fp.IsOpened() || !fp.Seek(offset)) {
+        return false;
+    }
+    data.resize(len);
+    return fp.Read(data.data(), len) == len;
+}
+} // namespace
+
 class SFTPDirCloser
 {
     sftp_dir m_dir;
@@ -49,6 +217,35 @@ public:
     ~SFTPDirCloser() { sftp_closedir(m_dir); }
 };
 
+class SFTPFileCloser
+{
+    sftp_file m_file;
+
+public:
+    SFTPFileCloser(sftp_file f)
+        : m_file(f)
+    {
+    }
+    ~SFTPFileCloser() { sftp_close(m_file); }
+};
+
+double clSFTP::TransferStats::GetThroughput() const
+{
+    // avoid dividing by 0 for small files
+    return (double)transferred * 1000.0 / (double)std::max(elapsedMs, 1L);
+}
+
+wxString clSFTP::TransferStats::ToString() const
+{
+    wxString str;
+    str << wxString::Format("%.2fMB in %ldms (%.2fMB/s)", transferred / (1024.0 * 1024.0), elapsedMs,
+                            GetThroughput() / (1024.0 * 1024.0));
+    if (resumedAt) {
+        str << ", resumed at " << resumedAt;
+    }
+    return str;
+}
+
 clSFTP::clSFTP(clSSH::Ptr_t ssh)
     : m_ssh(ssh)
     , m_sftp(NULL)
@@ -127,25 +324,8 @@ void clSFTP::Write(const wxFileName& localFile, const wxString& remotePath)
     if (!localFile.Exists()) {
         throw clException(wxString() << "scp::Write file '" << localFile.GetFullPath() << "' does not exist!");
     }
-
-    wxFFile fp(localFile.GetFullPath(), "rb");
-    if (!fp.IsOpened()) {
-        throw clException(wxString() << "scp::Write could not open file '" << localFile.GetFullPath() << "'. "
-                                     << ::strerror(errno));
-    }
-
-    wxMemoryBuffer memBuffer;
-    size_t len = fp.Length();
-    void* buffer = memBuffer.GetWriteBuf(len);
-    size_t nbytes(0);
-    nbytes = fp.Read(buffer, fp.Length());
-    if (nbytes != (size_t)fp.Length()) {
-        throw clException(wxString() << "failed to read local file content. expected read size: " << len
-                                     << ". bytes read: " << nbytes);
-    }
-    fp.Close();
-    memBuffer.SetDataLen(len);
-    Write(memBuffer, remotePath);
+    TransferStats stats = Upload(localFile.GetFullPath(), remotePath);
+    clDEBUG() << "SFTP: uploaded" << localFile.GetFullPath() << "->" << remotePath << stats.ToString() << endl;
 }
 
 void clSFTP::Write(const wxMemoryBuffer& fileContent, const wxString& remotePath)
@@ -168,25 +348,144 @@ void clSFTP::Write(const wxMemoryBuffer& fileContent, const wxString& remotePath
                           sftp_get_error(m_sftp));
     }
 
-    char* p = (char*)fileContent.GetData();
-    const int maxChunkSize = 65536;
-    wxInt64 bytesLeft = fileContent.GetDataLen();
+    {
+        SFTPFileCloser fc(file);
+        const char* p = (const char*)fileContent.GetData();
+        DoPipelinedWrite(
+            file, tmpRemoteFile, 0, fileContent.GetDataLen(),
+            [&p](char* data, size_t len) -> size_t {
+                memcpy(data, p, len);
+                p += len;
+                return len;
+            },
+            nullptr);
+    }
+    DoReplaceRemoteFile(tmpRemoteFile, remotePath);
+}
 
-    while (bytesLeft > 0) {
-        wxInt64 chunkSize = bytesLeft > maxChunkSize ? maxChunkSize : bytesLeft;
-        wxInt64 bytesWritten = sftp_write(file, p, chunkSize);
-        if (bytesWritten < 0) {
-            sftp_close(file);
-            throw clException(wxString() << _("Can't write data to file: ") << tmpRemoteFile << ". "
-                                         << ssh_get_error(m_ssh->GetSession()),
-                              sftp_get_error(m_sftp));
+clSFTP::TransferStats clSFTP::Upload(const wxString& localPath, const wxString& remotePath, bool resume,
+                                     const ProgressCallback& progress)
+{
+    if (!m_sftp) {
+        throw clException("SFTP is not initialized");
+    }
+
+    wxFFile fp(localPath, "rb");
+    if (!fp.IsOpened()) {
+        throw clException(wxString() << "scp::Write could not open file '" << localPath << "'. "
+                                     << ::strerror(errno));
+    }
+
+    wxStopWatch sw;
+    TransferStats stats;
+    stats.total = fp.Length();
+
+    wxString tmpRemoteFile = remotePath + PARTIAL_FILE_SUFFIX;
+    wxString infoRemoteFile = remotePath + PARTIAL_INFO_SUFFIX;
+    wxString sourceId = GetLocalSourceId(localPath);
+    auto cb = tmpRemoteFile.mb_str(wxConvUTF8);
+    if (resume && !sourceId.empty() && DoReadRemoteText(infoRemoteFile) == sourceId) {
+        // a previous upload of this version of the file was interrupted
+        sftp_attributes attr = sftp_stat(m_sftp, cb.data());
+        if (attr) {
+            size_t partialSize = attr->size;
+            sftp_attributes_free(attr);
+
+            sftp_file partial =
+                (partialSize > 0 && partialSize < stats.total) ? sftp_open(m_sftp, cb.data(), O_RDONLY, 0) : NULL;
+            if (partial) {
+                SFTPFileCloser fc(partial);
+                size_t len = std::min(partialSize, RESUME_CHECK_SIZE);
+                std::string remoteTail;
+                std::string localTail;
+                if (DoReadRange(partial, partialSize - len, len, remoteTail) &&
+                    ReadLocalRange(localPath, partialSize - len, len, localTail) && remoteTail == localTail) {
+                    stats.resumedAt = partialSize;
+                }
+            }
+        }
+    }
+
+    if (resume && !stats.resumedAt) {
+        // record what the partial file is made of, before writing it
+        DoWriteRemoteText(infoRemoteFile, sourceId);
+    }
+
+    int access_type = O_WRONLY | O_CREAT | (stats.resumedAt ? 0 : O_TRUNC);
+    sftp_file file = sftp_open(m_sftp, cb.data(), access_type, 0644);
+    if (file == NULL) {
+        throw clException(wxString() << _("Can't open file: ") << tmpRemoteFile << ". "
+                                     << ssh_get_error(m_ssh->GetSession()),
+                          sftp_get_error(m_sftp));
+    }
+
+    try {
+        {
+            SFTPFileCloser fc(file);
+            if (stats.resumedAt && !fp.Seek(stats.resumedAt)) {
+                throw clException(wxString() << "scp::Write could not seek in file '" << localPath << "'");
+            }
+            DoPipelinedWrite(
+                file, tmpRemoteFile, stats.resumedAt, stats.total,
+                [&fp](char* data, size_t len) -> size_t { return fp.Read(data, len); }, progress);
         }
-        bytesLeft -= bytesWritten;
-        p += bytesWritten;
+        fp.Close();
+        DoReplaceRemoteFile(tmpRemoteFile, remotePath);
+    } catch (const clException&) {
+        if (!resume) {
+            // nothing can continue this upload
+            DoUnlinkQuietly(tmpRemoteFile);
+        }
+        throw;
     }
-    sftp_close(file);
 
+    if (resume) {
+        DoUnlinkQuietly(infoRemoteFile);
+    }
+    stats.transferred = stats.total - stats.resumedAt;
+    stats.elapsedMs = sw.Time();
+    return stats;
+}
+
+wxString clSFTP::DoReadRemoteText(const wxString& remotePath)
+{
+    sftp_file file = sftp_open(m_sftp, remotePath.mb_str(wxConvUTF8).data(), O_RDONLY, 0);
+    if (file == NULL) {
+        return wxEmptyString;
+    }
+    SFTPFileCloser fc(file);
+
+    char buffer[256];
+    ssize_t count = sftp_read(file, buffer, sizeof(buffer));
+    if (count <= 0) {
+        return wxEmptyString;
+    }
+    return wxString::FromUTF8(buffer, count);
+}
+
+bool clSFTP::DoWriteRemoteText(const wxString& remotePath, const wxString& content)
+{
+    sftp_file file = sftp_open(m_sftp, remotePath.mb_str(wxConvUTF8).data(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (file == NULL) {
+        return false;
+    }
+    SFTPFileCloser fc(file);
+
+    auto data = content.mb_str(wxConvUTF8);
+    return sftp_write(file, data.data(), data.length()) == (ssize_t)data.length();
+}
+
+void clSFTP::DoUnlinkQuietly(const wxString& remotePath)
+{
+    if (sftp_unlink(m_sftp, remotePath.mb_str(wxConvUTF8).data()) < 0) {
+        clDEBUG() << "SFTP: failed to delete" << remotePath << ssh_get_error(m_ssh->GetSession()) << endl;
+    }
+}
+
+void clSFTP::DoReplaceRemoteFile(const wxString& tmpRemoteFile, const wxString& remotePath)
+{
     // Unlink the original file if it exists
+    auto cb = tmpRemoteFile.mb_str(wxConvUTF8);
     auto char_buffer_remote = remotePath.mb_str(wxConvUTF8);
     SFTPAttribute::Ptr_t pattr(new SFTPAttribute(sftp_stat(m_sftp, char_buffer_remote.data())));
 
@@ -208,6 +507,78 @@ void clSFTP::Write(const wxMemoryBuffer& fileContent, const wxString& remotePath
     }
 }
 
+void clSFTP::DoPipelinedWrite(SFTPFile_t file, const wxString& remotePath, size_t offset, size_t total,
+                              const DataSource_t& source, const ProgressCallback& progress)
+{
+    const size_t chunkSize = GetChunkSize(m_sftp, false);
+    std::vector<char> buffer(chunkSize);
+    if (sftp_seek64(file, offset) < 0) {
+        throw clException(wxString() << _("Can't write data to file: ") << remotePath << ". "
+                                     << ssh_get_error(m_ssh->GetSession()),
+                          sftp_get_error(m_sftp));
+    }
+
+#if SFTP_HAS_AIO
+    std::deque<PendingRequest> requests;
+    PendingRequestsCleaner cleaner(file, requests);
+    size_t next = offset;
+    while (offset < total) {
+        // keep the pipeline full. The data is copied into the request, so the buffer can be reused right away
+        while (requests.size() < TRANSFER_MAX_REQUESTS && next < total) {
+            PendingRequest req;
+            req.offset = next;
+            req.len = source(buffer.data(), std::min(chunkSize, total - next));
+            if (req.len == 0) {
+                throw clException(wxString() << _("Failed to read the local content of: ") << remotePath);
+            }
+            if (sftp_aio_begin_write(file, buffer.data(), req.len, &req.aio) == SSH_ERROR) {
+                throw clException(wxString() << _("Can't write data to file: ") << remotePath << ". "
+                                             << ssh_get_error(m_ssh->GetSession()),
+                                  sftp_get_error(m_sftp));
+            }
+            requests.push_back(req);
+            next += req.len;
+        }
+
+        // wait for the oldest request
+        PendingRequest req = requests.front();
+        requests.pop_front();
+        if (sftp_aio_wait_write(&req.aio) == SSH_ERROR) {
+            throw clException(wxString() << _("Can't write data to file: ") << remotePath << ". "
+                                         << ssh_get_error(m_ssh->GetSession()),
+                              sftp_get_error(m_sftp));
+        }
+        offset = req.offset + req.len;
+        if (progress && !progress(offset, total)) {
+            throw clException(wxString() << _("Transfer cancelled: ") << remotePath);
+        }
+    }
+#else
+    // this version of libssh can only write synchronously
+    while (offset < total) {
+        size_t len = source(buffer.data(), std::min(chunkSize, total - offset));
+        if (len == 0) {
+            throw clException(wxString() << _("Failed to read the local content of: ") << remotePath);
+        }
+        const char* p = buffer.data();
+        while (len > 0) {
+            ssize_t bytesWritten = sftp_write(file, p, len);
+            if (bytesWritten < 0) {
+                throw clException(wxString() << _("Can't write data to file: ") << remotePath << ". "
+                                             << ssh_get_error(m_ssh->GetSession()),
+                                  sftp_get_error(m_sftp));
+            }
+            len -= bytesWritten;
+            p += bytesWritten;
+            offset += bytesWritten;
+        }
+        if (progress && !progress(offset, total)) {
+            throw clException(wxString() << _("Transfer cancelled: ") << remotePath);
+        }
+    }
+#endif
+}
+
 SFTPAttribute::List_t clSFTP::List(const wxString& folder, size_t flags, const wxString& filter)
 {
     sftp_dir dir;
@@ -281,6 +652,7 @@ SFTPAttribute::Ptr_t clSFTP::Read(const wxString& remotePath, wxMemoryBuffer& bu
                                      << ssh_get_error(m_ssh->GetSession()),
                           sftp_get_error(m_sftp));
     }
+    SFTPFileCloser fc(file);
 
     SFTPAttribute::Ptr_t fileAttr = Stat(remotePath);
     if (!fileAttr) {
@@ -288,35 +660,203 @@ SFTPAttribute::Ptr_t clSFTP::Read(const wxString& remotePath, wxMemoryBuffer& bu
                                      << ssh_get_error(m_ssh->GetSession()),
                           sftp_get_error(m_sftp));
     }
-    wxInt64 fileSize = fileAttr->GetSize();
+    size_t fileSize = fileAttr->GetSize();
     if (fileSize == 0)
         return fileAttr;
 
-    // Allocate buffer for the file content
-    char pBuffer[65536]; // buffer
-
     // Read the entire file content
-    wxInt64 bytesLeft = fileSize;
-    wxInt64 bytesRead = 0;
-    while (bytesLeft > 0) {
-        wxInt64 nbytes = sftp_read(file, pBuffer, sizeof(pBuffer));
-        if (nbytes <= 0) {
-            break; // we will throw later
+    buffer.SetBufSize(buffer.GetDataLen() + fileSize);
+    try {
+        DoPipelinedRead(
+            file, remotePath, 0, fileSize, [&buffer](const char* data, size_t len) { buffer.AppendData(data, len); },
+            nullptr);
+    } catch (const clException&) {
+        buffer.Clear();
+        throw;
+    }
+    return fileAttr;
+}
+
+clSFTP::TransferStats clSFTP::Download(const wxString& remotePath, const wxString& localPath, bool resume,
+                                       const ProgressCallback& progress)
+{
+    if (!m_sftp) {
+        throw clException("SFTP is not initialized");
+    }
+
+    sftp_file file = sftp_open(m_sftp, remotePath.mb_str(wxConvUTF8).data(), O_RDONLY, 0);
+    if (file == NULL) {
+        throw clException(wxString() << _("Failed to open remote file: ") << remotePath << ". "
+                                     << ssh_get_error(m_ssh->GetSession()),
+                          sftp_get_error(m_sftp));
+    }
+    SFTPFileCloser fc(file);
+
+    sftp_attributes attr = sftp_fstat(file);
+    if (attr == NULL) {
+        throw clException(wxString() << _("Failed to stat remote file: ") << remotePath << ". "
+                                     << ssh_get_error(m_ssh->GetSession()),
+                          sftp_get_error(m_sftp));
+    }
+
+    wxStopWatch sw;
+    TransferStats stats;
+    stats.total = attr->size;
+    wxString sourceId = GetSourceId(attr->size, attr->mtime);
+    sftp_attributes_free(attr);
+
+    // when `localPath` is a symlink, replace the file it points to and keep the link
+    wxString targetPath = FileUtils::IsSymlink(localPath) ? FileUtils::RealPath(localPath, true) : localPath;
+    wxString partialPath = targetPath + PARTIAL_FILE_SUFFIX;
+    wxString infoPath = targetPath + PARTIAL_INFO_SUFFIX;
+    wxFileOffset partialSize =
+        (resume && ReadLocalText(infoPath) == sourceId) ? GetLocalFileSize(partialPath) : wxInvalidOffset;
+    if (partialSize > 0 && (size_t)partialSize < stats.total) {
+        // a previous download of this version of the file was interrupted
+        size_t len = std::min((size_t)partialSize, RESUME_CHECK_SIZE);
+        std::string remoteTail;
+        std::string localTail;
+        if (DoReadRange(file, partialSize - len, len, remoteTail) &&
+            ReadLocalRange(partialPath, partialSize - len, len, localTail) && remoteTail == localTail) {
+            stats.resumedAt = partialSize;
         }
-        bytesRead += nbytes;
-        bytesLeft -= nbytes;
-        buffer.AppendData(pBuffer, nbytes);
     }
 
-    if (bytesRead != fileSize) {
-        sftp_close(file);
-        buffer.Clear();
+    if (resume && !stats.resumedAt) {
+        // record what the partial file is made of, before writing it
+        WriteLocalText(infoPath, sourceId);
+    }
+
+    try {
+        {
+            wxLogNull no_log;
+            wxFFile fp(partialPath, stats.resumedAt ? "ab" : "wb");
+            if (!fp.IsOpened()) {
+                throw clException(wxString() << _("Failed to open local file: ") << partialPath << ". "
+                                             << ::strerror(errno));
+            }
+            DoPipelinedRead(
+                file, remotePath, stats.resumedAt, stats.total,
+                [&fp, &partialPath](const char* data, size_t len) {
+                    if (fp.Write(data, len) != len) {
+                        throw clException(wxString() << _("Failed to write local file: ") << partialPath);
+                    }
+                },
+                progress);
+            if (!fp.Close()) {
+                throw clException(wxString() << _("Failed to write local file: ") << partialPath);
+            }
+        }
+
+        CopyLocalFileMode(targetPath, partialPath);
+        if (!::wxRenameFile(partialPath, targetPath, true)) {
+            throw clException(wxString() << _("Failed to rename file: ") << partialPath << " -> " << targetPath);
+        }
+    } catch (const clException&) {
+        if (!resume) {
+            // nothing can continue this download
+            RemoveLocalFile(partialPath);
+        }
+        throw;
+    }
+
+    if (resume) {
+        RemoveLocalFile(infoPath);
+    }
+    stats.transferred = stats.total - stats.resumedAt;
+    stats.elapsedMs = sw.Time();
+    return stats;
+}
+
+void clSFTP::DoPipelinedRead(SFTPFile_t file, const wxString& remotePath, size_t offset, size_t total,
+                             const DataSink_t& sink, const ProgressCallback& progress)
+{
+    const size_t chunkSize = GetChunkSize(m_sftp, true);
+    std::vector<char> buffer(chunkSize);
+    std::deque<PendingRequest> requests;
+    PendingRequestsCleaner cleaner(file, requests);
+
+    if (sftp_seek64(file, offset) < 0) {
         throw clException(wxString() << _("Could not read file:") << remotePath << ". "
                                      << ssh_get_error(m_ssh->GetSession()),
                           sftp_get_error(m_sftp));
     }
-    sftp_close(file);
-    return fileAttr;
+
+    // the requests are sent at the file position, which each request moves forward
+    size_t next = offset;
+    while (offset < total) {
+        // keep the pipeline full
+        while (requests.size() < TRANSFER_MAX_REQUESTS && next < total) {
+            PendingRequest req;
+            req.offset = next;
+            req.len = std::min(chunkSize, total - next);
+#if SFTP_HAS_AIO
+            bool ok = sftp_aio_begin_read(file, req.len, &req.aio) != SSH_ERROR;
+#else
+            int id = sftp_async_read_begin(file, req.len);
+            bool ok = id >= 0;
+            req.id = id;
+#endif
+            if (!ok) {
+                throw clException(wxString() << _("Could not read file:") << remotePath << ". "
+                                             << ssh_get_error(m_ssh->GetSession()),
+                                  sftp_get_error(m_sftp));
+            }
+            requests.push_back(req);
+            next += req.len;
+        }
+
+        // wait for the oldest request
+        PendingRequest req = requests.front();
+        requests.pop_front();
+#if SFTP_HAS_AIO
+        ssize_t nbytes = sftp_aio_wait_read(&req.aio, buffer.data(), buffer.size());
+#else
+        ssize_t nbytes = sftp_async_read(file, buffer.data(), req.len, req.id);
+#endif
+        if (nbytes <= 0) {
+            // an error, or the file was truncated while we were reading it
+            throw clException(wxString() << _("Could not read file:") << remotePath << ". "
+                                         << ssh_get_error(m_ssh->GetSession()),
+                              sftp_get_error(m_sftp));
+        }
+        sink(buffer.data(), nbytes);
+
+        if ((size_t)nbytes < req.len) {
+            // the server returned less than requested. The next ranges are already requested: read the rest of this
+            // one now, and restore the position of the next request
+            std::string remainder;
+            if (!DoReadRange(file, req.offset + nbytes, req.len - nbytes, remainder) || sftp_seek64(file, next) < 0) {
+                throw clException(wxString() << _("Could not read file:") << remotePath << ". "
+                                             << ssh_get_error(m_ssh->GetSession()),
+                                  sftp_get_error(m_sftp));
+            }
+            sink(remainder.data(), remainder.size());
+        }
+
+        offset = req.offset + req.len;
+        if (progress && !progress(offset, total)) {
+            throw clException(wxString() << _("Transfer cancelled: ") << remotePath);
+        }
+    }
+}
+
+bool clSFTP::DoReadRange(SFTPFile_t file, size_t offset, size_t len, std::string& data)
+{
+    data.resize(len);
+    if (sftp_seek64(file, offset) < 0) {
+        return false;
+    }
+
+    size_t bytesRead = 0;
+    while (bytesRead < len) {
+        ssize_t nbytes = sftp_read(file, data.data() + bytesRead, len - bytesRead);
+        if (nbytes <= 0) {
+            return false;
+        }
+        bytesRead += nbytes;
+    }
+    return true;
 }
 
 void clSFTP::CreateDir(const wxString& dirname)
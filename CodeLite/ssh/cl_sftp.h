@@ -33,6 +33,7 @@
 #include "cl_ssh.h"
 #include "codelite_exports.h"
 #include "ssh_account_info.h"
+#include <functional>
 #include <memory>
 #include <wx/buffer.h>
 #include <wx/filename.h>
@@ -40,6 +41,8 @@
 // We do it this way to avoid exposing the include to <libssh/sftp.h> to files including this header
 struct sftp_session_struct;
 using SFTPSession_t = struct sftp_session_struct*;
+struct sftp_file_struct;
+using SFTPFile_t = struct sftp_file_struct*;
 
 class WXDLLIMPEXP_CL clSFTP
 {
@@ -56,10 +59,68 @@ public:
         SFTP_BROWSE_FOLDERS = 0x00000002,
     };
 
+    /// the transfers of files of this size or larger should be resumable, see Upload() and Download()
+    static constexpr size_t RESUME_MIN_SIZE = 4 * 1024 * 1024;
+
+    /**
+     * @brief the result of a file transfer
+     */
+    struct TransferStats {
+        size_t total = 0;       // the file size
+        size_t resumedAt = 0;   // where the transfer started, non 0 when an interrupted transfer was resumed
+        size_t transferred = 0; // the number of bytes that were sent or received
+        long elapsedMs = 0;
+
+        /**
+         * @brief return the throughput in bytes per second
+         */
+        double GetThroughput() const;
+        wxString ToString() const;
+    };
+
+    /**
+     * @brief called after every chunk with the number of bytes done so far and the file size. Return false to
+     * cancel the transfer
+     */
+    using ProgressCallback = std::function<bool(size_t done, size_t total)>;
+
 protected:
+    using DataSink_t = std::function<void(const char* data, size_t len)>;
+    using DataSource_t = std::function<size_t(char* data, size_t len)>;
+
     wxString GetErrorString() const;
     wxString ExecuteCommand(const wxString& command);
 
+    /**
+     * @brief read [offset, total) from `file`, keeping several read requests in flight. The data is passed to
+     * `sink` in order
+     */
+    void DoPipelinedRead(SFTPFile_t file, const wxString& remotePath, size_t offset, size_t total,
+                         const DataSink_t& sink, const ProgressCallback& progress);
+    /**
+     * @brief write [offset, total) to `file`, keeping several write requests in flight. The data is taken from
+     * `source`, in order
+     */
+    void DoPipelinedWrite(SFTPFile_t file, const wxString& remotePath, size_t offset, size_t total,
+                          const DataSource_t& source, const ProgressCallback& progress);
+    /**
+     * @brief read `len` bytes at `offset` (blocking)
+     */
+    bool DoReadRange(SFTPFile_t file, size_t offset, size_t len, std::string& data);
+    /**
+     * @brief replace `remotePath` with the uploaded `tmpRemoteFile`, keeping the permissions of the original file
+     */
+    void DoReplaceRemoteFile(const wxString& tmpRemoteFile, const wxString& remotePath);
+    /**
+     * @brief return the content of a small remote text file, or an empty string
+     */
+    wxString DoReadRemoteText(const wxString& remotePath);
+    bool DoWriteRemoteText(const wxString& remotePath, const wxString& content);
+    /**
+     * @brief delete a remote file, errors are ignored
+     */
+    void DoUnlinkQuietly(const wxString& remotePath);
+
 public:
     clSFTP(clSSH::Ptr_t ssh);
     virtual ~clSFTP();
@@ -113,6 +174,29 @@ public:
      */
     void Write(const wxMemoryBuffer& fileContent, const wxString& remotePath);
 
+    /**
+     * @brief upload a local file, streamed from the disk. The data is written to `remotePath` + ".codelitesftp-part"
+     * which replaces `remotePath` once complete
+     * @param resume keep the partial file when the upload fails, and continue a previous upload of this file instead
+     * of starting over. An upload is resumed only if the size and modification time of the local file are the ones
+     * recorded when the partial upload started, and the last bytes of the partial file match the local file. When
+     * false, the partial file is removed if the upload fails
+     * @throws clException
+     */
+    TransferStats Upload(const wxString& localPath, const wxString& remotePath, bool resume = false,
+                         const ProgressCallback& progress = nullptr);
+
+    /**
+     * @brief download a remote file, streamed to the disk. The data is written to `localPath` + ".codelitesftp-part"
+     * which replaces `localPath` once complete, with the permissions of the file it replaces. When `localPath` is a
+     * symlink, the file it points to is replaced instead
+     * @param resume keep the partial file when the download fails, and continue a previous download of this file
+     * instead of starting over (see Upload)
+     * @throws clException
+     */
+    TransferStats Download(const wxString& remotePath, const wxString& localPath, bool resume = false,
+                           const ProgressCallback& progress = nullptr);
+
     /**
      * @brief create an empty remote file
      */
@@ -35,14 +35,37 @@ BuildTab::BuildTab(wxWindow* parent)
         Cleanup();
     });
     m_buffer_sw.Start();
+    StartWorkerThread();
+}
+
+BuildTab::~BuildTab() { StopWorkerThread(); }
+
+void BuildTab::StartWorkerThread()
+{
+    m_shutdown.store(false);
+    m_workerThread = std::make_unique<std::thread>([this]() {
+        while (!m_shutdown.load()) {
+            std::function<void()> job;
+            if (m_workerQueue.ReceiveTimeout(100, job) == wxMSGQUEUE_NO_ERROR && job) {
+                job();
+            }
+        }
+    });
+}
+
+void BuildTab::StopWorkerThread()
+{
+    if (m_workerThread) {
+        m_shutdown.store(true);
+        m_workerThread->join();
+        m_workerThread.reset();
+    }
 }
 
 void BuildTab::OnBuildStarted(clBuildEvent& e)
 {
     e.Skip();
     m_buildInProgress = true;
-    m_currentRootDir.clear();
-    m_currentProjectName.clear();
 
     // clear all build markers
     IEditor::List_t all_editors;
@@ -55,9 +78,6 @@ void BuildTab::OnBuildStarted(clBuildEvent& e)
     ManagerST::Get()->ShowOutputPane(BUILD_WIN, true, false);
 
     m_buffer.clear();
-    if (e.IsCleanLog()) {
-        ClearView();
-    }
 
     // read the build tab settings
     EditorConfigST::Get()->ReadObject(wxT("BuildTabSettings"), &m_buildTabSettings);
@@ -72,8 +92,34 @@ void BuildTab::OnBuildStarted(clBuildEvent& e)
         clDEBUG() << "Active compiler is set to:" << m_activeCompiler->GetName() << endl;
     }
 
-    m_viewStc->Initialise(m_activeCompiler, m_buildTabSettings.IsSkipWarnings(), e.GetProjectName());
-    if (!m_activeCompiler) {
+    // the lines of this build are matched by the worker thread using its own copy of the patterns
+    m_matcher = m_activeCompiler ? m_activeCompiler->CreateOutputMatcher() : nullptr;
+
+    // the output of the previous build might still be on its way to the view
+    QueueAction([this, compiler = m_activeCompiler, clean_log = e.IsCleanLog(), project_name = e.GetProjectName()]() {
+        DoBuildStarted(compiler, clean_log, project_name);
+    });
+
+    // notify the plugins that the build had started
+    clBuildEvent build_started_event(wxEVT_BUILD_STARTED);
+    build_started_event.SetProjectName(e.GetProjectName());
+    build_started_event.SetConfigurationName(e.GetConfigurationName());
+    EventNotifier::Get()->AddPendingEvent(build_started_event);
+
+    // start stop watch
+    m_sw.Start();
+}
+
+void BuildTab::DoBuildStarted(CompilerPtr compiler, bool clean_log, const wxString& project_name)
+{
+    m_currentRootDir.clear();
+    m_currentProjectName.clear();
+    if (clean_log) {
+        m_viewStc->Clear();
+    }
+
+    m_viewStc->Initialise(compiler, m_buildTabSettings.IsSkipWarnings(), project_name);
+    if (!compiler) {
         clDEBUG() << "Compiler not selected in the workspace build settings or not available" << endl;
 
         // toolchain not selected in build configuration or unavailable
@@ -87,15 +133,6 @@ void BuildTab::OnBuildStarted(clBuildEvent& e)
         m_viewStc->Add(wxT("\n"));
         m_viewStc->ScrollToEnd();
     }
-
-    // notify the plugins that the build had started
-    clBuildEvent build_started_event(wxEVT_BUILD_STARTED);
-    build_started_event.SetProjectName(e.GetProjectName());
-    build_started_event.SetConfigurationName(e.GetConfigurationName());
-    EventNotifier::Get()->AddPendingEvent(build_started_event);
-
-    // start stop watch
-    m_sw.Start();
 }
 
 void BuildTab::OnBuildAddLine(clBuildEvent& e)
@@ -111,9 +148,15 @@ void BuildTab::OnBuildEnded(clBuildEvent& e)
     m_buildInProgress = false;
     ProcessBuffer(true);
 
+    // wait for the remaining lines before we summarise the build
+    QueueAction([this]() { DoBuildEnded(); });
+}
+
+void BuildTab::DoBuildEnded()
+{
     wxString text = CreateSummaryLine();
-    m_buffer.swap(text);
-    ProcessBuffer(true);
+    m_viewStc->Add(text, true);
+    m_viewStc->ScrollToEnd();
 
     if (m_buildTabSettings.GetScrollTo() == BuildTabSettingsData::SCROLL_TO_FIRST_ERROR) {
         m_viewStc->SelectFirstErrorOrWarning(0, m_buildTabSettings.IsSkipWarnings(), true);
@@ -129,18 +172,62 @@ void BuildTab::OnBuildEnded(clBuildEvent& e)
     m_currentRootDir.clear();
 }
 
-#define PROCESSBUFFER_FMT_LINES_MAX 8192
-#define PROCESSBUFFER_FLUSH_TIME 200 // ms
-
 void BuildTab::ProcessBuffer(bool last_line)
 {
-    auto remainder = m_viewStc->Add(m_buffer, last_line);
-    m_viewStc->ScrollToEnd();
+    wxString remainder;
+    auto step = std::make_shared<Step>();
+    step->lines = BuildTabView::SplitLines(m_buffer, last_line, remainder);
+    m_buffer.swap(remainder);
+    if (step->lines.empty()) {
+        return;
+    }
 
-    if (last_line) {
-        m_buffer.clear();
-    } else {
-        m_buffer.swap(remainder);
+    m_steps.push_back(step);
+
+    // strip and match the lines in the background, the view is updated on the main thread
+    m_workerQueue.Post([this, step, matcher = m_matcher]() {
+        for (auto& line : step->lines) {
+            BuildTabView::PrepareLine(line, matcher.get());
+        }
+
+        CallAfter([this, step]() {
+            step->ready = true;
+            FlushSteps();
+        });
+    });
+}
+
+void BuildTab::QueueAction(std::function<void()> action)
+{
+    if (m_steps.empty()) {
+        action();
+        return;
+    }
+
+    auto step = std::make_shared<Step>();
+    step->action = std::move(action);
+    step->ready = true;
+    m_steps.push_back(step);
+}
+
+void BuildTab::FlushSteps()
+{
+    bool lines_added = false;
+    while (!m_steps.empty() && m_steps.front()->ready) {
+        auto step = m_steps.front();
+        m_steps.pop_front();
+        if (!step->lines.empty() && !step->discard_lines) {
+            m_viewStc->AddLines(step->lines);
+            lines_added = true;
+        }
+
+        if (step->action) {
+            step->action();
+        }
+    }
+
+    if (lines_added) {
+        m_viewStc->ScrollToEnd();
     }
 }
 
@@ -164,6 +251,11 @@ void BuildTab::ClearView()
 {
     m_viewStc->Clear();
     m_buffer.clear();
+
+    // keep the pending actions (e.g. the build ended notification), but not the lines
+    for (auto& step : m_steps) {
+        step->discard_lines = true;
+    }
 }
 
 wxString BuildTab::WrapLineInColour(const wxString& line, int colour, bool fold_font) const
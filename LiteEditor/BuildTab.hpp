@@ -9,6 +9,12 @@
 #include "cl_editor.h"
 #include "compiler.h"
 
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <wx/msgqueue.h>
 #include <wx/panel.h>
 #include <wx/stopwatch.h>
 
@@ -16,7 +22,7 @@ class BuildTab : public wxPanel
 {
 public:
     BuildTab(wxWindow* parent);
-    ~BuildTab() = default;
+    ~BuildTab() override;
 
     void AppendLine(const wxString& text);
     void ClearView();
@@ -34,6 +40,12 @@ protected:
     void OnBuildEnded(clBuildEvent& e);
 
     void ProcessBuffer(bool last_line = false);
+    void QueueAction(std::function<void()> action);
+    void FlushSteps();
+    void DoBuildStarted(CompilerPtr compiler, bool clean_log, const wxString& project_name);
+    void DoBuildEnded();
+    void StartWorkerThread();
+    void StopWorkerThread();
     void Cleanup();
     void ProcessBuildingProjectLine(const wxString& line);
     bool ProcessCargoBuildLine(const wxString& line);
@@ -43,6 +55,15 @@ protected:
     wxString CreateSummaryLine();
 
 private:
+    /// The build output is stripped and matched against the compiler patterns by a worker thread. Steps (batches of
+    /// lines, build started / ended) are applied to the view in the order they were queued, once they are ready
+    struct Step {
+        std::vector<BuildTabLine> lines;
+        std::function<void()> action; // called after the lines were added to the view
+        bool ready = false;
+        bool discard_lines = false; // the view was cleared while the lines were prepared
+    };
+
     BuildTabSettingsData m_buildTabSettings;
     wxStopWatch m_sw;
 
@@ -55,6 +76,12 @@ private:
     wxString m_currentProjectName;
     wxString m_currentRootDir;
     BuildTabView* m_viewStc = nullptr;
+
+    std::unique_ptr<std::thread> m_workerThread;
+    wxMessageQueue<std::function<void()>> m_workerQueue;
+    std::atomic_bool m_shutdown{false};
+    clBuildOutputMatcher::Ptr_t m_matcher; // used by the worker thread
+    std::deque<std::shared_ptr<Step>> m_steps;
 };
 
 #endif // BUILDTAB_HPP
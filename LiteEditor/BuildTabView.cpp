@@ -152,32 +152,66 @@ void BuildTabView::InitialiseView()
 #define PROCESSBUFFER_FMT_LINES_MAX 8192
 #define PROCESSBUFFER_FLUSH_TIME 200 // ms
 
-wxString BuildTabView::Add(const wxString& output, bool process_last_line)
+std::vector<BuildTabLine> BuildTabView::SplitLines(const wxString& output, bool process_last_line, wxString& remainder)
 {
-    SetEditable(true);
     auto lines = ::wxStringTokenize(output, "\n", wxTOKEN_RET_DELIMS);
-    wxString remainder;
-    const size_t line_count = lines.Count();
-    bool is_dark_theme = DrawingUtils::IsDark(StyleGetBackground(0));
-    size_t cur_line_number = GetLineCount() - 1;
-
-    wxString textToAppend;
-    for (size_t i = 0; i < line_count; i++, cur_line_number++) {
+    std::vector<BuildTabLine> result;
+    result.reserve(lines.size());
+    for (size_t i = 0; i < lines.size(); i++) {
         auto& line = lines[i];
         if (!process_last_line && !line.EndsWith("\n")) {
             // not a complete line
             remainder.swap(line);
             break;
         }
-        line.Trim();
+        result.emplace_back();
+        result.back().line.swap(line);
+    }
+    return result;
+}
+
+void BuildTabView::PrepareLine(BuildTabLine& line, clBuildOutputMatcher* matcher)
+{
+    line.line.Trim();
+
+    // Remove unwanted ANSI OSC escape sequences
+    line.line = StringUtils::StripTerminalOSC(line.line);
+
+    // remove the terminal ANSI colouring escape code
+    StringUtils::StripTerminalColouring(line.line, line.stripped_line);
+
+    // Pass the "clean" line to the regex processor
+    line.matched = matcher && matcher->Matches(line.stripped_line, &line.match_pattern);
+}
+
+wxString BuildTabView::Add(const wxString& output, bool process_last_line)
+{
+    wxString remainder;
+    auto lines = SplitLines(output, process_last_line, remainder);
 
-        // Remove unwanted ANSI OSC escape sequences
-        line = StringUtils::StripTerminalOSC(line);
+    // Do not heavy process big lines count, no one will read results.
+    bool match_lines = lines.size() <= PROCESSBUFFER_FMT_LINES_MAX;
+    for (auto& line : lines) {
+        PrepareLine(line, match_lines ? m_matcher.get() : nullptr);
+    }
+    AddLines(lines);
+    return remainder;
+}
+
+void BuildTabView::AddLines(std::vector<BuildTabLine>& lines)
+{
+    SetEditable(true);
+    bool is_dark_theme = DrawingUtils::IsDark(StyleGetBackground(0));
+    size_t cur_line_number = GetLineCount() - 1;
+
+    wxString textToAppend;
+    for (size_t i = 0; i < lines.size(); i++, cur_line_number++) {
+        auto& line = lines[i].line;
 
         // easy path: check for common makefile messages
         wxString lcLine = line.Lower();
         if (lcLine.Contains("entering directory") || lcLine.Contains("leaving directory")) {
-            StringUtils::StripTerminalColouring(line, line);
+            line = lines[i].stripped_line;
 
             wxString directory_name = line.AfterFirst('\'');
             directory_name = directory_name.BeforeLast('\'');
@@ -198,13 +232,12 @@ wxString BuildTabView::Add(const wxString& output, bool process_last_line)
             textToAppend << line << "\n";
 
         } else if (lcLine.Contains(CLEAN_PROJECT_PREFIX)) {
-            StringUtils::StripTerminalColouring(line, line);
-            line = WrapLineInColour(line, AnsiColours::Gray(), false, is_dark_theme);
+            line = WrapLineInColour(lines[i].stripped_line, AnsiColours::Gray(), false, is_dark_theme);
             textToAppend << line << "\n";
 
         } else if (lcLine.Contains(BUILD_END_MSG) || lcLine.Contains("=== build completed") ||
                    lcLine.Contains("=== build ended")) {
-            StringUtils::StripTerminalColouring(line, line);
+            line = lines[i].stripped_line;
             if (m_errorCount > 0) {
                 // build ended with error
                 line = WrapLineInColour(line, AnsiColours::Red(), false, is_dark_theme);
@@ -222,28 +255,19 @@ wxString BuildTabView::Add(const wxString& output, bool process_last_line)
             line = WrapLineInColour(line, AnsiColours::Gray(), false, is_dark_theme);
             textToAppend << line << "\n";
 
-        } else if (line_count > PROCESSBUFFER_FMT_LINES_MAX) {
-            // Do not heavy process big lines count, no one will read results.
-            textToAppend << line;
-
         } else {
-            std::shared_ptr<LineClientData> line_data(new LineClientData);
-            line_data->message = line;
-            line_data->root_dir = wxEmptyString; // maybe empty string
-
-            // remove the terminal ANSI colouring escape code
-            wxString modified_line;
-            StringUtils::StripTerminalColouring(line, modified_line);
-            bool lineHasColours = (line.length() != modified_line.length());
+            std::shared_ptr<LineClientData> line_data;
+            bool lineHasColours = (line.length() != lines[i].stripped_line.length());
 
             if (!m_activeCompiler) {
                 clWARNING() << "(Build Tab View) No active compiler" << endl;
             }
 
-            // Pass the "clean" line to the regex processor
-            if (!m_activeCompiler || !m_activeCompiler->Matches(modified_line, &line_data->match_pattern)) {
-                line_data.reset();
-            } else {
+            if (lines[i].matched) {
+                line_data.reset(new LineClientData);
+                line_data->message = line;
+                line_data->root_dir = wxEmptyString; // maybe empty string
+                line_data->match_pattern = lines[i].match_pattern;
                 switch (line_data->match_pattern.sev) {
                 case Compiler::kSevError:
                     m_errorCount++;
@@ -287,7 +311,6 @@ wxString BuildTabView::Add(const wxString& output, bool process_last_line)
     }
 
     SetEditable(false);
-    return remainder;
 }
 
 void BuildTabView::Clear()
@@ -300,6 +323,7 @@ void BuildTabView::Clear()
     m_warnCount = 0;
     m_currentProject = wxEmptyString;
     m_activeCompiler = nullptr;
+    m_matcher.reset();
     m_workingDirectories.clear();
     m_isRemoteBuild = false;
     m_buildingProject.clear();
@@ -595,6 +619,7 @@ void BuildTabView::Initialise(CompilerPtr compiler, bool only_erros, const wxStr
 {
     Clear();
     m_activeCompiler = compiler; // maybe null
+    m_matcher = m_activeCompiler ? m_activeCompiler->CreateOutputMatcher() : nullptr;
     m_onlyErrors = only_erros;
     m_isRemoteBuild = false;
     m_buildingProject = project;
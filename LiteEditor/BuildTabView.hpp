@@ -1,5 +1,6 @@
 #pragma once
 
+#include "clBuildOutputMatcher.hpp"
 #include "clEditorEditEventsHandler.h"
 #include "compiler.h"
 
@@ -18,6 +19,15 @@ struct LineClientData {
     wxString toolchain;
 };
 
+/// A build output line, prepared by `BuildTabView::PrepareLine()`. This is the expensive part of adding a line to the
+/// view, so it can be done by a worker thread
+struct BuildTabLine {
+    wxString line;          // trimmed, without the OSC escape sequences
+    wxString stripped_line; // `line` without the ANSI colouring escape codes
+    bool matched = false;
+    Compiler::PatternMatch match_pattern;
+};
+
 class BuildTabView : public wxStyledTextCtrl
 {
 public:
@@ -34,6 +44,17 @@ public:
     /// it is returned for later processing (unless `process_last_line` is `true`)
     wxString Add(const wxString& output, bool process_last_line = false);
 
+    /// Append lines that were already prepared by `PrepareLine()`
+    void AddLines(std::vector<BuildTabLine>& lines);
+
+    /// Split `output` into lines. The last line is kept in `remainder` if it is not completed (unless
+    /// `process_last_line` is `true`)
+    static std::vector<BuildTabLine> SplitLines(const wxString& output, bool process_last_line, wxString& remainder);
+
+    /// Strip `line` and match it against the compiler patterns. This function does not access the view and it can be
+    /// called from any thread (but `matcher` must not be shared between threads)
+    static void PrepareLine(BuildTabLine& line, clBuildOutputMatcher* matcher);
+
     /// Clear the view and all parsed information
     void Clear();
 
@@ -69,6 +90,7 @@ protected:
 private:
     std::map<size_t, std::shared_ptr<LineClientData>> m_lineInfo;
     CompilerPtr m_activeCompiler;
+    clBuildOutputMatcher::Ptr_t m_matcher; // used by Add()
     bool m_onlyErrors = false;
     size_t m_errorCount = 0;
     size_t m_warnCount = 0;
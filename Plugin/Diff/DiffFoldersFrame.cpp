@@ -10,15 +10,12 @@
 #include "macros.h"
 #include "wxStringHash.h"
 
-#include <atomic>
-
 static int nCallCounter = 0;
-static std::atomic_bool checksumThreadStop;
 
 DiffFoldersFrame::DiffFoldersFrame(wxWindow* parent)
     : DiffFoldersBaseDlg(parent)
+    , m_hashCache(std::make_shared<clFileHashCache>())
 {
-    checksumThreadStop.store(false);
     m_toolbar->SetMiniToolBar(false);
 
     clBitmapList* images = new clBitmapList;
@@ -75,73 +72,13 @@ void DiffFoldersFrame::OnNewComparison(wxCommandEvent& event)
     }
 }
 
-#define CLOSE_FP(fp)      \
-    {                     \
-        if(fp) {          \
-            fclose(fp);   \
-            fp = nullptr; \
-        }                 \
-    }
-
-static bool CompareFilesCheckSum(const wxString& fn1, const wxString& fn2)
-{
-    // The sizes are the same
-    unsigned char checksum1 = 0;
-    unsigned char checksum2 = 0;
-
-    FILE* fp1 = fopen(fn1.mb_str(), "rb");
-    FILE* fp2 = fopen(fn2.mb_str(), "rb");
-    if(!fp1 || !fp2) {
-        CLOSE_FP(fp1);
-        CLOSE_FP(fp2);
-        return false;
-    }
-
-    while(!feof(fp1) && !ferror(fp1) && !feof(fp2) && !ferror(fp2)) {
-        checksum1 ^= fgetc(fp1);
-        checksum2 ^= fgetc(fp2);
-        if(checksum1 != checksum2) {
-            break;
-        }
-    }
-    CLOSE_FP(fp1);
-    CLOSE_FP(fp2);
-    return (checksum1 == checksum2);
-}
-
-static void HelperThreadCalculateChecksum(int callId, const wxArrayString& items, const wxString& left,
-                                          const wxString& right, DiffFoldersFrame* sink)
-{
-    wxArrayString results;
-    for(size_t i = 0; i < items.size(); ++i) {
-        if(checksumThreadStop.load()) {
-            break;
-        }
-        wxFileName fnLeft(left, items.Item(i));
-        wxFileName fnRight(right, items.Item(i));
-        if(fnLeft.IsOk() && fnLeft.FileExists() && fnRight.IsOk() && fnRight.FileExists()) {
-            if(fnLeft.GetSize() != fnRight.GetSize()) {
-                // If the size is different, no need to go further
-                results.Add("different");
-            } else {
-                bool isSame = CompareFilesCheckSum(fnLeft.GetFullPath(), fnRight.GetFullPath());
-                results.Add(isSame ? "same" : "different");
-            }
-        } else {
-            results.Add("n/a"); // Don't know
-        }
-    }
-    if(!checksumThreadStop.load()) {
-        sink->CallAfter(&DiffFoldersFrame::OnChecksum, callId, results);
-    }
-}
-
 void DiffFoldersFrame::BuildTrees(const wxString& left, const wxString& right)
 {
     StopChecksumThread();
     wxBusyCursor bc;
     m_dvListCtrl->DeleteAllItems();
     m_entries.clear();
+    m_rows.clear();
     m_dvListCtrl->SetSortFunction(nullptr);
     m_leftFolder = left;
     m_rightFolder = right;
@@ -188,7 +125,6 @@ void DiffFoldersFrame::BuildTrees(const wxString& left, const wxString& right)
 
     // Sort the merged list
     m_entries = viewList.ToSortedVector();
-    wxArrayString displayedItems;
     for(size_t i = 0; i < m_entries.size(); ++i) {
         cols.clear();
         const DiffViewEntry& entry = m_entries[i];
@@ -198,9 +134,6 @@ void DiffFoldersFrame::BuildTrees(const wxString& left, const wxString& right)
             continue;
         }
 
-        // This will be passed to the checksum thread
-        displayedItems.Add(entry.GetFullName());
-
         if(entry.IsExistsInLeft()) {
             cols.push_back(::MakeBitmapIndexText(entry.GetLeft().fullpath, entry.GetImageId(true)));
         } else {
@@ -212,11 +145,18 @@ void DiffFoldersFrame::BuildTrees(const wxString& left, const wxString& right)
         } else {
             cols.push_back(::MakeBitmapIndexText("", wxNOT_FOUND));
         }
-        m_dvListCtrl->AppendItem(cols, (wxUIntPtr)&entry);
+        m_rows.insert({ entry.GetFullName(), m_dvListCtrl->AppendItem(cols, (wxUIntPtr)&entry) });
     }
 
-    m_checksumThread = new std::thread(&HelperThreadCalculateChecksum, (++nCallCounter), displayedItems, m_leftFolder,
-                                       m_rightFolder, this);
+    // Compare the trees in the background, the rows are updated one folder at a time
+    int callId = ++nCallCounter;
+    auto compare = std::make_shared<clFolderCompare>(m_hashCache);
+    m_compare = compare;
+    m_checksumThread = new std::thread([this, compare, callId, left, right]() {
+        compare->Run(left, right, [this, callId](clFolderCompare::DirSummary&& summary) {
+            CallAfter(&DiffFoldersFrame::OnFolderSummary, callId, summary);
+        });
+    });
 }
 
 void DiffFoldersFrame::OnItemActivated(wxDataViewEvent& event)
@@ -335,22 +275,38 @@ void DiffFoldersFrame::OnCopyToLeft(wxCommandEvent& event)
     }
 }
 
-void DiffFoldersFrame::OnChecksum(int callId, const wxArrayString& checksumArray)
+void DiffFoldersFrame::OnFolderSummary(int callId, const clFolderCompare::DirSummary& summary)
 {
     if(callId != nCallCounter) {
         return;
     }
+
+    std::vector<wxString> modified;
+    if(summary.path.empty()) {
+        // the displayed folder itself
+        for(const auto& entry : summary.entries) {
+            if(entry.status == clFolderCompare::eStatus::kDifferent) {
+                modified.push_back(entry.name);
+            }
+        }
+    } else if(summary.HasDifferences()) {
+        // a sub folder: mark the displayed folder that contains it
+        modified.push_back(summary.path.BeforeFirst('/'));
+    }
+
+    if(modified.empty()) {
+        return;
+    }
+
     bool isDark = DrawingUtils::IsDark(m_dvListCtrl->GetColours().GetBgColour());
     wxColour modifiedColour = isDark ? wxColour("rgb(255, 128, 64)") : *wxRED;
-    for(size_t i = 0; i < checksumArray.size(); ++i) {
-        const wxString& answer = checksumArray.Item(i);
-        if(answer == "different") {
-            wxDataViewItem item = m_dvListCtrl->RowToItem(i);
-            if(item.IsOk()) {
-                m_dvListCtrl->SetItemTextColour(item, modifiedColour, 0);
-                m_dvListCtrl->SetItemTextColour(item, modifiedColour, 1);
-            }
+    for(const wxString& name : modified) {
+        auto where = m_rows.find(name);
+        if(where == m_rows.end() || !where->second.IsOk()) {
+            continue;
         }
+        m_dvListCtrl->SetItemTextColour(where->second, modifiedColour, 0);
+        m_dvListCtrl->SetItemTextColour(where->second, modifiedColour, 1);
     }
 }
 
@@ -367,12 +323,14 @@ void DiffFoldersFrame::OnRefreshUI(wxUpdateUIEvent& event)
 
 void DiffFoldersFrame::StopChecksumThread()
 {
-    checksumThreadStop.store(false);
+    if(m_compare) {
+        m_compare->Stop();
+    }
     if(m_checksumThread) {
         m_checksumThread->join();
     }
-    checksumThreadStop.store(false);
     wxDELETE(m_checksumThread);
+    m_compare.reset();
 }
 
 void DiffFoldersFrame::OnUpFolder(wxCommandEvent& event)
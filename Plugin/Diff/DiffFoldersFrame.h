@@ -4,11 +4,14 @@
 #include "DiffUI.h"
 #include "bitmap_loader.h"
 #include "clFilesCollector.h"
+#include "clFolderCompare.h"
 #include "codelite_exports.h"
 #include "globals.h"
 #include "imanager.h"
 
+#include <memory>
 #include <thread>
+#include <unordered_map>
 
 struct WXDLLIMPEXP_SDK DiffViewEntry {
 protected:
@@ -107,13 +110,18 @@ class WXDLLIMPEXP_SDK DiffFoldersFrame : public DiffFoldersBaseDlg
     size_t m_depth = 0;
     bool m_showSimilarItems = false;
     std::thread* m_checksumThread = nullptr;
+    std::shared_ptr<clFolderCompare> m_compare;
+    // kept between comparisons, so a refresh only hashes the files that were modified
+    std::shared_ptr<clFileHashCache> m_hashCache;
     DiffViewEntry::Vect_t m_entries;
+    // the displayed rows, by name
+    std::unordered_map<wxString, wxDataViewItem> m_rows;
 
 public:
     explicit DiffFoldersFrame(wxWindow* parent);
     ~DiffFoldersFrame() override;
 
-    void OnChecksum(int callId, const wxArrayString& checksumArray);
+    void OnFolderSummary(int callId, const clFolderCompare::DirSummary& summary);
 protected:
     void BuildTrees(const wxString& left, const wxString& right);
     void DoOpenDiff(const wxDataViewItem& item);
@@ -62,6 +62,9 @@
 
 #define NUMBER_MARGIN_ID 0
 
+// the diff thread posts its result to the views in chunks of (at least) this many lines
+#define DIFF_CHUNK_LINES 5000
+
 DiffSideBySidePanel::DiffSideBySidePanel(wxWindow* parent)
     : DiffSideBySidePanelBase(parent)
     , m_darkTheme(false)
@@ -179,6 +182,9 @@ DiffSideBySidePanel::DiffSideBySidePanel(wxWindow* parent)
 
 DiffSideBySidePanel::~DiffSideBySidePanel()
 {
+    // the diff thread reads the files, some of them are deleted below
+    StopDiffThread();
+
     if ((m_flags & kDeleteLeftOnExit)) {
         clRemoveFile(m_textCtrlLeftFile->GetValue());
     }
@@ -222,23 +228,140 @@ void DiffSideBySidePanel::Diff()
         return;
     }
 
+    // A diff that is still running is for the previous files (or settings)
+    StopDiffThread();
+
     // Cleanup
     DoClean();
 
     // Prepare the views
     PrepareViews();
 
-    // Prepare the diff
-    clDTL d;
-    d.Diff(m_textCtrlLeftFile->GetValue(),
-           m_textCtrlRightFile->GetValue(),
-           m_config.IsSingleViewMode() ? clDTL::kOnePane : clDTL::kTwoPanes);
-    clDTL::LineInfoVec_t& resultLeft = const_cast<clDTL::LineInfoVec_t&>(d.GetResultLeft());
-    clDTL::LineInfoVec_t& resultRight = const_cast<clDTL::LineInfoVec_t&>(d.GetResultRight());
-    m_sequences = d.GetSequences();
+    // The files are read and compared in the background. The diff thread builds the views content and markers part
+    // by part, as the changes are found, and posts them to the views in chunks. The whole diff result is never held
+    // in memory.
+    // If the user wants to ignore whitespace diffs, the changed lines that only differ by whitespace are unmarked.
+    // Note that this doesn't work in single-view mode where each change is shown on 2 lines, before & after.
+    // Having those unmarked would be very confusing
+    const bool ignoreWhitespace = m_config.IsIgnoreWhitespace() && !m_config.IsSingleViewMode();
+    const clDTL::DiffMode mode = m_config.IsSingleViewMode() ? clDTL::kOnePane : clDTL::kTwoPanes;
+    int callId = ++m_diffCallId;
+    m_diffThread = new std::thread([this, callId, fnLeft, fnRight, mode, ignoreWhitespace]() {
+        DiffChunk chunk;
+        size_t firstLine = 0; // the line number of the first line of the current part of the result
+
+        auto onResult = [&](clDTL::LineInfoVec_t& resultLeft, clDTL::LineInfoVec_t& resultRight, bool is_change) {
+            if (m_stopDiff.load()) {
+                // the diff itself can't be interrupted, but there is no point in building the result
+                return;
+            }
+
+            if (is_change) {
+                chunk.sequences.push_back(std::make_pair((int)firstLine, (int)(firstLine + resultLeft.size())));
+            }
+
+            if (is_change && ignoreWhitespace) {
+                for (size_t l = 0, r = 0; (l < resultLeft.size()) && (r < resultRight.size()); ++l, ++r) {
+                    if (resultLeft.at(l).m_type == clDTL::LINE_REMOVED ||
+                        resultLeft.at(l).m_type == clDTL::LINE_ADDED) {
+                        wxString left(resultLeft.at(l).m_line);
+                        left.Replace(" ", "");
+                        left.Replace("\t", "");
+                        left.Replace("\r", "");
+                        wxString right(resultRight.at(r).m_line);
+                        right.Replace(" ", "");
+                        right.Replace("\t", "");
+                        right.Replace("\r", "");
+                        if (left == right) {
+                            resultLeft.at(l).m_type = clDTL::LINE_COMMON;
+                            resultRight.at(r).m_type = clDTL::LINE_COMMON;
+                        }
+                    }
+                }
+            }
+
+            // The left pane is always the one with the deletions "-"
+            for (size_t n = 0; n < resultLeft.size(); ++n) {
+                int i = firstLine + n;
+                chunk.left << resultLeft.at(n).m_line;
+                if (resultLeft.at(n).m_type == clDTL::LINE_ADDED) {
+                    chunk.leftGreenMarkers.push_back(i);
+
+                } else if (resultLeft.at(n).m_type == clDTL::LINE_REMOVED) {
+                    chunk.leftRedMarkers.push_back(i);
+
+                } else if (resultLeft.at(n).m_type == clDTL::LINE_PLACEHOLDER) {
+                    chunk.leftPlaceholdersMarkers.push_back(i);
+                }
+            }
+
+            // The right pane is always with the new additions "+"
+            for (size_t n = 0; n < resultRight.size(); ++n) {
+                int i = firstLine + n;
+                chunk.right << resultRight.at(n).m_line;
+                if (resultRight.at(n).m_type == clDTL::LINE_REMOVED) {
+                    chunk.rightRedMarkers.push_back(i);
+
+                } else if (resultRight.at(n).m_type == clDTL::LINE_ADDED) {
+                    chunk.rightGreenMarkers.push_back(i);
+
+                } else if (resultRight.at(n).m_type == clDTL::LINE_PLACEHOLDER) {
+                    chunk.rightPlaceholdersMarkers.push_back(i);
+                }
+            }
+
+            size_t count = wxMax(resultLeft.size(), resultRight.size());
+            chunk.linesCount += count;
+            firstLine += count;
+            if (chunk.linesCount >= DIFF_CHUNK_LINES) {
+                CallAfter(&DiffSideBySidePanel::OnDiffChunk, callId, chunk);
+                chunk = {};
+            }
+        };
+
+        clDTL d;
+        d.Diff(fnLeft, fnRight, mode, onResult);
+        if (m_stopDiff.load()) {
+            return;
+        }
+
+        if (chunk.linesCount) {
+            CallAfter(&DiffSideBySidePanel::OnDiffChunk, callId, chunk);
+        }
+        CallAfter(&DiffSideBySidePanel::OnDiffDone, callId);
+    });
+}
+
+void DiffSideBySidePanel::OnDiffChunk(int callId, const DiffChunk& chunk)
+{
+    if (callId != m_diffCallId) {
+        // a chunk of a diff that was stopped
+        return;
+    }
+
+    m_sequences.insert(m_sequences.end(), chunk.sequences.begin(), chunk.sequences.end());
+    UpdateViews(chunk);
+
+    if (m_cur_sequence == wxNOT_FOUND && !m_sequences.empty()) {
+        // Select the first diff
+        wxCommandEvent dummy;
+        OnNextDiffSequence(dummy);
+    }
+}
+
+void DiffSideBySidePanel::OnDiffDone(int callId)
+{
+    if (callId != m_diffCallId) {
+        return;
+    }
+
+    // the thread posted this as its last action
+    StopDiffThread();
 
     if (m_sequences.empty()) {
         // Files are the same !
+        wxFileName fnLeft(m_textCtrlLeftFile->GetValue());
+        wxFileName fnRight(m_textCtrlRightFile->GetValue());
         m_stcLeft->SetReadOnly(false);
         m_stcRight->SetReadOnly(false);
 
@@ -267,87 +390,18 @@ void DiffSideBySidePanel::Diff()
         return;
     }
 
-    if (m_config.IsIgnoreWhitespace() && !m_config.IsSingleViewMode()) {
-        // If the user wants to ignore whitespace diffs, go through first to remove them
-        // Note that this doesn't work in single-view mode where each change is shown on
-        // 2 lines, before & after. Having those unmarked would be very confusing
-        for (size_t l = 0, r = 0; (l < resultLeft.size()) && (r < resultRight.size()); ++l, ++r) {
-            if (resultLeft.at(l).m_type == clDTL::LINE_REMOVED || resultLeft.at(l).m_type == clDTL::LINE_ADDED) {
-                wxString left(resultLeft.at(l).m_line);
-                left.Replace(" ", "");
-                left.Replace("\t", "");
-                left.Replace("\r", "");
-                wxString right(resultRight.at(r).m_line);
-                right.Replace(" ", "");
-                right.Replace("\t", "");
-                right.Replace("\r", "");
-                if (left == right) {
-                    resultLeft.at(l).m_type = clDTL::LINE_COMMON;
-                    resultRight.at(r).m_type = clDTL::LINE_COMMON;
-                }
-            }
-        }
-    }
-
-    m_cur_sequence = 0; // the first line of the sequence
-
-    // Create 2 strings "left" and "right"
-    wxString leftContent, rightContent;
-
-    m_overviewPanelMarkers.SetCount(wxMax(resultLeft.size(), resultRight.size()) + 1, 0);
-
-    // The left pane is always the one with the deletions "-"
-    for (size_t i = 0; i < resultLeft.size(); ++i) {
-        if (resultLeft.at(i).m_type == clDTL::LINE_ADDED) {
-            leftContent << resultLeft.at(i).m_line;
-            m_leftGreenMarkers.push_back(i);
-            m_overviewPanelMarkers.Item(i) = 1;
-
-        } else if (resultLeft.at(i).m_type == clDTL::LINE_REMOVED) {
-            leftContent << resultLeft.at(i).m_line;
-            m_leftRedMarkers.push_back(i);
-            m_overviewPanelMarkers.Item(i) = 1;
-
-        } else if (resultLeft.at(i).m_type == clDTL::LINE_PLACEHOLDER) {
-            // PLACEHOLDER
-            leftContent << resultLeft.at(i).m_line;
-            m_leftPlaceholdersMarkers.push_back(i);
-
-        } else {
-            // COMMON
-            leftContent << resultLeft.at(i).m_line;
-        }
-    }
-
-    // The right pane is always with the new additions "+"
-    for (size_t i = 0; i < resultRight.size(); ++i) {
-        if (resultRight.at(i).m_type == clDTL::LINE_REMOVED) {
-            rightContent << resultRight.at(i).m_line;
-            m_rightRedMarkers.push_back(i);
-            m_overviewPanelMarkers.Item(i) = 1;
-
-        } else if (resultRight.at(i).m_type == clDTL::LINE_ADDED) {
-            rightContent << resultRight.at(i).m_line;
-            m_rightGreenMarkers.push_back(i);
-            m_overviewPanelMarkers.Item(i) = 1;
-
-        } else if (resultRight.at(i).m_type == clDTL::LINE_PLACEHOLDER) {
-            rightContent << resultRight.at(i).m_line;
-            m_rightPlaceholdersMarkers.push_back(i);
+    m_overviewPanelMarkers.Add(0);
+    Refresh();
+}
 
-        } else {
-            // COMMON
-            rightContent << resultRight.at(i).m_line;
-        }
+void DiffSideBySidePanel::StopDiffThread()
+{
+    m_stopDiff.store(true);
+    if (m_diffThread) {
+        m_diffThread->join();
     }
-    UpdateViews(leftContent, rightContent);
-    m_stcLeft->SetSavePoint();
-    m_stcRight->SetSavePoint();
-
-    // Select the first diff
-    wxCommandEvent dummy;
-    m_cur_sequence = -1;
-    OnNextDiffSequence(dummy);
+    wxDELETE(m_diffThread);
+    m_stopDiff.store(false);
 }
 
 void DiffSideBySidePanel::PrepareViews()
@@ -426,47 +480,47 @@ void DiffSideBySidePanel::DefineMarkers(wxStyledTextCtrl* ctrl)
     ctrl->MarkerSetBackground(MARKER_SEQUENCE_VERTICAL, sideMarker);
 }
 
-void DiffSideBySidePanel::UpdateViews(const wxString& left, const wxString& right)
+void DiffSideBySidePanel::UpdateViews(const DiffChunk& chunk)
 {
     m_stcLeft->SetEditable(true);
     m_stcRight->SetEditable(true);
 
-    m_stcLeft->SetText(left);
-    m_stcLeft->MarkerDeleteAll(RED_MARKER);
-
-    m_stcRight->SetText(right);
-    m_stcRight->MarkerDeleteAll(GREEN_MARKER);
+    m_stcLeft->AppendText(chunk.left);
+    m_stcRight->AppendText(chunk.right);
 
     // Show whitespaces
     m_stcRight->SetViewWhiteSpace(wxSTC_WS_VISIBLEALWAYS);
     m_stcLeft->SetViewWhiteSpace(wxSTC_WS_VISIBLEALWAYS);
 
     // apply the markers
-    for (size_t i = 0; i < m_leftRedMarkers.size(); ++i) {
-        int line = m_leftRedMarkers.at(i);
-        m_stcLeft->MarkerAdd(line, RED_MARKER);
-    }
-    for (size_t i = 0; i < m_leftGreenMarkers.size(); ++i) {
-        int line = m_leftGreenMarkers.at(i);
-        m_stcLeft->MarkerAdd(line, GREEN_MARKER);
-    }
-    for (size_t i = 0; i < m_leftPlaceholdersMarkers.size(); ++i) {
-        int line = m_leftPlaceholdersMarkers.at(i);
-        m_stcLeft->MarkerAdd(line, PLACE_HOLDER_MARKER);
-    }
-    for (size_t i = 0; i < m_rightGreenMarkers.size(); ++i) {
-        int line = m_rightGreenMarkers.at(i);
-        m_stcRight->MarkerAdd(line, GREEN_MARKER);
-    }
-    for (size_t i = 0; i < m_rightRedMarkers.size(); ++i) {
-        int line = m_rightRedMarkers.at(i);
-        m_stcRight->MarkerAdd(line, RED_MARKER);
-    }
-    for (size_t i = 0; i < m_rightPlaceholdersMarkers.size(); ++i) {
-        int line = m_rightPlaceholdersMarkers.at(i);
-        m_stcRight->MarkerAdd(line, PLACE_HOLDER_MARKER);
+    auto addMarkers = [](wxStyledTextCtrl* stc, const Markers_t& lines, int marker, Markers_t& markers) {
+        for (int line : lines) {
+            stc->MarkerAdd(line, marker);
+        }
+        markers.insert(markers.end(), lines.begin(), lines.end());
+    };
+    addMarkers(m_stcLeft, chunk.leftRedMarkers, RED_MARKER, m_leftRedMarkers);
+    addMarkers(m_stcLeft, chunk.leftGreenMarkers, GREEN_MARKER, m_leftGreenMarkers);
+    addMarkers(m_stcLeft, chunk.leftPlaceholdersMarkers, PLACE_HOLDER_MARKER, m_leftPlaceholdersMarkers);
+    addMarkers(m_stcRight, chunk.rightGreenMarkers, GREEN_MARKER, m_rightGreenMarkers);
+    addMarkers(m_stcRight, chunk.rightRedMarkers, RED_MARKER, m_rightRedMarkers);
+    addMarkers(m_stcRight, chunk.rightPlaceholdersMarkers, PLACE_HOLDER_MARKER, m_rightPlaceholdersMarkers);
+
+    // the overview bar marks every changed line
+    m_overviewPanelMarkers.Add(0, chunk.linesCount);
+    for (const Markers_t* lines : { &chunk.leftRedMarkers,
+                                    &chunk.leftGreenMarkers,
+                                    &chunk.rightRedMarkers,
+                                    &chunk.rightGreenMarkers }) {
+        for (int line : *lines) {
+            m_overviewPanelMarkers.Item(line) = 1;
+        }
     }
 
+    // appending is not a user modification
+    m_stcLeft->SetSavePoint();
+    m_stcRight->SetSavePoint();
+
     // Restore the 'read-only' state
     m_stcLeft->SetEditable(false);
     m_stcRight->SetEditable(false);
@@ -32,6 +32,8 @@
 #include "clToolBar.h"
 #include "wxcrafter_plugin.h"
 
+#include <atomic>
+#include <thread>
 #include <vector>
 #include <wx/filename.h>
 
@@ -46,6 +48,22 @@ class WXDLLIMPEXP_SDK DiffSideBySidePanel : public DiffSideBySidePanelBase
 
     using Markers_t = std::vector<int>;
 
+    /**
+     * @brief a part of the diff result, as built by the diff thread. The line numbers are the views line numbers
+     */
+    struct DiffChunk {
+        wxString left;
+        wxString right;
+        size_t linesCount = 0;
+        Markers_t leftRedMarkers;
+        Markers_t leftGreenMarkers;
+        Markers_t leftPlaceholdersMarkers;
+        Markers_t rightGreenMarkers;
+        Markers_t rightRedMarkers;
+        Markers_t rightPlaceholdersMarkers;
+        std::vector<std::pair<int, int>> sequences;
+    };
+
 public:
     struct FileInfo {
         wxFileName filename;
@@ -112,6 +130,10 @@ protected:
     FileInfo m_left;
     FileInfo m_right;
 
+    std::thread* m_diffThread = nullptr;
+    std::atomic_bool m_stopDiff{ false };
+    int m_diffCallId = 0;
+
 protected:
     virtual void OnBrowseLeftFile(wxCommandEvent& event);
     virtual void OnBrowseRightFile(wxCommandEvent& event);
@@ -169,8 +191,14 @@ public:
     void OnPageClosing(wxNotifyEvent& event);
 
     void PrepareViews();
-    void UpdateViews(const wxString& left, const wxString& right);
+    /**
+     * @brief append a part of the diff result to the views
+     */
+    void UpdateViews(const DiffChunk& chunk);
     void DoClean();
+    void StopDiffThread();
+    void OnDiffChunk(int callId, const DiffChunk& chunk);
+    void OnDiffDone(int callId);
     void DoDrawSequenceMarkers(int firstLine, int lastLine, wxStyledTextCtrl* ctrl);
     void DoCopyCurrentSequence(wxStyledTextCtrl* from, wxStyledTextCtrl* to);
     void DoCopyFileContent(wxStyledTextCtrl* from, wxStyledTextCtrl* to);
@@ -188,7 +216,8 @@ public:
 
     void DoLayout();
     /**
-     * @brief display a diff view for 2 files left and right
+     * @brief display a diff view for 2 files left and right. The files are compared in the background and the
+     * views are filled as the result arrives
      */
     void Diff();
 
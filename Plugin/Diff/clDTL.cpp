@@ -25,13 +25,19 @@
 
 #include "clDTL.h"
 
-#include "dtl/dtl.hpp"
+#include "clLineDiff.h"
 #include "fileutils.h"
 
+#include <algorithm>
 #include <wx/ffile.h>
-#include <wx/tokenzr.h>
 #include <wx/utils.h>
 
+namespace
+{
+// long runs of common lines are reported in batches of this size
+constexpr size_t COMMON_LINES_BATCH = 4096;
+} // namespace
+
 void clDTL::Diff(const wxFileName& fnLeft, const wxFileName& fnRight, DiffMode mode)
 {
     wxString leftFile, rightFile;
@@ -40,208 +46,106 @@ void clDTL::Diff(const wxFileName& fnLeft, const wxFileName& fnRight, DiffMode m
     DiffStrings(leftFile, rightFile, mode);
 }
 
+void clDTL::Diff(const wxFileName& fnLeft, const wxFileName& fnRight, DiffMode mode, const ResultCallback& on_result)
+{
+    wxString leftFile, rightFile;
+    if(!FileUtils::ReadFileContent(fnLeft, leftFile) || !FileUtils::ReadFileContent(fnRight, rightFile))
+        return;
+    DiffStrings(leftFile, rightFile, mode, on_result);
+}
+
 void clDTL::DiffStrings(const wxString& before, const wxString& after, DiffMode mode)
 {
     m_resultLeft.clear();
     m_resultRight.clear();
     m_sequences.clear();
 
-    using elem = wxString;
-    using sesElem = std::pair<elem, dtl::elemInfo>;
-
-    wxArrayString leftLines = wxStringTokenize(before, "\n", wxTOKEN_RET_DELIMS);
-    wxArrayString rightLines = wxStringTokenize(after, "\n", wxTOKEN_RET_DELIMS);
-
-    std::vector<elem> leftLinesVec;
-    std::vector<elem> rightLinesVec;
-    leftLinesVec.insert(leftLinesVec.end(), leftLines.begin(), leftLines.end());
-    rightLinesVec.insert(rightLinesVec.end(), rightLines.begin(), rightLines.end());
-
-    dtl::Diff<elem, std::vector<elem>> diff(leftLinesVec, rightLinesVec);
-    diff.onHuge();
-    diff.compose();
-
-    if(0 == diff.getEditDistance()) {
-        // nothing to be done - files are identical
-        return;
-    }
-
-    if(mode & clDTL::kTwoPanes) {
-
-        ///////////////////////////////////////////////////////////////////
-        // Two panes diff
-        // designed for displayed on a two panes view where on the left
-        // pane all deletions while on the right pane all the new lines
-        ///////////////////////////////////////////////////////////////////
-
-        // Loop over the diff and check if it is a whitespace only diff
-        std::vector<sesElem> seq = diff.getSes().getSequence();
-        m_resultLeft.reserve(seq.size());
-        m_resultRight.reserve(seq.size());
-
-        const int STATE_NONE = 0;
-        const int STATE_IN_SEQ = 1;
-
-        int state = STATE_NONE;
-        int seqStartLine = wxNOT_FOUND;
-        size_t seqSize = 0;
-
-        LineInfoVec_t tmpSeqLeft;
-        LineInfoVec_t tmpSeqRight;
-
-        for(size_t i = 0; i < seq.size(); ++i) {
-            switch(seq.at(i).second.type) {
-            case dtl::SES_COMMON: {
-                if(state == STATE_IN_SEQ) {
-
-                    // set the sequence size
-                    seqSize = ::wxMax(tmpSeqLeft.size(), tmpSeqRight.size());
-
-                    m_sequences.push_back(std::make_pair(seqStartLine, seqStartLine + seqSize));
-                    seqStartLine = wxNOT_FOUND;
-                    state = STATE_NONE;
-
-                    // increase the buffer size
-                    tmpSeqLeft.resize(seqSize);
-                    tmpSeqRight.resize(seqSize);
-
-                    m_resultLeft.insert(m_resultLeft.end(), tmpSeqLeft.begin(), tmpSeqLeft.end());
-                    m_resultRight.insert(m_resultRight.end(), tmpSeqRight.begin(), tmpSeqRight.end());
-
-                    tmpSeqLeft.clear();
-                    tmpSeqRight.clear();
-                    seqSize = 0;
-                }
-                clDTL::LineInfo line(seq.at(i).first, LINE_COMMON);
-                m_resultLeft.push_back(line);
-                m_resultRight.push_back(line);
-                break;
-            }
-            case dtl::SES_ADD: {
-                clDTL::LineInfo lineRight(seq.at(i).first, LINE_ADDED);
-                tmpSeqRight.push_back(lineRight);
-
-                if(state == STATE_NONE) {
-                    seqStartLine = m_resultLeft.size();
-                    state = STATE_IN_SEQ;
-                }
-                break;
-            }
-            case dtl::SES_DELETE: {
-                clDTL::LineInfo lineLeft(seq.at(i).first, LINE_REMOVED);
-                tmpSeqLeft.push_back(lineLeft);
+    DiffStrings(before, after, mode, [this](LineInfoVec_t& left, LineInfoVec_t& right, bool is_change) {
+        if(is_change) {
+            m_sequences.push_back(std::make_pair(m_resultLeft.size(), m_resultLeft.size() + left.size()));
+        }
+        m_resultLeft.insert(m_resultLeft.end(), std::make_move_iterator(left.begin()),
+                            std::make_move_iterator(left.end()));
+        m_resultRight.insert(m_resultRight.end(), std::make_move_iterator(right.begin()),
+                             std::make_move_iterator(right.end()));
+    });
+}
 
-                if(state == STATE_NONE) {
-                    seqStartLine = m_resultLeft.size();
-                    state = STATE_IN_SEQ;
+void clDTL::DiffStrings(const wxString& before, const wxString& after, DiffMode mode, const ResultCallback& on_result)
+{
+    clLineDiff diff;
+    diff.SetInputs(before, after);
+
+    const bool twoPanes = (mode & clDTL::kTwoPanes);
+    LineInfoVec_t left;
+    LineInfoVec_t right;
+
+    // the common lines are only reported once a change follows them: identical inputs report nothing
+    size_t commonStart = 0;
+    auto reportCommon = [&](size_t commonEnd) {
+        while(commonStart < commonEnd) {
+            size_t batchEnd = std::min(commonEnd, commonStart + COMMON_LINES_BATCH);
+            left.clear();
+            right.clear();
+            for(size_t i = commonStart; i < batchEnd; ++i) {
+                left.push_back(LineInfo(diff.GetLeftLine(i), LINE_COMMON));
+                if(twoPanes) {
+                    right.push_back(left.back());
                 }
-                break;
-            }
             }
+            commonStart = batchEnd;
+            on_result(left, right, false);
         }
+    };
 
-        if(state == STATE_IN_SEQ) {
-            // set the sequence size
-            seqSize = ::wxMax(tmpSeqLeft.size(), tmpSeqRight.size());
-            if(seqSize) {
-                m_sequences.push_back(std::make_pair(seqStartLine, seqStartLine + seqSize));
-                seqStartLine = wxNOT_FOUND;
-                state = STATE_NONE;
-
-                // increase the buffer size
-                tmpSeqLeft.resize(seqSize);
-                tmpSeqRight.resize(seqSize);
+    bool changed = false;
+    diff.Run([&](const clLineDiff::Hunk& hunk) {
+        changed = true;
+        reportCommon(hunk.left_start);
 
-                m_resultLeft.insert(m_resultLeft.end(), tmpSeqLeft.begin(), tmpSeqLeft.end());
-                m_resultRight.insert(m_resultRight.end(), tmpSeqRight.begin(), tmpSeqRight.end());
+        left.clear();
+        right.clear();
+        for(size_t i = 0; i < hunk.left_count; ++i) {
+            left.push_back(LineInfo(diff.GetLeftLine(hunk.left_start + i), LINE_REMOVED));
+        }
 
-                tmpSeqLeft.clear();
-                tmpSeqRight.clear();
-                seqSize = 0;
-            }
+        // Two panes: all the deletions on the left pane and all the new lines on the right pane, the shorter
+        // side is padded with placeholders. One pane: the deletions are followed by the new lines
+        LineInfoVec_t& added = twoPanes ? right : left;
+        for(size_t i = 0; i < hunk.right_count; ++i) {
+            added.push_back(LineInfo(diff.GetRightLine(hunk.right_start + i), LINE_ADDED));
         }
-    } else {
-        ///////////////////////////////////////////////////////////////////
-        // One pane diff view
-        // designed for displayed on a single editor
-        ///////////////////////////////////////////////////////////////////
-        std::vector<sesElem> seq = diff.getSes().getSequence();
-        m_resultLeft.reserve(seq.size());
-        int seqStartLine = wxNOT_FOUND;
-        for(size_t i = 0; i < seq.size(); ++i) {
-            switch(seq.at(i).second.type) {
-            case dtl::SES_COMMON: {
-                if(seqStartLine != wxNOT_FOUND) {
-                    m_sequences.push_back(std::make_pair(seqStartLine, m_resultLeft.size()));
-                    seqStartLine = wxNOT_FOUND;
-                }
-                clDTL::LineInfo line(seq.at(i).first, LINE_COMMON);
-                m_resultLeft.push_back(line);
-                break;
-            }
-            case dtl::SES_ADD: {
-                if(seqStartLine == wxNOT_FOUND) {
-                    seqStartLine = m_resultLeft.size();
-                }
-                clDTL::LineInfo line(seq.at(i).first, LINE_ADDED);
-                m_resultLeft.push_back(line);
-                break;
-            }
-            case dtl::SES_DELETE: {
-                if(seqStartLine == wxNOT_FOUND) {
-                    seqStartLine = m_resultLeft.size();
-                }
-                clDTL::LineInfo line(seq.at(i).first, LINE_REMOVED);
-                m_resultLeft.push_back(line);
-                break;
-            }
-            }
+        if(twoPanes) {
+            size_t seqSize = std::max(left.size(), right.size());
+            left.resize(seqSize);
+            right.resize(seqSize);
         }
 
-        if(seqStartLine != wxNOT_FOUND) {
-            m_sequences.push_back(std::make_pair(seqStartLine, m_resultLeft.size()));
-            seqStartLine = wxNOT_FOUND;
-        }
+        commonStart = hunk.left_start + hunk.left_count;
+        on_result(left, right, true);
+    });
+
+    if(changed) {
+        reportCommon(diff.GetLeftLinesCount());
     }
 }
 
 std::vector<PatchStep> clDTL::CreatePatch(const wxString& before, const wxString& after) const
 {
-    using elem = wxString;
-    using sesElem = std::pair<elem, dtl::elemInfo>;
+    clLineDiff diff;
+    diff.SetInputs(before, after);
 
-    wxArrayString leftLines = wxStringTokenize(before, "\n", wxTOKEN_RET_DELIMS);
-    wxArrayString rightLines = wxStringTokenize(after, "\n", wxTOKEN_RET_DELIMS);
-
-    std::vector<elem> leftLinesVec;
-    std::vector<elem> rightLinesVec;
-    leftLinesVec.insert(leftLinesVec.end(), leftLines.begin(), leftLines.end());
-    rightLinesVec.insert(rightLinesVec.end(), rightLines.begin(), rightLines.end());
-
-    dtl::Diff<elem, std::vector<elem>> diff(leftLinesVec, rightLinesVec);
-    diff.onHuge();
-    diff.compose();
-
-    std::vector<sesElem> sesSeq = diff.getSes().getSequence();
-
-    int line = 0;
+    // the steps are applied one after the other: at the start of a hunk, the lines before it already match
+    // `after`, so the hunk starts at its line number in `after`
     std::vector<PatchStep> steps;
-    steps.reserve(sesSeq.size() * 2);
-    for(auto sesIt = sesSeq.begin(); sesIt != sesSeq.end(); ++sesIt, ++line) {
-        switch(sesIt->second.type) {
-        case dtl::SES_ADD: {
-            steps.push_back({ line, PatchAction::ADD_LINE, sesIt->first });
-            break;
-        }
-        case dtl::SES_DELETE: {
+    diff.Run([&](const clLineDiff::Hunk& hunk) {
+        int line = hunk.right_start;
+        for(size_t i = 0; i < hunk.left_count; ++i) {
             steps.push_back({ line, PatchAction::DELETE_LINE, wxEmptyString });
-            --line;
-            break;
         }
-        case dtl::SES_COMMON:
-        default:
-            break;
+        for(size_t i = 0; i < hunk.right_count; ++i, ++line) {
+            steps.push_back({ line, PatchAction::ADD_LINE, diff.GetRightLine(hunk.right_start + i) });
         }
-    }
+    });
     return steps;
 }
@@ -28,6 +28,7 @@
 
 #include "codelite_exports.h"
 
+#include <functional>
 #include <vector>
 #include <wx/filename.h>
 #include <wx/string.h>
@@ -93,6 +94,13 @@ public:
 
     enum DiffMode { kTwoPanes = 0x01, kOnePane = 0x02 };
 
+    /**
+     * @brief receives the result, in order, one part at a time: a run of common lines (`is_change` is false) or
+     * a change. In two panes mode `left` and `right` have the same size (the shorter side of a change is padded
+     * with placeholders), in one pane mode `right` is always empty. The vectors can be moved from
+     */
+    using ResultCallback = std::function<void(LineInfoVec_t& left, LineInfoVec_t& right, bool is_change)>;
+
 private:
     LineInfoVec_t m_resultLeft;
     LineInfoVec_t m_resultRight;
@@ -109,6 +117,13 @@ public:
     void Diff(const wxFileName& fnLeft, const wxFileName& fnRight, DiffMode mode);
     void DiffStrings(const wxString& before, const wxString& after, DiffMode mode);
 
+    /**
+     * @brief same as above, but pass the result to `on_result` as the changes are found instead of storing it.
+     * When the inputs are identical, `on_result` is never called
+     */
+    void Diff(const wxFileName& fnLeft, const wxFileName& fnRight, DiffMode mode, const ResultCallback& on_result);
+    void DiffStrings(const wxString& before, const wxString& after, DiffMode mode, const ResultCallback& on_result);
+
     const LineInfoVec_t& GetResultLeft() const { return m_resultLeft; }
     const LineInfoVec_t& GetResultRight() const { return m_resultRight; }
     const SeqLinePair_t& GetSequences() const { return m_sequences; }
@@ -0,0 +1,373 @@
+#include "clFolderCompare.h"
+
+#include "clFilesCollector.h"
+#include "file_logger.h"
+
+#include <cstring>
+#include <ctime>
+#include <deque>
+#include <map>
+#include <thread>
+#include <wx/ffile.h>
+#include <wx/filefn.h>
+#include <wx/filename.h>
+
+namespace
+{
+constexpr uint64_t PRIME64_1 = 11400714785074694791ULL;
+constexpr uint64_t PRIME64_2 = 14029467366897019727ULL;
+constexpr uint64_t PRIME64_3 = 1609587929392839161ULL;
+constexpr uint64_t PRIME64_4 = 9650029242287828579ULL;
+constexpr uint64_t PRIME64_5 = 2870177450012600261ULL;
+
+inline uint64_t rotl64(uint64_t x, int r) { return (x << r) | (x >> (64 - r)); }
+
+inline uint64_t read64(const char* p)
+{
+    uint64_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+inline uint32_t read32(const char* p)
+{
+    uint32_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+inline uint64_t xxh64_round(uint64_t acc, uint64_t input)
+{
+    acc += input * PRIME64_2;
+    acc = rotl64(acc, 31);
+    return acc * PRIME64_1;
+}
+
+inline uint64_t xxh64_merge_round(uint64_t acc, uint64_t val)
+{
+    acc ^= xxh64_round(0, val);
+    return acc * PRIME64_1 + PRIME64_4;
+}
+
+// files are hashed one block of this size at a time
+constexpr size_t HASH_BLOCK_SIZE = 1024 * 1024;
+
+// the hash of a file modified less than this number of seconds ago is not cached: on file systems that store the
+// modification time in seconds, the file could still change without changing its modification time
+constexpr time_t RECENT_CHANGE_SECONDS = 2;
+
+int64_t get_mtime_ns(const wxStructStat& st)
+{
+#if defined(__WXMSW__)
+    return (int64_t)st.st_mtime * 1000000000;
+#elif defined(__WXMAC__)
+    return (int64_t)st.st_mtimespec.tv_sec * 1000000000 + st.st_mtimespec.tv_nsec;
+#else
+    return (int64_t)st.st_mtim.tv_sec * 1000000000 + st.st_mtim.tv_nsec;
+#endif
+}
+
+bool is_recently_modified(int64_t mtime_ns)
+{
+    return mtime_ns / 1000000000 >= (int64_t)(::time(nullptr) - RECENT_CHANGE_SECONDS);
+}
+
+/// a directory that exists on both sides
+struct Dir {
+    wxString left_path;
+    wxString right_path;
+    clFolderCompare::DirSummary summary;
+    // the number of files of this directory that are still to be compared
+    std::atomic<size_t> pending{ 0 };
+};
+
+struct Job {
+    Dir* dir = nullptr;
+    size_t index = 0; // in dir->summary.entries
+};
+
+wxString get_name(const wxString& fullpath) { return fullpath.AfterLast(wxFileName::GetPathSeparator()); }
+
+void finalize_summary(clFolderCompare::DirSummary& summary)
+{
+    for(const auto& entry : summary.entries) {
+        switch(entry.status) {
+        case clFolderCompare::eStatus::kSame:
+            ++summary.same;
+            break;
+        case clFolderCompare::eStatus::kDifferent:
+            ++summary.different;
+            break;
+        case clFolderCompare::eStatus::kLeftOnly:
+            ++summary.left_only;
+            break;
+        case clFolderCompare::eStatus::kRightOnly:
+            ++summary.right_only;
+            break;
+        case clFolderCompare::eStatus::kUnknown:
+            break;
+        }
+    }
+}
+} // namespace
+
+bool clFileHashCache::Get(const wxString& path, size_t size, int64_t mtime_ns, uint64_t& hash)
+{
+    std::unique_lock<std::mutex> lk{ m_mutex };
+    auto where = m_entries.find(path);
+    if(where == m_entries.end() || where->second.size != size || where->second.mtime_ns != mtime_ns) {
+        return false;
+    }
+    hash = where->second.hash;
+    return true;
+}
+
+void clFileHashCache::Set(const wxString& path, size_t size, int64_t mtime_ns, uint64_t hash)
+{
+    std::unique_lock<std::mutex> lk{ m_mutex };
+    m_entries[path] = { size, mtime_ns, hash };
+}
+
+void clFileHashCache::Clear()
+{
+    std::unique_lock<std::mutex> lk{ m_mutex };
+    m_entries.clear();
+}
+
+uint64_t clFileHashCache::Hash(const char* data, size_t size, uint64_t seed)
+{
+    const char* p = data;
+    const char* end = data + size;
+    uint64_t h = 0;
+
+    if(size >= 32) {
+        const char* limit = end - 32;
+        uint64_t v1 = seed + PRIME64_1 + PRIME64_2;
+        uint64_t v2 = seed + PRIME64_2;
+        uint64_t v3 = seed;
+        uint64_t v4 = seed - PRIME64_1;
+        do {
+            v1 = xxh64_round(v1, read64(p));
+            v2 = xxh64_round(v2, read64(p + 8));
+            v3 = xxh64_round(v3, read64(p + 16));
+            v4 = xxh64_round(v4, read64(p + 24));
+            p += 32;
+        } while(p <= limit);
+
+        h = rotl64(v1, 1) + rotl64(v2, 7) + rotl64(v3, 12) + rotl64(v4, 18);
+        h = xxh64_merge_round(h, v1);
+        h = xxh64_merge_round(h, v2);
+        h = xxh64_merge_round(h, v3);
+        h = xxh64_merge_round(h, v4);
+    } else {
+        h = seed + PRIME64_5;
+    }
+
+    h += (uint64_t)size;
+    while(p + 8 <= end) {
+        h ^= xxh64_round(0, read64(p));
+        h = rotl64(h, 27) * PRIME64_1 + PRIME64_4;
+        p += 8;
+    }
+    if(p + 4 <= end) {
+        h ^= (uint64_t)read32(p) * PRIME64_1;
+        h = rotl64(h, 23) * PRIME64_2 + PRIME64_3;
+        p += 4;
+    }
+    while(p < end) {
+        h ^= (uint64_t)(unsigned char)(*p) * PRIME64_5;
+        h = rotl64(h, 11) * PRIME64_1;
+        ++p;
+    }
+
+    h ^= h >> 33;
+    h *= PRIME64_2;
+    h ^= h >> 29;
+    h *= PRIME64_3;
+    h ^= h >> 32;
+    return h;
+}
+
+bool clFileHashCache::HashFile(const wxString& path, uint64_t& hash)
+{
+    // the memory used does not depend on the file size, and a file that is truncated meanwhile is just shorter (a
+    // memory mapping would raise SIGBUS)
+    wxFFile fp(path, "rb");
+    if(!fp.IsOpened()) {
+        return false;
+    }
+
+    thread_local std::string buffer(HASH_BLOCK_SIZE, 0);
+    uint64_t h = 0;
+    while(true) {
+        size_t bytes = fp.Read(&buffer[0], buffer.size());
+        if(bytes) {
+            // each block is seeded with the hash of the blocks before it
+            h = Hash(buffer.data(), bytes, h);
+        }
+        if(bytes < buffer.size()) {
+            break;
+        }
+    }
+    if(fp.Error()) {
+        return false;
+    }
+    hash = h;
+    return true;
+}
+
+bool clFolderCompare::GetHash(const wxString& path, size_t size, int64_t mtime_ns, uint64_t& hash)
+{
+    if(m_cache && m_cache->Get(path, size, mtime_ns, hash)) {
+        return true;
+    }
+    if(!clFileHashCache::HashFile(path, hash)) {
+        return false;
+    }
+    if(m_cache && !is_recently_modified(mtime_ns)) {
+        m_cache->Set(path, size, mtime_ns, hash);
+    }
+    return true;
+}
+
+clFolderCompare::eStatus clFolderCompare::CompareFiles(const wxString& left, const wxString& right)
+{
+    wxStructStat left_stat;
+    wxStructStat right_stat;
+    if(wxStat(left, &left_stat) != 0 || wxStat(right, &right_stat) != 0) {
+        return eStatus::kUnknown;
+    }
+
+    if(left_stat.st_size != right_stat.st_size) {
+        // If the size is different, no need to go further
+        return eStatus::kDifferent;
+    }
+
+    if(left_stat.st_size == 0) {
+        return eStatus::kSame;
+    }
+
+    uint64_t left_hash = 0;
+    uint64_t right_hash = 0;
+    if(!GetHash(left, left_stat.st_size, get_mtime_ns(left_stat), left_hash) ||
+       !GetHash(right, right_stat.st_size, get_mtime_ns(right_stat), right_hash)) {
+        return eStatus::kUnknown;
+    }
+    return left_hash == right_hash ? eStatus::kSame : eStatus::kDifferent;
+}
+
+void clFolderCompare::Run(const wxString& left, const wxString& right, const SummaryCallback& on_summary,
+                          size_t threads)
+{
+    // 1. walk both trees. A std::deque: the jobs keep pointers to the directories
+    std::deque<Dir> dirs;
+    std::vector<Job> jobs;
+    dirs.emplace_back();
+    dirs.back().left_path = left;
+    dirs.back().right_path = right;
+
+    clFilesScanner scanner;
+    clFilesScanner::EntryData::Vec_t left_entries;
+    clFilesScanner::EntryData::Vec_t right_entries;
+    for(size_t i = 0; i < dirs.size() && !IsStopped(); ++i) {
+        Dir& dir = dirs[i];
+        scanner.ScanNoRecurse(dir.left_path, left_entries);
+        scanner.ScanNoRecurse(dir.right_path, right_entries);
+
+        // name -> flags of the left and right entries, sorted by name
+        std::map<wxString, std::pair<size_t, size_t>> merged;
+        for(const auto& d : left_entries) {
+            merged[get_name(d.fullpath)].first = d.flags;
+        }
+        for(const auto& d : right_entries) {
+            merged[get_name(d.fullpath)].second = d.flags;
+        }
+
+        size_t jobs_count = 0;
+        for(const auto& [name, flags] : merged) {
+            auto [left_flags, right_flags] = flags;
+            bool left_folder = left_flags & clFilesScanner::kIsFolder;
+            bool right_folder = right_flags & clFilesScanner::kIsFolder;
+
+            Entry entry;
+            entry.name = name;
+            if(left_flags == 0 || right_flags == 0) {
+                entry.is_folder = left_folder || right_folder;
+                entry.status = left_flags ? eStatus::kLeftOnly : eStatus::kRightOnly;
+
+            } else if(left_folder && right_folder) {
+                if((left_flags & clFilesScanner::kIsSymlink) || (right_flags & clFilesScanner::kIsSymlink)) {
+                    // don't follow links to folders, they might lead to a cycle
+                    continue;
+                }
+                wxString relative_path = dir.summary.path.empty() ? name : dir.summary.path + "/" + name;
+                Dir& child = dirs.emplace_back();
+                child.left_path = dir.left_path + wxFileName::GetPathSeparator() + name;
+                child.right_path = dir.right_path + wxFileName::GetPathSeparator() + name;
+                child.summary.path = relative_path;
+                continue;
+
+            } else if(left_folder || right_folder) {
+                // a file on one side, a folder on the other
+                entry.is_folder = true;
+                entry.status = eStatus::kDifferent;
+
+            } else {
+                jobs.push_back({ &dir, dir.summary.entries.size() });
+                ++jobs_count;
+            }
+            dir.summary.entries.push_back(entry);
+        }
+
+        dir.pending.store(jobs_count);
+        if(jobs_count == 0) {
+            // nothing to hash
+            finalize_summary(dir.summary);
+            on_summary(std::move(dir.summary));
+        }
+    }
+
+    if(IsStopped()) {
+        return;
+    }
+
+    clDEBUG() << "Folder compare:" << dirs.size() << "folders," << jobs.size() << "files to compare" << endl;
+
+    // 2. compare the files. Each thread takes the next job, the last job of a directory reports its summary
+    std::atomic<size_t> next_job{ 0 };
+    auto worker = [&]() {
+        while(!IsStopped()) {
+            size_t index = next_job.fetch_add(1);
+            if(index >= jobs.size()) {
+                break;
+            }
+
+            Job& job = jobs[index];
+            Dir& dir = *job.dir;
+            Entry& entry = dir.summary.entries[job.index];
+            entry.status = CompareFiles(dir.left_path + wxFileName::GetPathSeparator() + entry.name,
+                                        dir.right_path + wxFileName::GetPathSeparator() + entry.name);
+            if(dir.pending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                finalize_summary(dir.summary);
+                on_summary(std::move(dir.summary));
+            }
+        }
+    };
+
+    if(threads == 0) {
+        // one thread per core, but at least 2: one thread can hash while the other waits for the disk. Past 8, the
+        // disk is the bottleneck
+        threads = std::max(2u, std::min(std::thread::hardware_concurrency(), 8u));
+    }
+    threads = std::min(threads, jobs.size());
+
+    // the calling thread is a worker too
+    std::vector<std::thread> pool;
+    for(size_t i = 1; i < threads; ++i) {
+        pool.emplace_back(worker);
+    }
+    worker();
+    for(auto& t : pool) {
+        t.join();
+    }
+}
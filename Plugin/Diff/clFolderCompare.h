@@ -0,0 +1,118 @@
+#ifndef CLFOLDERCOMPARE_H
+#define CLFOLDERCOMPARE_H
+
+#include "codelite_exports.h"
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+#include <wx/string.h>
+
+/**
+ * @class clFileHashCache
+ * @brief a thread safe cache of file content hashes. An entry is used as long as the size and the modification time
+ * (in nanoseconds) of the file did not change
+ */
+class WXDLLIMPEXP_SDK clFileHashCache
+{
+    struct Entry {
+        size_t size = 0;
+        int64_t mtime_ns = 0;
+        uint64_t hash = 0;
+    };
+
+    std::mutex m_mutex;
+    std::unordered_map<wxString, Entry> m_entries;
+
+public:
+    clFileHashCache() = default;
+    ~clFileHashCache() = default;
+
+    bool Get(const wxString& path, size_t size, int64_t mtime_ns, uint64_t& hash);
+    void Set(const wxString& path, size_t size, int64_t mtime_ns, uint64_t hash);
+    void Clear();
+
+    /**
+     * @brief a fast, non cryptographic, 64 bit hash (XXH64)
+     */
+    static uint64_t Hash(const char* data, size_t size, uint64_t seed = 0);
+    /**
+     * @brief hash the content of `path`. The file is read and hashed one block at a time
+     */
+    static bool HashFile(const wxString& path, uint64_t& hash);
+};
+
+/**
+ * @class clFolderCompare
+ * @brief compare two folder trees, recursively.
+ * Files that exist on both sides with the same size are compared by hashing their content on a pool of worker
+ * threads. The result is reported one directory at a time, as soon as all the files of that directory were compared
+ */
+class WXDLLIMPEXP_SDK clFolderCompare
+{
+public:
+    enum class eStatus {
+        kUnknown, // not compared yet, or one of the files could not be read
+        kSame,
+        kDifferent,
+        kLeftOnly,
+        kRightOnly,
+    };
+
+    struct Entry {
+        wxString name;
+        bool is_folder = false;
+        eStatus status = eStatus::kUnknown;
+    };
+
+    /**
+     * @brief the result of a single directory. Only the folders that exist on one side (or that are files on the
+     * other side) are listed in `entries`: the folders that exist on both sides have their own summary
+     */
+    struct DirSummary {
+        wxString path; // relative to the compared folders, always with '/' as separator. Empty for the root
+        std::vector<Entry> entries;
+        size_t same = 0;
+        size_t different = 0;
+        size_t left_only = 0;
+        size_t right_only = 0;
+
+        bool HasDifferences() const { return different || left_only || right_only; }
+    };
+
+    /**
+     * @brief called once per directory. Note: it is called from the worker threads
+     */
+    using SummaryCallback = std::function<void(DirSummary&& summary)>;
+
+private:
+    std::shared_ptr<clFileHashCache> m_cache;
+    std::atomic_bool m_stop{ false };
+
+    eStatus CompareFiles(const wxString& left, const wxString& right);
+    bool GetHash(const wxString& path, size_t size, int64_t mtime_ns, uint64_t& hash);
+
+public:
+    clFolderCompare(std::shared_ptr<clFileHashCache> cache)
+        : m_cache(std::move(cache))
+    {
+    }
+    ~clFolderCompare() = default;
+
+    /**
+     * @brief compare `left` and `right`, blocks until done (or until `Stop()` is called)
+     * @param threads the number of hashing threads, 0 means: pick a number based on the number of cores
+     */
+    void Run(const wxString& left, const wxString& right, const SummaryCallback& on_summary, size_t threads = 0);
+    /**
+     * @brief stop the comparison as soon as possible, can be called from any thread
+     */
+    void Stop() { m_stop.store(true); }
+    bool IsStopped() const { return m_stop.load(); }
+};
+
+#endif // CLFOLDERCOMPARE_H
@@ -0,0 +1,398 @@
+#include "clLineDiff.h"
+
+#include <algorithm>
+#include <unordered_map>
+
+namespace
+{
+constexpr uint32_t NONE = UINT32_MAX;
+
+// a line that appears more than this in a region is not used as a histogram anchor (same limit as git)
+constexpr uint32_t MAX_CHAIN_LENGTH = 64;
+
+// the Myers fallback gives up (and reports the whole region as a single change) once the edit cost reaches
+// max(MIN_MYERS_COST, MYERS_BUDGET / region lines): this bounds its run time on large, very different regions
+constexpr size_t MIN_MYERS_COST = 256;
+constexpr size_t MYERS_BUDGET = 20000000;
+} // namespace
+
+void clLineDiff::SplitLines(text_t text, std::vector<Line>& lines)
+{
+    // same lines as wxStringTokenize(text, "\n", wxTOKEN_RET_DELIMS)
+    lines.clear();
+    size_t start = 0;
+    while(start < text.length()) {
+        size_t where = text.find('\n', start);
+        size_t end = (where == text_t::npos) ? text.length() : where + 1;
+        lines.push_back({ start, end - start });
+        start = end;
+    }
+}
+
+void clLineDiff::SetInputs(const wxString& before, const wxString& after)
+{
+#if wxUSE_UNICODE_WCHAR
+    m_left_text = text_t{ before.wc_str(), before.length() };
+    m_right_text = text_t{ after.wc_str(), after.length() };
+#else
+    m_left_copy = before.ToStdWstring();
+    m_right_copy = after.ToStdWstring();
+    m_left_text = m_left_copy;
+    m_right_text = m_right_copy;
+#endif
+
+    SplitLines(m_left_text, m_left_lines);
+    SplitLines(m_right_text, m_right_lines);
+
+    // intern the lines: equal lines get the same id
+    std::unordered_map<text_t, uint32_t> ids;
+    ids.reserve(m_left_lines.size() + m_right_lines.size());
+    auto intern = [&ids](text_t text, const std::vector<Line>& lines, std::vector<uint32_t>& interned) {
+        interned.clear();
+        interned.reserve(lines.size());
+        for(const auto& line : lines) {
+            auto where = ids.insert({ text.substr(line.offset, line.length), (uint32_t)ids.size() }).first;
+            interned.push_back(where->second);
+        }
+    };
+    intern(m_left_text, m_left_lines, m_a);
+    intern(m_right_text, m_right_lines, m_b);
+    m_unique_count = ids.size();
+}
+
+wxString clLineDiff::GetLeftLine(size_t line) const
+{
+    const Line& l = m_left_lines[line];
+    return wxString(m_left_text.data() + l.offset, l.length);
+}
+
+wxString clLineDiff::GetRightLine(size_t line) const
+{
+    const Line& l = m_right_lines[line];
+    return wxString(m_right_text.data() + l.offset, l.length);
+}
+
+void clLineDiff::Emit(const Hunk& hunk, const HunkCallback& on_hunk)
+{
+    // adjacent changes (e.g. a deletion followed by an addition) are reported as one hunk
+    if(m_has_pending && m_pending.left_start + m_pending.left_count == hunk.left_start &&
+       m_pending.right_start + m_pending.right_count == hunk.right_start) {
+        m_pending.left_count += hunk.left_count;
+        m_pending.right_count += hunk.right_count;
+        return;
+    }
+
+    Flush(on_hunk);
+    m_pending = hunk;
+    m_has_pending = true;
+}
+
+void clLineDiff::Flush(const HunkCallback& on_hunk)
+{
+    if(m_has_pending) {
+        m_has_pending = false;
+        on_hunk(m_pending);
+    }
+}
+
+void clLineDiff::Run(const HunkCallback& on_hunk)
+{
+    m_has_pending = false;
+    m_count_a.assign(m_unique_count, 0);
+    m_count_b.assign(m_unique_count, 0);
+    m_head.assign(m_unique_count, NONE);
+    m_next.assign(m_a.size(), NONE);
+
+    // the regions are processed depth first, left to right, so the hunks are found in order
+    std::vector<Region> stack;
+    stack.push_back({ 0, m_a.size(), 0, m_b.size(), false });
+    std::vector<Match> anchors;
+
+    while(!stack.empty()) {
+        Region r = stack.back();
+        stack.pop_back();
+
+        // skip the common prefix and suffix
+        while(r.a_begin < r.a_end && r.b_begin < r.b_end && m_a[r.a_begin] == m_b[r.b_begin]) {
+            ++r.a_begin;
+            ++r.b_begin;
+        }
+        while(r.a_begin < r.a_end && r.b_begin < r.b_end && m_a[r.a_end - 1] == m_b[r.b_end - 1]) {
+            --r.a_end;
+            --r.b_end;
+        }
+
+        Hunk whole{ r.a_begin, r.a_end - r.a_begin, r.b_begin, r.b_end - r.b_begin };
+        if(r.a_begin == r.a_end || r.b_begin == r.b_end) {
+            // a pure addition or deletion (or nothing at all)
+            if(whole.left_count || whole.right_count) {
+                Emit(whole, on_hunk);
+            }
+            continue;
+        }
+
+        anchors.clear();
+        bool has_common = true;
+        bool found = false;
+        if(!r.myers) {
+            found = (m_algorithm == Algorithm::kHistogram) ? FindHistogramAnchor(r, anchors, has_common)
+                                                           : FindPatienceAnchors(r, anchors, has_common);
+        }
+
+        if(found) {
+            // compare the gaps between the anchors. Pushed in reverse, so the leftmost gap is processed first
+            size_t a_end = r.a_end;
+            size_t b_end = r.b_end;
+            for(auto iter = anchors.rbegin(); iter != anchors.rend(); ++iter) {
+                stack.push_back({ iter->a + iter->length, a_end, iter->b + iter->length, b_end, false });
+                a_end = iter->a;
+                b_end = iter->b;
+            }
+            stack.push_back({ r.a_begin, a_end, r.b_begin, b_end, false });
+            continue;
+        }
+
+        size_t split_a = 0;
+        size_t split_b = 0;
+        if(has_common && Bisect(r, split_a, split_b)) {
+            stack.push_back({ split_a, r.a_end, split_b, r.b_end, true });
+            stack.push_back({ r.a_begin, split_a, r.b_begin, split_b, true });
+            continue;
+        }
+
+        // nothing in common (or too expensive to find out): the whole region was rewritten
+        Emit(whole, on_hunk);
+    }
+    Flush(on_hunk);
+}
+
+bool clLineDiff::FindHistogramAnchor(const Region& region, std::vector<Match>& anchors, bool& has_common)
+{
+    // index the left side: the occurrences count of every line and a chain of its positions
+    for(size_t a = region.a_end; a-- > region.a_begin;) {
+        uint32_t id = m_a[a];
+        m_next[a] = m_head[id];
+        m_head[id] = a;
+        ++m_count_a[id];
+    }
+
+    // find the longest common run that contains the least frequent line
+    has_common = false;
+    Match best;
+    uint32_t best_count = MAX_CHAIN_LENGTH;
+    bool found = false;
+    for(size_t b = region.b_begin; b < region.b_end;) {
+        uint32_t count = m_count_a[m_b[b]];
+        size_t b_next = b + 1;
+        if(count == 0) {
+            b = b_next;
+            continue;
+        }
+
+        has_common = true;
+        if(count > best_count) {
+            b = b_next;
+            continue;
+        }
+
+        for(uint32_t a = m_head[m_b[b]]; a != NONE; a = m_next[a]) {
+            uint32_t run_count = count;
+            size_t a_start = a;
+            size_t b_start = b;
+            while(a_start > region.a_begin && b_start > region.b_begin && m_a[a_start - 1] == m_b[b_start - 1]) {
+                --a_start;
+                --b_start;
+                run_count = std::min(run_count, m_count_a[m_a[a_start]]);
+            }
+
+            size_t a_end = a + 1;
+            size_t b_end = b + 1;
+            while(a_end < region.a_end && b_end < region.b_end && m_a[a_end] == m_b[b_end]) {
+                run_count = std::min(run_count, m_count_a[m_a[a_end]]);
+                ++a_end;
+                ++b_end;
+            }
+
+            // the lines of this run were all visited
+            b_next = std::max(b_next, b_end);
+            if(a_end - a_start > best.length || run_count < best_count) {
+                best = { a_start, b_start, a_end - a_start };
+                best_count = run_count;
+                found = true;
+            }
+        }
+        b = b_next;
+    }
+
+    for(size_t a = region.a_begin; a < region.a_end; ++a) {
+        uint32_t id = m_a[a];
+        m_head[id] = NONE;
+        m_count_a[id] = 0;
+    }
+
+    if(found) {
+        anchors.push_back(best);
+    }
+    return found;
+}
+
+bool clLineDiff::FindPatienceAnchors(const Region& region, std::vector<Match>& anchors, bool& has_common)
+{
+    for(size_t a = region.a_begin; a < region.a_end; ++a) {
+        uint32_t id = m_a[a];
+        ++m_count_a[id];
+        m_head[id] = a;
+    }
+    for(size_t b = region.b_begin; b < region.b_end; ++b) {
+        ++m_count_b[m_b[b]];
+    }
+
+    // the lines that appear exactly once on each side, ordered by their position on the right side
+    has_common = false;
+    std::vector<Match> unique;
+    for(size_t b = region.b_begin; b < region.b_end; ++b) {
+        uint32_t id = m_b[b];
+        if(m_count_a[id] == 0) {
+            continue;
+        }
+        has_common = true;
+        if(m_count_a[id] == 1 && m_count_b[id] == 1) {
+            unique.push_back({ m_head[id], b, 1 });
+        }
+    }
+
+    for(size_t a = region.a_begin; a < region.a_end; ++a) {
+        uint32_t id = m_a[a];
+        m_count_a[id] = 0;
+        m_head[id] = NONE;
+    }
+    for(size_t b = region.b_begin; b < region.b_end; ++b) {
+        m_count_b[m_b[b]] = 0;
+    }
+
+    if(unique.empty()) {
+        return false;
+    }
+
+    // the longest increasing subsequence of the left side positions (patience sorting)
+    std::vector<size_t> tails;                      // index in `unique` of the smallest tail of each pile
+    std::vector<size_t> previous(unique.size(), 0); // the top of the previous pile when the match was placed
+    for(size_t i = 0; i < unique.size(); ++i) {
+        auto pile = std::lower_bound(tails.begin(), tails.end(), unique[i].a,
+                                     [&unique](size_t index, size_t a) { return unique[index].a < a; });
+        if(pile != tails.begin()) {
+            previous[i] = *(pile - 1);
+        }
+        if(pile == tails.end()) {
+            tails.push_back(i);
+        } else {
+            *pile = i;
+        }
+    }
+
+    anchors.resize(tails.size());
+    size_t index = tails.back();
+    for(size_t i = tails.size(); i-- > 0;) {
+        anchors[i] = unique[index];
+        index = previous[index];
+    }
+    return true;
+}
+
+bool clLineDiff::Bisect(const Region& region, size_t& split_a, size_t& split_b)
+{
+    // "An O(ND) Difference Algorithm and Its Variations", Eugene W. Myers: find the middle snake by running the
+    // forward and the reverse searches at the same time, only the furthest reaching paths are kept
+    const uint32_t* A = m_a.data() + region.a_begin;
+    const uint32_t* B = m_b.data() + region.b_begin;
+    const int n = region.a_end - region.a_begin;
+    const int m = region.b_end - region.b_begin;
+
+    const int max_d = (n + m + 1) / 2;
+    const int max_cost = (int)std::max(MIN_MYERS_COST, MYERS_BUDGET / (n + m));
+    const int d_limit = std::min(max_d, max_cost);
+    const int v_offset = d_limit + 1;
+    const int v_length = 2 * v_offset + 1;
+    m_v1.assign(v_length, -1);
+    m_v2.assign(v_length, -1);
+    m_v1[v_offset + 1] = 0;
+    m_v2[v_offset + 1] = 0;
+
+    const int delta = n - m;
+    // if the total number of lines is odd, the forward path collides with the reverse path
+    const bool front = (delta % 2 != 0);
+    int k1_start = 0;
+    int k1_end = 0;
+    int k2_start = 0;
+    int k2_end = 0;
+    for(int d = 0; d < d_limit; ++d) {
+        // walk the forward path one step
+        for(int k1 = -d + k1_start; k1 <= d - k1_end; k1 += 2) {
+            int k1_offset = v_offset + k1;
+            int x1 = 0;
+            if(k1 == -d || (k1 != d && m_v1[k1_offset - 1] < m_v1[k1_offset + 1])) {
+                x1 = m_v1[k1_offset + 1];
+            } else {
+                x1 = m_v1[k1_offset - 1] + 1;
+            }
+            int y1 = x1 - k1;
+            while(x1 < n && y1 < m && A[x1] == B[y1]) {
+                ++x1;
+                ++y1;
+            }
+            m_v1[k1_offset] = x1;
+            if(x1 > n) {
+                // ran off the right of the graph
+                k1_end += 2;
+            } else if(y1 > m) {
+                // ran off the bottom of the graph
+                k1_start += 2;
+            } else if(front) {
+                int k2_offset = v_offset + delta - k1;
+                if(k2_offset >= 0 && k2_offset < v_length && m_v2[k2_offset] != -1) {
+                    // mirror x2 onto the top-left coordinate system
+                    int x2 = n - m_v2[k2_offset];
+                    if(x1 >= x2) {
+                        split_a = region.a_begin + x1;
+                        split_b = region.b_begin + y1;
+                        return true;
+                    }
+                }
+            }
+        }
+
+        // walk the reverse path one step
+        for(int k2 = -d + k2_start; k2 <= d - k2_end; k2 += 2) {
+            int k2_offset = v_offset + k2;
+            int x2 = 0;
+            if(k2 == -d || (k2 != d && m_v2[k2_offset - 1] < m_v2[k2_offset + 1])) {
+                x2 = m_v2[k2_offset + 1];
+            } else {
+                x2 = m_v2[k2_offset - 1] + 1;
+            }
+            int y2 = x2 - k2;
+            while(x2 < n && y2 < m && A[n - x2 - 1] == B[m - y2 - 1]) {
+                ++x2;
+                ++y2;
+            }
+            m_v2[k2_offset] = x2;
+            if(x2 > n) {
+                k2_end += 2;
+            } else if(y2 > m) {
+                k2_start += 2;
+            } else if(!front) {
+                int k1_offset = v_offset + delta - k2;
+                if(k1_offset >= 0 && k1_offset < v_length && m_v1[k1_offset] != -1) {
+                    int x1 = m_v1[k1_offset];
+                    int y1 = v_offset + x1 - k1_offset;
+                    if(x1 >= n - x2) {
+                        split_a = region.a_begin + x1;
+                        split_b = region.b_begin + y1;
+                        return true;
+                    }
+                }
+            }
+        }
+    }
+    return false;
+}
@@ -0,0 +1,136 @@
+#ifndef CLLINEDIFF_H
+#define CLLINEDIFF_H
+
+#include "codelite_exports.h"
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <wx/string.h>
+
+/**
+ * @class clLineDiff
+ * @brief a line based diff for large inputs.
+ * Every line is interned into an integer id, so the algorithms compare integers instead of strings. The common
+ * prefix and suffix of every region are skipped right away, the remaining regions are split around the lines
+ * they have in common (histogram or patience diff), and only the regions where every common line is too frequent
+ * to be used as an anchor fall back to a linear space Myers diff (with a cost limit).
+ * The memory usage is linear in the number of lines, and the hunks are reported in order, as soon as they are
+ * found
+ *
+ * The inputs are not copied: they must outlive this object
+ */
+class WXDLLIMPEXP_SDK clLineDiff
+{
+public:
+    enum class Algorithm {
+        kHistogram,
+        kPatience,
+    };
+
+    /**
+     * @brief a change: `left_count` lines starting at `left_start` were replaced by `right_count` lines starting
+     * at `right_start` (line indexes are 0 based). One of the counts can be 0 (pure deletion or pure addition)
+     */
+    struct Hunk {
+        size_t left_start = 0;
+        size_t left_count = 0;
+        size_t right_start = 0;
+        size_t right_count = 0;
+    };
+    using HunkCallback = std::function<void(const Hunk&)>;
+
+private:
+    using text_t = std::basic_string_view<wxChar>;
+    struct Line {
+        size_t offset = 0;
+        size_t length = 0;
+    };
+
+    /**
+     * @brief a region of the inputs that is still to be compared: [a_begin, a_end) x [b_begin, b_end)
+     */
+    struct Region {
+        size_t a_begin = 0;
+        size_t a_end = 0;
+        size_t b_begin = 0;
+        size_t b_end = 0;
+        // skip the anchors search: the region was created by the Myers fallback
+        bool myers = false;
+    };
+
+    /**
+     * @brief matching lines: A[a + i] == B[b + i] for i < length
+     */
+    struct Match {
+        size_t a = 0;
+        size_t b = 0;
+        size_t length = 0;
+    };
+
+    Algorithm m_algorithm = Algorithm::kHistogram;
+    text_t m_left_text;
+    text_t m_right_text;
+#if !wxUSE_UNICODE_WCHAR
+    // the internal buffer of wxString can only be viewed directly in wchar_t builds
+    std::basic_string<wxChar> m_left_copy;
+    std::basic_string<wxChar> m_right_copy;
+#endif
+    std::vector<Line> m_left_lines;
+    std::vector<Line> m_right_lines;
+    std::vector<uint32_t> m_a; // the interned left lines
+    std::vector<uint32_t> m_b; // the interned right lines
+    size_t m_unique_count = 0;
+
+    // per id scratch buffers, indexed by line id. Only the entries touched by a region are reset after it
+    std::vector<uint32_t> m_count_a;
+    std::vector<uint32_t> m_count_b;
+    std::vector<uint32_t> m_head;
+    // the next (lower) occurrence of the same line in A, indexed by line number
+    std::vector<uint32_t> m_next;
+    std::vector<int> m_v1;
+    std::vector<int> m_v2;
+
+    Hunk m_pending;
+    bool m_has_pending = false;
+
+    static void SplitLines(text_t text, std::vector<Line>& lines);
+    void Emit(const Hunk& hunk, const HunkCallback& on_hunk);
+    void Flush(const HunkCallback& on_hunk);
+    /**
+     * @brief find the matches to split `region` around. Return false if there are none: `has_common` is set to
+     * true when the region has common lines that are too frequent to be used
+     */
+    bool FindHistogramAnchor(const Region& region, std::vector<Match>& anchors, bool& has_common);
+    bool FindPatienceAnchors(const Region& region, std::vector<Match>& anchors, bool& has_common);
+    /**
+     * @brief find the middle snake of `region` (linear space Myers). Return false if the cost limit was reached
+     */
+    bool Bisect(const Region& region, size_t& split_a, size_t& split_b);
+
+public:
+    clLineDiff(Algorithm algorithm = Algorithm::kHistogram)
+        : m_algorithm(algorithm)
+    {
+    }
+    ~clLineDiff() = default;
+
+    /**
+     * @brief split the inputs into lines (each line keeps its terminating "\n") and intern them
+     */
+    void SetInputs(const wxString& before, const wxString& after);
+
+    /**
+     * @brief compare the inputs, `on_hunk` is called for every change, ordered by line
+     */
+    void Run(const HunkCallback& on_hunk);
+
+    size_t GetLeftLinesCount() const { return m_left_lines.size(); }
+    size_t GetRightLinesCount() const { return m_right_lines.size(); }
+    wxString GetLeftLine(size_t line) const;
+    wxString GetRightLine(size_t line) const;
+};
+
+#endif // CLLINEDIFF_H
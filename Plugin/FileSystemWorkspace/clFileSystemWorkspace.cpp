@@ -50,6 +50,7 @@
     }
 
 wxDEFINE_EVENT(wxEVT_FS_SCAN_COMPLETED, clFileSystemEvent);
+wxDEFINE_EVENT(wxEVT_FS_SCAN_DELTA, clFileSystemEvent);
 wxDEFINE_EVENT(wxEVT_FS_NEW_WORKSPACE_FILE_CREATED, clFileSystemEvent);
 clFileSystemWorkspace::clFileSystemWorkspace(bool dummy)
     : m_dummy(dummy)
@@ -62,6 +63,7 @@ clFileSystemWorkspace::clFileSystemWorkspace(bool dummy)
         EventNotifier::Get()->Bind(wxEVT_CMD_CREATE_NEW_WORKSPACE, &clFileSystemWorkspace::OnNewWorkspace, this);
         EventNotifier::Get()->Bind(wxEVT_ALL_EDITORS_CLOSED, &clFileSystemWorkspace::OnAllEditorsClosed, this);
         EventNotifier::Get()->Bind(wxEVT_FS_SCAN_COMPLETED, &clFileSystemWorkspace::OnScanCompleted, this);
+        EventNotifier::Get()->Bind(wxEVT_FS_SCAN_DELTA, &clFileSystemWorkspace::OnScanDelta, this);
         EventNotifier::Get()->Bind(wxEVT_CMD_RETAG_WORKSPACE, &clFileSystemWorkspace::OnParseWorkspace, this);
         EventNotifier::Get()->Bind(wxEVT_CMD_RETAG_WORKSPACE_FULL, &clFileSystemWorkspace::OnParseWorkspace, this);
         EventNotifier::Get()->Bind(wxEVT_SAVE_SESSION_NEEDED, &clFileSystemWorkspace::OnSaveSession, this);
@@ -91,6 +93,11 @@ clFileSystemWorkspace::clFileSystemWorkspace(bool dummy)
         EventNotifier::Get()->Bind(wxEVT_DBG_UI_START, &clFileSystemWorkspace::OnDebug, this);
 
         EventNotifier::Get()->Bind(wxEVT_FILE_CREATED, &clFileSystemWorkspace::OnFileSystemUpdated, this);
+
+        m_watcher.SetOwner(this);
+        Bind(wxEVT_FILE_MODIFIED, &clFileSystemWorkspace::OnWatcherFilesModified, this);
+        Bind(wxEVT_FILE_NOT_FOUND, &clFileSystemWorkspace::OnWatcherFilesDeleted, this);
+        Bind(wxEVT_FILE_WATCHER_OVERFLOW, &clFileSystemWorkspace::OnWatcherOverflow, this);
     }
 }
 
@@ -103,6 +110,7 @@ clFileSystemWorkspace::~clFileSystemWorkspace()
         EventNotifier::Get()->Unbind(wxEVT_CMD_CREATE_NEW_WORKSPACE, &clFileSystemWorkspace::OnNewWorkspace, this);
         EventNotifier::Get()->Unbind(wxEVT_ALL_EDITORS_CLOSED, &clFileSystemWorkspace::OnAllEditorsClosed, this);
         EventNotifier::Get()->Unbind(wxEVT_FS_SCAN_COMPLETED, &clFileSystemWorkspace::OnScanCompleted, this);
+        EventNotifier::Get()->Unbind(wxEVT_FS_SCAN_DELTA, &clFileSystemWorkspace::OnScanDelta, this);
         EventNotifier::Get()->Unbind(wxEVT_SAVE_SESSION_NEEDED, &clFileSystemWorkspace::OnSaveSession, this);
 
         // parsing event
@@ -135,6 +143,12 @@ clFileSystemWorkspace::~clFileSystemWorkspace()
         EventNotifier::Get()->Unbind(wxEVT_DBG_UI_START, &clFileSystemWorkspace::OnDebug, this);
 
         EventNotifier::Get()->Unbind(wxEVT_FILE_CREATED, &clFileSystemWorkspace::OnFileSystemUpdated, this);
+
+        CancelScan();
+        m_watcher.Clear();
+        Unbind(wxEVT_FILE_MODIFIED, &clFileSystemWorkspace::OnWatcherFilesModified, this);
+        Unbind(wxEVT_FILE_NOT_FOUND, &clFileSystemWorkspace::OnWatcherFilesDeleted, this);
+        Unbind(wxEVT_FILE_WATCHER_OVERFLOW, &clFileSystemWorkspace::OnWatcherOverflow, this);
     }
 }
 
@@ -177,53 +191,84 @@ bool clFileSystemWorkspace::IsBuildSupported() const { return true; }
 
 bool clFileSystemWorkspace::IsProjectSupported() const { return false; }
 
-void clFileSystemWorkspace::CacheFiles(bool force)
-{
-    // should we force a rescan of the files?
-    if (force) {
-        m_files.Clear();
-    }
-    // sanity
-    if (!m_files.IsEmpty()) {
-        m_files.Clear();
-    }
-    std::thread thr(
-        [=, this](const wxString& rootFolder) {
-            clFilesScanner fs;
-            std::vector<wxString> files;
-            wxStringSet_t excludeFolders = {".git/", ".svn/", ".codelite/", ".ctagsd/"};
-
-            wxString excludePaths = GetExcludeFolders();
-            wxArrayString paths = StringUtils::BuildArgv(excludePaths);
-            if (!paths.IsEmpty()) {
-                for (wxString& excludePath : paths) {
-                    excludePath.Trim().Trim(false);
-                    if (excludePath.EndsWith("/") || excludePath.EndsWith("\\")) {
-                        excludePath.RemoveLast();
-                    }
-                    if (excludePath.IsEmpty()) {
-                        continue;
-                    }
-
-                    wxFileName fnpath(excludePath, "");
-                    excludeFolders.insert(fnpath.GetPath());
-                }
+void clFileSystemWorkspace::CacheFiles()
+{
+    // a new scan replaces the one in progress
+    CancelScan();
+
+    // the scan parameters, changing them invalidates the manifest
+    m_manifest.SetFilter(GetDir(), GetFilesMask(), GetExcludeFoldersSet());
+
+    // the complete list is needed when we have nothing to apply the changes on
+    bool send_all = m_files.IsEmpty();
+    m_scanThread = new std::thread(
+        [this, send_all](const wxString& rootFolder, const wxFileName& manifestFile) {
+            // the previous manifest might have been left on the disk
+            bool full_scan = m_manifest.IsEmpty();
+            if (full_scan) {
+                m_manifest.Load(manifestFile);
             }
 
-            fs.Scan(rootFolder, files, GetFilesMask(), "", excludeFolders);
-            clFileSystemEvent event(wxEVT_FS_SCAN_COMPLETED);
-            wxArrayString arrfiles;
-            arrfiles.Alloc(files.size());
-            for (const wxString& s : files) {
-                wxFileName f(s);
-                arrfiles.Add(f.GetFullPath());
+            clFileSystemWorkspaceManifest::Delta delta;
+            if (!m_manifest.Update(delta, m_scanCancelled)) {
+                clDEBUG() << "FSW: scan cancelled" << endl;
+                return;
+            }
+            m_manifest.Save(manifestFile);
+            clDEBUG() << "FSW: scan completed." << delta.folders_read << "folders read," << delta.folders_reused
+                      << "re-used. Added:" << delta.added.size() << "removed:" << delta.removed.size() << endl;
+
+            if (send_all || full_scan) {
+                clFileSystemEvent event(wxEVT_FS_SCAN_COMPLETED);
+                event.SetPaths(m_manifest.GetFiles());
+                event.SetFileName(rootFolder);
+                EventNotifier::Get()->QueueEvent(event.Clone());
+
+            } else if (!delta.IsEmpty()) {
+                clFileSystemEvent event(wxEVT_FS_SCAN_DELTA);
+                event.SetPaths(delta.added);
+                event.SetStrings(delta.removed);
+                event.SetFileName(rootFolder);
+                EventNotifier::Get()->QueueEvent(event.Clone());
             }
-
-            event.SetPaths(arrfiles);
-            EventNotifier::Get()->QueueEvent(event.Clone());
         },
-        GetDir());
-    thr.detach();
+        GetDir(),
+        GetManifestFile());
+}
+
+void clFileSystemWorkspace::CancelScan()
+{
+    if (m_scanThread) {
+        m_scanCancelled.store(true);
+        m_scanThread->join();
+        wxDELETE(m_scanThread);
+    }
+    m_scanCancelled.store(false);
+}
+
+wxStringSet_t clFileSystemWorkspace::GetExcludeFoldersSet() const
+{
+    wxStringSet_t excludeFolders = { ".git", ".svn", ".codelite", ".ctagsd" };
+    wxArrayString paths = StringUtils::BuildArgv(GetExcludeFolders());
+    for (wxString& excludePath : paths) {
+        excludePath.Trim().Trim(false);
+        if (excludePath.IsEmpty()) {
+            continue;
+        }
+
+        wxFileName fnpath(excludePath, "");
+        fnpath.MakeAbsolute(GetDir());
+        excludeFolders.insert(fnpath.GetPath());
+    }
+    return excludeFolders;
+}
+
+wxFileName clFileSystemWorkspace::GetManifestFile() const
+{
+    wxFileName fn(GetFileName());
+    fn.SetExt("files");
+    fn.AppendDir(".codelite");
+    return fn;
 }
 
 void clFileSystemWorkspace::OnBuildStarting(clBuildEvent& event)
@@ -372,6 +417,12 @@ void clFileSystemWorkspace::DoClose()
     // Store the session
     clGetManager()->StoreWorkspaceSession(m_filename);
 
+    // no more file system notifications
+    CancelScan();
+    m_watcher.Clear();
+    m_files.Clear();
+    m_manifest.Clear();
+
     // avoid any file re-cache, we are closing
     Save(false);
     DoClear();
@@ -433,6 +484,11 @@ void clFileSystemWorkspace::New(const wxString& folder, const wxString& name) {
 
 void clFileSystemWorkspace::OnScanCompleted(clFileSystemEvent& event)
 {
+    if (!IsOpen() || event.GetFileName() != GetDir()) {
+        // a scan of a workspace that is no longer opened
+        return;
+    }
+
     clDEBUG() << "FSW: CacheFiles completed. Found" << event.GetPaths().size() << "files";
     m_files.Clear();
     m_files.Alloc(event.GetPaths().size());
@@ -441,6 +497,9 @@ void clFileSystemWorkspace::OnScanCompleted(clFileSystemEvent& event)
     }
     clGetManager()->SetStatusMessage(_("File system scan completed"));
 
+    // keep the files list up to date from now on
+    StartWatcher();
+
     // Trigger a non full reparse
     Parse(false);
 
@@ -449,6 +508,27 @@ void clFileSystemWorkspace::OnScanCompleted(clFileSystemEvent& event)
     EventNotifier::Get()->ProcessEvent(event_scan);
 }
 
+void clFileSystemWorkspace::OnScanDelta(clFileSystemEvent& event)
+{
+    if (!IsOpen() || event.GetFileName() != GetDir()) {
+        return;
+    }
+
+    clDEBUG() << "FSW: files changed. Added:" << event.GetPaths().size() << "removed:" << event.GetStrings().size()
+              << endl;
+    m_files.Remove(event.GetStrings());
+    for (const wxString& filename : event.GetPaths()) {
+        m_files.Add(filename);
+    }
+    clGetManager()->SetStatusMessage(_("File system scan completed"));
+
+    // Trigger a non full reparse
+    Parse(false);
+
+    clWorkspaceEvent event_scan{ wxEVT_WORKSPACE_FILES_SCANNED };
+    EventNotifier::Get()->ProcessEvent(event_scan);
+}
+
 void clFileSystemWorkspace::OnParseWorkspace(wxCommandEvent& event)
 {
     if (!m_isLoaded) {
@@ -910,10 +990,10 @@ void clFileSystemWorkspace::OnSourceControlPulled(clSourceControlEvent& event)
     GetView()->RefreshTree();
 
     // Re-Cache the files and trigger a workspace parse
-    CacheFiles(true);
+    CacheFiles();
 }
 
-void clFileSystemWorkspace::FileSystemUpdated() { CacheFiles(true); }
+void clFileSystemWorkspace::FileSystemUpdated() { CacheFiles(); }
 
 void clFileSystemWorkspace::OnDebug(clDebugEvent& event)
 {
@@ -1088,6 +1168,66 @@ void clFileSystemWorkspace::OnFileSystemUpdated(clFileSystemEvent& event)
     }
 }
 
+void clFileSystemWorkspace::StartWatcher()
+{
+    m_watcher.Clear();
+    if (!m_isLoaded) {
+        return;
+    }
+
+    // where inotify is not available, new and deleted files are picked by the next scan
+    if (m_watcher.WatchTree(GetDir(), GetExcludeFoldersSet())) {
+        m_watcher.Start();
+    }
+}
+
+void clFileSystemWorkspace::OnWatcherFilesModified(clFileSystemEvent& event)
+{
+    if (!IsOpen()) {
+        return;
+    }
+
+    // we only care about new files: ctagsd and the language servers watch the content changes
+    wxString mask = GetFilesMask();
+    size_t count = 0;
+    for (const wxString& path : event.GetPaths()) {
+        wxFileName fn(path);
+        if (m_files.Contains(fn) || !FileUtils::WildMatch(mask, fn) || !fn.FileExists()) {
+            continue;
+        }
+        m_files.Add(fn);
+        ++count;
+    }
+
+    if (count) {
+        clDEBUG() << "FSW: added" << count << "new files" << endl;
+    }
+}
+
+void clFileSystemWorkspace::OnWatcherFilesDeleted(clFileSystemEvent& event)
+{
+    if (!IsOpen()) {
+        return;
+    }
+
+    size_t count = m_files.Remove(event.GetPaths());
+    if (count) {
+        clDEBUG() << "FSW: removed" << count << "files" << endl;
+    }
+}
+
+void clFileSystemWorkspace::OnWatcherOverflow(clFileSystemEvent& event)
+{
+    wxUnusedVar(event);
+    if (!IsOpen()) {
+        return;
+    }
+
+    // we missed some changes, scan the workspace again
+    clDEBUG() << "FSW: file system watcher overflow, re-scanning the workspace" << endl;
+    CacheFiles();
+}
+
 void clFileSystemWorkspace::CreateCompileFlagsFile()
 {
     wxBusyCursor bc;
@@ -7,14 +7,18 @@
 #include "clDebuggerTerminal.h"
 #include "clFileCache.hpp"
 #include "clFileSystemEvent.h"
+#include "clFileSystemWatcher.h"
 #include "clFileSystemWorkspaceConfig.hpp"
+#include "clFileSystemWorkspaceManifest.hpp"
 #include "clShellHelper.hpp"
 #include "clWorkspaceManager.h"
 #include "cl_command_event.h"
 #include "codelite_exports.h"
 #include "compiler.h"
 
+#include <atomic>
 #include <optional>
+#include <thread>
 #include <unordered_map>
 #include <vector>
 #include <wx/arrstr.h>
@@ -39,14 +43,30 @@ class WXDLLIMPEXP_SDK clFileSystemWorkspace : public LocalWorkspaceCommon
     clBacktickCache::ptr_t m_backtickCache;
     clShellHelper m_shell_helper;
     std::optional<int> m_indentWidth{ std::nullopt };
+    clFileSystemWatcher m_watcher;
+    clFileSystemWorkspaceManifest m_manifest;
+    std::thread* m_scanThread = nullptr;
+    std::atomic_bool m_scanCancelled{ false };
 
 protected:
-    void CacheFiles(bool force = false);
+    /**
+     * @brief scan the workspace folder in the background. The first scan sends the complete list of files
+     * (wxEVT_FS_SCAN_COMPLETED), the next ones only the files that were added or removed (wxEVT_FS_SCAN_DELTA).
+     * Only the folders that changed since the previous scan are read, see clFileSystemWorkspaceManifest
+     */
+    void CacheFiles();
+    /**
+     * @brief cancel the background scan (if any) and wait for it to exit
+     */
+    void CancelScan();
+    wxStringSet_t GetExcludeFoldersSet() const;
+    wxFileName GetManifestFile() const;
     wxString GetTargetCommand(const wxString& target) const;
     void DoPrintBuildMessage(const wxString& message);
     clEnvList_t GetEnvList();
     CompilerPtr GetCompiler();
     void CheckForCMakeLists();
+    void StartWatcher();
 
     //===--------------------------
     // Event handlers
@@ -64,6 +84,7 @@ protected:
     void OnCloseWorkspace(clCommandEvent& event);
     void OnAllEditorsClosed(wxCommandEvent& event);
     void OnScanCompleted(clFileSystemEvent& event);
+    void OnScanDelta(clFileSystemEvent& event);
     void OnParseWorkspace(wxCommandEvent& event);
     void OnBuildProcessTerminated(clProcessEvent& event);
     void OnBuildProcessOutput(clProcessEvent& event);
@@ -77,6 +98,9 @@ protected:
     void OnDebug(clDebugEvent& event);
     void OnFileSystemUpdated(clFileSystemEvent& event);
     void OnReloadWorkspace(clCommandEvent& event);
+    void OnWatcherFilesModified(clFileSystemEvent& event);
+    void OnWatcherFilesDeleted(clFileSystemEvent& event);
+    void OnWatcherOverflow(clFileSystemEvent& event);
 
 protected:
     bool Load(const wxFileName& file);
@@ -197,5 +221,7 @@ public:
 };
 
 wxDECLARE_EXPORTED_EVENT(WXDLLIMPEXP_SDK, wxEVT_FS_SCAN_COMPLETED, clFileSystemEvent);
+/// files added (`GetPaths()`) and removed (`GetStrings()`) since the previous scan
+wxDECLARE_EXPORTED_EVENT(WXDLLIMPEXP_SDK, wxEVT_FS_SCAN_DELTA, clFileSystemEvent);
 wxDECLARE_EXPORTED_EVENT(WXDLLIMPEXP_SDK, wxEVT_FS_NEW_WORKSPACE_FILE_CREATED, clFileSystemEvent);
 #endif // CLFILESYSTEMWORKSPACE_HPP
@@ -0,0 +1,324 @@
+#include "clFileSystemWorkspaceManifest.hpp"
+
+#include "file_logger.h"
+#include "fileutils.h"
+
+#include <algorithm>
+#include <deque>
+#include <string_view>
+#include <wx/dir.h>
+#include <wx/ffile.h>
+#include <wx/filefn.h>
+#include <wx/tokenzr.h>
+
+namespace
+{
+constexpr const char* MANIFEST_VERSION = "1";
+
+/// split `line` on tabs, return the number of fields found (up to `max_fields`). The last field takes the rest of
+/// the line, so it may contain tabs
+size_t split_fields(std::string_view line, std::string_view* fields, size_t max_fields)
+{
+    size_t count = 0;
+    while (count + 1 < max_fields) {
+        size_t where = line.find('\t');
+        if (where == std::string_view::npos) {
+            break;
+        }
+        fields[count++] = line.substr(0, where);
+        line.remove_prefix(where + 1);
+    }
+    fields[count++] = line;
+    return count;
+}
+
+template <typename T> T to_number(std::string_view str)
+{
+    T value = 0;
+    for (char ch : str) {
+        if (ch < '0' || ch > '9') {
+            break;
+        }
+        value = value * 10 + (ch - '0');
+    }
+    return value;
+}
+
+inline wxString from_utf8(std::string_view str) { return wxString::FromUTF8(str.data(), str.length()); }
+} // namespace
+
+void clFileSystemWorkspaceManifest::SetFilter(const wxString& root,
+                                             const wxString& filesSpec,
+                                             const wxStringSet_t& excludeFolders)
+{
+    wxString signature = GetSignature();
+    m_root = wxFileName(root, wxEmptyString).GetPath();
+    m_filesSpec = filesSpec;
+    m_filesSpecArr = ::wxStringTokenize(filesSpec, ";,|", wxTOKEN_STRTOK);
+    m_excludeFolders = excludeFolders;
+    if (signature != GetSignature()) {
+        m_folders.clear();
+    }
+}
+
+wxString clFileSystemWorkspaceManifest::GetSignature() const
+{
+    // sort the exclude list, so the signature does not depend on the set order
+    std::vector<wxString> excludes{ m_excludeFolders.begin(), m_excludeFolders.end() };
+    std::sort(excludes.begin(), excludes.end());
+
+    wxString signature;
+    signature << MANIFEST_VERSION << "|" << m_root << "|" << m_filesSpec << "|";
+    for (const wxString& exclude : excludes) {
+        signature << exclude << ";";
+    }
+    signature.Replace("\t", " ");
+    signature.Replace("\n", " ");
+    return signature;
+}
+
+bool clFileSystemWorkspaceManifest::IsExcluded(const wxString& fullpath, const wxString& name) const
+{
+    return m_excludeFolders.count(name) || m_excludeFolders.count(fullpath);
+}
+
+void clFileSystemWorkspaceManifest::ReadFolder(const wxString& path, time_t mtime, Folder& folder) const
+{
+    folder.mtime = mtime;
+    folder.files.clear();
+    folder.folders.clear();
+
+    wxDir dir(path);
+    if (!dir.IsOpened()) {
+        return;
+    }
+
+    wxString name;
+    bool cont = dir.GetFirst(&name);
+    while (cont) {
+        wxString fullpath;
+        fullpath << path << wxFileName::GetPathSeparator() << name;
+
+        // a single stat() tells us the type, size and time of the entry (symbolic links are followed)
+        wxStructStat st;
+        if (wxStat(fullpath, &st) == 0) {
+            if (S_ISDIR(st.st_mode)) {
+                folder.folders.push_back(name);
+            } else if (FileUtils::WildMatch(m_filesSpecArr, name)) {
+                folder.files.push_back({ name, st.st_mtime, (size_t)st.st_size });
+            }
+        }
+        cont = dir.GetNext(&name);
+    }
+}
+
+bool clFileSystemWorkspaceManifest::Update(Delta& delta, const std::atomic_bool& cancelled)
+{
+    delta = {};
+    if (m_root.empty() || !wxFileName::DirExists(m_root)) {
+        clDEBUG() << "Manifest: no such dir:" << m_root << endl;
+        return true;
+    }
+
+    // a folder modified during the scan can have the same (second resolution) time on the next scan, we don't
+    // trust such times
+    time_t scan_start = time(nullptr);
+
+    std::unordered_map<wxString, Folder> folders;
+    folders.reserve(m_folders.size());
+    wxStringSet_t visited;
+    std::deque<wxString> queue;
+    queue.push_back(m_root);
+    visited.insert(FileUtils::RealPath(m_root));
+
+    auto add_files = [](const wxString& path, const std::vector<File>& files, wxArrayString& output) {
+        for (const File& file : files) {
+            output.Add(path + wxFileName::GetPathSeparator() + file.name);
+        }
+    };
+
+    while (!queue.empty()) {
+        if (cancelled) {
+            // we already moved some folders out, start from scratch next time
+            m_folders.clear();
+            return false;
+        }
+
+        wxString path = std::move(queue.front());
+        queue.pop_front();
+
+        time_t mtime = FileUtils::GetFileModificationTime(path);
+        auto iter = m_folders.find(path);
+        Folder folder;
+        if (iter != m_folders.end() && mtime != 0 && iter->second.mtime == mtime) {
+            // no entry was added or removed, re-use the folder as is
+            folder = std::move(iter->second);
+            delta.folders_reused++;
+
+        } else {
+            ReadFolder(path, mtime, folder);
+            delta.folders_read++;
+
+            // compare with what we had
+            if (iter == m_folders.end()) {
+                add_files(path, folder.files, delta.added);
+            } else {
+                wxStringSet_t old_files;
+                for (const File& file : iter->second.files) {
+                    old_files.insert(file.name);
+                }
+                for (const File& file : folder.files) {
+                    if (old_files.erase(file.name) == 0) {
+                        delta.added.Add(path + wxFileName::GetPathSeparator() + file.name);
+                    }
+                }
+                for (const wxString& name : old_files) {
+                    delta.removed.Add(path + wxFileName::GetPathSeparator() + name);
+                }
+            }
+
+            if (mtime >= scan_start - 1) {
+                folder.mtime = 0;
+            }
+        }
+
+        if (iter != m_folders.end()) {
+            m_folders.erase(iter);
+        }
+
+        for (const wxString& name : folder.folders) {
+            wxString fullpath;
+            fullpath << path << wxFileName::GetPathSeparator() << name;
+            if (IsExcluded(fullpath, name)) {
+                continue;
+            }
+
+            wxString realpath = FileUtils::RealPath(fullpath);
+            if (realpath != fullpath && m_excludeFolders.count(realpath)) {
+                continue;
+            }
+
+            if (visited.insert(realpath).second) {
+                queue.push_back(fullpath);
+            }
+        }
+        folders.insert({ path, std::move(folder) });
+    }
+
+    // what remains are folders that were deleted (or are now excluded)
+    for (const auto& [path, folder] : m_folders) {
+        add_files(path, folder.files, delta.removed);
+    }
+
+    m_folders.swap(folders);
+    return true;
+}
+
+wxArrayString clFileSystemWorkspaceManifest::GetFiles() const
+{
+    size_t count = 0;
+    for (const auto& [_, folder] : m_folders) {
+        count += folder.files.size();
+    }
+
+    wxArrayString files;
+    files.reserve(count);
+    for (const auto& [path, folder] : m_folders) {
+        for (const File& file : folder.files) {
+            files.Add(path + wxFileName::GetPathSeparator() + file.name);
+        }
+    }
+    return files;
+}
+
+bool clFileSystemWorkspaceManifest::Save(const wxFileName& filename) const
+{
+    // a simple line based format:
+    // S <signature>
+    // D <mtime> <folder full path>
+    // F <mtime> <size> <file name>
+    // d <sub folder name>
+    std::string content;
+    content.reserve(m_folders.size() * 128);
+    content.append("S\t").append(GetSignature().ToStdString(wxConvUTF8)).append("\n");
+    for (const auto& [path, folder] : m_folders) {
+        content.append("D\t").append(std::to_string(folder.mtime)).append("\t");
+        content.append(path.ToStdString(wxConvUTF8)).append("\n");
+        for (const File& file : folder.files) {
+            content.append("F\t").append(std::to_string(file.mtime)).append("\t");
+            content.append(std::to_string(file.size)).append("\t");
+            content.append(file.name.ToStdString(wxConvUTF8)).append("\n");
+        }
+        for (const wxString& name : folder.folders) {
+            content.append("d\t").append(name.ToStdString(wxConvUTF8)).append("\n");
+        }
+    }
+    return FileUtils::WriteFileContentRaw(filename, content);
+}
+
+bool clFileSystemWorkspaceManifest::Load(const wxFileName& filename)
+{
+    m_folders.clear();
+
+    wxFFile fp(filename.GetFullPath(), "rb");
+    if (!fp.IsOpened()) {
+        return false;
+    }
+
+    std::string content;
+    content.resize(fp.Length());
+    if (content.empty() || fp.Read(content.data(), content.size()) != content.size()) {
+        return false;
+    }
+    fp.Close();
+
+    std::string_view buffer{ content };
+    std::string_view fields[4];
+    Folder* folder = nullptr;
+    bool first_line = true;
+    while (!buffer.empty()) {
+        size_t eol = buffer.find('\n');
+        std::string_view line = buffer.substr(0, eol);
+        buffer.remove_prefix(eol == std::string_view::npos ? buffer.length() : eol + 1);
+        if (line.length() < 2 || line[1] != '\t') {
+            continue;
+        }
+
+        char kind = line[0];
+        line.remove_prefix(2);
+        if (first_line) {
+            // the manifest must have been created with the same scan parameters
+            first_line = false;
+            if (kind != 'S' || from_utf8(line) != GetSignature()) {
+                clDEBUG() << "Manifest:" << filename << "is outdated" << endl;
+                return false;
+            }
+            continue;
+        }
+
+        switch (kind) {
+        case 'D':
+            if (split_fields(line, fields, 2) == 2) {
+                folder = &m_folders[from_utf8(fields[1])];
+                folder->mtime = to_number<time_t>(fields[0]);
+            }
+            break;
+        case 'F':
+            if (folder && split_fields(line, fields, 3) == 3) {
+                folder->files.push_back(
+                    { from_utf8(fields[2]), to_number<time_t>(fields[0]), to_number<size_t>(fields[1]) });
+            }
+            break;
+        case 'd':
+            if (folder) {
+                folder->folders.push_back(from_utf8(line));
+            }
+            break;
+        default:
+            break;
+        }
+    }
+
+    clDEBUG() << "Manifest: loaded" << m_folders.size() << "folders from" << filename << endl;
+    return !m_folders.empty();
+}
@@ -0,0 +1,91 @@
+#ifndef CLFILESYSTEMWORKSPACEMANIFEST_HPP
+#define CLFILESYSTEMWORKSPACEMANIFEST_HPP
+
+#include "codelite_exports.h"
+#include "macros.h"
+
+#include <atomic>
+#include <unordered_map>
+#include <vector>
+#include <wx/arrstr.h>
+#include <wx/filename.h>
+#include <wx/string.h>
+
+/**
+ * @class clFileSystemWorkspaceManifest
+ * @brief the list of the workspace files, persisted under `.codelite/` so re-opening (or refreshing) the workspace
+ * does not have to crawl the entire tree.
+ *
+ * For every folder we keep its modification time, its sub folders and the files matching the workspace mask (with
+ * their modification time and size). Adding, removing or renaming an entry changes the modification time of its
+ * folder, so `Update()` only reads the folders whose modification time changed and re-uses the rest.
+ */
+class WXDLLIMPEXP_SDK clFileSystemWorkspaceManifest
+{
+public:
+    struct File {
+        wxString name;
+        time_t mtime = 0;
+        size_t size = 0;
+    };
+
+    struct Folder {
+        time_t mtime = 0;
+        std::vector<File> files;
+        std::vector<wxString> folders; // sub folders names
+    };
+
+    struct Delta {
+        wxArrayString added;
+        wxArrayString removed;
+        size_t folders_read = 0;
+        size_t folders_reused = 0;
+        bool IsEmpty() const { return added.empty() && removed.empty(); }
+    };
+
+private:
+    std::unordered_map<wxString, Folder> m_folders;
+    wxString m_root;
+    wxString m_filesSpec;
+    wxArrayString m_filesSpecArr;
+    wxStringSet_t m_excludeFolders;
+
+protected:
+    wxString GetSignature() const;
+    bool IsExcluded(const wxString& fullpath, const wxString& name) const;
+    void ReadFolder(const wxString& path, time_t mtime, Folder& folder) const;
+
+public:
+    clFileSystemWorkspaceManifest() = default;
+    ~clFileSystemWorkspaceManifest() = default;
+
+    /**
+     * @brief set the scan parameters: the root folder, the files mask and the folders to skip (a folder name, e.g.
+     * ".git", or a full path). Changing the parameters invalidates the manifest
+     */
+    void SetFilter(const wxString& root, const wxString& filesSpec, const wxStringSet_t& excludeFolders);
+
+    /**
+     * @brief load the manifest from `filename`. Return false (and leave the manifest empty) if the file does not exist
+     * or was written with different scan parameters
+     */
+    bool Load(const wxFileName& filename);
+    bool Save(const wxFileName& filename) const;
+
+    /**
+     * @brief re-scan the root folder, reading only the folders that changed since the previous scan.
+     * Return false if `cancelled` was raised, in which case the manifest is cleared
+     */
+    bool Update(Delta& delta, const std::atomic_bool& cancelled);
+
+    /**
+     * @brief return the full path of all the files in the manifest
+     */
+    wxArrayString GetFiles() const;
+
+    size_t GetFoldersCount() const { return m_folders.size(); }
+    bool IsEmpty() const { return m_folders.empty(); }
+    void Clear() { m_folders.clear(); }
+};
+
+#endif // CLFILESYSTEMWORKSPACEMANIFEST_HPP
@@ -1,6 +1,5 @@
 #include "GotoAnythingDlg.h"
 
-#include "clAnagram.h"
 #include "codelite_events.h"
 #include "event_notifier.h"
 #include "file_logger.h"
@@ -13,6 +12,10 @@ GotoAnythingDlg::GotoAnythingDlg(wxWindow* parent, const std::vector<clGotoEntry
     : GotoAnythingBaseDlg(parent)
     , m_allEntries(entries)
 {
+    m_index.Reserve(m_allEntries.size());
+    for (const clGotoEntry& entry : m_allEntries) {
+        m_index.Add(entry.GetDesc());
+    }
     DoPopulate(m_allEntries);
 
     ::clSetDialogBestSizeAndPosition(this);
@@ -98,20 +101,16 @@ void GotoAnythingDlg::ApplyFilter()
 
     // Update the last applied filter
     m_currentFilter = filter;
-    if (filter.IsEmpty()) {
+    if (filter.Trim().Trim(false).IsEmpty()) {
         DoPopulate(m_allEntries);
     } else {
 
-        // Filter the list
-        clAnagram anagram(filter);
+        // Filter the list, best match first
         std::vector<clGotoEntry> matchedEntries;
         std::vector<int> matchedEntriesIndex;
-        for (size_t i = 0; i < m_allEntries.size(); ++i) {
-            const clGotoEntry& entry = m_allEntries[i];
-            if (anagram.MatchesInOrder(entry.GetDesc())) {
-                matchedEntries.push_back(entry);
-                matchedEntriesIndex.push_back(i);
-            }
+        for (const auto& match : m_index.Search(filter)) {
+            matchedEntries.push_back(m_allEntries[match.index]);
+            matchedEntriesIndex.push_back(match.index);
         }
 
         // And populate the list
@@ -3,6 +3,7 @@
 
 #include "GotoAnythingBaseUI.h"
 #include "bitmap_loader.h"
+#include "clFuzzyIndex.hpp"
 #include "clGotoAnythingManager.h"
 #include "clThemedListCtrl.h"
 #include "codelite_exports.h"
@@ -13,6 +14,7 @@ class WXDLLIMPEXP_SDK GotoAnythingDlg : public GotoAnythingBaseDlg
 {
     const std::vector<clGotoEntry>& m_allEntries;
     wxString m_currentFilter;
+    clFuzzyIndex m_index;
     clThemedListCtrl::BitmapVec_t m_bitmaps;
 
 protected:
@@ -6,7 +6,53 @@
 namespace
 {
 const wxString EMPTY_STRING;
+
+/// above this number of recorded changes, sending the entire file is cheaper
+constexpr size_t MAX_RECORDED_CHANGES = 1000;
+
+bool is_single_line(const wxString& text) { return text.find('\n') == wxString::npos; }
+
+/// try to merge `change` into `last`, return true on success
+bool merge_change(LSP::TextDocumentContentChangeEvent& last, const LSP::TextDocumentContentChangeEvent& change)
+{
+    const auto& last_range = last.GetRange();
+    const auto& range = change.GetRange();
+    if(last_range.GetStart().GetLine() != last_range.GetEnd().GetLine() ||
+       range.GetStart().GetLine() != range.GetEnd().GetLine() ||
+       range.GetStart().GetLine() != last_range.GetStart().GetLine()) {
+        return false;
+    }
+
+    bool last_is_insert = last_range.GetStart() == last_range.GetEnd() && !last.GetText().empty();
+    bool last_is_delete = last.GetText().empty();
+    bool is_insert = range.GetStart() == range.GetEnd() && !change.GetText().empty();
+    bool is_delete = change.GetText().empty();
+
+    if(last_is_insert && is_insert && is_single_line(last.GetText()) && is_single_line(change.GetText()) &&
+       range.GetStart().GetCharacter() ==
+           last_range.GetStart().GetCharacter() + static_cast<int>(last.GetText().length())) {
+        // typing: "a" + "b" => "ab"
+        last.SetText(last.GetText() + change.GetText());
+        return true;
+    }
+
+    if(last_is_delete && is_delete && range.GetEnd() == last_range.GetStart()) {
+        // backspace: the new deletion ends where the previous one started
+        last.SetRange(LSP::Range{ range.GetStart(), last_range.GetEnd() });
+        return true;
+    }
+
+    if(last_is_delete && is_delete && range.GetStart() == last_range.GetStart()) {
+        // delete key: the text after the caret shifted left, extend the previous range by the deleted length
+        int length = range.GetEnd().GetCharacter() - range.GetStart().GetCharacter();
+        LSP::Position end = last_range.GetEnd();
+        end.SetCharacter(end.GetCharacter() + length);
+        last.SetRange(LSP::Range{ last_range.GetStart(), end });
+        return true;
+    }
+    return false;
 }
+} // namespace
 
 bool FileContentTracker::exists(const wxString& filepath)
 {
@@ -112,3 +158,70 @@ bool FileContentTracker::get_last_content(const wxString& filepath, wxString* co
     }
     return false;
 }
+
+void FileContentTracker::start_recording(const wxString& filepath)
+{
+    update_content(filepath, EMPTY_STRING);
+    FileState* state = nullptr;
+    if(find(filepath, &state)) {
+        state->flags = FILE_STATE_RECORDING;
+        state->changes.clear();
+    }
+}
+
+bool FileContentTracker::is_recording(const wxString& filepath)
+{
+    FileState* state = nullptr;
+    return find(filepath, &state) && (state->flags & FILE_STATE_RECORDING);
+}
+
+void FileContentTracker::add_change(const wxString& filepath, const LSP::TextDocumentContentChangeEvent& change)
+{
+    FileState* state = nullptr;
+    if(!find(filepath, &state) || !(state->flags & FILE_STATE_RECORDING) || (state->flags & FILE_STATE_FULL_SYNC)) {
+        return;
+    }
+
+    if(!state->changes.empty() && merge_change(state->changes.back(), change)) {
+        return;
+    }
+
+    if(state->changes.size() >= MAX_RECORDED_CHANGES) {
+        set_full_sync(filepath);
+        return;
+    }
+    state->changes.push_back(change);
+}
+
+void FileContentTracker::set_full_sync(const wxString& filepath)
+{
+    FileState* state = nullptr;
+    if(find(filepath, &state)) {
+        state->flags |= FILE_STATE_FULL_SYNC;
+        state->changes.clear();
+    }
+}
+
+bool FileContentTracker::has_changes(const wxString& filepath)
+{
+    FileState* state = nullptr;
+    if(!find(filepath, &state)) {
+        return false;
+    }
+    return (state->flags & FILE_STATE_FULL_SYNC) || !state->changes.empty();
+}
+
+bool FileContentTracker::take_changes(const wxString& filepath,
+                                      std::vector<LSP::TextDocumentContentChangeEvent>* changes)
+{
+    FileState* state = nullptr;
+    if(!find(filepath, &state)) {
+        return false;
+    }
+
+    bool full_sync = state->flags & FILE_STATE_FULL_SYNC;
+    state->flags &= ~FILE_STATE_FULL_SYNC;
+    changes->swap(state->changes);
+    state->changes.clear();
+    return !full_sync;
+}
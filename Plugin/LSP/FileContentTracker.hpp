@@ -11,12 +11,18 @@
 
 enum FileStateFlags {
     FILE_STATE_NONE = 0,
+    /// the changes are recorded from the editor modification notifications, `content` is not kept
+    FILE_STATE_RECORDING = (1 << 0),
+    /// the recorded changes can not be used, the next synchronization must send the entire file
+    FILE_STATE_FULL_SYNC = (1 << 1),
 };
 
 struct WXDLLIMPEXP_SDK FileState {
     size_t flags = FILE_STATE_NONE;
     wxString content;
     wxString file_path;
+    /// the changes recorded since the last synchronization, in the order they were made
+    std::vector<LSP::TextDocumentContentChangeEvent> changes;
 };
 
 class WXDLLIMPEXP_SDK FileContentTracker
@@ -54,6 +60,34 @@ public:
      * @brief return the last seen content for filepath
      */
     bool get_last_content(const wxString& filepath, wxString* content);
+
+    /**
+     * @brief from now on, `filepath` changes are reported by the editor (see `add_change()`) instead of being
+     * computed by comparing the file content
+     */
+    void start_recording(const wxString& filepath);
+    bool is_recording(const wxString& filepath);
+
+    /**
+     * @brief record a change made to `filepath`. Consecutive typing (or deleting) on the same line is merged into a
+     * single change
+     */
+    void add_change(const wxString& filepath, const LSP::TextDocumentContentChangeEvent& change);
+
+    /**
+     * @brief the recorded changes for `filepath` are not usable, the next synchronization must send the entire file
+     */
+    void set_full_sync(const wxString& filepath);
+
+    /**
+     * @brief return true if `filepath` was modified since the last call to `take_changes()`
+     */
+    bool has_changes(const wxString& filepath);
+
+    /**
+     * @brief return and clear the recorded changes of `filepath`. Returns false if the entire file must be sent
+     */
+    bool take_changes(const wxString& filepath, std::vector<LSP::TextDocumentContentChangeEvent>* changes);
     void clear() { m_files.clear(); }
 };
 
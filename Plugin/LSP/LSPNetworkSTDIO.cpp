@@ -74,7 +74,7 @@ void LSPNetworkSTDIO::DoStartLocalProcess()
 
     wxArrayString args = m_startupInfo.GetLspServerCommand();
     try {
-        m_server->Start(args);
+        m_server->Start(args, IProcessCreateDefault | IProcessStderrEvent | IProcessReactor);
 
     } catch (const clException& e) {
         clERROR() << "failed to execute LSP proceess with args:" << args << endl;
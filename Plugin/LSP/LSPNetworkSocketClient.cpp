@@ -29,7 +29,8 @@ void LSPNetworkSocketClient::Open(const LSPStartupInfo& info)
         if(m_startupInfo.GetFlags() & LSPStartupInfo::kRemoteLSP) {
             throw clException("Executing LSP over SSH is enabled only for STDIO based LSPs");
         } else {
-            m_lspServer = ::CreateAsyncProcess(this, cmd, IProcessCreateDefault, m_startupInfo.GetWorkingDirectory());
+            m_lspServer = ::CreateAsyncProcess(this, cmd, IProcessCreateDefault | IProcessReactor,
+                                               m_startupInfo.GetWorkingDirectory());
         }
         if(!m_lspServer) {
             throw clException(wxString() << "Failed to execute process: " << cmd);
@@ -35,6 +35,7 @@ void LanguageServerConfig::FromJSON(const JSONItem& json)
 {
     m_servers.clear();
     m_flags = json.namedObject("flags").toSize_t(m_flags);
+    m_maxRequestsInFlight = json.namedObject("maxRequestsInFlight").toSize_t(m_maxRequestsInFlight);
     if(json.hasNamedObject("servers")) {
         JSONItem servers = json.namedObject("servers");
         size_t count = servers.arraySize();
@@ -51,6 +52,7 @@ JSONItem LanguageServerConfig::ToJSON() const
 {
     JSONItem json = JSONItem::createObject(GetName());
     json.addProperty("flags", m_flags);
+    json.addProperty("maxRequestsInFlight", m_maxRequestsInFlight);
     JSONItem servers = JSONItem::createArray("servers");
     for (const auto& p : m_servers) {
         servers.append(p.second.ToJSON());
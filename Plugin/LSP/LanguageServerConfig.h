@@ -15,6 +15,7 @@ public:
 protected:
     size_t m_flags = 0;
     LanguageServerEntry::Map_t m_servers;
+    size_t m_maxRequestsInFlight = 8;
 
 private:
     LanguageServerConfig();
@@ -43,6 +44,12 @@ public:
     }
     size_t GetFlags() const { return m_flags; }
     bool IsEnabled() const { return HasFlag(kEnabaled); }
+    /**
+     * @brief the number of requests that can wait for a reply from a language server at the same time. 1 means that
+     * requests are sent one at a time
+     */
+    void SetMaxRequestsInFlight(size_t count) { m_maxRequestsInFlight = count; }
+    size_t GetMaxRequestsInFlight() const { return m_maxRequestsInFlight; }
     void SetEnabled(bool b) { EnableFlag(kEnabaled, b); }
     LanguageServerConfig& SetServers(const LanguageServerEntry::Map_t& servers)
     {
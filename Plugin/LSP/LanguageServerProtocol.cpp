@@ -1,5 +1,6 @@
 #include "LanguageServerProtocol.h"
 
+#include "LSP/CancelRequestNotification.hpp"
 #include "LSP/CodeActionRequest.hpp"
 #include "LSP/CompletionRequest.h"
 #include "LSP/DidChangeTextDocumentRequest.h"
@@ -17,6 +18,7 @@
 #include "LSP/LSPNetworkRemoteSTDIO.hpp"
 #include "LSP/LSPNetworkSTDIO.h"
 #include "LSP/LSPNetworkSocketClient.h"
+#include "LSP/MessageDecoder.hpp"
 #include "LSP/RenameRequest.hpp"
 #include "LSP/Request.h"
 #include "LSP/ResponseError.h"
@@ -25,6 +27,7 @@
 #include "LSP/SignatureHelpRequest.h"
 #include "LSP/WorkspaceExecuteCommand.hpp"
 #include "LSP/WorkspaceSymbolRequest.hpp"
+#include "LanguageServerConfig.h"
 #include "clWorkspaceManager.h"
 #include "cl_exception.h"
 #include "codelite_events.h"
@@ -43,6 +46,12 @@
 #include <wx/stc/stc.h>
 #include <wx/textdlg.h>
 
+namespace
+{
+/// stop waiting for a reply after this amount of time
+constexpr long long LSP_REPLY_TIMEOUT_MS = 60 * 1000;
+} // namespace
+
 thread_local wxString emptyString;
 FileExtManager::FileType LanguageServerProtocol::workspace_file_type = FileExtManager::TypeOther;
 
@@ -176,6 +185,18 @@ void LanguageServerProtocol::QueueMessage(LSP::MessageWithParams::Ptr_t request)
     if (request->As<LSP::CompletionRequest>()) {
         m_lastCompletionRequestId = request->As<LSP::CompletionRequest>()->GetId();
     }
+
+    // a newer request makes older requests of the same kind redundant (e.g. a completion request for the previous
+    // caret position). Let the server know that it can stop working on them
+    for (int id : m_Queue.DropSuperseded(request)) {
+        LSP_DEBUG() << "Cancelling request ID#" << id << "superseded by" << request->GetMethod() << endl;
+        LSP::MessageWithParams::Ptr_t cancel_notification =
+            LSP::MessageWithParams::MakeRequest(new LSP::CancelRequestNotification(id));
+        if (IsRunning()) {
+            m_network->Send(cancel_notification->ToString());
+        }
+    }
+
     m_Queue.Push(request);
     ProcessQueue();
 }
@@ -236,10 +257,18 @@ bool LanguageServerProtocol::Start()
 void LanguageServerProtocol::DoClear()
 {
     m_filesTracker.clear();
-    m_outputBuffer.clear();
+    m_recordedEditors.clear();
+    m_incrementalChangeSupported = false;
+    m_messageDecoder.Clear();
     m_state = kUnInitialized;
     m_initializeRequestID = wxNOT_FOUND;
+    for (const auto& [method, stats] : m_Queue.GetStats()) {
+        LSP_DEBUG() << GetLogPrefix() << method << "replies:" << stats.count << "avg:" << stats.GetAverageMs()
+                    << "ms, max:" << stats.max_ms << "ms, cancelled:" << stats.cancelled
+                    << ", expired:" << stats.expired << endl;
+    }
     m_Queue.Clear();
+    m_Queue.SetWindow(LanguageServerConfig::Get().GetMaxRequestsInFlight());
     m_lastCompletionRequestId = wxNOT_FOUND;
     // Destroy the current connection
     m_network->Close();
@@ -279,8 +308,7 @@ void LanguageServerProtocol::FindDefinition(IEditor* editor)
 
     // If the editor is modified, we need to tell the LSP to re-parse the source file
     wxString filename = GetEditorFilePath(editor);
-    wxString fileContent = editor->GetEditorText();
-    SendOpenOrChangeRequest(editor, fileContent, GetLanguageId(editor));
+    SendOpenOrChangeRequest(editor, GetLanguageId(editor));
 
     // If we have a selection, use the start position.
     int pos{wxNOT_FOUND};
@@ -294,18 +322,44 @@ void LanguageServerProtocol::FindDefinition(IEditor* editor)
     QueueMessage(req);
 }
 
-void LanguageServerProtocol::SendOpenOrChangeRequest(IEditor* editor,
-                                                     const wxString& fileContent,
-                                                     const wxString& languageId)
+void LanguageServerProtocol::SendOpenOrChangeRequest(IEditor* editor, const wxString& languageId)
 {
     CHECK_PTR_RET(editor);
     wxString filename = GetEditorFilePath(editor);
 
+    if (m_filesTracker.is_recording(filename)) {
+        // the editor reports its modifications to us, no need to fetch and compare the file content
+        if (!IsInitialized()) {
+            // keep the changes until the server is ready
+            return;
+        }
+
+        if (!m_filesTracker.has_changes(filename)) {
+            LOG_IF_TRACE { LSP_TRACE() << GetLogPrefix() << "No changes detected in file:" << filename << endl; }
+            return;
+        }
+
+        std::vector<LSP::TextDocumentContentChangeEvent> changes;
+        bool can_send_changes = m_filesTracker.take_changes(filename, &changes) && IsIncrementalChangeSupported();
+
+        LSP::DidChangeTextDocumentRequest::Ptr_t req;
+        if (can_send_changes) {
+            LSP_DEBUG() << "textDocument/didChange: using incremental changes:" << changes.size() << "changes" << endl;
+            req = LSP::MessageWithParams::MakeRequest(new LSP::DidChangeTextDocumentRequest(filename, changes));
+        } else {
+            LSP_DEBUG() << "textDocument/didChange: using full change request" << endl;
+            req = LSP::MessageWithParams::MakeRequest(
+                new LSP::DidChangeTextDocumentRequest(filename, editor->GetEditorText()));
+        }
+        QueueMessage(req);
+        return;
+    }
+
+    wxString fileContent = editor->GetEditorText();
     wxString preContent;
     if (m_filesTracker.exists(filename) && m_filesTracker.get_last_content(filename, &preContent)) {
         // we already did "open" for this, see if there are changes to report back to the language server
-        auto changes = m_filesTracker.changes_from(preContent, fileContent);
-        if (changes.empty()) {
+        if (preContent == fileContent) {
             // everything is up-to-date
             LOG_IF_TRACE { LSP_TRACE() << GetLogPrefix() << "No changes detected in file:" << filename << endl; }
             return;
@@ -320,6 +374,7 @@ void LanguageServerProtocol::SendOpenOrChangeRequest(IEditor* editor,
         // incremental changes are supported, send them
         if (IsIncrementalChangeSupported()) {
             // only send the changes
+            auto changes = m_filesTracker.changes_from(preContent, fileContent);
             LSP_DEBUG() << "textDocument/didChange: using incremental changes:" << changes.size() << "changes" << endl;
             req->GetParams()->As<LSP::DidChangeTextDocumentParams>()->SetContentChanges(changes);
         } else {
@@ -333,12 +388,91 @@ void LanguageServerProtocol::SendOpenOrChangeRequest(IEditor* editor,
             LSP::MessageWithParams::MakeRequest(new LSP::DidOpenTextDocumentRequest(filename, fileContent, languageId));
         QueueMessage(req);
 
+        // from now on, let the editor tell us what was changed
+        wxStyledTextCtrl* ctrl = editor->GetCtrl();
+        if (ctrl) {
+            // make sure we are bound only once
+            ctrl->Unbind(wxEVT_STC_MODIFIED, &LanguageServerProtocol::OnEditorModified, this);
+            ctrl->Bind(wxEVT_STC_MODIFIED, &LanguageServerProtocol::OnEditorModified, this);
+            m_recordedEditors.erase(ctrl);
+            m_recordedEditors.insert({ ctrl, filename });
+            m_filesTracker.start_recording(filename);
+        }
+
         // send a semantic request
         SendSemanticTokensRequest(editor);
     }
 
-    // update the content for the file
-    m_filesTracker.update_content(filename, fileContent);
+    if (!m_filesTracker.is_recording(filename)) {
+        // update the content for the file
+        m_filesTracker.update_content(filename, fileContent);
+    }
+}
+
+namespace
+{
+/// convert a Scintilla position into an LSP position (the character is counted in characters, not bytes)
+LSP::Position to_lsp_position(wxStyledTextCtrl* ctrl, int pos)
+{
+    int line = ctrl->LineFromPosition(pos);
+    return LSP::Position{ line, ctrl->CountCharacters(ctrl->PositionFromLine(line), pos) };
+}
+
+/// return the position reached after walking over `text`, starting from `start`
+LSP::Position advance_position(const LSP::Position& start, const wxString& text)
+{
+    size_t last_lf = text.rfind('\n');
+    if (last_lf == wxString::npos) {
+        return LSP::Position{ start.GetLine(), start.GetCharacter() + static_cast<int>(text.length()) };
+    }
+
+    int lines = 0;
+    for (wxChar ch : text) {
+        if (ch == '\n') {
+            ++lines;
+        }
+    }
+    return LSP::Position{ start.GetLine() + lines, static_cast<int>(text.length() - last_lf - 1) };
+}
+} // namespace
+
+void LanguageServerProtocol::OnEditorModified(wxStyledTextEvent& event)
+{
+    event.Skip();
+    wxStyledTextCtrl* ctrl = dynamic_cast<wxStyledTextCtrl*>(event.GetEventObject());
+    auto iter = m_recordedEditors.find(ctrl);
+    if (ctrl == nullptr || iter == m_recordedEditors.end()) {
+        return;
+    }
+
+    const wxString& filename = iter->second;
+    if (!m_filesTracker.is_recording(filename)) {
+        return;
+    }
+
+    int type = event.GetModificationType();
+    if (!(type & (wxSTC_MOD_INSERTTEXT | wxSTC_MOD_DELETETEXT))) {
+        return;
+    }
+
+    if (!IsIncrementalChangeSupported()) {
+        // the server wants the entire file anyway, just remember that it changed
+        m_filesTracker.set_full_sync(filename);
+        return;
+    }
+
+    // both notifications are sent after the document was modified. The text before the modification position is
+    // unchanged, so the start position is valid for the document before the change as well
+    LSP::TextDocumentContentChangeEvent change;
+    LSP::Position start = to_lsp_position(ctrl, event.GetPosition());
+    if (type & wxSTC_MOD_INSERTTEXT) {
+        change.SetRange(LSP::Range{ start, start });
+        change.SetText(event.GetText());
+    } else {
+        // for deletions, the notification carries the removed text
+        change.SetRange(LSP::Range{ start, advance_position(start, event.GetText()) });
+    }
+    m_filesTracker.add_change(filename, change);
 }
 
 void LanguageServerProtocol::SendCloseRequest(const wxString& filename)
@@ -362,7 +496,7 @@ void LanguageServerProtocol::SendSaveRequest(IEditor* editor, const wxString& fi
 
         // before sending the save request, send a change request
         LSP_DEBUG() << "Flushing changes before save" << endl;
-        SendOpenOrChangeRequest(editor, fileContent, GetLanguageId(editor));
+        SendOpenOrChangeRequest(editor, GetLanguageId(editor));
 
         LSP::CompletionRequest::Ptr_t req =
             LSP::MessageWithParams::MakeRequest(new LSP::DidSaveTextDocumentRequest(filename, fileContent));
@@ -425,6 +559,13 @@ void LanguageServerProtocol::OnFileClosed(clCommandEvent& event)
     event.Skip();
     SendCloseRequest(event.GetFileName());
     m_filesTracker.erase(event.GetFileName());
+    for (auto iter = m_recordedEditors.begin(); iter != m_recordedEditors.end();) {
+        if (iter->second == event.GetFileName()) {
+            iter = m_recordedEditors.erase(iter);
+        } else {
+            ++iter;
+        }
+    }
 }
 
 void LanguageServerProtocol::OnFileSaved(clCommandEvent& event)
@@ -450,8 +591,7 @@ void LanguageServerProtocol::OpenEditor(IEditor* editor)
     }
 
     if (editor && ShouldHandleFile(editor)) {
-        wxString fileContent = editor->GetEditorText();
-        SendOpenOrChangeRequest(editor, fileContent, GetLanguageId(editor));
+        SendOpenOrChangeRequest(editor, GetLanguageId(editor));
         SendSemanticTokensRequest(editor);
         // cache symbols
         DocumentSymbols(editor, LSP::DocumentSymbolsRequest::CONTEXT_OUTLINE_VIEW, nullptr);
@@ -465,8 +605,7 @@ void LanguageServerProtocol::FunctionHelp(IEditor* editor)
     CHECK_COND_RET(ShouldHandleFile(editor));
 
     // If the editor is modified, we need to tell the LSP to reparse the source file
-    wxString fileContent = editor->GetEditorText();
-    SendOpenOrChangeRequest(editor, fileContent, GetLanguageId(editor));
+    SendOpenOrChangeRequest(editor, GetLanguageId(editor));
     const wxString& filename = GetEditorFilePath(editor);
     LSP::SignatureHelpRequest::Ptr_t req = LSP::MessageWithParams::MakeRequest(new LSP::SignatureHelpRequest(
         filename, editor->GetCurrentLine(), editor->GetColumnInChars(editor->GetCurrentPosition())));
@@ -481,8 +620,7 @@ void LanguageServerProtocol::HoverTip(IEditor* editor)
 
     // If the editor is modified, we need to tell the LSP to reparse the source file
     const wxString& filename = GetEditorFilePath(editor);
-    wxString fileContent = editor->GetEditorText();
-    SendOpenOrChangeRequest(editor, fileContent, GetLanguageId(editor));
+    SendOpenOrChangeRequest(editor, GetLanguageId(editor));
 
     if (ShouldHandleFile(editor)) {
         int pos = editor->GetPosAtMousePointer();
@@ -501,8 +639,7 @@ void LanguageServerProtocol::CodeComplete(IEditor* editor, bool userTriggered)
     CHECK_PTR_RET(editor);
     CHECK_COND_RET(ShouldHandleFile(editor));
     // If the editor is modified, we need to tell the LSP to reparse the source file
-    wxString fileContent = editor->GetEditorText();
-    SendOpenOrChangeRequest(editor, fileContent, GetLanguageId(editor));
+    SendOpenOrChangeRequest(editor, GetLanguageId(editor));
 
     // Now request the for code completion
     SendCodeCompleteRequest(
@@ -514,22 +651,25 @@ void LanguageServerProtocol::ProcessQueue()
     if (m_Queue.IsEmpty()) {
         return;
     }
-    if (m_Queue.IsWaitingReponse()) {
-        LSP_DEBUG() << "LSP is busy, will not send message";
-        return;
-    }
-    LSP::MessageWithParams::Ptr_t req = m_Queue.Get();
+
     if (!IsRunning()) {
         LSP_DEBUG() << GetLogPrefix() << "is down.";
         return;
     }
 
-    // Write the message length as string of 10 bytes
-    m_network->Send(req->ToString());
-    m_Queue.SetWaitingReponse(true);
-    m_Queue.Pop();
-    if (!req->GetStatusMessage().IsEmpty()) {
-        clGetManager()->SetStatusMessage(req->GetStatusMessage(), 1);
+    m_Queue.ExpireInFlight(LSP_REPLY_TIMEOUT_MS);
+    if (!m_Queue.CanSend()) {
+        LSP_DEBUG() << "LSP is busy," << m_Queue.GetInFlightCount() << "requests are waiting for a reply";
+        return;
+    }
+
+    // send everything the window allows
+    while (m_Queue.CanSend()) {
+        LSP::MessageWithParams::Ptr_t req = m_Queue.TakeNext();
+        m_network->Send(req->ToString());
+        if (!req->GetStatusMessage().IsEmpty()) {
+            clGetManager()->SetStatusMessage(req->GetStatusMessage(), 1);
+        }
     }
 }
 
@@ -555,8 +695,7 @@ void LanguageServerProtocol::FindDeclaration(IEditor* editor, bool for_add_missi
     CHECK_COND_RET(ShouldHandleFile(editor));
 
     // If the editor is modified, we need to tell the LSP to reparse the source file
-    wxString fileContent = editor->GetEditorText();
-    SendOpenOrChangeRequest(editor, fileContent, GetLanguageId(editor));
+    SendOpenOrChangeRequest(editor, GetLanguageId(editor));
 
     LSP_DEBUG() << GetLogPrefix() << "Sending GotoDeclarationRequest" << endl;
     LSP::GotoDeclarationRequest::Ptr_t req = LSP::MessageWithParams::MakeRequest(
@@ -611,13 +750,12 @@ void LanguageServerProtocol::OnNetError(clCommandEvent& event)
 
 void LanguageServerProtocol::EventMainLoop(clCommandEvent& event)
 {
-    m_outputBuffer.append(event.GetStringRaw());
-    LSP_DEBUG() << "Received data from LSP server of size:" << m_outputBuffer.size() << "bytes" << endl;
+    m_messageDecoder.Append(event.GetStringRaw());
+    LSP_DEBUG() << "Received data from LSP server of size:" << m_messageDecoder.GetPendingSize() << "bytes" << endl;
 
-    m_Queue.SetWaitingReponse(false);
-    while (!m_outputBuffer.empty()) {
+    while (!m_messageDecoder.IsEmpty()) {
         // attempt to consume a complete JSON payload from the aggregated network buffer
-        auto json = LSP::Message::GetJSONPayload(m_outputBuffer);
+        auto json = m_messageDecoder.Next();
         if (!json) {
             LOG_IF_TRACE { LSP_TRACE() << "Unable to read JSON payload" << endl; }
             LOG_IF_DEBUG
@@ -627,18 +765,24 @@ void LanguageServerProtocol::EventMainLoop(clCommandEvent& event)
                 // dump the output buffer into a file and continue
                 // we only dump 3 files per CodeLite session
                 static size_t dumps_count = 0;
-                if (dumps_count < 3 && (m_outputBuffer.size() > (1024 * 1024 * 1024))) {
+                if (dumps_count < 3 && (m_messageDecoder.GetPendingSize() > (1024 * 1024 * 1024))) {
                     dumps_count++;
                     auto tmp_filename =
                         FileUtils::CreateTempFileName(clStandardPaths::Get().GetTempDir(), "cl_lsp", "txt");
-                    FileUtils::WriteFileContent(tmp_filename, m_outputBuffer);
-                    LSP_SYSTEM() << "Output buffer exceeds 1MB (" << m_outputBuffer.size() << "Bytes)" << endl;
-                    LSP_SYSTEM() << "Dumped m_outputBuffer into:" << tmp_filename.GetFullPath() << endl;
+                    FileUtils::WriteFileContentRaw(tmp_filename, std::string{ m_messageDecoder.GetPending() });
+                    LSP_SYSTEM() << "Output buffer exceeds 1MB (" << m_messageDecoder.GetPendingSize() << "Bytes)"
+                                 << endl;
+                    LSP_SYSTEM() << "Dumped the output buffer into:" << tmp_filename.GetFullPath() << endl;
                 }
             }
             break;
         }
 
+        if (!json->isOk()) {
+            // the decoder already logged this, move on to the next message
+            continue;
+        }
+
         auto json_item = json->toElement();
         // check the message type
         wxString message_method = json_item["method"].toString();
@@ -669,9 +813,13 @@ void LanguageServerProtocol::EventMainLoop(clCommandEvent& event)
             // other response
             LSP::ResponseMessage res(std::move(json));
             if (IsInitialized()) {
-                LSP::MessageWithParams::Ptr_t msg_ptr = m_Queue.TakePendingReplyMessage(res.GetId());
-                // Is this an error message?
-                if (res.IsErrorResponse()) {
+                bool cancelled = false;
+                LSP::MessageWithParams::Ptr_t msg_ptr = m_Queue.TakePendingReplyMessage(res.GetId(), &cancelled);
+                if (cancelled) {
+                    // we asked the server to cancel this request, nobody is waiting for this reply
+                    LSP_DEBUG() << GetLogPrefix() << "Ignoring reply for cancelled request ID#" << res.GetId() << endl;
+
+                } else if (res.IsErrorResponse()) {
                     // an error response arrived, handle it
                     HandleResponseError(res, msg_ptr);
                 } else {
@@ -682,6 +830,7 @@ void LanguageServerProtocol::EventMainLoop(clCommandEvent& event)
                 // Server is not initialized yet: only accept initialization responses here
                 if (res.GetId() == m_initializeRequestID) {
                     m_state = kInitialized;
+                    m_Queue.TakePendingReplyMessage(res.GetId());
 
                     // Keep the semantic tokens array
                     if (CheckCapability(res, "semanticTokensProvider", "textDocument/semanticTokens/full")) {
@@ -696,11 +845,14 @@ void LanguageServerProtocol::EventMainLoop(clCommandEvent& event)
                     CheckCapability(res, "workspaceSymbolProvider", "workspace/symbol");
                     CheckCapability(res, "renameProvider", "textDocument/rename");
                     CheckCapability(res, "referencesProvider", "textDocument/references");
-                    // Check for textDocumentSync capability
+                    // Check for textDocumentSync capability. It is either a `TextDocumentSyncKind` number or a
+                    // `TextDocumentSyncOptions` object
                     // https://microsoft.github.io/language-server-protocol/specifications/lsp/3.17/specification/#textDocumentSyncOptions
-                    if (res["result"]["capabilities"]["textDocumentSync"]["change"].toInt(wxNOT_FOUND) == 2) {
-                        m_incrementalChangeSupported = true;
-                    }
+                    auto text_document_sync = res["result"]["capabilities"]["textDocumentSync"];
+                    int sync_kind = text_document_sync.isNumber() ? text_document_sync.toInt(wxNOT_FOUND)
+                                                                  : text_document_sync["change"].toInt(wxNOT_FOUND);
+                    m_incrementalChangeSupported = (sync_kind == 2);
+                    LSP_DEBUG() << GetLogPrefix() << "Server text document sync kind:" << sync_kind << endl;
 
                     LSP_DEBUG() << GetLogPrefix() << "Sending InitializedNotification" << endl;
 
@@ -980,64 +1132,130 @@ void LanguageServerProtocol::SetStartedCallback(LSPOnConnectedCallback_t&& cb)
 // LSPRequestMessageQueue
 //===------------------------------------------------------------------
 
-void LSPRequestMessageQueue::Push(LSP::MessageWithParams::Ptr_t message)
+void LSPRequestMessageQueue::Push(LSP::MessageWithParams::Ptr_t message) { m_Queue.push_back(message); }
+
+bool LSPRequestMessageQueue::CanSend() const
 {
-    m_Queue.push(message);
+    if (m_Queue.empty()) {
+        return false;
+    }
+
+    // notifications do not expect a reply, they are never held back. Requests are sent as long as the window is not
+    // full. We never send a message ahead of the queue head, so the server sees the messages in the order they were
+    // queued (e.g. `didChange` is always received before the `completion` request that follows it)
+    return m_Queue.front()->As<LSP::Request>() == nullptr || m_inFlight.size() < m_window;
+}
+
+LSP::MessageWithParams::Ptr_t LSPRequestMessageQueue::TakeNext()
+{
+    if (m_Queue.empty()) {
+        return LSP::MessageWithParams::Ptr_t(nullptr);
+    }
+
+    LSP::MessageWithParams::Ptr_t message = m_Queue.front();
+    m_Queue.pop_front();
 
     // Messages of type 'Request' require responses from the server
     LSP::Request* req = message->As<LSP::Request>();
     if (req) {
-        m_pendingReplyMessages.insert({req->GetId(), message});
+        m_inFlight.insert({ req->GetId(), InFlight{ message, std::chrono::steady_clock::now(), false } });
     }
+    return message;
 }
 
-void LSPRequestMessageQueue::Pop()
+std::vector<int> LSPRequestMessageQueue::DropSuperseded(const LSP::MessageWithParams::Ptr_t& request)
 {
-    if (!m_Queue.empty()) {
-        m_Queue.pop();
+    std::vector<int> cancelled_ids;
+    LSP::Request* req = request->As<LSP::Request>();
+    if (req == nullptr) {
+        return cancelled_ids;
+    }
+
+    wxString key = req->GetSupersedeKey();
+    if (key.empty()) {
+        return cancelled_ids;
+    }
+
+    auto is_superseded = [&key](const LSP::MessageWithParams::Ptr_t& message) -> bool {
+        LSP::Request* r = message->As<LSP::Request>();
+        return r && r->GetSupersedeKey() == key;
+    };
+
+    // queued requests were never sent, just drop them
+    m_Queue.erase(std::remove_if(m_Queue.begin(), m_Queue.end(), is_superseded), m_Queue.end());
+
+    // requests that were already sent must be cancelled
+    for (auto& [id, in_flight] : m_inFlight) {
+        if (!in_flight.cancelled && is_superseded(in_flight.message)) {
+            in_flight.cancelled = true;
+            cancelled_ids.push_back(id);
+        }
     }
-    SetWaitingReponse(false);
+    return cancelled_ids;
 }
 
-LSP::MessageWithParams::Ptr_t LSPRequestMessageQueue::Get()
+void LSPRequestMessageQueue::ExpireInFlight(long long timeout_ms)
 {
-    if (m_Queue.empty()) {
-        return LSP::MessageWithParams::Ptr_t(nullptr);
+    auto now = std::chrono::steady_clock::now();
+    for (auto iter = m_inFlight.begin(); iter != m_inFlight.end();) {
+        auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(now - iter->second.sent_at).count();
+        if (elapsed < timeout_ms) {
+            ++iter;
+            continue;
+        }
+
+        LSP_WARNING() << "No reply for" << iter->second.message->GetMethod() << "request ID#" << iter->first
+                      << "after" << elapsed << "ms. Giving up" << endl;
+        m_stats[iter->second.message->GetMethod()].expired++;
+        iter = m_inFlight.erase(iter);
     }
-    return m_Queue.front();
 }
 
 void LSPRequestMessageQueue::Clear()
 {
-    while (!m_Queue.empty()) {
-        m_Queue.pop();
-    }
-    SetWaitingReponse(false);
-    m_pendingReplyMessages.clear();
+    m_Queue.clear();
+    m_inFlight.clear();
 }
 
 void LSPRequestMessageQueue::Move(LSPRequestMessageQueue& other)
 {
-    while (!other.m_Queue.empty()) {
-        m_Queue.push(other.m_Queue.front());
-        other.m_Queue.pop();
-    }
+    m_Queue.insert(m_Queue.end(), other.m_Queue.begin(), other.m_Queue.end());
+    other.m_Queue.clear();
 
-    SetWaitingReponse(false);
-    m_pendingReplyMessages.clear();
+    // replies that `other` is waiting for are now ours
+    m_inFlight.merge(other.m_inFlight);
+    other.m_inFlight.clear();
 }
 
-LSP::MessageWithParams::Ptr_t LSPRequestMessageQueue::TakePendingReplyMessage(int msgid)
+LSP::MessageWithParams::Ptr_t LSPRequestMessageQueue::TakePendingReplyMessage(int msgid, bool* cancelled)
 {
-    if (m_pendingReplyMessages.empty()) {
+    auto iter = m_inFlight.find(msgid);
+    if (iter == m_inFlight.end()) {
         return LSP::MessageWithParams::Ptr_t(nullptr);
     }
-    if (m_pendingReplyMessages.count(msgid) == 0) {
-        return LSP::MessageWithParams::Ptr_t(nullptr);
+
+    InFlight in_flight = std::move(iter->second);
+    m_inFlight.erase(iter);
+
+    auto elapsed =
+        std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - in_flight.sent_at)
+            .count();
+    auto& stats = m_stats[in_flight.message->GetMethod()];
+    if (in_flight.cancelled) {
+        stats.cancelled++;
+    } else {
+        stats.count++;
+        stats.total_ms += elapsed;
+        stats.max_ms = std::max<long long>(stats.max_ms, elapsed);
+    }
+
+    LSP_DEBUG() << "Reply for" << in_flight.message->GetMethod() << "request ID#" << msgid << "arrived after"
+                << elapsed << "ms" << (in_flight.cancelled ? "(cancelled)" : "") << endl;
+
+    if (cancelled) {
+        *cancelled = in_flight.cancelled;
     }
-    LSP::MessageWithParams::Ptr_t msgptr = m_pendingReplyMessages[msgid];
-    m_pendingReplyMessages.erase(msgid);
-    return msgptr;
+    return in_flight.cancelled ? LSP::MessageWithParams::Ptr_t(nullptr) : in_flight.message;
 }
 
 void LanguageServerProtocol::OnWorkspaceLoaded(clWorkspaceEvent& e) { e.Skip(); }
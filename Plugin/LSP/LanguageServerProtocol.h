@@ -7,6 +7,7 @@
 #include "LSP/IPathConverter.hpp"
 #include "LSP/LSPEvent.h"
 #include "LSP/LSPNetwork.h"
+#include "LSP/MessageDecoder.hpp"
 #include "LSP/MessageWithParams.h"
 #include "SocketAPI/clSocketClientAsync.h"
 #include "cl_command_event.h"
@@ -16,35 +17,100 @@
 #include "macros.h"
 #include "wxStringHash.h"
 
+#include <algorithm>
+#include <chrono>
+#include <deque>
 #include <functional>
 #include <memory>
-#include <queue>
 #include <string>
 #include <unordered_map>
+#include <vector>
 #include <wx/arrstr.h>
 #include <wx/filename.h>
 
 using LSPOnConnectedCallback_t = std::function<void()>;
 
 class IEditor;
+class wxStyledTextCtrl;
+class wxStyledTextEvent;
+/**
+ * @class LSPRequestMessageQueue
+ * @brief the outgoing message queue of a language server.
+ *
+ * Messages are sent in the order they were queued. Up to `GetWindow()` requests can wait for their reply at the same
+ * time (notifications are never held back by pending replies). A window of 1 restores the one-request-at-a-time
+ * behavior
+ */
 class WXDLLIMPEXP_SDK LSPRequestMessageQueue
 {
-    std::queue<LSP::MessageWithParams::Ptr_t> m_Queue;
-    std::unordered_map<int, LSP::MessageWithParams::Ptr_t> m_pendingReplyMessages;
-    bool m_waitingReponse = false;
+public:
+    struct MethodStats {
+        size_t count = 0;
+        size_t cancelled = 0;
+        size_t expired = 0;
+        long long total_ms = 0;
+        long long max_ms = 0;
+
+        long long GetAverageMs() const { return count ? total_ms / (long long)count : 0; }
+    };
+
+private:
+    struct InFlight {
+        LSP::MessageWithParams::Ptr_t message;
+        std::chrono::steady_clock::time_point sent_at;
+        bool cancelled = false;
+    };
+
+    std::deque<LSP::MessageWithParams::Ptr_t> m_Queue;
+    std::unordered_map<int, InFlight> m_inFlight;
+    std::unordered_map<wxString, MethodStats> m_stats;
+    size_t m_window = 8;
 
 public:
     LSPRequestMessageQueue() = default;
     virtual ~LSPRequestMessageQueue() = default;
 
-    LSP::MessageWithParams::Ptr_t TakePendingReplyMessage(int msgid);
+    /**
+     * @brief return the request that matches the reply `msgid` and stop tracking it. Returns nullptr if `msgid` is
+     * unknown or if the request was cancelled (in which case `cancelled` is set to true)
+     */
+    LSP::MessageWithParams::Ptr_t TakePendingReplyMessage(int msgid, bool* cancelled = nullptr);
     void Push(LSP::MessageWithParams::Ptr_t message);
-    void Pop();
-    LSP::MessageWithParams::Ptr_t Get();
+
+    /**
+     * @brief can the message at the head of the queue be sent now?
+     */
+    bool CanSend() const;
+
+    /**
+     * @brief remove the message at the head of the queue. If it is a request, start tracking its reply
+     */
+    LSP::MessageWithParams::Ptr_t TakeNext();
+
+    /**
+     * @brief drop the queued requests that are superseded by `request` (see `LSP::Request::GetSupersedeKey()`). Sent
+     * requests can not be dropped: they are marked as cancelled and their IDs are returned, so the caller can send a
+     * `$/cancelRequest` for them
+     */
+    std::vector<int> DropSuperseded(const LSP::MessageWithParams::Ptr_t& request);
+
+    /**
+     * @brief stop waiting for replies that did not arrive within `timeout_ms`, so a server that drops requests can
+     * not block the queue forever
+     */
+    void ExpireInFlight(long long timeout_ms);
+
     void Clear();
     bool IsEmpty() const { return m_Queue.empty(); }
-    void SetWaitingReponse(bool waitingReponse) { this->m_waitingReponse = waitingReponse; }
-    bool IsWaitingReponse() const { return m_waitingReponse; }
+    size_t GetInFlightCount() const { return m_inFlight.size(); }
+
+    void SetWindow(size_t window) { m_window = std::max<size_t>(window, 1); }
+    size_t GetWindow() const { return m_window; }
+
+    /**
+     * @brief per method reply latency
+     */
+    const std::unordered_map<wxString, MethodStats>& GetStats() const { return m_stats; }
 
     /// move the content of `other` into `this` while consuming the `other` queue
     void Move(LSPRequestMessageQueue& other);
@@ -62,8 +128,9 @@ class WXDLLIMPEXP_SDK LanguageServerProtocol : public wxEvtHandler
     LSPNetwork::Ptr_t m_network;
     wxString m_initOptions;
     FileContentTracker m_filesTracker;
+    std::unordered_map<wxStyledTextCtrl*, wxString> m_recordedEditors;
     wxStringSet_t m_languages;
-    std::string m_outputBuffer;
+    LSP::MessageDecoder m_messageDecoder;
     wxString m_rootFolder;
     clEnvList_t m_env;
     LSPStartupInfo m_startupInfo;
@@ -101,6 +168,7 @@ protected:
     void OnWorkspaceLoaded(clWorkspaceEvent& e);
     void OnWorkspaceClosed(clWorkspaceEvent& e);
     void OnEditorChanged(wxCommandEvent& event);
+    void OnEditorModified(wxStyledTextEvent& event);
 
     wxString GetEditorFilePath(IEditor* editor) const;
     bool
@@ -117,9 +185,9 @@ protected:
     IEditor* GetEditor(const clCodeCompletionEvent& event) const;
 
     /**
-     * @brief notify about file open
+     * @brief notify about file open. If the file is already opened, report the changes made since the last call
      */
-    void SendOpenOrChangeRequest(IEditor* editor, const wxString& fileContent, const wxString& languageId);
+    void SendOpenOrChangeRequest(IEditor* editor, const wxString& languageId);
 
     /**
      * @brief report a file-close notification
@@ -0,0 +1,493 @@
+#include "clBuildOutputMatcher.hpp"
+
+#include "file_logger.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <deque>
+
+namespace
+{
+/**
+ * @brief a minimal parser for the advanced regular expressions (ARE) used by the compiler patterns. It only finds out
+ * which literal strings every match must contain, it does not validate the pattern
+ */
+class RequiredLiteralsParser
+{
+    const std::string& m_re;
+    size_t m_pos = 0;
+    bool m_ok = true;
+
+    typedef clBuildOutputMatcher::Literals_t Literals_t;
+
+    enum eAtom { kAtomLiteral, kAtomOther, kAtomGroup };
+
+    static size_t Score(const Literals_t& literals)
+    {
+        // a set of literals is as selective as its shortest member
+        size_t score = std::string::npos;
+        for (const auto& literal : literals) {
+            score = std::min(score, literal.length());
+        }
+        return literals.empty() ? 0 : score;
+    }
+
+    static const Literals_t& Best(const std::vector<Literals_t>& candidates)
+    {
+        static const Literals_t empty;
+        const Literals_t* best = &empty;
+        for (const auto& candidate : candidates) {
+            size_t score = Score(candidate);
+            size_t best_score = Score(*best);
+            if (score > best_score || (score == best_score && score && candidate.size() < best->size())) {
+                best = &candidate;
+            }
+        }
+        return *best;
+    }
+
+    char Peek(size_t offset = 0) const { return m_pos + offset < m_re.length() ? m_re[m_pos + offset] : 0; }
+
+    void SkipBracket()
+    {
+        // we are on the '['
+        ++m_pos;
+        if (Peek() == '^') {
+            ++m_pos;
+        }
+        if (Peek() == ']') {
+            ++m_pos;
+        }
+        while (m_pos < m_re.length() && m_re[m_pos] != ']') {
+            if (m_re[m_pos] == '[' && (Peek(1) == ':' || Peek(1) == '.' || Peek(1) == '=')) {
+                // [:alpha:], [.x.] or [=x=]
+                size_t end = m_re.find(std::string(1, Peek(1)) + "]", m_pos + 2);
+                if (end == std::string::npos) {
+                    m_ok = false;
+                    return;
+                }
+                m_pos = end + 2;
+            } else if (m_re[m_pos] == '\\') {
+                m_pos += 2;
+            } else {
+                ++m_pos;
+            }
+        }
+
+        if (m_pos >= m_re.length()) {
+            m_ok = false;
+            return;
+        }
+        ++m_pos; // the ']'
+    }
+
+    /// parse a quantifier (if any) following an atom
+    void ParseQuantifier(bool& optional, bool& repeated)
+    {
+        optional = false;
+        repeated = false;
+        char ch = Peek();
+        if (ch == '*' || ch == '?') {
+            optional = true;
+            ++m_pos;
+        } else if (ch == '+') {
+            repeated = true;
+            ++m_pos;
+        } else if (ch == '{') {
+            ++m_pos;
+            if (!isdigit((unsigned char)Peek())) {
+                m_ok = false;
+                return;
+            }
+            size_t min_count = 0;
+            while (isdigit((unsigned char)Peek())) {
+                min_count = min_count * 10 + (Peek() - '0');
+                ++m_pos;
+            }
+            size_t end = m_re.find('}', m_pos);
+            if (end == std::string::npos) {
+                m_ok = false;
+                return;
+            }
+            m_pos = end + 1;
+            optional = min_count == 0;
+            repeated = !optional;
+        } else {
+            return;
+        }
+
+        if (Peek() == '?') {
+            // non greedy
+            ++m_pos;
+        }
+    }
+
+    /// parse a sequence of atoms up to '|' or ')'
+    Literals_t ParseSequence(bool& pure, std::string& literal)
+    {
+        std::vector<Literals_t> requirements;
+        std::string current;
+        bool is_pure = true;
+        auto flush = [&]() {
+            if (!current.empty()) {
+                requirements.push_back({ current });
+                current.clear();
+            }
+        };
+
+        while (m_ok && m_pos < m_re.length() && Peek() != '|' && Peek() != ')') {
+            eAtom kind = kAtomOther;
+            char ch = 0;
+            Literals_t group_literals;
+            bool group_pure = false;
+            std::string group_literal;
+
+            unsigned char c = m_re[m_pos];
+            if (c == '(') {
+                ++m_pos;
+                bool lookahead = false;
+                if (Peek() == '?') {
+                    if (Peek(1) == ':') {
+                        m_pos += 2;
+                    } else if (Peek(1) == '=' || Peek(1) == '!') {
+                        m_pos += 2;
+                        lookahead = true;
+                    } else {
+                        // embedded options, we can't tell
+                        m_ok = false;
+                        break;
+                    }
+                }
+                group_literals = ParseAlternation(group_pure, group_literal);
+                if (Peek() != ')') {
+                    m_ok = false;
+                    break;
+                }
+                ++m_pos;
+                kind = lookahead ? kAtomOther : kAtomGroup;
+
+            } else if (c == '[') {
+                SkipBracket();
+
+            } else if (c == '\\') {
+                char escaped = Peek(1);
+                if (escaped == 0) {
+                    m_ok = false;
+                    break;
+                }
+                if (isalnum((unsigned char)escaped)) {
+                    // class shorthand (\d, \s, \w ...) and constraint escapes (\m, \y ...) are not literals. Escapes
+                    // that encode a character (\x41, \u1234, back references) are not supported
+                    if (strchr("dDsSwWmMyYAZ", escaped) == nullptr) {
+                        m_ok = false;
+                        break;
+                    }
+                } else if ((unsigned char)escaped < 128) {
+                    kind = kAtomLiteral;
+                    ch = tolower((unsigned char)escaped);
+                }
+                m_pos += 2;
+
+            } else if (c == '*' || c == '+' || c == '?' || c == '{') {
+                m_ok = false;
+                break;
+
+            } else {
+                if (c < 128 && c != '.' && c != '^' && c != '$') {
+                    kind = kAtomLiteral;
+                    ch = tolower(c);
+                }
+                ++m_pos;
+            }
+
+            bool optional = false;
+            bool repeated = false;
+            ParseQuantifier(optional, repeated);
+            if (!m_ok) {
+                break;
+            }
+
+            if (kind == kAtomLiteral && !optional) {
+                current.push_back(ch);
+                if (repeated) {
+                    // the character appears at least once, but we can't tell what follows it
+                    flush();
+                    is_pure = false;
+                }
+
+            } else if (kind == kAtomGroup && !optional && !repeated && group_pure) {
+                // a group with a plain string, e.g. "(error)", is part of the surrounding literal
+                current.append(group_literal);
+
+            } else {
+                flush();
+                is_pure = false;
+                if (kind == kAtomGroup && !optional) {
+                    if (group_pure && !group_literal.empty()) {
+                        requirements.push_back({ group_literal });
+                    } else if (!group_literals.empty()) {
+                        requirements.push_back(group_literals);
+                    }
+                }
+            }
+        }
+        flush();
+
+        pure = is_pure && requirements.size() <= 1;
+        literal = pure && !requirements.empty() ? requirements[0][0] : std::string();
+        return Best(requirements);
+    }
+
+    /// parse alternatives up to ')' or the end of the pattern
+    Literals_t ParseAlternation(bool& pure, std::string& literal)
+    {
+        std::vector<Literals_t> alternatives;
+        bool missing = false;
+        size_t count = 0;
+        Literals_t first;
+        while (m_ok) {
+            bool seq_pure = false;
+            std::string seq_literal;
+            Literals_t literals = ParseSequence(seq_pure, seq_literal);
+            if (count == 0) {
+                pure = seq_pure;
+                literal = seq_literal;
+            }
+            ++count;
+            missing = missing || literals.empty();
+            alternatives.push_back(literals);
+
+            if (Peek() != '|') {
+                break;
+            }
+            ++m_pos;
+        }
+
+        if (count == 1) {
+            return alternatives[0];
+        }
+
+        // one of the alternatives must match
+        pure = false;
+        literal.clear();
+        if (missing) {
+            return {};
+        }
+
+        Literals_t result;
+        for (const auto& alternative : alternatives) {
+            for (const auto& s : alternative) {
+                if (std::find(result.begin(), result.end(), s) == result.end()) {
+                    result.push_back(s);
+                }
+            }
+        }
+        return result;
+    }
+
+public:
+    RequiredLiteralsParser(const std::string& re)
+        : m_re(re)
+    {
+    }
+
+    Literals_t Parse()
+    {
+        bool pure = false;
+        std::string literal;
+        if (m_re.compare(0, 4, "***=") == 0) {
+            // the rest of the pattern is a literal
+            literal = m_re.substr(4);
+            std::transform(literal.begin(), literal.end(), literal.begin(), [](unsigned char c) { return tolower(c); });
+            if (literal.empty() || std::any_of(literal.begin(), literal.end(), [](unsigned char c) { return c >= 128; })) {
+                return {};
+            }
+            return { literal };
+        }
+
+        if (m_re.compare(0, 4, "***:") == 0) {
+            m_pos = 4;
+        }
+
+        Literals_t literals = ParseAlternation(pure, literal);
+        if (!m_ok || m_pos != m_re.length()) {
+            return {};
+        }
+        return literals;
+    }
+};
+} // namespace
+
+clBuildOutputMatcher::clBuildOutputMatcher(const Compiler::CmpListInfoPattern& warnings,
+                                           const Compiler::CmpListInfoPattern& errors)
+{
+    m_nodes.emplace_back();
+    std::fill(std::begin(m_nodes[0].next), std::end(m_nodes[0].next), -1);
+
+    // warnings must be first!
+    AddPatterns(warnings, Compiler::kSevWarning);
+    AddPatterns(errors, Compiler::kSevError);
+    BuildAutomaton();
+    m_candidates.resize(m_patterns.size(), 0);
+}
+
+clBuildOutputMatcher::Literals_t clBuildOutputMatcher::GetRequiredLiterals(const wxString& pattern)
+{
+    std::string re = pattern.ToStdString(wxConvUTF8);
+    RequiredLiteralsParser parser(re);
+    return parser.Parse();
+}
+
+void clBuildOutputMatcher::AddPatterns(const Compiler::CmpListInfoPattern& patterns, Compiler::eSeverity severity)
+{
+    for (const auto& info : patterns) {
+        Pattern pattern;
+        // if any of the below conversion fails, we got a problem with this pattern
+        if (!info.fileNameIndex.ToCLong(&pattern.file_index) || !info.lineNumberIndex.ToCLong(&pattern.line_index) ||
+           !info.columnIndex.ToCLong(&pattern.column_index)) {
+            continue;
+        }
+
+        pattern.re.reset(new wxRegEx(info.pattern, wxRE_ADVANCED | wxRE_ICASE));
+        if (!pattern.re->IsValid()) {
+            clWARNING() << "Regex pattern:" << info.pattern << "is not valid!" << endl;
+            continue;
+        }
+
+        pattern.severity = severity;
+        size_t index = m_patterns.size();
+        Literals_t literals = GetRequiredLiterals(info.pattern);
+        pattern.always = literals.empty();
+        m_hasAlways = m_hasAlways || pattern.always;
+        for (const auto& literal : literals) {
+            AddLiteral(literal, index);
+        }
+        m_patterns.push_back(std::move(pattern));
+    }
+}
+
+void clBuildOutputMatcher::AddLiteral(const std::string& literal, size_t pattern_index)
+{
+    int state = 0;
+    for (unsigned char ch : literal) {
+        int next = m_nodes[state].next[ch];
+        if (next == -1) {
+            next = (int)m_nodes.size();
+            m_nodes[state].next[ch] = next;
+            m_nodes.emplace_back();
+            std::fill(std::begin(m_nodes.back().next), std::end(m_nodes.back().next), -1);
+        }
+        state = next;
+    }
+    m_nodes[state].patterns.push_back(pattern_index);
+}
+
+void clBuildOutputMatcher::BuildAutomaton()
+{
+    // classic Aho-Corasick construction: BFS over the trie, turning it into a full transition table
+    std::deque<int> queue;
+    for (int& next : m_nodes[0].next) {
+        if (next == -1) {
+            next = 0;
+        } else {
+            m_nodes[next].fail = 0;
+            queue.push_back(next);
+        }
+    }
+
+    while (!queue.empty()) {
+        int state = queue.front();
+        queue.pop_front();
+
+        const auto& fail_patterns = m_nodes[m_nodes[state].fail].patterns;
+        m_nodes[state].patterns.insert(m_nodes[state].patterns.end(), fail_patterns.begin(), fail_patterns.end());
+        for (size_t ch = 0; ch < 128; ++ch) {
+            int next = m_nodes[state].next[ch];
+            if (next == -1) {
+                m_nodes[state].next[ch] = m_nodes[m_nodes[state].fail].next[ch];
+            } else {
+                m_nodes[next].fail = m_nodes[m_nodes[state].fail].next[ch];
+                queue.push_back(next);
+            }
+        }
+    }
+}
+
+bool clBuildOutputMatcher::Scan(const wxString& line)
+{
+    std::fill(m_candidates.begin(), m_candidates.end(), 0);
+    bool found = false;
+    int state = 0;
+    for (wxUniChar ch : line) {
+        wxUint32 value = ch.GetValue();
+        if (value >= 128) {
+            // our literals are ASCII only
+            state = 0;
+            continue;
+        }
+        if (value >= 'A' && value <= 'Z') {
+            value |= 0x20;
+        }
+        state = m_nodes[state].next[value];
+        for (size_t index : m_nodes[state].patterns) {
+            m_candidates[index] = 1;
+            found = true;
+        }
+    }
+    return found;
+}
+
+bool clBuildOutputMatcher::DoMatch(Pattern& pattern, const wxString& line, Compiler::PatternMatch* match_result)
+{
+    if (!pattern.re->Matches(line)) {
+        return false;
+    }
+
+    match_result->sev = pattern.severity;
+    // extract the file name
+    if (pattern.re->GetMatchCount() > (size_t)pattern.file_index) {
+        match_result->file_path = pattern.re->GetMatch(line, pattern.file_index);
+    }
+
+    // extract the line number
+    if (pattern.re->GetMatchCount() > (size_t)pattern.line_index) {
+        long lineNumber;
+        wxString strLine = pattern.re->GetMatch(line, pattern.line_index);
+        strLine.ToCLong(&lineNumber);
+        match_result->line_number = lineNumber;
+    }
+
+    if (pattern.re->GetMatchCount() > (size_t)pattern.column_index) {
+        long column;
+        wxString strCol = pattern.re->GetMatch(line, pattern.column_index);
+        if (strCol.StartsWith(":")) {
+            strCol.Remove(0, 1);
+        }
+
+        if (!strCol.IsEmpty() && strCol.ToLong(&column)) {
+            match_result->column = column;
+        }
+    }
+    return true;
+}
+
+bool clBuildOutputMatcher::Matches(const wxString& line, Compiler::PatternMatch* match_result)
+{
+    if (!match_result || m_patterns.empty()) {
+        return false;
+    }
+
+    // most of the lines contain none of the literals: rule them out without running a single regex
+    if (!Scan(line) && !m_hasAlways) {
+        return false;
+    }
+
+    for (size_t i = 0; i < m_patterns.size(); ++i) {
+        auto& pattern = m_patterns[i];
+        if ((pattern.always || m_candidates[i]) && DoMatch(pattern, line, match_result)) {
+            return true;
+        }
+    }
+    return false;
+}
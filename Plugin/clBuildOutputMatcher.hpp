@@ -0,0 +1,79 @@
+#ifndef CLBUILDOUTPUTMATCHER_HPP
+#define CLBUILDOUTPUTMATCHER_HPP
+
+#include "codelite_exports.h"
+#include "compiler.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <wx/regex.h>
+
+/**
+ * @class clBuildOutputMatcher
+ * @brief classify build output lines using the compiler error and warning patterns
+ *
+ * Every pattern is compiled once. In addition, the literal strings that any match of the pattern must contain (e.g.
+ * " error: " or "link : fatal error") are extracted from the pattern and all of them are combined into a single
+ * Aho-Corasick automaton. A line is scanned once by the automaton and only the patterns whose literals were found are
+ * tried with the regex engine. Patterns we can not extract a literal from are always tried.
+ *
+ * The matcher keeps the match state of its regular expressions, so an instance must not be used by more than one
+ * thread at a time. It does not reference the compiler it was created from, so it can be passed to a worker thread
+ */
+class WXDLLIMPEXP_SDK clBuildOutputMatcher
+{
+public:
+    typedef std::shared_ptr<clBuildOutputMatcher> Ptr_t;
+
+    /// a set of literals, at least one of them appears in every line that the pattern matches
+    typedef std::vector<std::string> Literals_t;
+
+private:
+    struct Pattern {
+        std::unique_ptr<wxRegEx> re;
+        Compiler::eSeverity severity = Compiler::kSevError;
+        long file_index = wxNOT_FOUND;
+        long line_index = wxNOT_FOUND;
+        long column_index = wxNOT_FOUND;
+        bool always = false; // no literal prefilter, always run the regex
+    };
+
+    struct Node {
+        int next[128];
+        int fail = 0;
+        std::vector<size_t> patterns; // patterns whose literal ends at this node (including via fail links)
+    };
+
+    std::vector<Pattern> m_patterns;
+    std::vector<Node> m_nodes;
+    std::vector<unsigned char> m_candidates;
+    bool m_hasAlways = false;
+
+private:
+    void AddPatterns(const Compiler::CmpListInfoPattern& patterns, Compiler::eSeverity severity);
+    void AddLiteral(const std::string& literal, size_t pattern_index);
+    void BuildAutomaton();
+    bool Scan(const wxString& line);
+    bool DoMatch(Pattern& pattern, const wxString& line, Compiler::PatternMatch* match_result);
+
+public:
+    /**
+     * @brief build a matcher. Warnings are checked first, the first matching pattern wins
+     */
+    clBuildOutputMatcher(const Compiler::CmpListInfoPattern& warnings, const Compiler::CmpListInfoPattern& errors);
+    ~clBuildOutputMatcher() = default;
+
+    /**
+     * @brief attempt to parse line and provide details about the parsed data
+     */
+    bool Matches(const wxString& line, Compiler::PatternMatch* match_result);
+
+    /**
+     * @brief return the literals required by `pattern` (case insensitive, lower case). The list is empty when no
+     * literal can be extracted from the pattern
+     */
+    static Literals_t GetRequiredLiterals(const wxString& pattern);
+};
+
+#endif // CLBUILDOUTPUTMATCHER_HPP
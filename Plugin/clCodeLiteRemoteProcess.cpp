@@ -33,12 +33,6 @@ wxDEFINE_EVENT(wxEVT_CODELITE_REMOTE_FINDPATH, clCommandEvent);
 wxDEFINE_EVENT(wxEVT_CODELITE_REMOTE_FINDPATH_DONE, clCommandEvent);
 wxDEFINE_EVENT(wxEVT_CODELITE_REMOTE_LIST_LSPS, clCommandEvent);
 wxDEFINE_EVENT(wxEVT_CODELITE_REMOTE_LIST_LSPS_DONE, clCommandEvent);
-namespace
-{
-const char msg_terminator[] = ">>codelite-remote-msg-end<<\n";
-size_t msg_terminator_len = sizeof(msg_terminator) - 1;
-} // namespace
-
 namespace
 {
 class CodeLiteRemoteProcess : public IProcess
@@ -46,6 +40,7 @@ class CodeLiteRemoteProcess : public IProcess
     clCodeLiteRemoteProcess* m_process = nullptr;
     std::function<void(const wxString&)> m_callback = nullptr;
     wxString m_output;
+    size_t m_requestId = 0;
 
 private:
     bool DoWrite(const wxString& buff)
@@ -63,7 +58,15 @@ public:
         , m_process(process)
     {
     }
-    ~CodeLiteRemoteProcess() { m_process = nullptr; }
+    ~CodeLiteRemoteProcess()
+    {
+        if (m_process) {
+            m_process->Detach(m_requestId);
+        }
+        m_process = nullptr;
+    }
+
+    void SetRequestId(size_t request_id) { m_requestId = request_id; }
 
     // are we using callback?
     bool IsUsingCallback() const { return m_callback != nullptr; }
@@ -112,7 +115,12 @@ public:
     // Terminate the process. It is recommended to use this method
     // so it will invoke the 'Cleanup' procedure and the process
     // termination event will be sent out
-    void Terminate() override {}
+    void Terminate() override
+    {
+        if (m_process) {
+            m_process->Cancel(m_requestId);
+        }
+    }
 
     /**
      * @brief send signal to the process
@@ -196,7 +204,7 @@ void clCodeLiteRemoteProcess::StartIfNotRunning()
     command.push_back(wxString() << m_account.GetPort());
 
     // start the process in interactive mode
-    command.push_back("python3 " + m_scriptPath + " --context " + GetContext());
+    command.push_back("python3 " + m_scriptPath + " --context " + GetContext() + " --framed");
 
     clDEBUG() << "Starting codelite-remote:" << command << endl;
     // start the process
@@ -234,8 +242,13 @@ void clCodeLiteRemoteProcess::StartInteractive(const SSHAccountInfo& account,
 
 void clCodeLiteRemoteProcess::OnProcessOutput(clProcessEvent& e)
 {
-    m_outputRead << e.GetOutput();
-    ProcessOutput();
+    const std::string& raw = e.GetOutputRaw();
+    if (raw.empty()) {
+        std::string output = e.GetOutput().ToStdString(wxConvUTF8);
+        ProcessOutput(output.data(), output.size());
+    } else {
+        ProcessOutput(raw.data(), raw.size());
+    }
 }
 
 void clCodeLiteRemoteProcess::OnProcessTerminated(clProcessEvent& e)
@@ -265,98 +278,204 @@ void clCodeLiteRemoteProcess::Stop()
 
 void clCodeLiteRemoteProcess::Cleanup()
 {
-    while (!m_completionCallbacks.empty()) {
-        m_completionCallbacks.pop_back();
-    }
+    m_requests.clear();
+    m_decoder.Clear();
     m_process.reset();
 }
 
-bool clCodeLiteRemoteProcess::GetNextBuffer(wxString& raw_input_buffer, wxString& buffer, bool& is_completed)
+bool clCodeLiteRemoteProcess::DecodePayload(clRemoteFrameDecoder::eFrameType type,
+                                            std::string_view payload,
+                                            std::string& output)
 {
-    size_t separator_len = msg_terminator_len;
-    size_t where = raw_input_buffer.find(msg_terminator);
-    if (where == wxString::npos) {
-        // locate the \n from the end
-        is_completed = false;
-        where = raw_input_buffer.rfind("\n");
-        separator_len = 1;
-    } else {
-        is_completed = true;
+    if (type == clRemoteFrameDecoder::eFrameType::kCompressedData) {
+        return clRemoteFrameDecoder::Decompress(payload, output);
     }
+    output.append(payload);
+    return true;
+}
+
+void clCodeLiteRemoteProcess::ProcessOutput(const char* data, size_t len)
+{
+    // collect the frames first, and run the callbacks once the decoder is done: a callback may send a new request or
+    // stop the process
+    std::vector<size_t> ready;
+    m_decoder.Feed(data, len, [&](size_t id, clRemoteFrameDecoder::eFrameType type, std::string_view payload) {
+        if (type == clRemoteFrameDecoder::eFrameType::kText) {
+            clDEBUG() << "codelite-remote:" << wxString::FromUTF8(payload.data(), payload.size()) << endl;
+            return;
+        }
+
+        auto where = m_requests.find(id);
+        if (where == m_requests.end()) {
+            if (type == clRemoteFrameDecoder::eFrameType::kEnd && !payload.empty()) {
+                clWARNING() << "codelite-remote:" << wxString::FromUTF8(payload.data(), payload.size()) << endl;
+            } else {
+                clDEBUG() << "Read output for request" << id << ". But there is no such request" << endl;
+            }
+            return;
+        }
+
+        auto& request = where->second;
+        if (type == clRemoteFrameDecoder::eFrameType::kEnd) {
+            request.completed = true;
+            if (!payload.empty() && !request.cancelled) {
+                clWARNING() << "codelite-remote:" << request.command << ":"
+                            << wxString::FromUTF8(payload.data(), payload.size()) << endl;
+            }
+        } else if (!request.cancelled && !DecodePayload(type, payload, request.pending)) {
+            clWARNING() << "codelite-remote:" << request.command << ": failed to decompress reply" << endl;
+        }
 
-    if (where != wxString::npos) {
-        size_t length_to_take = where;
-        if (separator_len == 1) {
-            length_to_take += 1;
+        if (ready.empty() || ready.back() != id) {
+            ready.push_back(id);
         }
-        buffer = raw_input_buffer.Mid(0, length_to_take);
-        raw_input_buffer.erase(0, where + separator_len);
+    });
+
+    for (size_t id : ready) {
+        DeliverOutput(id);
     }
-    return where != wxString::npos;
 }
 
-void clCodeLiteRemoteProcess::ProcessOutput()
+void clCodeLiteRemoteProcess::DeliverOutput(size_t request_id)
 {
-    bool is_completed = false;
-    wxString buffer;
+    auto where = m_requests.find(request_id);
+    if (where == m_requests.end()) {
+        return;
+    }
 
-    while (GetNextBuffer(m_outputRead, buffer, is_completed)) {
-        if (m_completionCallbacks.empty()) {
-            clDEBUG() << "Read: [" << buffer << "]. But there are no completion callback" << endl;
-            continue;
+    // pass complete lines only, so the handlers can split the output by lines. Once the reply is completed, pass
+    // whatever is left
+    auto& request = where->second;
+    bool is_completed = request.completed;
+    size_t count = request.pending.size();
+    if (!is_completed) {
+        size_t where_lf = request.pending.rfind('\n');
+        count = where_lf == std::string::npos ? 0 : where_lf + 1;
+        if (count == 0) {
+            return;
         }
+    }
 
-        auto p = m_completionCallbacks.front();
-        if (p.user_callback != nullptr) {
-            p.aggregated_output << buffer;
-            if (is_completed) {
-                p.user_callback(p.aggregated_output);
-            }
-        } else if (p.handler) {
-            auto handler = static_cast<CodeLiteRemoteProcess*>(p.handler);
-            handler->PostOutputEvent(buffer);
-            if (is_completed) {
-                handler->PostTerminateEvent();
-
-                // when using callback the handler is handled internally
-                if (handler->IsUsingCallback()) {
-                    delete handler;
-                }
-            }
-        } else if (p.func) {
-            (this->*p.func)(buffer, is_completed);
-        }
+    wxString buffer = wxString::FromUTF8(request.pending.data(), count);
+    if (buffer.empty() && count > 0) {
+        buffer = wxString::From8BitData(request.pending.data(), count);
+    }
+    request.pending.erase(0, count);
 
+    if (!is_completed) {
+        // the handlers only queue events here, so the request entry remains valid
+        RunCallback(request, buffer, false);
+        return;
+    }
+
+    CallbackOptions options = std::move(request);
+    m_requests.erase(where);
+    LOG_IF_TRACE
+    {
+        auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() -
+                                                                              options.start_time);
+        clDEBUG1() << "codelite-remote: request" << request_id << "(" << options.command << ") completed in"
+                   << elapsed.count() << "ms" << endl;
+    }
+    RunCallback(options, buffer, true);
+    ResetStates();
+}
+
+void clCodeLiteRemoteProcess::RunCallback(CallbackOptions& options, const wxString& buffer, bool is_completed)
+{
+    if (options.user_callback != nullptr) {
+        options.aggregated_output << buffer;
         if (is_completed) {
-            m_completionCallbacks.pop_front();
-            ResetStates();
+            options.user_callback(options.aggregated_output);
         }
+    } else if (options.handler) {
+        auto handler = static_cast<CodeLiteRemoteProcess*>(options.handler);
+        handler->PostOutputEvent(buffer);
+        if (is_completed) {
+            handler->PostTerminateEvent();
+
+            // when using callback the handler is handled internally
+            if (handler->IsUsingCallback()) {
+                delete handler;
+            }
+        }
+    } else if (options.func) {
+        (this->*options.func)(buffer, is_completed);
     }
 }
 
-void clCodeLiteRemoteProcess::ListLSPs()
+size_t clCodeLiteRemoteProcess::SendRequest(JSONItem& item, CallbackOptions options, bool compress)
 {
     if (!m_process) {
+        return 0;
+    }
+
+    size_t request_id = ++m_nextRequestId;
+    item.addProperty("id", request_id);
+    if (compress && m_compressReplies) {
+        item.addProperty("compress", true);
+    }
+
+    wxString command = item.format(false);
+    m_process->Write(command + "\n");
+    LOG_IF_TRACE { clDEBUG1() << command << endl; }
+
+    options.command = item["command"].toString();
+    options.start_time = std::chrono::steady_clock::now();
+    m_requests.insert({ request_id, std::move(options) });
+    return request_id;
+}
+
+void clCodeLiteRemoteProcess::Cancel(size_t request_id)
+{
+    auto where = m_requests.find(request_id);
+    if (!m_process || where == m_requests.end() || where->second.cancelled) {
         return;
     }
 
-    // build the command and send it
+    // the remote process still ends the reply, the request is removed then
+    where->second.cancelled = true;
+    where->second.pending.clear();
+
     JSON root(cJSON_Object);
     auto item = root.toElement();
-    item.addProperty("command", "list_lsps");
+    item.addProperty("command", "cancel");
+    item.addProperty("id", request_id);
     m_process->Write(item.format(false) + "\n");
+}
 
-    // push a callback
-    m_completionCallbacks.push_back({ &clCodeLiteRemoteProcess::OnListLSPsOutput, nullptr, nullptr });
+void clCodeLiteRemoteProcess::Detach(size_t request_id)
+{
+    Cancel(request_id);
+    auto where = m_requests.find(request_id);
+    if (where == m_requests.end()) {
+        return;
+    }
+    where->second.func = nullptr;
+    where->second.handler = nullptr;
+    where->second.user_callback = nullptr;
 }
 
-void clCodeLiteRemoteProcess::ListFiles(const wxString& root_dir,
-                                        const wxString& extensions,
-                                        const wxString& exclude_extensions,
-                                        const wxString& exclude_patterns)
+size_t clCodeLiteRemoteProcess::ListLSPs()
 {
     if (!m_process) {
-        return;
+        return 0;
+    }
+
+    // build the command and send it
+    JSON root(cJSON_Object);
+    auto item = root.toElement();
+    item.addProperty("command", "list_lsps");
+    return SendRequest(item, { &clCodeLiteRemoteProcess::OnListLSPsOutput, nullptr, nullptr });
+}
+
+size_t clCodeLiteRemoteProcess::ListFiles(const wxString& root_dir,
+                                          const wxString& extensions,
+                                          const wxString& exclude_extensions,
+                                          const wxString& exclude_patterns)
+{
+    if (!m_process) {
+        return 0;
     }
 
     // build the command and send it
@@ -367,22 +486,18 @@ void clCodeLiteRemoteProcess::ListFiles(const wxString& root_dir,
     item.addProperty("file_extensions", ::wxStringTokenize(extensions, ",; |", wxTOKEN_STRTOK));
     item.addProperty("exclude_extensions", ::wxStringTokenize(exclude_extensions, ",; |", wxTOKEN_STRTOK));
     item.addProperty("exclude_patterns", ::wxStringTokenize(exclude_patterns, ",; |", wxTOKEN_STRTOK));
-    LOG_IF_TRACE { clDEBUG1() << "ListFiles: sending command:" << item.format(false) << endl; }
-    m_process->Write(item.format(false) + "\n");
-
-    // push a callback
-    m_completionCallbacks.push_back({ &clCodeLiteRemoteProcess::OnListFilesOutput, nullptr, nullptr });
+    return SendRequest(item, { &clCodeLiteRemoteProcess::OnListFilesOutput, nullptr, nullptr }, true);
 }
 
-void clCodeLiteRemoteProcess::Search(const wxString& root_dir,
-                                     const wxString& extensions,
-                                     const wxString& exclude_patterns,
-                                     const wxString& find_what,
-                                     bool whole_word,
-                                     bool icase)
+size_t clCodeLiteRemoteProcess::Search(const wxString& root_dir,
+                                       const wxString& extensions,
+                                       const wxString& exclude_patterns,
+                                       const wxString& find_what,
+                                       bool whole_word,
+                                       bool icase)
 {
     if (!m_process) {
-        return;
+        return 0;
     }
 
     // build the command and send it
@@ -396,21 +511,16 @@ void clCodeLiteRemoteProcess::Search(const wxString& root_dir,
     item.addProperty("icase", icase);
     item.addProperty("whole_word", whole_word);
 
-    wxString command = item.format(false);
-    m_process->Write(command + "\n");
-    LOG_IF_TRACE { clDEBUG1() << command << endl; }
-
-    // push a callback
-    m_completionCallbacks.push_back({ &clCodeLiteRemoteProcess::OnFindOutput, nullptr, nullptr });
+    return SendRequest(item, { &clCodeLiteRemoteProcess::OnFindOutput, nullptr, nullptr }, true);
 }
 
-void clCodeLiteRemoteProcess::Locate(const wxString& path,
-                                     const wxString& name,
-                                     const wxString& ext,
-                                     const std::vector<wxString>& versions)
+size_t clCodeLiteRemoteProcess::Locate(const wxString& path,
+                                       const wxString& name,
+                                       const wxString& ext,
+                                       const std::vector<wxString>& versions)
 {
     if (!m_process) {
-        return;
+        return 0;
     }
 
     // build the command and send it
@@ -431,18 +541,13 @@ void clCodeLiteRemoteProcess::Locate(const wxString& path,
 
     item.addProperty("versions", v);
 
-    wxString command = item.format(false);
-    m_process->Write(command + "\n");
-    LOG_IF_TRACE { clDEBUG1() << command << endl; }
-
-    // push a callback
-    m_completionCallbacks.push_back({ &clCodeLiteRemoteProcess::OnLocateOutput, nullptr, nullptr });
+    return SendRequest(item, { &clCodeLiteRemoteProcess::OnLocateOutput, nullptr, nullptr });
 }
 
-void clCodeLiteRemoteProcess::FindPath(const wxString& path)
+size_t clCodeLiteRemoteProcess::FindPath(const wxString& path)
 {
     if (!m_process) {
-        return;
+        return 0;
     }
 
     // build the command and send it
@@ -451,12 +556,7 @@ void clCodeLiteRemoteProcess::FindPath(const wxString& path)
     item.addProperty("command", "find_path");
     item.addProperty("path", path);
 
-    wxString command = item.format(false);
-    m_process->Write(command + "\n");
-    LOG_IF_TRACE { clDEBUG1() << command << endl; }
-
-    // push a callback
-    m_completionCallbacks.push_back({ &clCodeLiteRemoteProcess::OnFindPathOutput, nullptr, nullptr });
+    return SendRequest(item, { &clCodeLiteRemoteProcess::OnFindPathOutput, nullptr, nullptr });
 }
 
 void clCodeLiteRemoteProcess::ResetStates()
@@ -465,11 +565,11 @@ void clCodeLiteRemoteProcess::ResetStates()
     m_fif_files_scanned = 0;
 }
 
-bool clCodeLiteRemoteProcess::DoExec(
+size_t clCodeLiteRemoteProcess::DoExec(
     const wxString& cmd, const wxString& working_directory, const clEnvList_t& env, IProcess* handler, UserCallback cb)
 {
     if (!m_process) {
-        return false;
+        return 0;
     }
 
     // build the command and send it
@@ -486,38 +586,35 @@ bool clCodeLiteRemoteProcess::DoExec(
         entry.addProperty("value", p.second);
     }
 
-    wxString command = item.format(false);
-    m_process->Write(command + "\n");
-
-    // push a callback
-    m_completionCallbacks.push_back({ &clCodeLiteRemoteProcess::OnExecOutput, handler, cb });
-    return true;
+    return SendRequest(item, { &clCodeLiteRemoteProcess::OnExecOutput, handler, cb }, true);
 }
 
-void clCodeLiteRemoteProcess::Exec(const wxArrayString& args, const wxString& working_directory, const clEnvList_t& env)
+size_t clCodeLiteRemoteProcess::Exec(const wxArrayString& args,
+                                     const wxString& working_directory,
+                                     const clEnvList_t& env)
 {
     wxString cmdstr = GetCmdString(args);
     if (cmdstr.empty()) {
-        return;
+        return 0;
     }
-    DoExec(cmdstr, working_directory, env);
+    return DoExec(cmdstr, working_directory, env);
 }
 
-void clCodeLiteRemoteProcess::ExecWithCallback(const wxArrayString& args,
-                                               UserCallback cb,
-                                               const wxString& working_directory,
-                                               const clEnvList_t& env)
+size_t clCodeLiteRemoteProcess::ExecWithCallback(const wxArrayString& args,
+                                                 UserCallback cb,
+                                                 const wxString& working_directory,
+                                                 const clEnvList_t& env)
 {
     wxString cmdstr = GetCmdString(args);
     if (cmdstr.empty()) {
-        return;
+        return 0;
     }
-    DoExec(cmdstr, working_directory, env, nullptr, std::move(cb));
+    return DoExec(cmdstr, working_directory, env, nullptr, std::move(cb));
 }
 
-void clCodeLiteRemoteProcess::Exec(const wxString& cmd, const wxString& working_directory, const clEnvList_t& env)
+size_t clCodeLiteRemoteProcess::Exec(const wxString& cmd, const wxString& working_directory, const clEnvList_t& env)
 {
-    DoExec(cmd, working_directory, env);
+    return DoExec(cmd, working_directory, env);
 }
 
 void clCodeLiteRemoteProcess::Write(const wxString& str)
@@ -538,7 +635,9 @@ IProcess* clCodeLiteRemoteProcess::CreateAsyncProcess(wxEvtHandler* handler,
                                                       const clEnvList_t& env)
 {
     CodeLiteRemoteProcess* p = new CodeLiteRemoteProcess(handler, this);
-    if (DoExec(cmd, working_directory, env, p)) {
+    size_t request_id = DoExec(cmd, working_directory, env, p);
+    if (request_id) {
+        p->SetRequestId(request_id);
         return p;
     }
     wxDELETE(p);
@@ -552,7 +651,9 @@ void clCodeLiteRemoteProcess::CreateAsyncProcessCB(const wxString& cmd,
 {
     CodeLiteRemoteProcess* p = new CodeLiteRemoteProcess(nullptr, this);
     p->SetCallback(std::move(callback));
-    if (DoExec(cmd, working_directory, env, p)) {
+    size_t request_id = DoExec(cmd, working_directory, env, p);
+    if (request_id) {
+        p->SetRequestId(request_id);
         return;
     }
     wxDELETE(p);
@@ -733,7 +834,7 @@ bool clCodeLiteRemoteProcess::SyncExec(const wxString& cmd,
                                        const clEnvList_t& env,
                                        wxString* output)
 {
-    if (!m_completionCallbacks.empty()) {
+    if (!m_requests.empty()) {
         clWARNING() << "unable to run SyncExec() for command:" << cmd << "async queue is not empty" << endl;
         return false;
     }
@@ -744,32 +845,49 @@ bool clCodeLiteRemoteProcess::SyncExec(const wxString& cmd,
     // disable the background reader thread
     m_process->SuspendAsyncReads();
 
-    if (!DoExec(cmd, working_directory, env)) {
+    size_t request_id = DoExec(cmd, working_directory, env);
+    if (request_id == 0) {
         return false;
     }
 
-    // DoExec pushes a callback to the queue - pop it
-    // as we don't really need it
-    m_completionCallbacks.pop_back();
+    // DoExec registers the request - remove it, we read the reply here
+    m_requests.erase(request_id);
+
+    std::string reply;
+    bool is_completed = false;
+    auto on_frame = [&](size_t id, clRemoteFrameDecoder::eFrameType type, std::string_view payload) {
+        if (id != request_id) {
+            clDEBUG() << "SyncExec(" << cmd << "): ignoring output of request" << id << endl;
+        } else if (type == clRemoteFrameDecoder::eFrameType::kEnd) {
+            is_completed = true;
+        } else {
+            DecodePayload(type, payload, reply);
+        }
+    };
 
     // read
     wxString buff_out, buff_err;
     std::string raw_buff, raw_buff_err;
-    m_outputRead.clear();
+    while (true) {
+        raw_buff.clear();
+        if (!m_process->Read(buff_out, buff_err, raw_buff, raw_buff_err)) {
+            break;
+        }
 
-    wxString complete_output;
-    while (m_process->Read(buff_out, buff_err, raw_buff, raw_buff_err)) {
-        m_outputRead << buff_out;
-        size_t where = m_outputRead.find(msg_terminator);
-        if (where == wxString::npos) {
+        if (raw_buff.empty() && !buff_out.empty()) {
+            raw_buff = buff_out.ToStdString(wxConvUTF8);
+        }
+        m_decoder.Feed(raw_buff.data(), raw_buff.size(), on_frame);
+        if (!is_completed) {
             continue;
         }
 
-        // strip the terminator and make it our output
-        *output = m_outputRead.Mid(0, where);
+        *output = wxString::FromUTF8(reply);
+        if (output->empty() && !reply.empty()) {
+            *output = wxString::From8BitData(reply.data(), reply.size());
+        }
         LOG_IF_TRACE { clDEBUG1() << "SyncExec(" << cmd << "):" << *output << endl; }
 
-        m_outputRead.clear();
         // resume the async nature of the process
         m_process->ResumeAsyncReads();
         return true;
@@ -781,16 +899,16 @@ bool clCodeLiteRemoteProcess::SyncExec(const wxString& cmd,
     return false;
 }
 
-void clCodeLiteRemoteProcess::Replace(const wxString& root_dir,
-                                      const wxString& extensions,
-                                      const wxString& exclude_patterns,
-                                      const wxString& find_what,
-                                      const wxString& replace_with,
-                                      bool whole_word,
-                                      bool icase)
+size_t clCodeLiteRemoteProcess::Replace(const wxString& root_dir,
+                                        const wxString& extensions,
+                                        const wxString& exclude_patterns,
+                                        const wxString& find_what,
+                                        const wxString& replace_with,
+                                        bool whole_word,
+                                        bool icase)
 {
     if (!m_process) {
-        return;
+        return 0;
     }
 
     // build the command and send it
@@ -805,10 +923,5 @@ void clCodeLiteRemoteProcess::Replace(const wxString& root_dir,
     item.addProperty("icase", icase);
     item.addProperty("whole_word", whole_word);
 
-    wxString command = item.format(false);
-    m_process->Write(command + "\n");
-    LOG_IF_TRACE { clDEBUG1() << command << endl; }
-
-    // push a callback
-    m_completionCallbacks.push_back({ &clCodeLiteRemoteProcess::OnReplaceOutput, nullptr, nullptr });
+    return SendRequest(item, { &clCodeLiteRemoteProcess::OnReplaceOutput, nullptr, nullptr }, true);
 }
\ No newline at end of file
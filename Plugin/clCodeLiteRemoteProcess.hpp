@@ -3,17 +3,21 @@
 
 #include "AsyncProcess/asyncprocess.h"
 #include "cl_command_event.h"
+#include "clRemoteFrameDecoder.hpp"
 #include "codelite_exports.h"
 #include "ssh/ssh_account_info.h"
 
-#include <deque>
+#include <chrono>
 #include <functional>
 #include <memory>
+#include <string>
+#include <unordered_map>
 #include <vector>
 #include <wx/arrstr.h>
 #include <wx/event.h>
 #include <wx/string.h>
 
+class JSONItem;
 class WXDLLIMPEXP_SDK clCodeLiteRemoteProcess : public wxEvtHandler
 {
 protected:
@@ -27,6 +31,13 @@ protected:
         // When user_callback is used, we aggregate the output here until "is_completed"
         // is true, only then we call the user_callback
         wxString aggregated_output;
+
+        // the reply bytes received after the last complete line
+        std::string pending;
+        wxString command;
+        std::chrono::steady_clock::time_point start_time;
+        bool cancelled = false;
+        bool completed = false;
         CallbackOptions(CallbackFunc func, IProcess* handler, UserCallback user_callback)
         {
             this->func = func;
@@ -37,8 +48,11 @@ protected:
 
 protected:
     std::unique_ptr<IProcess> m_process;
-    std::deque<CallbackOptions> m_completionCallbacks;
-    wxString m_outputRead;
+    // the requests waiting for their reply, by request id
+    std::unordered_map<size_t, CallbackOptions> m_requests;
+    size_t m_nextRequestId = 0;
+    clRemoteFrameDecoder m_decoder;
+    bool m_compressReplies = true;
     size_t m_fif_matches_count = 0;
     size_t m_fif_files_scanned = 0;
     bool m_going_down = false;
@@ -50,10 +64,18 @@ protected:
     void OnProcessOutput(clProcessEvent& e);
     void OnProcessTerminated(clProcessEvent& e);
     void Cleanup();
-    void ProcessOutput();
-    bool GetNextBuffer(wxString& raw_input_buffer, wxString& output, bool& is_completed);
+    void ProcessOutput(const char* data, size_t len);
+    void DeliverOutput(size_t request_id);
+    void RunCallback(CallbackOptions& options, const wxString& buffer, bool is_completed);
     void ResetStates();
 
+    /**
+     * @brief add an id to `item`, send it and register `options` to receive the reply
+     * @return the request id, 0 if the process is not running
+     */
+    size_t SendRequest(JSONItem& item, CallbackOptions options, bool compress = false);
+    static bool DecodePayload(clRemoteFrameDecoder::eFrameType type, std::string_view payload, std::string& output);
+
     // prepare an event from list command output
     void OnListFilesOutput(const wxString& output, bool is_completed);
     void OnListLSPsOutput(const wxString& output, bool is_completed);
@@ -62,11 +84,11 @@ protected:
     void OnLocateOutput(const wxString& buffer, bool is_completed);
     void OnFindPathOutput(const wxString& buffer, bool is_completed);
     void OnExecOutput(const wxString& buffer, bool is_completed);
-    bool DoExec(const wxString& cmd,
-                const wxString& working_directory,
-                const clEnvList_t& env,
-                IProcess* handler = nullptr,
-                UserCallback cb = nullptr);
+    size_t DoExec(const wxString& cmd,
+                    const wxString& working_directory,
+                    const clEnvList_t& env,
+                    IProcess* handler = nullptr,
+                    UserCallback cb = nullptr);
 
     template <typename Container>
     wxString GetCmdString(const Container& args) const
@@ -112,7 +134,27 @@ public:
     void Stop();
     bool IsRunning() const { return m_process != nullptr; }
 
+    /**
+     * @brief ask the remote process to compress the large replies (files list, search results and exec output).
+     * Enabled by default
+     */
+    void SetCompressReplies(bool b) { m_compressReplies = b; }
+    bool IsCompressReplies() const { return m_compressReplies; }
+
+    /**
+     * @brief stop a running request. The rest of its output is discarded, its completion callback is still called
+     */
+    void Cancel(size_t request_id);
+
+    /**
+     * @brief same as Cancel(), but the completion callback is not called either. Used when the callback owner is
+     * going away
+     */
+    void Detach(size_t request_id);
+
     // API
+    // The requests run concurrently on the remote machine. Each returns its request id (0 on failure) which can be
+    // passed to Cancel()
 
     /**
      * @brief find all files on a remote machine from a given directory that matches the extensions list
@@ -120,66 +162,66 @@ public:
      * @exclude_extensions a comma/semi colon separate list of patterns to exclude from the file list (e.g. "*.pyc")
      * @exclude_patterns a comma/semi colon separate list of patterns to exclude from the file list (e.g. "build-debug")
      */
-    void ListFiles(const wxString& root_dir,
-                   const wxString& extensions,
-                   const wxString& exclude_extensions,
-                   const wxString& exclude_patterns);
+    size_t ListFiles(const wxString& root_dir,
+                     const wxString& extensions,
+                     const wxString& exclude_extensions,
+                     const wxString& exclude_patterns);
 
     /**
      * @brief list all configured LSPs on the remote machine
      * the configuration is read from `codelite-remote.json` config file
      */
-    void ListLSPs();
+    size_t ListLSPs();
 
     /**
      * @brief find in files on a remote machine
      */
-    void Search(const wxString& root_dir,
-                const wxString& extensions,
-                const wxString& exclude_patterns,
-                const wxString& find_what,
-                bool whole_word,
-                bool icase);
+    size_t Search(const wxString& root_dir,
+                  const wxString& extensions,
+                  const wxString& exclude_patterns,
+                  const wxString& find_what,
+                  bool whole_word,
+                  bool icase);
 
     /**
      * @brief replace in file on a remote machine
      */
-    void Replace(const wxString& root_dir,
-                 const wxString& extensions,
-                 const wxString& exclude_patterns,
-                 const wxString& find_what,
-                 const wxString& replace_with,
-                 bool whole_word,
-                 bool icase);
+    size_t Replace(const wxString& root_dir,
+                   const wxString& extensions,
+                   const wxString& exclude_patterns,
+                   const wxString& find_what,
+                   const wxString& replace_with,
+                   bool whole_word,
+                   bool icase);
 
     /**
      * @brief execute a command on the remote machine
      */
-    void Exec(const wxArrayString& args, const wxString& working_directory, const clEnvList_t& env);
+    size_t Exec(const wxArrayString& args, const wxString& working_directory, const clEnvList_t& env);
 
     /**
      * @brief execute a command on the remote machine trigger "cb" when output arrives
      */
-    void ExecWithCallback(const wxArrayString& args,
-                          UserCallback cb,
-                          const wxString& working_directory = wxEmptyString,
-                          const clEnvList_t& env = {});
+    size_t ExecWithCallback(const wxArrayString& args,
+                            UserCallback cb,
+                            const wxString& working_directory = wxEmptyString,
+                            const clEnvList_t& env = {});
 
     /**
      * @brief attempt to locate a file on the remote machine with possible version number
      */
-    void Locate(const wxString& path, const wxString& name, const wxString& ext, const std::vector<wxString>& = {});
+    size_t Locate(const wxString& path, const wxString& name, const wxString& ext, const std::vector<wxString>& = {});
 
     /**
      * @brief execute a command on the remote machine
      */
-    void Exec(const wxString& cmd, const wxString& working_directory, const clEnvList_t& env);
+    size_t Exec(const wxString& cmd, const wxString& working_directory, const clEnvList_t& env);
 
     /**
      * @brief find a path from. if path does not exist, check the parent folder
      * going up until we hit the root path
      */
-    void FindPath(const wxString& path);
+    size_t FindPath(const wxString& path);
 
     /**
      * @brief call 'exec' and return an instance of IProcess. This method is for compatibility with the
@@ -1,5 +1,7 @@
 #include "clFileCache.hpp"
 
+#include <algorithm>
+
 void clFileCache::Add(const wxFileName& fn)
 {
     if(Contains(fn)) {
@@ -15,6 +17,44 @@ void clFileCache::Clear()
     m_files.clear();
 }
 
+size_t clFileCache::Remove(const wxArrayString& paths)
+{
+    if(paths.empty() || m_files.empty()) {
+        return 0;
+    }
+
+    std::unordered_set<wxString> removed{ paths.begin(), paths.end() };
+    auto is_removed = [&removed](const wxString& fullpath) {
+        // the file itself or one of its parent folders
+        wxString path = fullpath;
+        while(!path.empty()) {
+            if(removed.count(path)) {
+                return true;
+            }
+            size_t where = path.find_last_of(wxFileName::GetPathSeparators());
+            if(where == wxString::npos || where == 0) {
+                break;
+            }
+            path.Truncate(where);
+        }
+        return false;
+    };
+
+    // a single pass over the files
+    size_t count = m_files.size();
+    m_files.erase(std::remove_if(m_files.begin(), m_files.end(),
+                                 [&](const wxFileName& fn) {
+                                     wxString fullpath = fn.GetFullPath();
+                                     if(!is_removed(fullpath)) {
+                                         return false;
+                                     }
+                                     m_filesSet.erase(fullpath);
+                                     return true;
+                                 }),
+                  m_files.end());
+    return count - m_files.size();
+}
+
 bool clFileCache::Contains(const wxFileName& fn) const { return m_filesSet.count(fn.GetFullPath()); }
 
 void clFileCache::Alloc(size_t size)
@@ -6,6 +6,7 @@
 
 #include <unordered_set>
 #include <vector>
+#include <wx/arrstr.h>
 #include <wx/filename.h>
 
 class WXDLLIMPEXP_SDK clFileCache
@@ -28,6 +29,11 @@ public:
     void Alloc(size_t size);
     void Add(const wxFileName& fn);
     void Clear();
+    /**
+     * @brief remove files from the cache. A path can be a file or a folder, in which case all the files under it
+     * are removed. Return the number of files removed
+     */
+    size_t Remove(const wxArrayString& paths);
     bool Contains(const wxFileName& fn) const;
     size_t GetSize() const { return m_files.size(); }
     bool IsEmpty() const { return m_files.empty(); }
@@ -0,0 +1,163 @@
+#include "clRemoteFrameDecoder.hpp"
+
+#include "file_logger.h"
+
+#include <charconv>
+#include <wx/mstream.h>
+#include <wx/zstream.h>
+
+namespace
+{
+constexpr std::string_view FRAME_MAGIC = "@@cl ";
+// erase the consumed bytes only when there are at least this many of them
+constexpr size_t COMPACT_THRESHOLD = 64 * 1024;
+// the helper never sends more than 64KB in a frame. A larger length means that the line only looks like a header,
+// waiting for its payload would swallow the rest of the stream
+constexpr size_t MAX_FRAME_LENGTH = 1024 * 1024;
+
+bool parse_number(std::string_view& str, size_t& number)
+{
+    auto result = std::from_chars(str.data(), str.data() + str.size(), number);
+    if (result.ec != std::errc() || result.ptr == str.data()) {
+        return false;
+    }
+    str.remove_prefix(result.ptr - str.data());
+    return true;
+}
+} // namespace
+
+bool clRemoteFrameDecoder::ParseHeader(std::string_view line, Header& header)
+{
+    if (line.substr(0, FRAME_MAGIC.size()) != FRAME_MAGIC) {
+        return false;
+    }
+    line.remove_prefix(FRAME_MAGIC.size());
+
+    // <id> <type> <length>
+    if (!parse_number(line, header.id) || line.size() < 3 || line[0] != ' ' || line[2] != ' ') {
+        return false;
+    }
+
+    switch (line[1]) {
+    case 'D':
+        header.type = eFrameType::kData;
+        break;
+    case 'Z':
+        header.type = eFrameType::kCompressedData;
+        break;
+    case 'E':
+        header.type = eFrameType::kEnd;
+        break;
+    default:
+        return false;
+    }
+    line.remove_prefix(3);
+    return parse_number(line, header.length) && line.empty();
+}
+
+void clRemoteFrameDecoder::Feed(const char* data, size_t len, const FrameCallback& on_frame)
+{
+    m_buffer.append(data, len);
+    while (true) {
+        std::string_view pending{ m_buffer.data() + m_offset, m_buffer.size() - m_offset };
+        if (!m_hasHeader) {
+            size_t eol = pending.find('\n');
+            if (eol == std::string_view::npos) {
+                break;
+            }
+
+            std::string_view line = pending.substr(0, eol);
+            m_offset += eol + 1;
+            if (!ParseHeader(line, m_header)) {
+                on_frame(0, eFrameType::kText, pending.substr(0, eol + 1));
+            } else if (m_header.length > MAX_FRAME_LENGTH) {
+                clWARNING() << "codelite-remote: frame length" << m_header.length
+                            << "is too large, handling the line as text" << endl;
+                on_frame(0, eFrameType::kText, pending.substr(0, eol + 1));
+            } else {
+                m_hasHeader = true;
+            }
+            continue;
+        }
+
+        if (pending.size() < m_header.length) {
+            // wait for the rest of the payload
+            break;
+        }
+        m_offset += m_header.length;
+        m_hasHeader = false;
+        on_frame(m_header.id, m_header.type, pending.substr(0, m_header.length));
+    }
+
+    if (m_offset == m_buffer.size()) {
+        m_buffer.clear();
+        m_offset = 0;
+    } else if (m_offset >= COMPACT_THRESHOLD && m_offset * 2 >= m_buffer.size()) {
+        m_buffer.erase(0, m_offset);
+        m_offset = 0;
+    }
+}
+
+void clRemoteFrameDecoder::Clear()
+{
+    m_buffer.clear();
+    m_offset = 0;
+    m_hasHeader = false;
+}
+
+std::string clRemoteFrameDecoder::Encode(size_t id, eFrameType type, std::string_view payload)
+{
+    char type_char = 'D';
+    switch (type) {
+    case eFrameType::kCompressedData:
+        type_char = 'Z';
+        break;
+    case eFrameType::kEnd:
+        type_char = 'E';
+        break;
+    case eFrameType::kData:
+    case eFrameType::kText:
+        break;
+    }
+
+    std::string frame{ FRAME_MAGIC };
+    frame.append(std::to_string(id));
+    frame.append(1, ' ');
+    frame.append(1, type_char);
+    frame.append(1, ' ');
+    frame.append(std::to_string(payload.size()));
+    frame.append(1, '\n');
+    frame.append(payload);
+    return frame;
+}
+
+std::string clRemoteFrameDecoder::Compress(std::string_view data)
+{
+    wxMemoryOutputStream memory;
+    {
+        wxZlibOutputStream zlib(memory, wxZ_BEST_SPEED, wxZLIB_ZLIB);
+        zlib.Write(data.data(), data.size());
+        zlib.Close();
+    }
+
+    std::string compressed(memory.GetLength(), 0);
+    memory.CopyTo(compressed.data(), compressed.size());
+    return compressed;
+}
+
+bool clRemoteFrameDecoder::Decompress(std::string_view data, std::string& output)
+{
+    wxMemoryInputStream memory(data.data(), data.size());
+    wxZlibInputStream zlib(memory, wxZLIB_ZLIB);
+
+    char buffer[16 * 1024];
+    while (true) {
+        zlib.Read(buffer, sizeof(buffer));
+        size_t count = zlib.LastRead();
+        if (count == 0) {
+            break;
+        }
+        output.append(buffer, count);
+    }
+    return zlib.GetLastError() == wxSTREAM_EOF || zlib.GetLastError() == wxSTREAM_NO_ERROR;
+}
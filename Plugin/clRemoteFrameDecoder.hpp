@@ -0,0 +1,78 @@
+#ifndef CLREMOTEFRAMEDECODER_HPP
+#define CLREMOTEFRAMEDECODER_HPP
+
+#include "codelite_exports.h"
+
+#include <functional>
+#include <string>
+#include <string_view>
+
+/**
+ * @class clRemoteFrameDecoder
+ * @brief split the output of codelite-remote (started with `--framed`) into frames.
+ *
+ * Every reply is sent as a sequence of frames tagged with the id of the request it belongs to, so the replies of
+ * several requests can be interleaved. A frame is a header line followed by exactly `length` bytes of payload:
+ *
+ *     @@cl <id> <type> <length>\n<payload>
+ *
+ * type is one of:
+ * - `D` a chunk of the reply
+ * - `Z` a chunk of the reply, zlib compressed (only when the request asked for compression)
+ * - `E` the end of the reply. The payload is empty, or holds an error message
+ *
+ * Lines that are not frame headers (e.g. a message printed by the login shell) are reported as `kText`
+ */
+class WXDLLIMPEXP_SDK clRemoteFrameDecoder
+{
+public:
+    enum class eFrameType {
+        kData,
+        kCompressedData,
+        kEnd,
+        kText,
+    };
+
+    /**
+     * @brief called for every complete frame. `payload` is only valid during the call. For `kText`, `id` is 0
+     */
+    using FrameCallback = std::function<void(size_t id, eFrameType type, std::string_view payload)>;
+
+private:
+    struct Header {
+        size_t id = 0;
+        eFrameType type = eFrameType::kData;
+        size_t length = 0;
+    };
+
+    std::string m_buffer;
+    // the number of bytes of m_buffer that were already consumed. They are erased only once they make up most of
+    // the buffer, so a large reply is not copied over and over
+    size_t m_offset = 0;
+    Header m_header;
+    bool m_hasHeader = false;
+
+    static bool ParseHeader(std::string_view line, Header& header);
+
+public:
+    clRemoteFrameDecoder() = default;
+    ~clRemoteFrameDecoder() = default;
+
+    /**
+     * @brief append data read from the process, and report all the frames it completes. `on_frame` must not call
+     * `Feed` or `Clear` on this decoder
+     */
+    void Feed(const char* data, size_t len, const FrameCallback& on_frame);
+    void Clear();
+
+    /**
+     * @brief the number of bytes received that do not make a complete frame yet
+     */
+    size_t GetPendingBytes() const { return m_buffer.size() - m_offset; }
+
+    static std::string Encode(size_t id, eFrameType type, std::string_view payload);
+    static std::string Compress(std::string_view data);
+    static bool Decompress(std::string_view data, std::string& output);
+};
+
+#endif // CLREMOTEFRAMEDECODER_HPP
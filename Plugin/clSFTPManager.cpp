@@ -333,19 +333,25 @@ bool clSFTPManager::DoSyncDownload(const wxString& remotePath, const wxString& l
         }
     }
 
-    wxMemoryBuffer file_content;
-    if (!DoSyncReadFile(remotePath, accountName, &file_content)) {
-        return false;
-    }
+    // stream the file to the disk
+    std::promise<bool> download_promise;
+    auto future = download_promise.get_future();
+    auto download_func = [&download_promise, remotePath, localPath, conn]() {
+        try {
+            clSFTP::TransferStats stats = conn->Download(remotePath, localPath, false);
+            clDEBUG() << "SFTP Manager: downloaded" << remotePath << stats.ToString() << endl;
+            download_promise.set_value(true);
 
-    {
-        wxLogNull no_log;
-        wxFFile fp(localPath, "w+b");
-        if (!fp.IsOpened()) {
-            clERROR() << "failed to open local file:" << localPath << "for write" << endl;
-            return false;
+        } catch (const clException& e) {
+            clERROR() << "Failed to download remote file:" << remotePath << "." << e.What() << endl;
+            download_promise.set_value(false);
         }
-        fp.Write(file_content.GetData(), file_content.GetDataLen());
+    };
+
+    // queue the task and wait for the response
+    m_q.push_back(std::move(download_func));
+    if (!future.get()) {
+        return false;
     }
 
     // mark this file as ours
@@ -39,6 +39,8 @@
 #include <wx/regex.h>
 #include <wx/string.h>
 
+class clBuildOutputMatcher;
+
 /**
  * \ingroup LiteEditor
  * This class represents a compiler entry in the configuration file
@@ -74,7 +76,6 @@ public:
         wxString lineNumberIndex;
         wxString fileNameIndex;
         wxString columnIndex;
-        std::shared_ptr<wxRegEx> re;
     };
 
     /// If a file matches a regular expression, this structure
@@ -123,10 +124,7 @@ protected:
     bool m_isDefault;
     wxString m_installationPath;
     std::map<wxString, LinkLine> m_linkerLines;
-
-private:
-    bool IsMatchesPattern(CmpInfoPattern& pattern, eSeverity severity, const wxString& line,
-                          PatternMatch* match_result) const;
+    std::shared_ptr<clBuildOutputMatcher> m_outputMatcher; // created on demand by Matches()
 
 public:
     using ConstIterator = std::map<wxString, wxString>::const_iterator;
@@ -139,6 +137,12 @@ public:
      */
     bool Matches(const wxString& line, PatternMatch* match_result);
 
+    /**
+     * @brief create a matcher for this compiler's error and warning patterns. Unlike `Matches()`, the returned matcher
+     * can be used by a worker thread
+     */
+    std::shared_ptr<clBuildOutputMatcher> CreateOutputMatcher() const;
+
     /**
      * @brief return { "PATH", "/compiler/bin:$PATH"} pair
      */
@@ -193,8 +197,16 @@ public:
     const CmpListInfoPattern& GetErrPatterns() const { return m_errorPatterns; }
     const CmpListInfoPattern& GetWarnPatterns() const { return m_warningPatterns; }
 
-    void SetErrPatterns(const CmpListInfoPattern& p) { m_errorPatterns = p; }
-    void SetWarnPatterns(const CmpListInfoPattern& p) { m_warningPatterns = p; }
+    void SetErrPatterns(const CmpListInfoPattern& p)
+    {
+        m_errorPatterns = p;
+        m_outputMatcher.reset();
+    }
+    void SetWarnPatterns(const CmpListInfoPattern& p)
+    {
+        m_warningPatterns = p;
+        m_outputMatcher.reset();
+    }
 
     void SetGlobalIncludePath(const wxString& globalIncludePath) { this->m_globalIncludePath = globalIncludePath; }
     void SetGlobalLibPath(const wxString& globalLibPath) { this->m_globalLibPath = globalLibPath; }
@@ -102,17 +102,17 @@ OpenResourceDialog::OpenResourceDialog(wxWindow* parent, IManager* manager, cons
                 ProjectPtr p = m_manager->GetWorkspace()->GetProject(projects.Item(i));
                 if (p) {
                     const Project::FilesMap_t& files = p->GetFiles();
-                    // convert std::vector to wxArrayString
                     for (const auto& p : files) {
-                        wxFileName fn(p.second->GetFilename());
-                        m_files.insert(std::make_pair(fn.GetFullName(), fn.GetFullPath()));
+                        AddFile(wxFileName(p.second->GetFilename()).GetFullPath());
                     }
                 }
             }
         } else if (clFileSystemWorkspace::Get().IsOpen()) {
             const std::vector<wxFileName>& files = clFileSystemWorkspace::Get().GetFiles();
+            m_files.reserve(files.size());
+            m_filesIndex.Reserve(files.size());
             for (const wxFileName& fn : files) {
-                m_files.insert({fn.GetFullName(), fn.GetFullPath()});
+                AddFile(fn.GetFullPath());
             }
         }
     } else if (clWorkspaceManager::Get().IsWorkspaceOpened()) {
@@ -121,14 +121,14 @@ OpenResourceDialog::OpenResourceDialog(wxWindow* parent, IManager* manager, cons
         clWorkspaceManager::Get().GetWorkspace()->GetWorkspaceFiles(files);
         wxStringSet_t unique_files;
         m_files.reserve(files.size());
+        m_filesIndex.Reserve(files.size());
         for (const auto& file : files) {
             if (unique_files.count(file) == 0) {
                 unique_files.insert(file);
-                wxFileName fn(file);
                 // keep the file as-is do not "format" it by calling
                 // fn.GetFullPath() since we might be on Windows and we display
                 // Linux path style files
-                m_files.insert({fn.GetFullName(), file});
+                AddFile(file);
             }
         }
     }
@@ -222,6 +222,7 @@ void OpenResourceDialog::DoPopulateList()
     clDEBUG() << "Open resource:" << name << ":" << nLineNumber << ":" << nColumn << endl;
     m_lineNumber = nLineNumber;
     m_column = nColumn;
+    m_searchFilter = name;
 
     // Prepare the user filter
     m_userFilters.Clear();
@@ -249,11 +250,15 @@ void OpenResourceDialog::DoPopulateTags(const std::vector<LSP::SymbolInformation
         return;
     }
 
+    // rank the symbols returned by the language server
+    clFuzzyIndex index;
+    index.Reserve(symbols.size());
     for (const LSP::SymbolInformation& symbol : symbols) {
-        if (!MatchesFilter(symbol.GetName())) {
-            continue;
-        }
+        index.Add(symbol.GetName());
+    }
 
+    for (const auto& match : index.Search(m_searchFilter)) {
+        const LSP::SymbolInformation& symbol = symbols[match.index];
         // keep the fullpath
         DoAppendLine(symbol.GetName(),
                      symbol.GetContainerName(),
@@ -287,28 +292,27 @@ void OpenResourceDialog::DoPopulateWorkspaceFile()
     }
 
     if (!m_userFilters.empty()) {
-
-        std::unordered_multimap<wxString, wxString>::iterator iter = m_files.begin();
-        const int maxFileSize = 100;
-        int counter = 0;
-        for (; (iter != m_files.end()) && (counter < maxFileSize); iter++) {
-            const wxString& fullpath = iter->second;
-            if (!MatchesFilter(fullpath)) {
-                continue;
-            }
-
-            wxFileName fn(iter->second);
+        // the index keeps the previous matches, so typing more characters only re-checks those
+        const size_t maxFileSize = 100;
+        for (const auto& match : m_filesIndex.Search(m_searchFilter, maxFileSize)) {
+            const wxString& fullpath = m_files[match.index];
+            wxFileName fn(fullpath);
             int imgId = clGetManager()->GetStdIcons()->GetMimeImageId(fn.GetFullName());
             DoAppendLine(fn.GetFullName(),
-                         iter->second,
+                         fullpath,
                          false,
-                         new OpenResourceDialogItemData(iter->second, -1, "", fn.GetFullName(), ""),
+                         new OpenResourceDialogItemData(fullpath, -1, "", fn.GetFullName(), ""),
                          imgId);
-            ++counter;
         }
     }
 }
 
+void OpenResourceDialog::AddFile(const wxString& fullpath)
+{
+    m_files.push_back(fullpath);
+    m_filesIndex.Add(fullpath);
+}
+
 void OpenResourceDialog::Clear()
 {
     // list control does not own the client data, we need to free it ourselves
@@ -429,14 +433,6 @@ int OpenResourceDialog::DoGetTagImg(const LSP::SymbolInformation& symbol)
     return clGetManager()->GetStdIcons()->GetImageIndex(imgId);
 }
 
-bool OpenResourceDialog::MatchesFilter(const wxString& name)
-{
-    wxString mod_filter;
-    long line_number, column_number;
-    GetLineAndColumnFromFilter(m_textCtrlResourceName->GetValue(), mod_filter, line_number, column_number);
-    return FileUtils::FuzzyMatch(mod_filter, name);
-}
-
 void OpenResourceDialog::OnCheckboxfilesCheckboxClicked(wxCommandEvent& event) { DoPopulateList(); }
 void OpenResourceDialog::OnCheckboxshowsymbolsCheckboxClicked(wxCommandEvent& event) { DoPopulateList(); }
 
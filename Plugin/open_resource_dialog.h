@@ -28,6 +28,7 @@
 
 #include "LSP/LSPEvent.h"
 #include "LSP/basic_types.h"
+#include "clFuzzyIndex.hpp"
 #include "cl_command_event.h"
 #include "codelite_exports.h"
 #include "database/entry.h"
@@ -91,12 +92,14 @@ template <> struct hash<LSP::eSymbolKind> {
 class WXDLLIMPEXP_SDK OpenResourceDialog : public OpenResourceDialogBase
 {
     IManager* m_manager;
-    std::unordered_multimap<wxString, wxString> m_files;
+    std::vector<wxString> m_files;
+    clFuzzyIndex m_filesIndex;
     std::unordered_map<LSP::eSymbolKind, int> m_fileTypeHash;
     wxTimer* m_timer;
     bool m_needRefresh;
     wxArrayString m_filters;
     wxArrayString m_userFilters;
+    wxString m_searchFilter; // the filter text without the line and column
     long m_lineNumber = wxNOT_FOUND;
     long m_column = wxNOT_FOUND;
 
@@ -110,10 +113,10 @@ protected:
 
     void DoPopulateList();
     void DoPopulateWorkspaceFile();
-    bool MatchesFilter(const wxString& name);
     void DoPopulateTags(const std::vector<LSP::SymbolInformation>& symbols);
     void DoSelectItem(const wxDataViewItem& item);
     void Clear();
+    void AddFile(const wxString& fullpath);
     void DoAppendLine(const wxString& name, const wxString& fullname, bool boldFont,
                       OpenResourceDialogItemData* clientData, int imgid);
     int DoGetTagImg(const LSP::SymbolInformation& symbol);
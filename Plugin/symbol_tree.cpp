@@ -25,6 +25,7 @@
 #include "symbol_tree.h"
 
 #include "bitmap_loader.h"
+#include "clFuzzyIndex.hpp"
 #include "ctags_manager.h"
 #include "fileutils.h"
 #include "globals.h"
@@ -441,28 +442,41 @@ bool SymbolTree::Matches(const wxTreeItemId& item, const wxString& patter)
 {
     if(!item.IsOk())
         return false;
+
+    std::vector<wxTreeItemId> items;
+    clFuzzyIndex index;
+    DoCollectItems(item, items, index);
+
+    // select the best match
+    auto matches = index.Search(patter, 1);
+    if(matches.empty()) {
+        return false;
+    }
+
+    const wxTreeItemId& match = items[matches[0].index];
+    SelectItem(match);
+    EnsureVisible(match);
+    return true;
+}
+
+void SymbolTree::DoCollectItems(const wxTreeItemId& item, std::vector<wxTreeItemId>& items, clFuzzyIndex& index)
+{
     wxString displayName = GetItemText(item);
     wxString path = displayName.BeforeFirst(wxT('('));
     // Get the name from the path
     path = path.AfterLast(wxT(':'));
-    if(FileUtils::FuzzyMatch(patter, path)) {
-        SelectItem(item);
-        EnsureVisible(item);
-        return true;
-    }
+    items.push_back(item);
+    index.Add(path);
 
-    // Check the item's children
+    // Collect the item's children
     if(ItemHasChildren(item)) {
         wxTreeItemIdValue cookie;
         wxTreeItemId child = GetFirstChild(item, cookie);
         while(child.IsOk()) {
-            if(Matches(child, patter)) {
-                return true;
-            }
+            DoCollectItems(child, items, index);
             child = GetNextChild(item, cookie);
         }
     }
-    return false;
 }
 
 void SymbolTree::SetSymbolsImages(BitmapLoader::Vec_t* bitmaps) { SetBitmaps(bitmaps); }
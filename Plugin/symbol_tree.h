@@ -32,8 +32,11 @@
 #include "database/entry.h"
 
 #include <map>
+#include <vector>
 #include <wx/filename.h>
 
+class clFuzzyIndex;
+
 /**
  * Class MyTreeItemData, a user defined class which keeps the full name of a tree item.
  * This will allow us to quickly search the TagTree for entries using the full name as the key.
@@ -170,7 +173,7 @@ public:
 
     /**
      * \brief select item by its name and select it. If multiple matches
-     * fits 'name' the first one is selected
+     * fits 'name' the best ranked one is selected
      * \param name display name of the item to be selected (can be partial name)
      */
     void SelectItemByName(const wxString& name);
@@ -180,6 +183,7 @@ public:
 
 protected:
     bool Matches(const wxTreeItemId& item, const wxString& patter);
+    void DoCollectItems(const wxTreeItemId& item, std::vector<wxTreeItemId>& items, clFuzzyIndex& index);
 
     void GetItemChildrenRecursive(wxTreeItemId& parent, std::map<void*, bool>& deletedMap);
 
@@ -88,8 +88,13 @@ void SFTPWorkerThread::ProcessRequest(ThreadRequest* request)
                 return;
             case eSFTPActions::kUpload: {
                 DoReportStatusBarMessage(wxString() << _("Uploading file: ") << req->GetRemoteFile());
-                m_sftp->CreateRemoteFile(req->GetRemoteFile(), wxFileName(req->GetLocalFile()));
-                msg << "Successfully uploaded file: " << req->GetLocalFile() << " -> " << req->GetRemoteFile();
+                m_sftp->Mkpath(wxFileName(req->GetRemoteFile()).GetPath());
+                // a large upload that fails continues where it stopped when the file is uploaded again
+                wxULongLong size = wxFileName(req->GetLocalFile()).GetSize();
+                bool resume = size != wxInvalidSize && size.GetValue() >= clSFTP::RESUME_MIN_SIZE;
+                clSFTP::TransferStats stats = m_sftp->Upload(req->GetLocalFile(), req->GetRemoteFile(), resume);
+                msg << "Successfully uploaded file: " << req->GetLocalFile() << " -> " << req->GetRemoteFile() << " ("
+                    << stats.ToString() << ")";
                 DoReportMessage(accountName, msg, SFTPThreadMessage::STATUS_OK);
                 DoReportStatusBarMessage("");
                 break;
@@ -98,15 +103,12 @@ void SFTPWorkerThread::ProcessRequest(ThreadRequest* request)
             case eSFTPActions::kDownloadAndOpenContainingFolder:
             case eSFTPActions::kDownloadAndOpenWithDefaultApp: {
                 DoReportStatusBarMessage(wxString() << _("Downloading file: ") << req->GetRemoteFile());
-                wxMemoryBuffer buffer;
-                SFTPAttribute::Ptr_t fileAttr = m_sftp->Read(req->GetRemoteFile(), buffer);
-                wxFFile fp(req->GetLocalFile(), "w+b");
-                if (fp.IsOpened()) {
-                    fp.Write(buffer.GetData(), buffer.GetDataLen());
-                    fp.Close();
-                }
+                SFTPAttribute::Ptr_t fileAttr = m_sftp->Stat(req->GetRemoteFile());
+                bool resume = fileAttr && fileAttr->GetSize() >= clSFTP::RESUME_MIN_SIZE;
+                clSFTP::TransferStats stats = m_sftp->Download(req->GetRemoteFile(), req->GetLocalFile(), resume);
 
-                msg << "Successfully downloaded file: " << req->GetLocalFile() << " <- " << req->GetRemoteFile();
+                msg << "Successfully downloaded file: " << req->GetLocalFile() << " <- " << req->GetRemoteFile()
+                    << " (" << stats.ToString() << ")";
                 DoReportMessage(accountName, msg, SFTPThreadMessage::STATUS_OK);
                 DoReportStatusBarMessage("");
 
@@ -49,6 +49,7 @@ OpenResourceDlg::OpenResourceDlg(wxWindow* parent, IManager* manager)
     PHPWorkspace::Get()->GetWorkspaceFiles(files);
     m_table.Open(PHPWorkspace::Get()->GetFilename().GetPath());
     m_allFiles.reserve(files.size());
+    m_filesIndex.Reserve(files.size());
     for (wxFileName fn : files) {
         if (fn.GetFullName() == FOLDER_MARKER) {
             // fake item
@@ -61,6 +62,7 @@ OpenResourceDlg::OpenResourceDlg(wxWindow* parent, IManager* manager)
         fileItem.line = -1;
         fileItem.type = ResourceItem::kRI_File;
         m_allFiles.push_back(fileItem);
+        m_filesIndex.Add(fn.GetFullPath());
     }
 
     DoInitialize();
@@ -199,35 +201,34 @@ void OpenResourceDlg::DoGetResources(const wxString& filter)
     PHPEntityBase::List_t matches;
     m_table.LoadAllByFilter(matches, filter);
 
-    // Convert the PHP matches into resources
-    m_resources.reserve(matches.size());
+    // Convert the PHP matches into resources, best match first
+    clFuzzyIndex index;
+    index.Reserve(matches.size());
     for (PHPEntityBase::Ptr_t match : matches) {
-        if (FileUtils::FuzzyMatch(filter, match->GetFullName())) {
-            ResourceItem resource;
-            resource.displayName = match->GetDisplayName();
-            resource.filename = match->GetFilename();
-            resource.line = match->GetLine();
-            resource.SetType(match);
-            m_resources.push_back(resource);
-        }
+        index.Add(match->GetFullName());
+    }
+
+    auto ranked = index.Search(filter);
+    m_resources.reserve(ranked.size());
+    for (const auto& ranked_match : ranked) {
+        PHPEntityBase::Ptr_t match = matches[ranked_match.index];
+        ResourceItem resource;
+        resource.displayName = match->GetDisplayName();
+        resource.filename = match->GetFilename();
+        resource.line = match->GetLine();
+        resource.SetType(match);
+        m_resources.push_back(resource);
     }
 }
 
 ResourceVector_t OpenResourceDlg::DoGetFiles(const wxString& filter)
 {
     ResourceVector_t resources;
-    // filter non matched entries
-    wxString lcFilter = filter;
-    lcFilter.MakeLower();
-
-    for(size_t i = 0; i < m_allFiles.size(); i++) {
-        wxString filename = m_allFiles.at(i).filename.GetFullPath().Lower();
-        if(FileUtils::FuzzyMatch(filter, filename)) {
-            resources.push_back(m_allFiles.at(i));
-            // Don't return too many matches...
-            if(resources.size() == 300)
-                break;
-        }
+    // Don't return too many matches...
+    auto matches = m_filesIndex.Search(filter, 300);
+    resources.reserve(matches.size());
+    for(const auto& match : matches) {
+        resources.push_back(m_allFiles[match.index]);
     }
     return resources;
 }
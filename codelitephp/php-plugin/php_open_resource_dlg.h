@@ -29,6 +29,7 @@
 #include "PHP/PHPEntityBase.h"
 #include "PHP/PHPEntityVariable.h"
 #include "PHP/PHPLookupTable.h"
+#include "clFuzzyIndex.hpp"
 #include "php_ui.h"
 
 #include <memory>
@@ -100,6 +101,7 @@ public:
     IManager* m_mgr;
     std::unique_ptr<wxTimer> m_timer;
     ResourceVector_t m_allFiles;
+    clFuzzyIndex m_filesIndex; // the full path of every entry in m_allFiles
     ResourceVector_t m_resources;
     ResourceItem* m_selectedItem = nullptr;
     PHPLookupTable m_table;
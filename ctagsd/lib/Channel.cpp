@@ -20,7 +20,7 @@ eReadSome ChannelSocket::read_some()
     size_t bytes_read = 0;
     switch(client->Read(buffer, sizeof(buffer), bytes_read)) {
     case clSocketBase::kSuccess:
-        m_buffer.append(buffer, bytes_read);
+        m_decoder.Append(buffer, bytes_read);
         return eReadSome::kSuccess;
     case clSocketBase::kTimeout:
         return eReadSome::kTimeout;
@@ -49,6 +49,7 @@ bool ChannelSocket::write_reply(const wxString& message)
     // append the data
     s.append(cb.data(), cb.length());
     LOG_IF_TRACE { clDEBUG1() << "Sending reply:" << s << endl; }
+    std::lock_guard<std::mutex> lk{ m_write_mutex };
     client->Send(s);
     return true;
 }
@@ -56,7 +57,7 @@ bool ChannelSocket::write_reply(const wxString& message)
 std::unique_ptr<JSON> ChannelSocket::read_message()
 {
     while(true) {
-        auto msg = LSP::Message::GetJSONPayload(m_buffer);
+        auto msg = m_decoder.Next();
         if(msg) {
             return msg;
         }
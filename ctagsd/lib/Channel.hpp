@@ -2,9 +2,11 @@
 #define CHANNEL_HPP
 
 #include "JSON.h"
+#include "LSP/MessageDecoder.hpp"
 #include "SocketAPI/clSocketServer.h"
 
 #include <memory>
+#include <mutex>
 #include <wx/string.h>
 
 enum class eReadSome {
@@ -27,10 +29,12 @@ public:
 // socket based channel
 class ChannelSocket : public Channel
 {
-    std::string m_buffer;
+    LSP::MessageDecoder m_decoder;
     wxString m_ip;
     int m_port = -1;
     clSocketBase::Ptr_t client;
+    // replies are written from the dispatcher thread and from the reader thread (e.g. for cancelled requests)
+    std::mutex m_write_mutex;
 
 protected:
     eReadSome read_some();
@@ -3,6 +3,7 @@
 #include "SimpleTokenizer.hpp"
 #include "macros.h"
 
+#include <algorithm>
 #include <array>
 
 void LSPUtils::encode_semantic_tokens(const std::vector<TokenWrapper>& tokens_vec, std::vector<int>* encoded_arr)
@@ -164,3 +165,44 @@ void LSPUtils::to_symbol_information(const TagEntry* tag, LSP::SymbolInformation
     }
     symbol_information.SetLocation(loc);
 }
+
+namespace
+{
+/// return the offset of `position` in `buffer`
+size_t offset_from_position(const wxString& buffer, const LSP::Position& position)
+{
+    // locate the start of the line
+    size_t line_start = 0;
+    for(int line = 0; line < position.GetLine(); ++line) {
+        size_t lf = buffer.find('\n', line_start);
+        if(lf == wxString::npos) {
+            return buffer.length();
+        }
+        line_start = lf + 1;
+    }
+
+    // the character can not go beyond the end of the line
+    size_t line_end = buffer.find('\n', line_start);
+    if(line_end == wxString::npos) {
+        line_end = buffer.length();
+    } else if(line_end > line_start && buffer[line_end - 1] == '\r') {
+        --line_end;
+    }
+    return std::min(line_start + std::max(position.GetCharacter(), 0), line_end);
+}
+} // namespace
+
+void LSPUtils::apply_content_change(wxString& buffer, const LSP::TextDocumentContentChangeEvent& change)
+{
+    if(!change.GetRange().IsOk()) {
+        buffer = change.GetText();
+        return;
+    }
+
+    size_t start = offset_from_position(buffer, change.GetRange().GetStart());
+    size_t end = offset_from_position(buffer, change.GetRange().GetEnd());
+    if(end < start) {
+        std::swap(start, end);
+    }
+    buffer.replace(start, end - start, change.GetText());
+}
@@ -35,6 +35,12 @@ public:
     static LSP::CompletionItem::eCompletionItemKind get_completion_kind(const TagEntry* tag);
     static std::vector<LSP::SymbolInformation> to_symbol_information_array(const std::vector<TagEntryPtr>& tags,
                                                                            bool for_tree_view);
+
+    /**
+     * @brief apply a `didChange` content change to `buffer`. A change without a range replaces the entire buffer.
+     * Positions beyond the end of a line (or of the buffer) are clamped, as the LSP specification requires
+     */
+    static void apply_content_change(wxString& buffer, const LSP::TextDocumentContentChangeEvent& change);
 };
 
 #endif // LSPUTILS_HPP
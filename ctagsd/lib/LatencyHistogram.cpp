@@ -0,0 +1,71 @@
+#include "LatencyHistogram.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+
+size_t LatencyHistogram::bucket_index(uint64_t micros)
+{
+    // the first SUB_BUCKETS values have a bucket each, above that, each power of two [2^e, 2^(e+1)) is split into
+    // SUB_BUCKETS buckets using the bits that follow the most significant one
+    if(micros < SUB_BUCKETS) {
+        return micros;
+    }
+    size_t exponent = std::bit_width(micros) - 1;
+    size_t sub_bucket = (micros >> (exponent - SUB_BUCKETS_BITS)) & (SUB_BUCKETS - 1);
+    return (exponent - SUB_BUCKETS_BITS + 1) * SUB_BUCKETS + sub_bucket;
+}
+
+uint64_t LatencyHistogram::bucket_upper_bound(size_t index)
+{
+    if(index < SUB_BUCKETS) {
+        return index + 1;
+    }
+    size_t shift = index / SUB_BUCKETS - 1;
+    uint64_t sub_bucket = index % SUB_BUCKETS;
+    return (SUB_BUCKETS + sub_bucket + 1) << shift;
+}
+
+void LatencyHistogram::add(uint64_t micros)
+{
+    m_buckets[bucket_index(micros)]++;
+    m_count++;
+    m_total += micros;
+    m_max = std::max(m_max, micros);
+}
+
+void LatencyHistogram::clear()
+{
+    m_buckets.fill(0);
+    m_count = 0;
+    m_total = 0;
+    m_max = 0;
+}
+
+double LatencyHistogram::percentile(double p) const
+{
+    if(m_count == 0) {
+        return 0.0;
+    }
+
+    p = std::clamp(p, 0.0, 100.0);
+    uint64_t rank = std::max<uint64_t>(1, (uint64_t)std::ceil(p / 100.0 * m_count));
+    uint64_t seen = 0;
+    for(size_t i = 0; i < BUCKETS_COUNT; ++i) {
+        seen += m_buckets[i];
+        if(seen >= rank) {
+            // the bucket upper bound can not be above the largest sample
+            return std::min(bucket_upper_bound(i), m_max) / 1000.0;
+        }
+    }
+    return max_ms();
+}
+
+wxString LatencyHistogram::to_string() const
+{
+    wxString s;
+    s << "count: " << m_count << ", p50: " << wxString::Format("%.2f", percentile(50)) << "ms"
+      << ", p99: " << wxString::Format("%.2f", percentile(99)) << "ms"
+      << ", max: " << wxString::Format("%.2f", max_ms()) << "ms";
+    return s;
+}
@@ -0,0 +1,49 @@
+#ifndef LATENCYHISTOGRAM_HPP
+#define LATENCYHISTOGRAM_HPP
+
+#include <array>
+#include <cstdint>
+#include <wx/string.h>
+
+/**
+ * @class LatencyHistogram
+ * @brief a fixed size, log-scale, histogram of durations (in microseconds). Every power of two is split into
+ * 4 buckets, so a percentile is reported within 25% of its real value, no matter how many samples were added
+ */
+class LatencyHistogram
+{
+    static constexpr size_t SUB_BUCKETS_BITS = 2;
+    static constexpr size_t SUB_BUCKETS = 1 << SUB_BUCKETS_BITS;
+    static constexpr size_t BUCKETS_COUNT = 64 * SUB_BUCKETS;
+
+    std::array<uint64_t, BUCKETS_COUNT> m_buckets{};
+    uint64_t m_count = 0;
+    uint64_t m_total = 0;
+    uint64_t m_max = 0;
+
+    static size_t bucket_index(uint64_t micros);
+    static uint64_t bucket_upper_bound(size_t index);
+
+public:
+    LatencyHistogram() = default;
+    ~LatencyHistogram() = default;
+
+    void add(uint64_t micros);
+    void clear();
+
+    /**
+     * @brief return the duration, in milliseconds, under which `p` percents of the samples fall. 0 if empty
+     */
+    double percentile(double p) const;
+
+    uint64_t count() const { return m_count; }
+    double max_ms() const { return m_max / 1000.0; }
+    double mean_ms() const { return m_count == 0 ? 0.0 : (double)m_total / m_count / 1000.0; }
+
+    /**
+     * @brief a one line summary: count, p50, p99 and max
+     */
+    wxString to_string() const;
+};
+
+#endif // LATENCYHISTOGRAM_HPP
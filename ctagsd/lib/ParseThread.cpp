@@ -5,29 +5,42 @@
 
 ParseThread::~ParseThread() { stop(); }
 
+bool ParseThread::pop_task(ParseThreadTaskFunc& func)
+{
+    // active tasks always come first
+    std::list<Task>& Q = m_active_queue.empty() ? m_background_queue : m_active_queue;
+    if(Q.empty()) {
+        return false;
+    }
+
+    Task& task = Q.front();
+    if(!task.key.empty()) {
+        m_pending.erase(task.key);
+    }
+    func = std::move(task.func);
+    Q.pop_front();
+    return true;
+}
+
 void ParseThread::start(const wxString& settings_folder, const wxString& indexer_path)
 {
     stop();
-    m_change_thread = new std::thread(
-        [=](std::mutex& m, std::condition_variable& cv, std::vector<ParseThreadTaskFunc>& Q) {
-            FileLogger::RegisterThread(wxThread::GetCurrentId(), "Parser");
-            clDEBUG() << "ctagsd parser thread started..." << endl;
-            while(true) {
-                ParseThreadTaskFunc task_callback = nullptr;
-                {
-                    std::unique_lock<std::mutex> lk{ m };
-                    cv.wait(lk, [&] { return !Q.empty(); });
-                    task_callback = std::move(Q.front());
-                    Q.erase(Q.begin());
-                }
-
-                // parse the file
-                if(task_callback() == eParseThreadCallbackRC::RC_EXIT) {
-                    break;
-                }
+    m_change_thread = new std::thread([this]() {
+        FileLogger::RegisterThread(wxThread::GetCurrentId(), "Parser");
+        clDEBUG() << "ctagsd parser thread started..." << endl;
+        while(true) {
+            ParseThreadTaskFunc task_callback = nullptr;
+            {
+                std::unique_lock<std::mutex> lk{ m_mutex };
+                m_cv.wait(lk, [&] { return pop_task(task_callback); });
+            }
+
+            // parse the file
+            if(task_callback() == eParseThreadCallbackRC::RC_EXIT) {
+                break;
             }
-        },
-        ref(m_mutex), ref(m_cv), ref(m_queue));
+        }
+    });
 }
 
 void ParseThread::stop()
@@ -37,19 +50,42 @@ void ParseThread::stop()
         return;
     }
 
-    // place an empty request
+    // discard everything that is still pending and place an exit request
+    {
+        std::unique_lock<std::mutex> lk{ m_mutex };
+        m_dropped_count += m_active_queue.size() + m_background_queue.size();
+        m_active_queue.clear();
+        m_background_queue.clear();
+        m_pending.clear();
+    }
+
     ParseThreadTaskFunc stop_callback = []() { return eParseThreadCallbackRC::RC_EXIT; };
-    queue_parse_request(std::move(stop_callback));
+    queue_parse_request(std::move(stop_callback), wxEmptyString, eParseThreadPriority::kActive);
 
     m_change_thread->join();
     wxDELETE(m_change_thread);
-    clDEBUG() << "Success" << endl;
+    clDEBUG() << "Success. Coalesced tasks:" << m_coalesced_count << ". Dropped tasks:" << m_dropped_count << endl;
 }
 
-void ParseThread::queue_parse_request(ParseThreadTaskFunc&& task)
+void ParseThread::queue_parse_request(ParseThreadTaskFunc&& task, const wxString& key, eParseThreadPriority priority)
 {
     std::unique_lock<std::mutex> lk{ m_mutex };
-    // add new entry
-    m_queue.emplace_back(std::move(task));
+    std::list<Task>& Q = priority == eParseThreadPriority::kActive ? m_active_queue : m_background_queue;
+
+    if(!key.empty()) {
+        auto iter = m_pending.find(key);
+        if(iter != m_pending.end()) {
+            // a task for this key is still waiting in the queue: drop it and use the newer one instead
+            iter->second.queue->erase(iter->second.where);
+            m_pending.erase(iter);
+            m_coalesced_count++;
+            clDEBUG() << "Coalesced parse request for:" << key << ". Total coalesced:" << m_coalesced_count << endl;
+        }
+    }
+
+    Q.push_back({ key, std::move(task) });
+    if(!key.empty()) {
+        m_pending.insert({ key, { &Q, std::prev(Q.end()) } });
+    }
     m_cv.notify_one();
 }
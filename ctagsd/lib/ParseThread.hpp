@@ -4,8 +4,10 @@
 #include <atomic>
 #include <condition_variable>
 #include <functional>
+#include <list>
+#include <mutex>
 #include <thread>
-#include <vector>
+#include <unordered_map>
 #include <wx/string.h>
 
 enum class eParseThreadCallbackRC {
@@ -13,15 +15,37 @@ enum class eParseThreadCallbackRC {
     RC_EXIT,
 };
 
+enum class eParseThreadPriority {
+    kBackground, // e.g. parsing header files
+    kActive,     // the document the user is currently editing
+};
+
 using ParseThreadTaskFunc = std::function<eParseThreadCallbackRC()>;
 
 class ParseThread
 {
+    struct Task {
+        wxString key;
+        ParseThreadTaskFunc func;
+    };
+
+    struct PendingTask {
+        std::list<Task>* queue = nullptr;
+        std::list<Task>::iterator where;
+    };
+
     std::thread* m_change_thread = nullptr;
     std::mutex m_mutex;
     std::condition_variable m_cv;
     std::atomic_bool m_shutdown;
-    std::vector<ParseThreadTaskFunc> m_queue;
+    std::list<Task> m_active_queue;
+    std::list<Task> m_background_queue;
+    // pending tasks by key
+    std::unordered_map<wxString, PendingTask> m_pending;
+    std::atomic_size_t m_coalesced_count{ 0 };
+    std::atomic_size_t m_dropped_count{ 0 };
+
+    bool pop_task(ParseThreadTaskFunc& func);
 
 public:
     ParseThread() = default;
@@ -29,7 +53,22 @@ public:
 
     void start(const wxString& settings_folder, const wxString& indexer_path);
     void stop();
-    void queue_parse_request(ParseThreadTaskFunc&& task);
+    /**
+     * @brief queue a task for the parser thread. Tasks queued with `eParseThreadPriority::kActive`
+     * are executed before any background task. If `key` is not empty and a task with the same key is
+     * still waiting in the queue, the pending task is replaced by `task` (i.e. coalesced)
+     */
+    void queue_parse_request(ParseThreadTaskFunc&& task, const wxString& key = wxEmptyString,
+                             eParseThreadPriority priority = eParseThreadPriority::kBackground);
+
+    /**
+     * @brief number of pending tasks that were replaced by a newer task with the same key
+     */
+    size_t get_coalesced_count() const { return m_coalesced_count; }
+    /**
+     * @brief number of pending tasks that were discarded without being executed (e.g. on shutdown)
+     */
+    size_t get_dropped_count() const { return m_dropped_count; }
 };
 
 #endif // PARSETHREAD_HPP
@@ -7,6 +7,7 @@
 #include "Cxx/CxxTokenizer.h"
 #include "Cxx/CxxVariableScanner.h"
 #include "LSP/LSPEvent.h"
+#include "LSP/ResponseError.h"
 #include "LSP/basic_types.h"
 #include "LSPUtils.hpp"
 #include "Scanner.hpp"
@@ -18,12 +19,18 @@
 #include "database/tags_storage_sqlite3.h"
 #include "file_logger.h"
 #include "fileextmanager.h"
+#include "fileutils.h"
 #include "tags_options_data.h"
 
+#include <atomic>
+#include <condition_variable>
 #include <deque>
 #include <iostream>
+#include <mutex>
+#include <thread>
 #include <wx/filesys.h>
 #include <wx/stackwalk.h>
+#include <wx/stopwatch.h>
 
 using LSP::CompletionItem;
 using LSP::eSymbolKind;
@@ -56,6 +63,9 @@ void remove_db_if_needed(const wxString& dbpath)
         clSYSTEM() << "Current schema version is:" << db->GetSchemaVersion() << endl;
         db = nullptr;
         FileUtils::RemoveFile(dbpath);
+        // WAL mode sidecar files
+        FileUtils::RemoveFile(dbpath + "-wal");
+        FileUtils::RemoveFile(dbpath + "-shm");
     } else {
         clDEBUG() << "No schema changes detected" << endl;
     }
@@ -119,7 +129,12 @@ void scan_dir(const wxString& dir, const CTagsdSettings& settings, wxArrayString
 
     clFilesScanner scanner;
     wxArrayString exclude_folders_arr = ::wxStringTokenize(settings.GetIgnoreSpec(), ";", wxTOKEN_STRTOK);
-    scanner.Scan(dir, files, settings.GetFileMask(), wxEmptyString, settings.GetIgnoreSpec());
+    files.clear();
+    scanner.ScanParallel(dir, settings.GetFileMask(), wxEmptyString, settings.GetIgnoreSpec(),
+                         [&files](const wxString& file) -> bool {
+                             files.Add(file);
+                             return true;
+                         });
     filter_non_important_files(files, settings);
 }
 
@@ -144,9 +159,53 @@ size_t read_file_list(const wxString& settings_dir, const CTagsdSettings& settin
     return arr.size();
 }
 
+/**
+ * @brief return the database connection of the calling thread, (re-)opened when the workspace database
+ * `generation` changes. Used by the lookups that the completer runs in parallel
+ */
+ITagsStoragePtr get_thread_lookup(const wxString& db_path, size_t generation, size_t limit)
+{
+    thread_local ITagsStoragePtr lookup;
+    thread_local size_t lookup_generation = 0;
+    if (!lookup || lookup_generation != generation) {
+        lookup.reset(new TagsStorageSQLite());
+        lookup->OpenDatabase(db_path);
+        lookup->SetSingleSearchLimit(limit);
+        lookup->SetUseCache(true);
+        lookup_generation = generation;
+    }
+    return lookup;
+}
 } // namespace
 
-ProtocolHandler::~ProtocolHandler() { m_parse_thread.stop(); }
+ProtocolHandler::~ProtocolHandler()
+{
+    m_fs_watcher.Stop();
+    m_parse_thread.stop();
+    m_lookup_pool.stop();
+}
+
+void ProtocolHandler::set_request_token(CancellationToken token)
+{
+    m_request_token = std::move(token);
+    if (m_completer) {
+        m_completer->set_cancellation_token(m_request_token);
+    }
+}
+
+void ProtocolHandler::send_request_cancelled(size_t id, Channel::ptr_t channel)
+{
+    JSON root(cJSON_Object);
+    JSONItem response = root.toElement();
+    response.addProperty("id", id);
+    response.addProperty("jsonrpc", "2.0");
+    auto error = response.AddObject("error");
+    error.addProperty("code", (int)LSP::ResponseError::kErrorCodeRequestCancelled);
+    error.addProperty("message", "request cancelled");
+
+    clDEBUG() << "Request" << id << "cancelled" << endl;
+    channel->write_reply(response.format(false));
+}
 
 void ProtocolHandler::send_log_message(const wxString& message, int level, Channel::ptr_t channel)
 {
@@ -210,29 +269,30 @@ void ProtocolHandler::parse_file(const wxFileName& filename, const CTagsdSetting
     parse_files({filename.GetFullPath()}, settings);
 }
 
-void ProtocolHandler::do_parse_chunk(ITagsStoragePtr db,
-                                     const std::vector<wxString>& file_list,
-                                     size_t chunk_id,
-                                     const CTagsdSettings& settings)
+size_t ProtocolHandler::do_parse_chunk(const std::vector<wxString>& file_list,
+                                       size_t chunk_id,
+                                       const CTagsdSettings& settings,
+                                       std::vector<TagEntryPtr>& tags)
 {
-    std::vector<TagEntryPtr> tags;
     LOG_IF_DEBUG { clDEBUG() << "Parsing chunk (" << chunk_id << ") of" << file_list.size() << "files" << endl; }
     if (CTags::ParseFiles(file_list, settings.GetCodeliteIndexer(), settings.GetMacroTable(), tags) == 0) {
         clDEBUG() << "0 tags generated. processed:" << file_list.size()
                   << "files. Indexer:" << settings.GetCodeliteIndexer() << endl;
-        return;
+        return 0;
     }
+    LOG_IF_TRACE { clDEBUG1() << "Success" << endl; }
+    return tags.size();
+}
 
-    LOG_IF_TRACE
-    {
-        clDEBUG1() << "Success" << endl;
-        clDEBUG1() << "Updating symbols database..." << endl;
-    }
+void ProtocolHandler::do_store_chunk(ITagsStoragePtr db,
+                                     const std::vector<wxString>& file_list,
+                                     const std::vector<TagEntryPtr>& tags,
+                                     time_t update_time)
+{
     LOG_IF_DEBUG { clDEBUG() << "Storing" << tags.size() << "tags" << endl; }
-    db->Begin();
-
-    time_t update_time = time(nullptr);
-    db->Store(tags, false);
+    if (!tags.empty()) {
+        db->Store(tags, false);
+    }
 
     // update the files table in the database
     // we do this here, since some files might not yield tags
@@ -242,12 +302,11 @@ void ProtocolHandler::do_parse_chunk(ITagsStoragePtr db,
             db->UpdateFileEntry(file, (int)update_time);
         }
     }
-
-    // Commit whats left
-    db->Commit();
 }
 
-void ProtocolHandler::parse_files(const std::vector<wxString>& file_list, const CTagsdSettings& settings)
+void ProtocolHandler::parse_files(const std::vector<wxString>& file_list,
+                                  const CTagsdSettings& settings,
+                                  Channel::ptr_t channel)
 {
     clDEBUG() << "Parsing" << file_list.size() << "files" << endl;
     clDEBUG() << "Removing un-modified and unwanted files..." << endl;
@@ -274,29 +333,114 @@ void ProtocolHandler::parse_files(const std::vector<wxString>& file_list, const
         return;
     }
 
-    // don't parse all files at once, split them into chunks
-    // how many chunks?
-    size_t chunk_size = 2500;
-    size_t chunk_count = filtered_file_list.size() / chunk_size + 1;
-    clDEBUG() << "Parsing" << filtered_file_list.size() << "files..." << endl;
-    for (size_t i = 0; i < chunk_count; ++i) {
-        // determine the start/end iterators for each range
-        size_t start_offset = i * chunk_size;
+    // don't parse all files at once, split them into chunks. Each chunk is handled by a single
+    // `codelite_indexer` process. We want at least one chunk per worker, but no more than 2500 files per chunk
+    size_t total_files = filtered_file_list.size();
+    size_t workers_count = settings.GetIndexerProcessesCount();
+    size_t chunk_size = (total_files + workers_count - 1) / workers_count;
+    chunk_size = std::max<size_t>(chunk_size, 100);
+    chunk_size = std::min<size_t>(chunk_size, 2500);
+
+    std::vector<std::vector<wxString>> chunks;
+    chunks.reserve(total_files / chunk_size + 1);
+    for (size_t start_offset = 0; start_offset < total_files; start_offset += chunk_size) {
         auto iter_start = filtered_file_list.begin() + start_offset;
-        if (iter_start == filtered_file_list.end())
-            // last chunk is empty...
-            // this can happen when our initial file list size divides by 1000
-            // with 0 remainder
-            break;
-
-        auto iter_end = iter_start + chunk_size;
-        if ((start_offset + chunk_size) > filtered_file_list.size()) {
-            iter_end = filtered_file_list.end();
+        auto iter_end = iter_start + std::min(chunk_size, total_files - start_offset);
+        chunks.emplace_back(iter_start, iter_end);
+    }
+    workers_count = std::min(workers_count, chunks.size());
+
+    clDEBUG() << "Parsing" << total_files << "files using" << workers_count << "indexer processes," << chunks.size()
+              << "chunks" << endl;
+
+    wxStopWatch sw;
+    size_t files_done = 0;
+    auto report_progress = [&](size_t files_stored) {
+        files_done += files_stored;
+        if (!channel) {
+            return;
+        }
+        wxString message;
+        message << _("Indexing: ") << files_done << "/" << total_files << _(" files (")
+                << (files_done * 100 / total_files) << "%)";
+        send_log_message(message, LSP_LOG_INFO, channel);
+    };
+
+    if (workers_count <= 1) {
+        // no need to spawn threads, parse the chunks on the calling thread
+        for (size_t i = 0; i < chunks.size(); ++i) {
+            std::vector<TagEntryPtr> tags;
+            do_parse_chunk(chunks[i], i, settings, tags);
+
+            db->Begin();
+            do_store_chunk(db, chunks[i], tags, time(nullptr));
+            db->Commit();
+            report_progress(chunks[i].size());
+        }
+
+    } else {
+        // the workers run the indexer processes, while the calling thread is the only
+        // thread that writes into the database. Whatever the workers produced since the last
+        // commit is stored in a single transaction
+        struct ParsedChunk {
+            size_t chunk_id = 0;
+            std::vector<TagEntryPtr> tags;
+        };
+
+        std::mutex results_mutex;
+        std::condition_variable results_cv;
+        std::vector<ParsedChunk> results;
+        std::atomic_size_t next_chunk{0};
+
+        std::vector<std::thread> workers;
+        workers.reserve(workers_count);
+        for (size_t i = 0; i < workers_count; ++i) {
+            workers.emplace_back([&]() {
+                FileLogger::RegisterThread(wxThread::GetCurrentId(), "Indexer");
+                while (true) {
+                    size_t chunk_id = next_chunk.fetch_add(1);
+                    if (chunk_id >= chunks.size()) {
+                        break;
+                    }
+
+                    ParsedChunk parsed;
+                    parsed.chunk_id = chunk_id;
+                    do_parse_chunk(chunks[chunk_id], chunk_id, settings, parsed.tags);
+
+                    std::unique_lock<std::mutex> lk{results_mutex};
+                    results.emplace_back(std::move(parsed));
+                    results_cv.notify_one();
+                }
+                FileLogger::UnRegisterThread(wxThread::GetCurrentId());
+            });
+        }
+
+        size_t chunks_stored = 0;
+        while (chunks_stored < chunks.size()) {
+            std::vector<ParsedChunk> batch;
+            {
+                std::unique_lock<std::mutex> lk{results_mutex};
+                results_cv.wait(lk, [&] { return !results.empty(); });
+                batch.swap(results);
+            }
+
+            size_t batch_files = 0;
+            time_t update_time = time(nullptr);
+            db->Begin();
+            for (const auto& parsed : batch) {
+                do_store_chunk(db, chunks[parsed.chunk_id], parsed.tags, update_time);
+                batch_files += chunks[parsed.chunk_id].size();
+            }
+            db->Commit();
+            chunks_stored += batch.size();
+            report_progress(batch_files);
+        }
+
+        for (auto& worker : workers) {
+            worker.join();
         }
-        std::vector<wxString> chunk_vec{iter_start, iter_end};
-        do_parse_chunk(db, chunk_vec, i, settings);
     }
-    clDEBUG() << "Success" << endl;
+    clDEBUG() << "Success. Parsing took:" << sw.Time() << "ms" << endl;
 }
 
 std::vector<wxString> ProtocolHandler::update_additional_scopes_for_file(const wxString& filepath)
@@ -440,6 +584,10 @@ void ProtocolHandler::on_initialize(std::unique_ptr<JSON>&& msg, Channel::ptr_t
     capabilities.addProperty("definitionProvider", true);
     capabilities.addProperty("documentSymbolProvider", true);
     capabilities.addProperty("hoverProvider", true);
+    // we apply the `didChange` ranges ourselves, no need to send us the entire file on every change
+    auto textDocumentSync = capabilities.AddObject("textDocumentSync");
+    textDocumentSync.addProperty("openClose", true);
+    textDocumentSync.addProperty("change", 2); // TextDocumentSyncKind.Incremental
     auto semanticTokensProvider = capabilities.AddObject("semanticTokensProvider");
     auto full = semanticTokensProvider.AddObject("full");
     auto legend = semanticTokensProvider.AddObject("legend");
@@ -499,10 +647,13 @@ void ProtocolHandler::on_initialize(std::unique_ptr<JSON>&& msg, Channel::ptr_t
     wxFileName fn_db_path(m_settings_folder, "tags.db");
     remove_db_if_needed(fn_db_path.GetFullPath());
 
+    // the symbol index is re-loaded once the workspace is parsed, don't update it while parsing
+    TagsSymbolIndex::Release(fn_db_path.GetFullPath());
+
     wxString indexer_path = m_settings.GetCodeliteIndexer();
     std::vector<wxString> files_to_parse = {files.begin(), files.end()};
     clDEBUG() << "on_initialize(): parsing files..." << endl;
-    ProtocolHandler::parse_files(files_to_parse, m_settings);
+    ProtocolHandler::parse_files(files_to_parse, m_settings, channel);
     clDEBUG() << "on_initialize(): parsing files... Success" << endl;
 
     // Now that the database is parsed, re-open it
@@ -511,12 +662,36 @@ void ProtocolHandler::on_initialize(std::unique_ptr<JSON>&& msg, Channel::ptr_t
     TagsManagerST::Get()->GetDatabase()->SetSingleSearchLimit(m_settings.GetLimitResults());
     TagsManagerST::Get()->GetDatabase()->SetUseCache(true);
 
+    if (m_settings.IsSymbolIndex()) {
+        auto db = std::dynamic_pointer_cast<TagsStorageSQLite>(TagsManagerST::Get()->GetDatabase());
+        if (db) {
+            db->LoadSymbolIndex();
+        }
+    }
+
+    // from now on, only the files that change are re-indexed
+    start_fs_watcher();
+
     // reparse the workspace
     send_log_message(_("Initialization completed"), LSP_LOG_INFO, channel);
 
     m_completer.reset(new CxxCodeCompletion(TagsManagerST::Get()->GetDatabase(), m_settings.GetCodeliteIndexer()));
     m_completer->set_macros_table(m_settings.GetTokens());
     m_completer->set_types_table(m_settings.GetTypes());
+    m_completer->set_cancellation_token(m_request_token);
+
+    // the calling thread takes part in the lookups, so the pool needs one thread less
+    ++m_db_generation;
+    size_t lookup_threads = m_settings.GetLookupThreadsCount();
+    m_lookup_pool.start(lookup_threads - 1);
+    if (lookup_threads > 1) {
+        wxString db_path = fn_db_path.GetFullPath();
+        size_t generation = m_db_generation;
+        size_t limit = m_settings.GetLimitResults();
+        m_completer->set_parallel_lookups(
+            [this](size_t count, const std::function<void(size_t)>& task) { m_lookup_pool.parallel_for(count, task); },
+            [db_path, generation, limit]() { return get_thread_lookup(db_path, generation, limit); });
+    }
     channel->write_reply(response.format(false));
 }
 
@@ -594,18 +769,29 @@ void ProtocolHandler::on_did_change(std::unique_ptr<JSON>&& msg, Channel::ptr_t
     // Check if a real change was made that requires parsing
     size_t line_count_before = 0;
     size_t line_count_after = 0;
-    if (m_filesOpened.count(filepath)) {
-        line_count_before = count_lines(m_filesOpened[filepath]);
+    auto iter = m_filesOpened.find(filepath);
+    if (iter != m_filesOpened.end()) {
+        line_count_before = count_lines(iter->second);
+    } else {
+        iter = m_filesOpened.insert({filepath, wxEmptyString}).first;
     }
-    wxString file_content = json["params"]["contentChanges"][0]["text"].toString();
-    line_count_after = count_lines(file_content);
 
-    // update the new content
-    clDEBUG() << "textDocument/didChange: caching new content for file:" << filepath << endl;
-    m_filesOpened.erase(filepath);
+    // apply the changes, in order, to the buffer we hold. With incremental sync, each change carries a range,
+    // with full sync there is a single change holding the entire file
+    wxString& buffer = iter->second;
+    auto content_changes = json["params"]["contentChanges"];
+    int changes_count = content_changes.arraySize();
+    for (int i = 0; i < changes_count; ++i) {
+        LSP::TextDocumentContentChangeEvent change;
+        change.FromJSON(content_changes[i]);
+        LSPUtils::apply_content_change(buffer, change);
+    }
+    clDEBUG() << "textDocument/didChange: applied" << changes_count << "changes to file:" << filepath << endl;
     m_comments_cache.erase(filepath);
-    m_filesOpened.insert({filepath, file_content});
-    clDEBUG() << "Updating content for file:" << filepath << endl;
+
+    // the parse task runs on another thread, so it gets its own copy
+    wxString file_content = buffer;
+    line_count_after = count_lines(file_content);
 
     // we compare the preamble of both before and after the file
     // modification
@@ -641,7 +827,8 @@ void ProtocolHandler::on_did_change(std::unique_ptr<JSON>&& msg, Channel::ptr_t
             return eParseThreadCallbackRC::RC_SUCCESS;
         };
         clDEBUG() << "Pushing parse request to worker thread" << endl;
-        m_parse_thread.queue_parse_request(std::move(buffer_parse_task));
+        // a newer buffer of the same file replaces any pending re-parse of that file
+        m_parse_thread.queue_parse_request(std::move(buffer_parse_task), filepath, eParseThreadPriority::kActive);
 
         // parse the files included by this file
         if (!new_includes.empty()) {
@@ -654,6 +841,8 @@ void ProtocolHandler::on_did_change(std::unique_ptr<JSON>&& msg, Channel::ptr_t
             };
             m_parse_thread.queue_parse_request(std::move(headers_parse_task));
         }
+        clDEBUG() << "Parse thread stats. Coalesced:" << m_parse_thread.get_coalesced_count()
+                  << "Dropped:" << m_parse_thread.get_dropped_count() << endl;
     } else {
         clDEBUG() << "No real change detected. Will not re-parse the file" << endl;
     }
@@ -799,6 +988,11 @@ void ProtocolHandler::on_completion(std::unique_ptr<JSON>&& msg, Channel::ptr_t
         }
     }
 
+    if (is_request_cancelled()) {
+        send_request_cancelled(id, channel);
+        return;
+    }
+
     if (!candidates.empty()) {
         // ensure all relevant files have been parsed for comments
         clDEBUG() << "Updating comments for matches..." << endl;
@@ -853,6 +1047,149 @@ void ProtocolHandler::on_completion(std::unique_ptr<JSON>&& msg, Channel::ptr_t
 }
 
 // Notificatin -->
+void ProtocolHandler::start_fs_watcher()
+{
+    if (!clFileTreeWatcher::IsSupported()) {
+        return;
+    }
+
+    // the watcher can only skip whole folders: use the ignore spec entries that are plain folder names (e.g.
+    // "/build/"), the rest is filtered by `filter_non_important_files`
+    std::vector<wxString> exclude_folders = { ".git", ".svn", ".codelite", ".ctagsd" };
+    wxArrayString ignore_spec = ::wxStringTokenize(m_settings.GetIgnoreSpec(), ";", wxTOKEN_STRTOK);
+    for (const wxString& spec : ignore_spec) {
+        if (spec.length() > 2 && spec.StartsWith("/") && spec.EndsWith("/")) {
+            wxString name = spec.Mid(1, spec.length() - 2);
+            if (!name.Contains("/")) {
+                exclude_folders.push_back(name);
+            }
+        }
+    }
+
+    m_fs_watcher.Stop();
+    m_fs_watcher.SetExcludeFolders(exclude_folders);
+    m_fs_watcher.SetLatency(250);
+    if (!m_fs_watcher.Start([this](const clFileTreeWatcher::Changes_t& changes) { on_fs_changes(changes); })) {
+        return;
+    }
+
+    if (!m_fs_watcher.AddFolder(m_root_folder, true)) {
+        clWARNING() << "Could not watch folder:" << m_root_folder << endl;
+        m_fs_watcher.Stop();
+        return;
+    }
+    clDEBUG() << "Watching" << m_fs_watcher.GetWatchCount() << "folders for changes" << endl;
+}
+
+void ProtocolHandler::on_fs_changes(const clFileTreeWatcher::Changes_t& changes)
+{
+    wxArrayString modified;
+    {
+        std::lock_guard<std::mutex> lock{ m_fs_changes_mutex };
+        for (const auto& change : changes) {
+            switch (change.kind) {
+            case clFileTreeWatcher::kOverflow:
+                m_fs_rescan = true;
+                break;
+            case clFileTreeWatcher::kDeleted:
+                m_fs_modified.erase(change.path);
+                m_fs_deleted.insert(change.path);
+                m_fs_saved.erase(change.path);
+                break;
+            default:
+                // writing the file to the disk is what triggered `didSave`, which already parsed it
+                if (!is_saved_file(change.path)) {
+                    modified.Add(change.path);
+                }
+                break;
+            }
+        }
+
+        filter_non_important_files(modified, m_settings);
+        for (const wxString& file : modified) {
+            m_fs_deleted.erase(file);
+            m_fs_modified.insert(file);
+        }
+
+        if (!m_fs_rescan && m_fs_modified.empty() && m_fs_deleted.empty()) {
+            return;
+        }
+    }
+
+    // a single task handles all the pending changes, no matter how many batches arrive until it runs
+    ParseThreadTaskFunc task = [this]() {
+        apply_fs_changes();
+        return eParseThreadCallbackRC::RC_SUCCESS;
+    };
+    m_parse_thread.queue_parse_request(std::move(task), "fs-changes", eParseThreadPriority::kBackground);
+}
+
+void ProtocolHandler::apply_fs_changes()
+{
+    wxStringSet_t modified;
+    wxStringSet_t deleted;
+    bool rescan = false;
+    {
+        std::lock_guard<std::mutex> lock{ m_fs_changes_mutex };
+        modified.swap(m_fs_modified);
+        deleted.swap(m_fs_deleted);
+        std::swap(rescan, m_fs_rescan);
+    }
+
+    if (!deleted.empty()) {
+        wxFileName dbfile(m_settings.GetSettingsDir(), "tags.db");
+        ITagsStoragePtr db(new TagsStorageSQLite());
+        db->OpenDatabase(dbfile);
+
+        // a deleted folder takes all its files with it
+        std::vector<wxString> files;
+        for (const wxString& path : deleted) {
+            files.push_back(path);
+
+            std::vector<FileEntryPtr> entries;
+            wxString prefix = path + "/";
+            db->GetFiles(prefix, entries);
+            for (const auto& entry : entries) {
+                if (entry->GetFile().StartsWith(prefix)) {
+                    files.push_back(entry->GetFile());
+                }
+            }
+        }
+
+        clDEBUG() << "File system changes: removing symbols of" << files.size() << "files" << endl;
+        db->Begin();
+        for (const wxString& file : files) {
+            // this also removes the file entry
+            db->DeleteByFileName({}, file, false);
+        }
+        // the symbol index and the cached results are updated once the commit succeeds
+        db->Commit();
+    }
+
+    if (rescan) {
+        // we lost track of the changes: let the timestamps tell us which files need to be parsed
+        wxArrayString files;
+        scan_dir(m_root_folder, m_settings, files);
+        modified.insert(files.begin(), files.end());
+    }
+
+    if (!modified.empty()) {
+        clDEBUG() << "File system changes: parsing" << modified.size() << "files" << endl;
+        std::vector<wxString> files{ modified.begin(), modified.end() };
+        ProtocolHandler::parse_files(files, m_settings);
+    }
+}
+
+bool ProtocolHandler::is_saved_file(const wxString& file) const
+{
+    auto iter = m_fs_saved.find(file);
+    if (iter == m_fs_saved.end()) {
+        return false;
+    }
+    return iter->second.first == FileUtils::GetFileModificationTime(file) &&
+           iter->second.second == FileUtils::GetFileSize(file);
+}
+
 void ProtocolHandler::on_did_save(std::unique_ptr<JSON>&& msg, Channel::ptr_t channel)
 {
     wxUnusedVar(channel);
@@ -868,6 +1205,13 @@ void ProtocolHandler::on_did_save(std::unique_ptr<JSON>&& msg, Channel::ptr_t ch
     m_filesOpened.erase(filepath);
     m_filesOpened.insert({filepath, file_content});
 
+    // the file is parsed below, don't let the watcher event of this save parse it again
+    {
+        std::lock_guard<std::mutex> lock{ m_fs_changes_mutex };
+        m_fs_modified.erase(filepath);
+        m_fs_saved[filepath] = { FileUtils::GetFileModificationTime(filepath), FileUtils::GetFileSize(filepath) };
+    }
+
     // update the file using namespace
     clDEBUG() << "did_save: collecting files to parse..." << endl;
     parse_file_for_includes_and_using_namespace(filepath);
@@ -894,8 +1238,17 @@ void ProtocolHandler::on_did_save(std::unique_ptr<JSON>&& msg, Channel::ptr_t ch
         return eParseThreadCallbackRC::RC_SUCCESS;
     };
 
-    m_parse_thread.queue_parse_request(std::move(task));
-    TagsManagerST::Get()->GetDatabase()->ClearCache();
+    m_parse_thread.queue_parse_request(
+        std::move(task), wxString() << "save:" << filepath, eParseThreadPriority::kActive);
+
+    // no need to clear the cache: storing the new tags invalidates only the cached results affected by them
+    auto db = std::dynamic_pointer_cast<TagsStorageSQLite>(TagsManagerST::Get()->GetDatabase());
+    if (db) {
+        const auto& stats = db->GetCacheStats();
+        clDEBUG() << "Cache stats: hits:" << stats.hits << "misses:" << stats.misses << "evictions:" << stats.evictions
+                  << "invalidations:" << stats.invalidations << "entries:" << stats.entries << "bytes:" << stats.bytes
+                  << endl;
+    }
 
     // clear the cached "using namespace"
     m_additional_scopes.clear();
@@ -1190,6 +1543,11 @@ void ProtocolHandler::on_document_signature_help(std::unique_ptr<JSON>&& msg, Ch
         }
     }
 
+    if (is_request_cancelled()) {
+        send_request_cancelled(id, channel);
+        return;
+    }
+
     // sort the matches
     candidates.clear();
     m_completer->sort_tags(matches, candidates, true, {});
@@ -1239,6 +1597,11 @@ void ProtocolHandler::on_hover(std::unique_ptr<JSON>&& msg, Channel::ptr_t chann
     std::vector<TagEntryPtr> tags;
     do_find_definition_tags(std::move(msg), channel, true, tags, nullptr);
 
+    if (is_request_cancelled()) {
+        send_request_cancelled(id, channel);
+        return;
+    }
+
     // format tip from tag
     std::vector<TagEntryPtr> function_tag_arr;
     wxStringSet_t visited;
@@ -6,12 +6,17 @@
 #include "Cxx/CxxCodeCompletion.hpp"
 #include "JSON.h"
 #include "ParseThread.hpp"
+#include "RequestScheduler.hpp"
 #include "Scanner.hpp"
 #include "Settings.hpp"
+#include "WorkerPool.hpp"
+#include "clFileTreeWatcher.hpp"
 #include "database/istorage.h"
 #include "macros.h"
 
 #include <memory>
+#include <mutex>
+#include <unordered_map>
 #include <wx/string.h>
 
 struct CachedComment {
@@ -47,9 +52,32 @@ private:
     CxxCodeCompletion::ptr_t m_completer;
     ParseThread m_parse_thread;
 
+    // runs the independent lookups of a request in parallel (see CxxCodeCompletion::set_parallel_lookups())
+    WorkerPool m_lookup_pool;
+    // bumped every time the workspace database is re-created, so the lookup threads re-open it
+    size_t m_db_generation = 0;
+    // the token of the request being handled, set by the scheduler
+    CancellationToken m_request_token;
+
+    // files changed on disk, waiting to be re-indexed by the parse thread
+    clFileTreeWatcher m_fs_watcher;
+    std::mutex m_fs_changes_mutex;
+    wxStringSet_t m_fs_modified;
+    wxStringSet_t m_fs_deleted;
+    bool m_fs_rescan = false;
+    // the files parsed by `didSave` and their time stamp + size at that point: the watcher events they trigger are
+    // not parsed again (see is_saved_file())
+    std::unordered_map<wxString, std::pair<time_t, size_t>> m_fs_saved;
+
 private:
     JSONItem build_result(JSONItem& reply, size_t id, int result_kind);
 
+    /**
+     * @brief return true if the request being handled was cancelled by the client (or superseded by a newer
+     * request). In that case, the handler should reply with `send_request_cancelled()`
+     */
+    bool is_request_cancelled() const { return m_request_token && m_request_token->load(); }
+
     /**
      * @brief parse source file
      */
@@ -59,13 +87,21 @@ private:
      */
     static void parse_buffer(const wxFileName& filename, const wxString& buffer, const CTagsdSettings& settings);
     /**
-     * @brief parse list of files
+     * @brief parse list of files. The files are split into chunks which are indexed by a pool of
+     * `codelite_indexer` processes (see `CTagsdSettings::GetIndexerProcessesCount()`), the results are
+     * written into the database by the calling thread. If `channel` is provided, progress is reported
+     * to the client using "window/logMessage"
      */
-    static void parse_files(const std::vector<wxString>& files, const CTagsdSettings& settings);
+    static void parse_files(const std::vector<wxString>& files, const CTagsdSettings& settings,
+                            Channel::ptr_t channel = nullptr);
+
+    // helper method for parsing a chunk of files, returns the number of tags generated
+    static size_t do_parse_chunk(const std::vector<wxString>& files, size_t chunk_id, const CTagsdSettings& settings,
+                                 std::vector<TagEntryPtr>& tags);
 
-    // helper method for parsing a chunk of files
-    static void do_parse_chunk(ITagsStoragePtr db, const std::vector<wxString>& files, size_t chunk_id,
-                               const CTagsdSettings& settings);
+    // helper method for storing the tags of a parsed chunk. Must be called within a transaction
+    static void do_store_chunk(ITagsStoragePtr db, const std::vector<wxString>& files,
+                               const std::vector<TagEntryPtr>& tags, time_t update_time);
 
     bool ensure_file_content_exists(const wxString& filepath, Channel::ptr_t channel, size_t req_id);
     void update_comments_for_file(const wxString& filepath, const wxString& file_content);
@@ -78,6 +114,24 @@ private:
     size_t do_find_definition_tags(std::unique_ptr<JSON>&& msg, Channel::ptr_t channel, bool try_definition_first,
                                    std::vector<TagEntryPtr>& tags, wxString* file_match);
 
+    /**
+     * @brief watch the workspace folder and re-index the files modified outside of the editor
+     */
+    void start_fs_watcher();
+    /**
+     * @brief called from the watcher thread with a batch of changes
+     */
+    void on_fs_changes(const clFileTreeWatcher::Changes_t& changes);
+    /**
+     * @brief parse thread task: apply the pending file system changes to the database
+     */
+    void apply_fs_changes();
+    /**
+     * @brief return true if `file` was not modified since `didSave` parsed it. Must be called with
+     * `m_fs_changes_mutex` locked
+     */
+    bool is_saved_file(const wxString& file) const;
+
     void build_search_path();
     void parse_file_for_includes_and_using_namespace(const wxString& filepath);
     void parse_buffer_for_includes_and_using_namespace(const wxString& filepath, const wxString& buffer);
@@ -121,10 +175,20 @@ public:
     void on_hover(std::unique_ptr<JSON>&& msg, Channel::ptr_t channel);
     void on_workspace_symbol(std::unique_ptr<JSON>&& msg, Channel::ptr_t channel);
 
+    /**
+     * @brief set the cancellation token of the request about to be handled
+     */
+    void set_request_token(CancellationToken token);
+
     /**
      * @brief send a "window/logMessage" message to the client
      */
-    void send_log_message(const wxString& message, int level, Channel::ptr_t channel);
+    static void send_log_message(const wxString& message, int level, Channel::ptr_t channel);
+
+    /**
+     * @brief reply to request `id` with a "RequestCancelled" error
+     */
+    static void send_request_cancelled(size_t id, Channel::ptr_t channel);
 };
 
 #endif // PROTOCOLHANDLER_HPP
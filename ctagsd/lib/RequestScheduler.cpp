@@ -0,0 +1,189 @@
+#include "RequestScheduler.hpp"
+
+#include "file_logger.h"
+
+#include <map>
+#include <wx/thread.h>
+
+namespace
+{
+// how often the latency histograms are written to the log (at the debug level)
+constexpr std::chrono::seconds STATS_REPORT_INTERVAL{ 60 };
+} // namespace
+
+RequestScheduler::~RequestScheduler() { stop(); }
+
+bool RequestScheduler::is_superseding(const wxString& method)
+{
+    // the client is only interested in the result for the latest position of the caret
+    return method == "textDocument/completion" || method == "textDocument/signatureHelp" ||
+           method == "textDocument/hover";
+}
+
+void RequestScheduler::start(CancelledCallback&& on_cancelled)
+{
+    stop();
+    m_on_cancelled = std::move(on_cancelled);
+    m_shutdown = false;
+    m_last_report = clock_t::now();
+    m_thread = new std::thread([this]() {
+        FileLogger::RegisterThread(wxThread::GetCurrentId(), "Dispatcher");
+        clDEBUG() << "ctagsd dispatcher thread started..." << endl;
+        dispatch_loop();
+    });
+}
+
+void RequestScheduler::stop()
+{
+    if(!m_thread) {
+        return;
+    }
+
+    clDEBUG() << "Shutting down dispatcher thread" << endl;
+    size_t dropped = 0;
+    {
+        std::unique_lock<std::mutex> lk{ m_mutex };
+        m_shutdown = true;
+        dropped = m_queue.size();
+        m_queue.clear();
+        if(m_running.token) {
+            *m_running.token = true;
+        }
+    }
+    m_cv.notify_all();
+    m_thread->join();
+    wxDELETE(m_thread);
+    clDEBUG() << "Success. Dropped requests:" << dropped << endl;
+    log_stats(true);
+}
+
+void RequestScheduler::dispatch_loop()
+{
+    while(true) {
+        Request request;
+        {
+            std::unique_lock<std::mutex> lk{ m_mutex };
+            m_cv.wait(lk, [this] { return m_shutdown || !m_queue.empty(); });
+            if(m_shutdown) {
+                break;
+            }
+            request = std::move(m_queue.front());
+            m_queue.pop_front();
+            m_running = { request.method, request.id, request.has_id, request.token };
+        }
+
+        request.handler(std::move(request.msg), request.token);
+        auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(clock_t::now() - request.received);
+
+        {
+            std::unique_lock<std::mutex> lk{ m_mutex };
+            m_running = {};
+        }
+
+        m_latency[request.method].add(elapsed.count());
+        LOG_IF_TRACE
+        {
+            clDEBUG1() << request.method << "completed in" << elapsed.count() / 1000.0 << "ms"
+                       << (request.token->load() ? "(cancelled)" : "") << endl;
+        }
+
+        if(clock_t::now() - m_last_report >= STATS_REPORT_INTERVAL) {
+            log_stats(false);
+            m_last_report = clock_t::now();
+        }
+    }
+}
+
+std::list<RequestScheduler::Request> RequestScheduler::take_pending(const std::function<bool(const Request&)>& pred)
+{
+    std::list<Request> taken;
+    for(auto iter = m_queue.begin(); iter != m_queue.end();) {
+        auto next = std::next(iter);
+        if(pred(*iter)) {
+            m_cancelled[iter->method]++;
+            taken.splice(taken.end(), m_queue, iter);
+        }
+        iter = next;
+    }
+    return taken;
+}
+
+void RequestScheduler::reply_cancelled(std::list<Request>& requests)
+{
+    for(const auto& request : requests) {
+        LOG_IF_DEBUG { clDEBUG() << "Request" << request.id << request.method << "cancelled before it started" << endl; }
+        if(m_on_cancelled) {
+            m_on_cancelled(request.id);
+        }
+    }
+}
+
+void RequestScheduler::submit(const wxString& method, std::unique_ptr<JSON>&& msg, Handler&& handler)
+{
+    Request request;
+    auto json = msg->toElement();
+    request.method = method;
+    request.has_id = json.hasNamedObject("id");
+    request.id = json["id"].toSize_t();
+    request.msg = std::move(msg);
+    request.handler = std::move(handler);
+    request.token = std::make_shared<std::atomic_bool>(false);
+    request.received = clock_t::now();
+
+    std::list<Request> superseded;
+    {
+        std::unique_lock<std::mutex> lk{ m_mutex };
+        if(is_superseding(method) && request.has_id) {
+            superseded = take_pending([&method](const Request& r) { return r.has_id && r.method == method; });
+            if(m_running.token && m_running.has_id && m_running.method == method) {
+                *m_running.token = true;
+            }
+        }
+        m_queue.push_back(std::move(request));
+    }
+    m_cv.notify_one();
+    reply_cancelled(superseded);
+}
+
+void RequestScheduler::cancel(size_t id)
+{
+    std::list<Request> cancelled;
+    {
+        std::unique_lock<std::mutex> lk{ m_mutex };
+        cancelled = take_pending([id](const Request& r) { return r.has_id && r.id == id; });
+        if(m_running.token && m_running.has_id && m_running.id == id) {
+            *m_running.token = true;
+        }
+    }
+    reply_cancelled(cancelled);
+}
+
+void RequestScheduler::log_stats(bool summary)
+{
+    std::unordered_map<wxString, size_t> cancelled;
+    {
+        std::unique_lock<std::mutex> lk{ m_mutex };
+        cancelled = m_cancelled;
+    }
+
+    // sorted by method name, so consecutive reports are easy to compare
+    std::map<wxString, wxString> lines;
+    for(const auto& [method, histogram] : m_latency) {
+        lines[method] << histogram.to_string();
+    }
+    for(const auto& [method, count] : cancelled) {
+        lines[method] << (lines[method].empty() ? "" : ", ") << "cancelled before start: " << count;
+    }
+
+    if(lines.empty()) {
+        return;
+    }
+
+    for(const auto& [method, line] : lines) {
+        if(summary) {
+            clSYSTEM() << "Latency:" << method << line << endl;
+        } else {
+            clDEBUG() << "Latency:" << method << line << endl;
+        }
+    }
+}
@@ -0,0 +1,105 @@
+#ifndef REQUESTSCHEDULER_HPP
+#define REQUESTSCHEDULER_HPP
+
+#include "JSON.h"
+#include "LatencyHistogram.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <wx/string.h>
+
+/// set by the scheduler when the request should stop as soon as possible, checked by the handler
+using CancellationToken = std::shared_ptr<std::atomic_bool>;
+
+/**
+ * @class RequestScheduler
+ * @brief runs the LSP messages, in the order they were received, on a dedicated thread so the reader thread can
+ * keep reading the client messages (e.g. "$/cancelRequest") while a request is running.
+ *
+ * Every request gets a cancellation token. A request for a "superseding" method (completion, signature help,
+ * hover) makes the older requests for the same method obsolete: the ones still waiting in the queue are dropped
+ * and the running one is asked to stop. The time from the arrival of a message to the end of its handler is
+ * recorded per method
+ */
+class RequestScheduler
+{
+public:
+    using clock_t = std::chrono::steady_clock;
+    using Handler = std::function<void(std::unique_ptr<JSON>&& msg, CancellationToken token)>;
+    /**
+     * @brief called for a request that was cancelled before it started. The client expects a reply for every
+     * request, so this should send a "RequestCancelled" error
+     */
+    using CancelledCallback = std::function<void(size_t id)>;
+
+private:
+    struct Request {
+        wxString method;
+        size_t id = 0;
+        bool has_id = false; // notifications do not have an id
+        std::unique_ptr<JSON> msg;
+        Handler handler;
+        CancellationToken token;
+        clock_t::time_point received;
+    };
+
+    struct Running {
+        wxString method;
+        size_t id = 0;
+        bool has_id = false;
+        CancellationToken token;
+    };
+
+    std::thread* m_thread = nullptr;
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+    std::list<Request> m_queue;
+    Running m_running;
+    bool m_shutdown = false;
+    CancelledCallback m_on_cancelled;
+    // number of requests cancelled before they started, per method
+    std::unordered_map<wxString, size_t> m_cancelled;
+
+    // accessed by the dispatcher thread only
+    std::unordered_map<wxString, LatencyHistogram> m_latency;
+    clock_t::time_point m_last_report;
+
+    static bool is_superseding(const wxString& method);
+    void dispatch_loop();
+    /**
+     * @brief remove the queued requests matching `pred` and return them. Must be called with the lock held
+     */
+    std::list<Request> take_pending(const std::function<bool(const Request&)>& pred);
+    void reply_cancelled(std::list<Request>& requests);
+    void log_stats(bool summary);
+
+public:
+    RequestScheduler() = default;
+    ~RequestScheduler();
+
+    void start(CancelledCallback&& on_cancelled);
+    /**
+     * @brief drop the pending requests, wait for the running one and log the latency summary
+     */
+    void stop();
+
+    /**
+     * @brief queue a message. Messages run in the order they are queued
+     */
+    void submit(const wxString& method, std::unique_ptr<JSON>&& msg, Handler&& handler);
+
+    /**
+     * @brief cancel request `id` ("$/cancelRequest"): if it is still waiting, it is removed from the queue,
+     * if it is running its token is set
+     */
+    void cancel(size_t id);
+};
+
+#endif // REQUESTSCHEDULER_HPP
@@ -6,10 +6,13 @@
 #include "clangd/CompileCommandsJSON.h"
 #include "clangd/CompileFlagsTxt.h"
 #include "ctags_manager.h"
+#include "database/tags_storage_sqlite3.h"
 #include "file_logger.h"
 #include "tags_options_data.h"
 
+#include <algorithm>
 #include <set>
+#include <thread>
 #include <wx/string.h>
 
 namespace
@@ -71,6 +74,11 @@ void CTagsdSettings::Load(const wxFileName& filepath)
         m_ignore_spec = config["ignore_spec"].toString(m_ignore_spec);
         m_codelite_indexer = config["codelite_indexer"].toString();
         m_limit_results = config["limit_results"].toSize_t(m_limit_results);
+        m_indexer_processes = config["indexer_processes"].toSize_t(m_indexer_processes);
+        m_lookup_threads = config["lookup_threads"].toSize_t(m_lookup_threads);
+        m_wal_mode = config["wal_mode"].toBool(m_wal_mode);
+        m_crash_safe = config["crash_safe"].toBool(m_crash_safe);
+        m_symbol_index = config["symbol_index"].toBool(m_symbol_index);
         CreateDefault(filepath); // generate the default tokens and types
     }
 
@@ -86,6 +94,11 @@ void CTagsdSettings::Load(const wxFileName& filepath)
     LOG_IF_TRACE { clDEBUG1() << "codelite_indexer......:" << m_codelite_indexer << endl; }
     LOG_IF_TRACE { clDEBUG1() << "ignore_spec...........:" << m_ignore_spec << endl; }
     LOG_IF_TRACE { clDEBUG1() << "limit_results.........:" << m_limit_results << endl; }
+    LOG_IF_TRACE { clDEBUG1() << "indexer_processes.....:" << m_indexer_processes << endl; }
+    LOG_IF_TRACE { clDEBUG1() << "lookup_threads........:" << m_lookup_threads << endl; }
+    LOG_IF_TRACE { clDEBUG1() << "wal_mode..............:" << m_wal_mode << endl; }
+    LOG_IF_TRACE { clDEBUG1() << "crash_safe............:" << m_crash_safe << endl; }
+    LOG_IF_TRACE { clDEBUG1() << "symbol_index..........:" << m_symbol_index << endl; }
     LOG_IF_TRACE { clDEBUG1() << "Settings dir is set to:" << m_settings_dir << endl; }
 
     // convert the tokens to wxArrayString
@@ -100,6 +113,10 @@ void CTagsdSettings::Load(const wxFileName& filepath)
     tod.SetCcNumberOfDisplayItems(m_limit_results);
     tod.SetTokens(wxJoin(wxarr, '\n'));
     TagsManagerST::Get()->SetCtagsOptions(tod);
+
+    // applies to all the databases opened from now on
+    TagsStorageSQLite::SetWALMode(m_wal_mode);
+    TagsStorageSQLite::SetCrashSafe(m_crash_safe);
 }
 
 void CTagsdSettings::Save(const wxFileName& filepath)
@@ -110,6 +127,11 @@ void CTagsdSettings::Save(const wxFileName& filepath)
     config.addProperty("ignore_spec", m_ignore_spec);
     config.addProperty("codelite_indexer", m_codelite_indexer);
     config.addProperty("limit_results", m_limit_results);
+    config.addProperty("indexer_processes", m_indexer_processes);
+    config.addProperty("lookup_threads", m_lookup_threads);
+    config.addProperty("wal_mode", m_wal_mode);
+    config.addProperty("crash_safe", m_crash_safe);
+    config.addProperty("symbol_index", m_symbol_index);
     config.addProperty("search_path", m_search_path);
 
     auto types = config.AddArray("types");
@@ -182,3 +204,22 @@ wxStringMap_t CTagsdSettings::GetMacroTable() const
     }
     return table;
 }
+
+size_t CTagsdSettings::GetIndexerProcessesCount() const
+{
+    if (m_indexer_processes > 0) {
+        return m_indexer_processes;
+    }
+    size_t cores = std::thread::hardware_concurrency();
+    return cores == 0 ? 1 : cores;
+}
+
+size_t CTagsdSettings::GetLookupThreadsCount() const
+{
+    if (m_lookup_threads > 0) {
+        return m_lookup_threads;
+    }
+    // the lookups of a single request are few and short, more threads only add contention on the database
+    size_t cores = std::thread::hardware_concurrency();
+    return std::clamp<size_t>(cores, 1, 4);
+}
@@ -16,6 +16,11 @@ class CTagsdSettings
     wxString m_codelite_indexer;
     wxString m_ignore_spec = "/.git/;/.svn/;/build/;/build-;/CPack_Packages/;/CMakeFiles/";
     size_t m_limit_results = 150;
+    size_t m_indexer_processes = 0; // 0 means: use the number of available cores
+    size_t m_lookup_threads = 0;    // 0 means: use the number of available cores, up to 4
+    bool m_wal_mode = true;
+    bool m_crash_safe = false;
+    bool m_symbol_index = true;
     wxString m_settings_dir;
 
 private:
@@ -31,6 +36,26 @@ public:
 
     void SetLimitResults(size_t limit_results) { this->m_limit_results = limit_results; }
     size_t GetLimitResults() const { return m_limit_results; }
+    void SetIndexerProcesses(size_t indexer_processes) { this->m_indexer_processes = indexer_processes; }
+    size_t GetIndexerProcesses() const { return m_indexer_processes; }
+    /**
+     * @brief return the number of `codelite_indexer` processes to run in parallel
+     * when parsing a list of files. If `indexer_processes` is not set, use the number of cores
+     */
+    size_t GetIndexerProcessesCount() const;
+    void SetLookupThreads(size_t lookup_threads) { this->m_lookup_threads = lookup_threads; }
+    size_t GetLookupThreads() const { return m_lookup_threads; }
+    /**
+     * @brief return the number of threads running the independent database lookups of a request
+     * (e.g. the members of each parent class). If `lookup_threads` is not set, use up to 4 threads
+     */
+    size_t GetLookupThreadsCount() const;
+    void SetWalMode(bool wal_mode) { this->m_wal_mode = wal_mode; }
+    bool IsWalMode() const { return m_wal_mode; }
+    void SetCrashSafe(bool crash_safe) { this->m_crash_safe = crash_safe; }
+    bool IsCrashSafe() const { return m_crash_safe; }
+    void SetSymbolIndex(bool symbol_index) { this->m_symbol_index = symbol_index; }
+    bool IsSymbolIndex() const { return m_symbol_index; }
     void SetCodeliteIndexer(const wxString& codelite_indexer) { this->m_codelite_indexer = codelite_indexer; }
     void SetFileMask(const wxString& file_mask) { this->m_file_mask = file_mask; }
     void SetIgnoreSpec(const wxString& ignore_spec) { this->m_ignore_spec = ignore_spec; }
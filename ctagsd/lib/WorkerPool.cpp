@@ -0,0 +1,119 @@
+#include "WorkerPool.hpp"
+
+#include "file_logger.h"
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <wx/thread.h>
+
+WorkerPool::~WorkerPool() { stop(); }
+
+void WorkerPool::start(size_t threads_count)
+{
+    stop();
+    m_shutdown = false;
+    for(size_t i = 0; i < threads_count; ++i) {
+        m_threads.emplace_back([this, i]() {
+            FileLogger::RegisterThread(wxThread::GetCurrentId(), wxString() << "Worker " << i);
+            while(true) {
+                std::function<void()> task;
+                {
+                    std::unique_lock<std::mutex> lk{ m_mutex };
+                    m_cv.wait(lk, [this] { return m_shutdown || !m_queue.empty(); });
+                    if(m_shutdown) {
+                        break;
+                    }
+                    task = std::move(m_queue.front());
+                    m_queue.pop_front();
+                }
+                task();
+            }
+        });
+    }
+    clDEBUG() << "Worker pool started with" << threads_count << "threads" << endl;
+}
+
+void WorkerPool::stop()
+{
+    if(m_threads.empty()) {
+        return;
+    }
+
+    {
+        std::unique_lock<std::mutex> lk{ m_mutex };
+        m_shutdown = true;
+        m_queue.clear();
+    }
+    m_cv.notify_all();
+    for(auto& thread : m_threads) {
+        thread.join();
+    }
+    m_threads.clear();
+}
+
+void WorkerPool::submit(std::function<void()>&& task)
+{
+    {
+        std::unique_lock<std::mutex> lk{ m_mutex };
+        m_queue.push_back(std::move(task));
+    }
+    m_cv.notify_one();
+}
+
+void WorkerPool::parallel_for(size_t count, const std::function<void(size_t)>& task)
+{
+    if(count == 0) {
+        return;
+    }
+
+    if(count == 1 || m_threads.empty()) {
+        for(size_t i = 0; i < count; ++i) {
+            task(i);
+        }
+        return;
+    }
+
+    // every participant (the helpers and the calling thread) claims the next index until all are taken. A helper
+    // that starts after all the indices were claimed does nothing, so the caller never waits for a task that is
+    // still in the queue - only for the calls that are already running
+    struct Batch {
+        const std::function<void(size_t)>* task = nullptr;
+        size_t count = 0;
+        std::atomic_size_t next{ 0 };
+        std::mutex mutex;
+        std::condition_variable cv;
+        size_t done = 0;
+    };
+
+    auto batch = std::make_shared<Batch>();
+    batch->task = &task;
+    batch->count = count;
+
+    auto run = [batch]() {
+        size_t completed = 0;
+        size_t index = batch->next++;
+        while(index < batch->count) {
+            (*batch->task)(index);
+            ++completed;
+            index = batch->next++;
+        }
+
+        if(completed) {
+            std::unique_lock<std::mutex> lk{ batch->mutex };
+            batch->done += completed;
+            if(batch->done == batch->count) {
+                batch->cv.notify_all();
+            }
+        }
+    };
+
+    size_t helpers = std::min(count - 1, m_threads.size());
+    for(size_t i = 0; i < helpers; ++i) {
+        submit(run);
+    }
+    run();
+
+    std::unique_lock<std::mutex> lk{ batch->mutex };
+    batch->cv.wait(lk, [&batch] { return batch->done == batch->count; });
+}
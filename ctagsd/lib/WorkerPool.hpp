@@ -0,0 +1,48 @@
+#ifndef WORKERPOOL_HPP
+#define WORKERPOOL_HPP
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @class WorkerPool
+ * @brief a fixed size pool of threads running short, independent, tasks (e.g. database lookups)
+ */
+class WorkerPool
+{
+    std::vector<std::thread> m_threads;
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+    std::deque<std::function<void()>> m_queue;
+    bool m_shutdown = false;
+
+    void submit(std::function<void()>&& task);
+
+public:
+    WorkerPool() = default;
+    ~WorkerPool();
+
+    /**
+     * @brief start `threads_count` threads
+     */
+    void start(size_t threads_count);
+    /**
+     * @brief discard the pending tasks and join the threads
+     */
+    void stop();
+
+    /**
+     * @brief call `task(i)` for every `i` in [0, count) and return once all the calls are done. The calls are
+     * spread over the pool threads and the calling thread, which also runs calls while it waits: so this is safe
+     * to call from a pool thread, and it runs the calls sequentially when the pool is not started
+     */
+    void parallel_for(size_t count, const std::function<void(size_t)>& task);
+
+    size_t size() const { return m_threads.size(); }
+};
+
+#endif // WORKERPOOL_HPP
@@ -1,5 +1,6 @@
 #include "Channel.hpp"
 #include "ProtocolHandler.hpp"
+#include "RequestScheduler.hpp"
 #include "cl_standard_paths.h"
 #include "ctags_manager.h"
 #include "file_logger.h"
@@ -72,6 +73,11 @@ int main(int argc, char** argv)
         channel->open();
 
         ProtocolHandler protocol_handler;
+
+        // the handlers run, one at a time, on the scheduler thread. This thread keeps reading the client
+        // messages, so a cancellation (or a newer completion request) reaches the running request
+        RequestScheduler scheduler;
+        scheduler.start([channel](size_t id) { ProtocolHandler::send_request_cancelled(id, channel); });
         clSYSTEM() << "Started main loop" << endl;
 
         wxString message;
@@ -82,14 +88,30 @@ int main(int argc, char** argv)
             }
             auto json = msg->toElement();
             wxString method = json["method"].toString();
+            if(method == "$/cancelRequest") {
+                scheduler.cancel(json["params"]["id"].toSize_t());
+                continue;
+            }
+
+            ProtocolHandler::CallbackFunc cb = &ProtocolHandler::on_unsupported_message;
             if(function_table.count(method) == 0) {
                 LOG_IF_TRACE { clDEBUG1() << "Received unsupported method:" << method << endl; }
-                protocol_handler.on_unsupported_message(std::move(msg), channel);
             } else {
-                auto& cb = function_table[method];
-                (protocol_handler.*cb)(std::move(msg), channel);
+                cb = function_table[method];
             }
+
+            scheduler.submit(method, std::move(msg),
+                             [&protocol_handler, cb, channel](std::unique_ptr<JSON>&& msg, CancellationToken token) {
+                                 try {
+                                     protocol_handler.set_request_token(token);
+                                     (protocol_handler.*cb)(std::move(msg), channel);
+                                 } catch (const clSocketException& e) {
+                                     clERROR() << "Uncaught exception:" << e.what() << endl;
+                                     exit(1);
+                                 }
+                             });
         }
+        scheduler.stop();
 
     } catch (const clSocketException& e) {
         clERROR() << "Uncaught exception:" << e.what() << endl;
@@ -1,26 +1,54 @@
 #include "CTags.hpp"
+#include "CTagsSession.hpp"
 #include "CompletionHelper.hpp"
+#include "Diff/clDTL.h"
+#include "Diff/clFolderCompare.h"
+#include "Diff/clLineDiff.h"
 #include "Cxx/CxxCodeCompletion.hpp"
 #include "Cxx/CxxExpression.hpp"
 #include "Cxx/CxxScannerTokens.h"
 #include "Cxx/CxxTokenizer.h"
 #include "Cxx/CxxVariableScanner.h"
+#include "LSP/MessageDecoder.hpp"
 #include "LSPUtils.hpp"
+#include "LatencyHistogram.hpp"
+#include "RequestScheduler.hpp"
 #include "Settings.hpp"
 #include "SimpleTokenizer.hpp"
+#include "WorkerPool.hpp"
+#include "clBuildOutputMatcher.hpp"
 #include "clFilesCollector.h"
+#include "clFuzzyIndex.hpp"
+#include "clMappedFile.hpp"
+#include "clRemoteFrameDecoder.hpp"
+#include "compiler.h"
 #include "ctags_manager.h"
 #include "database/tags_storage_sqlite3.h"
 #include "fileutils.h"
 #include "macros.h"
+#include "ssh/cl_sftp.h"
 #include "strings.hpp"
 #include "tester.hpp"
 
 #include <iostream>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <wx/ffile.h>
 #include <wx/init.h>
 #include <wx/log.h>
+#include <wx/regex.h>
+#include <wx/tokenzr.h>
+#include <wx/utils.h>
 #include <wx/wxcrtvararg.h>
 
+#ifndef __WXMSW__
+#include <signal.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
 using namespace std;
 namespace
 {
@@ -112,6 +140,219 @@ wxString get_sample_file(const wxString& filename)
     return test_file.GetFullPath();
 }
 
+#if USE_SFTP
+/**
+ * @brief connect to the ssh server given by CL_TEST_SSH_HOST, CL_TEST_SSH_USER and optionally CL_TEST_SSH_PORT,
+ * CL_TEST_SSH_PASSWORD and CL_TEST_SSH_KEY. The server must run on this machine: the tests check the remote files
+ * directly on the disk
+ */
+clSFTP::Ptr_t connect_test_sftp()
+{
+    wxString host;
+    wxString user;
+    if(!wxGetEnv("CL_TEST_SSH_HOST", &host) || !wxGetEnv("CL_TEST_SSH_USER", &user)) {
+        return nullptr;
+    }
+
+    wxString password;
+    wxString key;
+    wxString port_str;
+    long port = 22;
+    wxGetEnv("CL_TEST_SSH_PASSWORD", &password);
+    wxArrayString keys;
+    if(wxGetEnv("CL_TEST_SSH_KEY", &key)) {
+        keys.Add(key);
+    }
+    if(wxGetEnv("CL_TEST_SSH_PORT", &port_str)) {
+        port_str.ToCLong(&port);
+    }
+
+    clSSH::Ptr_t ssh(new clSSH(host, user, password, keys, port));
+    ssh->Open();
+    wxString message;
+    if(!ssh->AuthenticateServer(message)) {
+        ssh->AcceptServerAuthentication();
+    }
+    ssh->Login();
+    clSFTP::Ptr_t sftp(new clSFTP(ssh));
+    sftp->Initialize();
+    return sftp;
+}
+
+std::string read_test_file(const wxString& path)
+{
+    std::string content;
+    wxFFile fp(path, "rb");
+    if(fp.IsOpened()) {
+        content.resize(fp.Length());
+        content.resize(fp.Read(content.data(), content.size()));
+    }
+    return content;
+}
+
+void write_test_file(const wxString& path, const std::string& content)
+{
+    wxFFile fp(path, "wb");
+    fp.Write(content.data(), content.size());
+}
+
+std::string create_test_content(size_t size, char seed)
+{
+    std::string content(size, 0);
+    for(size_t i = 0; i < size; ++i) {
+        content[i] = (char)(seed + (i * 31) % 251);
+    }
+    return content;
+}
+#endif
+
+/// apply the steps of clDTL::CreatePatch() to `before`, one after the other
+wxString apply_patch(const wxString& before, const std::vector<PatchStep>& steps)
+{
+    wxArrayString lines = wxStringTokenize(before, "\n", wxTOKEN_RET_DELIMS);
+    for(const auto& step : steps) {
+        if(step.line_number < 0 || step.line_number > (int)lines.size()) {
+            return "<line out of range>";
+        }
+        if(step.action == PatchAction::ADD_LINE) {
+            lines.Insert(step.content, step.line_number);
+        } else if(step.action == PatchAction::DELETE_LINE && step.line_number < (int)lines.size()) {
+            lines.RemoveAt(step.line_number);
+        } else {
+            return "<invalid step>";
+        }
+    }
+
+    wxString result;
+    for(const auto& line : lines) {
+        result << line;
+    }
+    return result;
+}
+
+/// rebuild `after` from the lines of `before` that are not part of any hunk and the right side of the hunks
+wxString apply_hunks(const wxString& before, const wxString& after, clLineDiff::Algorithm algorithm)
+{
+    clLineDiff diff(algorithm);
+    diff.SetInputs(before, after);
+
+    wxString result;
+    size_t left = 0;
+    size_t right = 0;
+    bool ordered = true;
+    diff.Run([&](const clLineDiff::Hunk& hunk) {
+        // the common lines before the hunk must be at the same distance from it on both sides
+        ordered = ordered && hunk.left_start >= left && hunk.left_start - left == hunk.right_start - right;
+        for(; left < hunk.left_start; ++left) {
+            result << diff.GetLeftLine(left);
+        }
+        for(size_t i = 0; i < hunk.right_count; ++i) {
+            result << diff.GetRightLine(hunk.right_start + i);
+        }
+        left += hunk.left_count;
+        right = hunk.right_start + hunk.right_count;
+    });
+
+    for(; left < diff.GetLeftLinesCount(); ++left) {
+        result << diff.GetLeftLine(left);
+    }
+    return ordered ? result : wxString("<hunks out of order>");
+}
+
+#ifndef __WXMSW__
+/**
+ * @brief codelite-remote running locally in framed mode, connected with pipes instead of ssh
+ */
+struct RemoteHelperProcess {
+    pid_t pid = -1;
+    int to_helper = -1;
+    int from_helper = -1;
+
+    ~RemoteHelperProcess()
+    {
+        if(to_helper != -1) {
+            Send("exit");
+            ::close(to_helper);
+        }
+        if(from_helper != -1) {
+            ::close(from_helper);
+        }
+        if(pid != -1) {
+            ::kill(pid, SIGTERM);
+            ::waitpid(pid, nullptr, 0);
+        }
+    }
+
+    bool Start(const wxString& python, const wxString& script)
+    {
+        int in[2];
+        int out[2];
+        if(::pipe(in) != 0) {
+            return false;
+        }
+        if(::pipe(out) != 0) {
+            ::close(in[0]);
+            ::close(in[1]);
+            return false;
+        }
+        ::signal(SIGPIPE, SIG_IGN);
+
+        std::string python_path = python.ToStdString(wxConvUTF8);
+        std::string script_path = script.ToStdString(wxConvUTF8);
+        pid = ::fork();
+        if(pid == 0) {
+            ::dup2(in[0], STDIN_FILENO);
+            ::dup2(out[1], STDOUT_FILENO);
+            ::close(in[0]);
+            ::close(in[1]);
+            ::close(out[0]);
+            ::close(out[1]);
+            ::execl(python_path.c_str(), python_path.c_str(), script_path.c_str(), "--context", "tests", "--framed",
+                    nullptr);
+            ::_exit(127);
+        }
+        ::close(in[0]);
+        ::close(out[1]);
+        to_helper = in[1];
+        from_helper = out[0];
+        return pid != -1;
+    }
+
+    bool Send(const std::string& command)
+    {
+        std::string line = command + "\n";
+        return ::write(to_helper, line.data(), line.size()) == (ssize_t)line.size();
+    }
+};
+#endif
+
+/// gives the tests access to both ways of parsing a file: the persistent indexer (JSON) and the one-shot indexer (text)
+class CTagsTester : public CTags
+{
+public:
+    using CTags::DoGenerate;
+    using CTags::GetSession;
+};
+
+/// the literals of a pattern as a single string, e.g. "note|warning"
+wxString join_literals(const clBuildOutputMatcher::Literals_t& literals)
+{
+    wxString joined;
+    for(const auto& literal : literals) {
+        joined << (joined.empty() ? "" : "|") << literal;
+    }
+    return joined;
+}
+
+/// true if the prefilter of `pattern` accepts `line`: the line contains one of the literals, or there are none
+bool prefilter_accepts(const wxString& pattern, const wxString& line)
+{
+    auto literals = clBuildOutputMatcher::GetRequiredLiterals(pattern);
+    std::string lower_line = line.Lower().ToStdString(wxConvUTF8);
+    return literals.empty() || std::any_of(literals.begin(), literals.end(), [&](const std::string& literal) {
+               return lower_line.find(literal) != std::string::npos;
+           });
+}
 } // namespace
 
 TEST_FUNC(test_lexing_raw_strings)
@@ -230,6 +471,639 @@ TEST_FUNC(TestLSPLocation)
     return true;
 }
 
+TEST_FUNC(TestLSPUtils_apply_content_change)
+{
+    auto make_change = [](int start_line, int start_char, int end_line, int end_char, const wxString& text) {
+        LSP::TextDocumentContentChangeEvent change;
+        change.SetRange(LSP::Range{ LSP::Position{ start_line, start_char }, LSP::Position{ end_line, end_char } });
+        change.SetText(text);
+        return change;
+    };
+
+    wxString buffer = "int main() {\r\n    return 0;\r\n}\r\n";
+
+    // insert
+    LSPUtils::apply_content_change(buffer, make_change(1, 13, 1, 13, " // done"));
+    CHECK_WXSTRING(buffer, "int main() {\r\n    return 0; // done\r\n}\r\n");
+
+    // delete across lines
+    LSPUtils::apply_content_change(buffer, make_change(0, 12, 1, 4, wxEmptyString));
+    CHECK_WXSTRING(buffer, "int main() {return 0; // done\r\n}\r\n");
+
+    // replace, the end character is beyond the end of the line and is clamped
+    LSPUtils::apply_content_change(buffer, make_change(0, 21, 0, 100, wxEmptyString));
+    CHECK_WXSTRING(buffer, "int main() {return 0;\r\n}\r\n");
+
+    // changes are applied in order, each one against the result of the previous one
+    LSPUtils::apply_content_change(buffer, make_change(2, 0, 2, 0, "a"));
+    LSPUtils::apply_content_change(buffer, make_change(2, 1, 2, 1, "b"));
+    LSPUtils::apply_content_change(buffer, make_change(2, 0, 2, 1, wxEmptyString));
+    CHECK_WXSTRING(buffer, "int main() {return 0;\r\n}\r\nb");
+
+    // no range: replace the entire buffer
+    LSP::TextDocumentContentChangeEvent full_change;
+    full_change.SetText("void foo();");
+    LSPUtils::apply_content_change(buffer, full_change);
+    CHECK_WXSTRING(buffer, "void foo();");
+    return true;
+}
+
+TEST_FUNC(TestLSPMessageDecoder)
+{
+    auto make_frame = [](const std::string& payload) {
+        return "Content-Length: " + std::to_string(payload.length()) + "\r\n\r\n" + payload;
+    };
+
+    std::string stream;
+    stream += make_frame(R"({"jsonrpc":"2.0","id":1,"result":null})");
+    stream += "content-length:" + std::to_string(strlen(R"({"id":2,"name":"\u00e9t\u00e9"})")) +
+              "\r\nContent-Type: application/vscode-jsonrpc; charset=utf-8\r\n\r\n" +
+              R"({"id":2,"name":"\u00e9t\u00e9"})";
+    stream += make_frame("{\"id\":3,\"name\":\"\xC3\xA9t\xC3\xA9\"}");
+    stream += make_frame("not a json");
+    stream += make_frame(R"({"id":5})");
+
+    // feed the stream a few bytes at a time, like the network does
+    LSP::MessageDecoder decoder;
+    std::vector<std::unique_ptr<JSON>> messages;
+    for (size_t i = 0; i < stream.length(); i += 7) {
+        decoder.Append(stream.data() + i, std::min<size_t>(7, stream.length() - i));
+        while (auto json = decoder.Next()) {
+            messages.push_back(std::move(json));
+        }
+    }
+
+    CHECK_SIZE(messages.size(), 5);
+    CHECK_BOOL(decoder.IsEmpty());
+    CHECK_EXPECTED(messages[0]->toElement()["id"].toInt(), 1);
+    CHECK_EXPECTED(messages[1]->toElement()["id"].toInt(), 2);
+    CHECK_EXPECTED(messages[2]->toElement()["id"].toInt(), 3);
+    CHECK_WXSTRING(messages[2]->toElement()["name"].toString(), wxString::FromUTF8("\xC3\xA9t\xC3\xA9"));
+    CHECK_BOOL(!messages[3]->isOk());
+    CHECK_EXPECTED(messages[4]->toElement()["id"].toInt(), 5);
+
+    // absurd lengths are malformed headers: they are skipped instead of waiting for the payload forever
+    for (const std::string& length : { "18446744073709551615", "18446744073709551600", "4294967296000" }) {
+        LSP::MessageDecoder bad_decoder;
+        std::string bad_stream = "Content-Length: " + length + "\r\n\r\n" + make_frame(R"({"id":6})");
+        bad_decoder.Append(bad_stream.data(), bad_stream.length());
+        auto json = bad_decoder.Next();
+        CHECK_BOOL(json && json->isOk());
+        CHECK_EXPECTED(json->toElement()["id"].toInt(), 6);
+        CHECK_BOOL(bad_decoder.IsEmpty());
+    }
+    return true;
+}
+
+TEST_FUNC(TestRemoteFrameDecoder)
+{
+    using eFrameType = clRemoteFrameDecoder::eFrameType;
+
+    // a line that looks like a header with a huge length is text, it must not swallow the frames that follow it
+    std::string stream = "@@cl 1 D 99999999999\n";
+    stream += clRemoteFrameDecoder::Encode(2, eFrameType::kData, "hello\n");
+    stream += clRemoteFrameDecoder::Encode(2, eFrameType::kEnd, {});
+
+    clRemoteFrameDecoder decoder;
+    std::string text;
+    std::string data;
+    size_t ends = 0;
+    decoder.Feed(stream.data(), stream.length(), [&](size_t id, eFrameType type, std::string_view payload) {
+        if(type == eFrameType::kText) {
+            text += payload;
+        } else if(type == eFrameType::kData && id == 2) {
+            data += payload;
+        } else if(type == eFrameType::kEnd && id == 2) {
+            ++ends;
+        }
+    });
+    CHECK_STRING(text.c_str(), "@@cl 1 D 99999999999\n");
+    CHECK_STRING(data.c_str(), "hello\n");
+    CHECK_SIZE(ends, 1);
+    CHECK_SIZE(decoder.GetPendingBytes(), 0);
+    return true;
+}
+
+TEST_FUNC(TestRemoteFrameDecoderWithHelper)
+{
+#ifndef __WXMSW__
+    wxString script;
+    wxFileName python;
+    if(!is_file_exists("Runtime/codelite-remote", &script) || !FileUtils::FindExe("python3", python)) {
+        cout << "codelite-remote or python3 not found. Please set environment variable CODELITE_SRC_DIR" << endl;
+        return true;
+    }
+
+    RemoteHelperProcess helper;
+    CHECK_BOOL(helper.Start(python.GetFullPath(), script));
+
+    // the output of the command on stderr is part of its reply
+    CHECK_BOOL(helper.Send(R"({"command":"exec","id":1,"wd":"","env":[],"cmd":"echo out; echo err 1>&2; echo out2"})"));
+    CHECK_BOOL(helper.Send(R"({"command":"exec","id":2,"wd":"","env":[],"cmd":"seq 1 100000","compress":true})"));
+
+    std::string expected_seq;
+    for(size_t i = 1; i <= 100000; ++i) {
+        expected_seq += std::to_string(i) + "\n";
+    }
+
+    using eFrameType = clRemoteFrameDecoder::eFrameType;
+    clRemoteFrameDecoder decoder;
+    std::unordered_map<size_t, std::string> replies;
+    std::unordered_map<size_t, std::string> errors;
+    size_t compressed_frames = 0;
+    bool decompress_ok = true;
+    auto on_frame = [&](size_t id, eFrameType type, std::string_view payload) {
+        switch(type) {
+        case eFrameType::kData:
+            replies[id] += payload;
+            break;
+        case eFrameType::kCompressedData:
+            ++compressed_frames;
+            decompress_ok = clRemoteFrameDecoder::Decompress(payload, replies[id]) && decompress_ok;
+            break;
+        case eFrameType::kEnd:
+            errors[id] = payload;
+            break;
+        case eFrameType::kText:
+            break;
+        }
+    };
+
+    char buffer[64 * 1024];
+    while(errors.size() < 2) {
+        ssize_t count = ::read(helper.from_helper, buffer, sizeof(buffer));
+        if(count <= 0) {
+            break;
+        }
+        decoder.Feed(buffer, count, on_frame);
+    }
+
+    CHECK_SIZE(errors.size(), 2);
+    CHECK_STRING(errors[1].c_str(), "");
+    CHECK_STRING(errors[2].c_str(), "");
+    CHECK_STRING(replies[1].c_str(), "out\nerr\nout2\n");
+    CHECK_BOOL(decompress_ok);
+    CHECK_BOOL(compressed_frames > 0);
+    CHECK_BOOL(replies[2] == expected_seq);
+    CHECK_SIZE(decoder.GetPendingBytes(), 0);
+#endif
+    return true;
+}
+
+TEST_FUNC(TestSFTPUploadDownload)
+{
+#if USE_SFTP
+    clSFTP::Ptr_t sftp;
+    try {
+        sftp = connect_test_sftp();
+    } catch(const clException& e) {
+        cout << "Failed to connect to the test ssh server. " << e.What() << endl;
+    }
+    if(!sftp) {
+        cout << "SFTP tests skipped. Please set environment variables CL_TEST_SSH_HOST and CL_TEST_SSH_USER" << endl;
+        return true;
+    }
+
+    wxFileName folder(wxFileName::GetTempDir(), wxEmptyString);
+    folder.AppendDir(wxString() << "ctagsd-tests-sftp-" << ::wxGetProcessId());
+    folder.Mkdir(wxS_DIR_DEFAULT, wxPATH_MKDIR_FULL);
+    wxString source = wxFileName(folder.GetPath(), "source.bin").GetFullPath();
+    wxString remote = wxFileName(folder.GetPath(), "remote.bin").GetFullPath();
+    wxString local = wxFileName(folder.GetPath(), "local.bin").GetFullPath();
+    wxString partial_suffix = ".codelitesftp-part";
+    wxString info_suffix = ".codelitesftp-part-info";
+
+    // cancel a transfer once a quarter of the file was sent
+    auto cancel_early = [](size_t done, size_t total) { return done < total / 4; };
+    const size_t file_size = 8 * 1024 * 1024;
+    std::string content = create_test_content(file_size, 'a');
+    write_test_file(source, content);
+
+    // replacing an existing file keeps its permissions
+    write_test_file(remote, "old content");
+    sftp->Chmod(remote, 0600);
+    clSFTP::TransferStats stats = sftp->Upload(source, remote);
+    CHECK_BOOL(read_test_file(remote) == content);
+    CHECK_SIZE(stats.resumedAt, 0);
+    wxStructStat st;
+    CHECK_BOOL(wxStat(remote, &st) == 0 && (st.st_mode & 0777) == 0600);
+    CHECK_BOOL(!wxFileName::FileExists(remote + partial_suffix));
+
+    // a failed upload that can't be resumed leaves nothing behind
+    bool failed = false;
+    try {
+        sftp->Upload(source, remote, false, cancel_early);
+    } catch(const clException&) {
+        failed = true;
+    }
+    CHECK_BOOL(failed);
+    CHECK_BOOL(!wxFileName::FileExists(remote + partial_suffix));
+    CHECK_BOOL(read_test_file(remote) == content);
+
+    // a resumable upload continues from where it stopped
+    failed = false;
+    try {
+        sftp->Upload(source, remote, true, cancel_early);
+    } catch(const clException&) {
+        failed = true;
+    }
+    CHECK_BOOL(failed);
+    CHECK_BOOL(wxFileName::FileExists(remote + partial_suffix));
+    CHECK_BOOL(wxFileName::FileExists(remote + info_suffix));
+    stats = sftp->Upload(source, remote, true);
+    CHECK_BOOL(stats.resumedAt > 0);
+    CHECK_BOOL(read_test_file(remote) == content);
+    CHECK_BOOL(!wxFileName::FileExists(remote + partial_suffix));
+    CHECK_BOOL(!wxFileName::FileExists(remote + info_suffix));
+
+    // the partial upload of an older version of the file is not resumed, even when its tail matches
+    failed = false;
+    try {
+        sftp->Upload(source, remote, true, cancel_early);
+    } catch(const clException&) {
+        failed = true;
+    }
+    CHECK_BOOL(failed);
+    std::string new_content = content;
+    new_content.replace(0, 1024, 1024, 'x');
+    write_test_file(source, new_content);
+    wxDateTime mtime = wxDateTime::Now() + wxTimeSpan::Minutes(5);
+    CHECK_BOOL(wxFileName(source).SetTimes(nullptr, &mtime, nullptr));
+    stats = sftp->Upload(source, remote, true);
+    CHECK_SIZE(stats.resumedAt, 0);
+    CHECK_BOOL(read_test_file(remote) == new_content);
+
+    // the same for downloads
+    failed = false;
+    try {
+        sftp->Download(remote, local, false, cancel_early);
+    } catch(const clException&) {
+        failed = true;
+    }
+    CHECK_BOOL(failed);
+    CHECK_BOOL(!wxFileName::FileExists(local + partial_suffix));
+
+    failed = false;
+    try {
+        sftp->Download(remote, local, true, cancel_early);
+    } catch(const clException&) {
+        failed = true;
+    }
+    CHECK_BOOL(failed);
+    CHECK_BOOL(wxFileName::FileExists(local + partial_suffix));
+    stats = sftp->Download(remote, local, true);
+    CHECK_BOOL(stats.resumedAt > 0);
+    CHECK_BOOL(read_test_file(local) == new_content);
+    CHECK_BOOL(!wxFileName::FileExists(local + partial_suffix));
+    CHECK_BOOL(!wxFileName::FileExists(local + info_suffix));
+
+#ifndef __WXMSW__
+    // replacing a local file keeps its permissions, and a symlink is written through
+    CHECK_BOOL(::chmod(local.mb_str(wxConvUTF8).data(), 0600) == 0);
+    wxString link = wxFileName(folder.GetPath(), "link.bin").GetFullPath();
+    CHECK_BOOL(::symlink(local.mb_str(wxConvUTF8).data(), link.mb_str(wxConvUTF8).data()) == 0);
+    write_test_file(remote, "new remote content");
+    sftp->Download(remote, link);
+    CHECK_BOOL(FileUtils::IsSymlink(link));
+    CHECK_BOOL(read_test_file(local) == "new remote content");
+    CHECK_BOOL(wxStat(local, &st) == 0 && (st.st_mode & 0777) == 0600);
+    CHECK_BOOL(!wxFileName::FileExists(link + partial_suffix));
+#endif
+
+    folder.Rmdir(wxPATH_RMDIR_RECURSIVE);
+#endif
+    return true;
+}
+
+TEST_FUNC(TestBuildOutputMatcher_literals)
+{
+    struct Case {
+        wxString pattern;
+        wxString literals;
+    };
+
+    // clang-format off
+    const std::vector<Case> cases = {
+        // the default patterns of Compiler, GNU
+        { "undefined reference to", "undefined reference to" },
+        { R"#(^(.+?):(\d+):(\d+)?(?:\{\d:-\}+)?(?:.*) (error): (.*)$)#", " error: " },
+        { R"#(^(?:.*referenced by .+?:\d+ )\((.+?):(\d+)\).*$)#", "referenced by " },
+        { R"#(make(.*?)(\*\*\*))#", "make" },
+        { R"#(^(.+?):(\d+):(\d+)?(?:\{\d:-\}+)?(?:.*) (note|warning): (.*)$)#", "note|warning" },
+        { R"#(^(?:In file included from *)(.+?):(\d+):.*$)#", "in file included from" },
+        // the default patterns of Compiler, VC
+        { "^windres: ([a-zA-Z:]{0,2}[ a-zA-Z\\\\.0-9_/\\+\\-]+) *:([0-9]+): syntax error", ": syntax error" },
+        { R"#(([>\d]*)(.*?)\(([\d]+)(.*?)error)#", "error" },
+        { "(^[a-zA-Z\\\\.0-9 _/\\:\\+\\-]+ *)(\\()([0-9]+)(\\))( \\: )(error)", ") : error" },
+        { "(LINK : fatal error)", "link : fatal error" },
+        { "(NMAKE : fatal error)", "nmake : fatal error" },
+        { "([a-z_A-Z]*\\.obj)( : warning)", " : warning" },
+        { "(cl : Command line warning)", "cl : command line warning" },
+        // the patterns of build_settings.xml
+        { R"#(^([^ ][a-zA-Z:]{0,2}[ a-zA-Z\\.0-9_/\\+\\-]+ *)(:)([0-9]*)([:0-9]*)(: )((fatal error)|(error)|(undefined reference)))#",
+          "fatal error|error|undefined reference" },
+        { R"#(^([^ ][a-zA-Z:]{0,2}[ a-zA-Z\\.0-9_/\\+\\-]+ *)(:)([^ ][a-zA-Z:]{0,2}[ a-zA-Z\\.0-9_/\\+\\-]+ *)(:)(\(\.text\+[0-9a-fx]*\)))#",
+          "(.text+" },
+        { R"#(([a-zA-Z:]{0,2}[ a-zA-Z\\.0-9_/\\+\\-]+ *)(:)([0-9]+ *)(:)([0-9:]*)?[ \t]*(warning|required))#", "warning|required" },
+        { R"#(([a-zA-Z:]{0,2}[ a-zA-Z\\.0-9_/\\+\\-]+ *)(:)([0-9]+ *)(:)([0-9:]*)?( note))#", " note" },
+        { R"#(^([a-zA-Z\.0-9_/\+\-]+)\(([0-9]+)\): error:)#", "): error:" },
+        // alternation: every alternative must provide a literal
+        { "foo|bar", "foo|bar" },
+        { "(foo|bar)baz", "baz" },
+        { "(warning|)x", "x" },
+        { R"#(\d+ (warning|error):)#", "warning|error" },
+        { "(?:Fatal) (error)", "fatal error" },
+        // optional and repeated atoms and groups
+        { "a(bc)?d", "a" },
+        { "colou?r", "colo" },
+        { "ab{2}c", "ab" },
+        { "x{0,3}yz", "yz" },
+        { "(ab)+c", "ab" },
+        { "a.*b", "a" },
+        // escapes and character classes
+        { R"#(\(\.text\+0x[0-9a-f]+\))#", "(.text+0x" },
+        { "[[:alpha:]]+error", "error" },
+        { R"#([^]x]+error\y)#", "error" },
+        // lookaheads are not part of the match
+        { "(?=abc)def", "def" },
+        // directors
+        { "***=a.b", "a.b" },
+        { "***:ERROR", "error" },
+        // we can't tell: the pattern is always tried
+        { "(?i)foo", "" },
+        { R"#(\x41)#", "" },
+        { ".*", "" },
+    };
+    // clang-format on
+
+    for(const auto& c : cases) {
+        CHECK_WXSTRING(join_literals(clBuildOutputMatcher::GetRequiredLiterals(c.pattern)), c.literals);
+    }
+
+    // build output lines, and lines that the patterns above are about
+    const std::vector<wxString> lines = {
+        "main.cpp:(.text+0x1f): undefined reference to `foo()'",
+        "main.o:main.cpp:(.text+0x1f): undefined reference to `foo()'",
+        "/usr/bin/ld: main.o: in function `main':",
+        "src/file.cpp:12:5: error: use of undeclared identifier 'foo'",
+        "src/file.cpp:12: error: expected ';'",
+        "src/file.cpp:12:5: fatal error: foo.h: No such file or directory",
+        "src/file.cpp:12:5: warning: unused variable 'count' [-Wunused-variable]",
+        "src/file.cpp:12:5: note: in instantiation of function template specialization",
+        "src/file.cpp:12:5:   required from here",
+        "In file included from src/file.cpp:12:",
+        "In file included from src/file.cpp:12,",
+        ">>> referenced by main.cpp:12 (src/main.cpp:12)",
+        "make[2]: *** [CMakeFiles/app.dir/build.make:76: app] Error 1",
+        "make: *** No rule to make target 'all'.  Stop.",
+        "windres: resource.rc:12: syntax error",
+        "1>C:\\work\\src\\file.cpp(12): error C2065: 'foo': undeclared identifier",
+        "1>C:\\work\\src\\file.cpp(12): warning C4101: 'count': unreferenced local variable",
+        "C:\\work\\src\\file.cpp(12) : error C2065: 'foo': undeclared identifier",
+        "C:\\work\\src\\file.cpp(12) : warning C4101: 'count'",
+        "LINK : fatal error LNK1104: cannot open file 'module.lib'",
+        "NMAKE : fatal error U1077: 'cl.exe' : return code '0x2'",
+        "main.obj : warning LNK4075: ignoring '/EDITANDCONTINUE'",
+        "cl : Command line warning D9025 : overriding '/O2' with '/Od'",
+        "file.cu(12): error: identifier \"foo\" is undefined",
+        "[12/100] /usr/bin/g++ -O2 -c src/file.cpp",
+        "-- Configuring done",
+        "FOO",
+        "xbar",
+        "BARBAZ",
+        "abcd",
+        "ad",
+        "COLOR",
+        "colour",
+        "abbc",
+        "xxyz",
+        "yz",
+        "12 warning:",
+        "12 ERROR:",
+        "warningx",
+        "abcerror",
+        "a-b",
+        "ababc",
+        "(.text+0x1f)",
+        "abcdef",
+        "A",
+        "a.b",
+    };
+
+    // the prefilter must accept every line that the regex matches
+    for(const auto& c : cases) {
+        wxLogNull no_log;
+        wxRegEx re(c.pattern, wxRE_ADVANCED | wxRE_ICASE);
+        if(!re.IsValid()) {
+            // the matcher drops the patterns the regex engine does not support
+            continue;
+        }
+        for(const auto& line : lines) {
+            if(re.Matches(line) && !prefilter_accepts(c.pattern, line)) {
+                CHECK_WXSTRING(line, wxString("a line accepted by: ") + c.pattern);
+            }
+        }
+    }
+
+    // the matcher returns what trying every pattern in order (warnings first) returns
+    for(auto regex_type : { Compiler::kRegexGNU, Compiler::kRegexVC }) {
+        Compiler compiler(nullptr, regex_type);
+        auto matcher = compiler.CreateOutputMatcher();
+        std::vector<std::pair<wxString, Compiler::eSeverity>> patterns;
+        for(const auto& info : compiler.GetWarnPatterns()) {
+            patterns.push_back({ info.pattern, Compiler::kSevWarning });
+        }
+        for(const auto& info : compiler.GetErrPatterns()) {
+            patterns.push_back({ info.pattern, Compiler::kSevError });
+        }
+
+        std::vector<size_t> matches(patterns.size(), 0);
+        for(const auto& line : lines) {
+            bool expected = false;
+            Compiler::eSeverity expected_sev = Compiler::kSevError;
+            for(size_t i = 0; i < patterns.size(); ++i) {
+                wxRegEx re(patterns[i].first, wxRE_ADVANCED | wxRE_ICASE);
+                if(re.Matches(line)) {
+                    CHECK_BOOL(prefilter_accepts(patterns[i].first, line));
+                    matches[i]++;
+                    if(!expected) {
+                        expected = true;
+                        expected_sev = patterns[i].second;
+                    }
+                }
+            }
+
+            Compiler::PatternMatch match;
+            CHECK_BOOL(matcher->Matches(line, &match) == expected);
+            if(expected) {
+                CHECK_BOOL(match.sev == expected_sev);
+            }
+        }
+
+        // every default pattern was exercised
+        for(size_t count : matches) {
+            CHECK_BOOL(count > 0);
+        }
+    }
+    return true;
+}
+
+TEST_FUNC(TestFuzzyIndex)
+{
+    clFuzzyIndex index;
+    index.Add("/src/CodeLite/fileutils.cpp");
+    index.Add("/src/Plugin/open_resource_dialog.cpp");
+    index.Add("/src/Plugin/open_resource_dialog.h");
+    index.Add("/src/docs/readme_open.md");
+    index.Add("/src/Plugin/GotoAnythingDlg.cpp");
+
+    // subsequence match, the shorter entry wins a tie
+    auto matches = index.Search("ORD");
+    CHECK_SIZE(matches.size(), 3);
+    CHECK_EXPECTED(matches[0].index, 2);
+    CHECK_EXPECTED(matches[1].index, 1);
+
+    // refine the previous result
+    matches = index.Search("ord.c");
+    CHECK_SIZE(matches.size(), 1);
+    CHECK_EXPECTED(matches[0].index, 1);
+
+    // every word must match, consecutive characters score higher
+    matches = index.Search("plugin dlg");
+    CHECK_SIZE(matches.size(), 3);
+    CHECK_EXPECTED(matches[0].index, 4);
+
+    // word boundaries score higher
+    matches = index.Search("gad", 1);
+    CHECK_SIZE(matches.size(), 1);
+    CHECK_EXPECTED(matches[0].index, 4);
+
+    CHECK_SIZE(index.Search("xyz").size(), 0);
+    CHECK_SIZE(index.Search("  ").size(), 0);
+    CHECK_SIZE(index.Search("o", 2).size(), 2);
+
+    int score1 = 0, score2 = 0;
+    CHECK_BOOL(clFuzzyIndex::Score("fu", "FileUtils", &score1));
+    CHECK_BOOL(clFuzzyIndex::Score("fu", "refund", &score2));
+    CHECK_BOOL(score1 > score2);
+    CHECK_BOOL(!clFuzzyIndex::Score("uf", "fun"));
+    return true;
+}
+
+TEST_FUNC(TestLatencyHistogram)
+{
+    LatencyHistogram histogram;
+    CHECK_EXPECTED(histogram.percentile(50), 0.0);
+
+    // 1ms..100ms
+    for (uint64_t ms = 1; ms <= 100; ++ms) {
+        histogram.add(ms * 1000);
+    }
+    CHECK_SIZE(histogram.count(), 100);
+    CHECK_EXPECTED(histogram.max_ms(), 100.0);
+    CHECK_EXPECTED(histogram.percentile(100), 100.0);
+
+    // the percentiles are accurate within 25%
+    double p50 = histogram.percentile(50);
+    double p99 = histogram.percentile(99);
+    CHECK_BOOL(p50 >= 50.0 && p50 <= 62.5);
+    CHECK_BOOL(p99 >= 99.0 && p99 <= 100.0);
+
+    histogram.clear();
+    histogram.add(3);
+    CHECK_EXPECTED(histogram.percentile(50), 0.003);
+    return true;
+}
+
+TEST_FUNC(TestWorkerPool_parallel_for)
+{
+    WorkerPool pool;
+    std::vector<size_t> results(100, 0);
+    auto square = [&results](size_t i) { results[i] = i * i; };
+
+    // not started: runs on the calling thread
+    pool.parallel_for(results.size(), square);
+    CHECK_SIZE(results[99], 99 * 99);
+
+    pool.start(3);
+    results.assign(results.size(), 0);
+    pool.parallel_for(results.size(), square);
+    for (size_t i = 0; i < results.size(); ++i) {
+        CHECK_SIZE(results[i], i * i);
+    }
+
+    // nested calls can not dead lock, the caller runs the tasks no one else picked
+    std::atomic_size_t count{ 0 };
+    pool.parallel_for(8, [&](size_t) { pool.parallel_for(8, [&](size_t) { ++count; }); });
+    CHECK_SIZE(count.load(), 64);
+    pool.stop();
+    return true;
+}
+
+TEST_FUNC(TestRequestScheduler_supersede_and_cancel)
+{
+    auto make_request = [](size_t id) {
+        auto msg = std::make_unique<JSON>(cJSON_Object);
+        msg->toElement().addProperty("id", id);
+        return msg;
+    };
+
+    std::mutex cancelled_mutex;
+    std::vector<size_t> cancelled;
+    RequestScheduler scheduler;
+    scheduler.start([&](size_t id) {
+        std::lock_guard<std::mutex> lk{ cancelled_mutex };
+        cancelled.push_back(id);
+    });
+
+    std::atomic_bool started{ false };
+    std::atomic_bool release{ false };
+    std::atomic_size_t handled_count{ 0 };
+    std::vector<size_t> handled;
+    CancellationToken first_token;
+
+    // request 1 is running until released
+    scheduler.submit("textDocument/completion", make_request(1),
+                     [&](std::unique_ptr<JSON>&& msg, CancellationToken token) {
+                         first_token = token;
+                         started = true;
+                         while (!release) {
+                             std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                         }
+                         handled.push_back(msg->toElement()["id"].toSize_t());
+                         ++handled_count;
+                     });
+    while (!started) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    auto handler = [&](std::unique_ptr<JSON>&& msg, CancellationToken token) {
+        handled.push_back(msg->toElement()["id"].toSize_t());
+        ++handled_count;
+    };
+
+    // 2 asks 1 to stop, 3 replaces 2 (still in the queue), 4 is cancelled by the client
+    scheduler.submit("textDocument/completion", make_request(2), handler);
+    scheduler.submit("textDocument/completion", make_request(3), handler);
+    scheduler.submit("textDocument/hover", make_request(4), handler);
+    scheduler.cancel(4);
+    CHECK_BOOL(first_token->load());
+
+    release = true;
+    while (handled_count < 2) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    scheduler.stop();
+
+    CHECK_SIZE(handled.size(), 2);
+    CHECK_SIZE(handled[0], 1);
+    CHECK_SIZE(handled[1], 3);
+    CHECK_SIZE(cancelled.size(), 2);
+    CHECK_SIZE(cancelled[0], 2);
+    CHECK_SIZE(cancelled[1], 4);
+    return true;
+}
+
 TEST_FUNC(TestCompletionHelper_get_expression)
 {
     wxStringMap_t M = {
@@ -493,6 +1367,204 @@ TEST_FUNC(TestSplitArgs)
     return true;
 }
 
+TEST_FUNC(TestLineDiff_patch_round_trip)
+{
+    auto repeat = [](const wxString& line, size_t count) {
+        wxString text;
+        for(size_t i = 0; i < count; ++i) {
+            text << line;
+        }
+        return text;
+    };
+
+    wxString unique_before;
+    wxString unique_after;
+    wxString unique_reversed;
+    for(int i = 0; i < 500; ++i) {
+        unique_before << "line " << i << "\n";
+        unique_after << "other line " << i << "\n";
+        unique_reversed << "line " << (499 - i) << "\n";
+    }
+
+    std::vector<std::pair<wxString, wxString>> cases = {
+        // empty and one-sided inputs
+        { "", "" },
+        { "", "a\nb\n" },
+        { "a\nb\n", "" },
+        { "a\nb\nc\n", "a\nb\nc\n" },
+        { "a\nb\nc\n", "a\nB\nc\n" },
+        // no trailing new line
+        { "a\nb", "a\nc" },
+        { "a\nb\n", "a\nb" },
+        { "a\nb", "a\nb\nc\n" },
+        { "a", "b" },
+        // all the lines are unique: nothing in common, or everything in common but in another order
+        { unique_before, unique_after },
+        { unique_before, unique_reversed },
+        // all the lines are the same: no line can be used as an anchor and the Myers fallback is used
+        { repeat("x\n", 300), repeat("x\n", 150) + "y\n" + repeat("x\n", 149) },
+        { repeat("x\n", 200), repeat("x\n", 300) },
+        { repeat("x\n", 300), repeat("x\n", 100) },
+        { repeat("{\n}\n", 200), repeat("}\n{\n", 200) },
+    };
+
+    // random edits of a text with many repeated lines
+    wxString base;
+    for(int i = 0; i < 400; ++i) {
+        base << (i % 7 == 0 ? wxString("}\n") : i % 5 == 0 ? wxString("\n") : wxString() << "statement " << i << ";\n");
+    }
+    unsigned int seed = 1;
+    auto next_random = [&seed](unsigned int max) {
+        seed = seed * 1103515245 + 12345;
+        return (seed >> 16) % max;
+    };
+    for(int round = 0; round < 20; ++round) {
+        wxArrayString lines = wxStringTokenize(base, "\n", wxTOKEN_RET_DELIMS);
+        for(int edit = 0; edit < 30; ++edit) {
+            size_t line = next_random(lines.size());
+            switch(next_random(3)) {
+            case 0:
+                lines.RemoveAt(line);
+                break;
+            case 1:
+                lines.Insert(wxString() << "new " << edit << "\n", line);
+                break;
+            default:
+                lines.Insert("}\n", line);
+                break;
+            }
+        }
+        wxString after;
+        for(const auto& line : lines) {
+            after << line;
+        }
+        cases.push_back({ base, after });
+    }
+
+    clDTL dtl;
+    for(const auto& [before, after] : cases) {
+        CHECK_BOOL(apply_patch(before, dtl.CreatePatch(before, after)) == after);
+        CHECK_BOOL(apply_hunks(before, after, clLineDiff::Algorithm::kHistogram) == after);
+        CHECK_BOOL(apply_hunks(before, after, clLineDiff::Algorithm::kPatience) == after);
+    }
+
+    // identical inputs have no steps, a changed line is a single deletion and a single addition
+    CHECK_SIZE(dtl.CreatePatch(unique_before, unique_before).size(), 0);
+    auto steps = dtl.CreatePatch("a\nb\nc\n", "a\nB\nc\n");
+    CHECK_SIZE(steps.size(), 2);
+    CHECK_BOOL(steps[0].action == PatchAction::DELETE_LINE);
+    CHECK_SIZE(steps[0].line_number, 1);
+    CHECK_BOOL(steps[1].action == PatchAction::ADD_LINE);
+    CHECK_SIZE(steps[1].line_number, 1);
+    CHECK_STRING(steps[1].content, "B\n");
+
+    // a single inserted line in a run of identical lines
+    steps = dtl.CreatePatch(repeat("x\n", 300), repeat("x\n", 150) + "y\n" + repeat("x\n", 150));
+    CHECK_SIZE(steps.size(), 1);
+    CHECK_BOOL(steps[0].action == PatchAction::ADD_LINE);
+    return true;
+}
+
+TEST_FUNC(TestMappedFile_reuse)
+{
+    wxString path = wxFileName::CreateTempFileName("cl-mapped-file");
+    std::string large(100 * 1024, 'x');
+    large.back() = 'y';
+    FileUtils::WriteFileContentRaw(path, large);
+
+    clMappedFile file;
+    CHECK_BOOL(file.Open(path));
+    CHECK_SIZE(file.GetSize(), large.size());
+    CHECK_BOOL(std::string(file.begin(), file.end()) == large);
+
+    // the same instance re-used for a smaller file
+    FileUtils::WriteFileContentRaw(path, "hello");
+    CHECK_BOOL(file.Open(path));
+    CHECK_SIZE(file.GetSize(), 5);
+    CHECK_BOOL(std::string(file.begin(), file.end()) == "hello");
+
+    // too large
+    CHECK_BOOL(!file.Open(path, 4));
+    CHECK_SIZE(file.GetSize(), 0);
+
+    wxRemoveFile(path);
+    CHECK_BOOL(!file.Open(path));
+    return true;
+}
+
+TEST_FUNC(TestFolderCompare)
+{
+    wxString root = wxFileName::CreateTempFileName("cl-folder-compare");
+    wxRemoveFile(root);
+    wxString left = root + "-left";
+    wxString right = root + "-right";
+    auto write = [](const wxString& dir, const wxString& name, const std::string& content) {
+        wxFileName fn(dir + wxFileName::GetPathSeparator() + name);
+        fn.Mkdir(wxS_DIR_DEFAULT, wxPATH_MKDIR_FULL);
+        FileUtils::WriteFileContentRaw(fn, content);
+    };
+
+    // larger than a hash block, the last byte differs
+    std::string large(3 * 1024 * 1024 + 7, 'x');
+    write(left, "same.txt", "same");
+    write(right, "same.txt", "same");
+    write(left, "content.txt", "aaaa");
+    write(right, "content.txt", "bbbb");
+    write(left, "size.txt", "a");
+    write(right, "size.txt", "ab");
+    write(left, "large.bin", large);
+    large.back() = 'y';
+    write(right, "large.bin", large);
+    write(left, "left.txt", "left");
+    write(right, "right.txt", "right");
+    write(left, "sub/same.txt", "same");
+    write(right, "sub/same.txt", "same");
+
+    auto cache = std::make_shared<clFileHashCache>();
+    std::mutex summaries_mutex;
+    std::map<wxString, clFolderCompare::DirSummary> summaries;
+    auto run = [&]() {
+        summaries.clear();
+        clFolderCompare compare(cache);
+        compare.Run(left, right, [&](clFolderCompare::DirSummary&& summary) {
+            std::lock_guard<std::mutex> lk{ summaries_mutex };
+            summaries[summary.path] = std::move(summary);
+        }, 2);
+    };
+    auto status_of = [&](const wxString& name) {
+        for(const auto& entry : summaries[""].entries) {
+            if(entry.name == name) {
+                return entry.status;
+            }
+        }
+        return clFolderCompare::eStatus::kUnknown;
+    };
+
+    run();
+    CHECK_SIZE(summaries.size(), 2);
+    CHECK_SIZE(summaries[""].same, 1);
+    CHECK_SIZE(summaries[""].different, 3);
+    CHECK_SIZE(summaries[""].left_only, 1);
+    CHECK_SIZE(summaries[""].right_only, 1);
+    CHECK_BOOL(status_of("same.txt") == clFolderCompare::eStatus::kSame);
+    CHECK_BOOL(status_of("content.txt") == clFolderCompare::eStatus::kDifferent);
+    CHECK_BOOL(status_of("size.txt") == clFolderCompare::eStatus::kDifferent);
+    CHECK_BOOL(status_of("large.bin") == clFolderCompare::eStatus::kDifferent);
+    CHECK_BOOL(status_of("left.txt") == clFolderCompare::eStatus::kLeftOnly);
+    CHECK_BOOL(status_of("right.txt") == clFolderCompare::eStatus::kRightOnly);
+    CHECK_SIZE(summaries["sub"].same, 1);
+    CHECK_BOOL(!summaries["sub"].HasDifferences());
+
+    // a change that keeps the size, right after the previous run, is not hidden by the hashes cache
+    write(right, "same.txt", "SAME");
+    run();
+    CHECK_BOOL(status_of("same.txt") == clFolderCompare::eStatus::kDifferent);
+
+    wxFileName::Rmdir(left, wxPATH_RMDIR_RECURSIVE);
+    wxFileName::Rmdir(right, wxPATH_RMDIR_RECURSIVE);
+    return true;
+}
+
 TEST_FUNC(test_symlink_is_scandir)
 {
     clFilesScanner scanner;
@@ -501,6 +1573,242 @@ TEST_FUNC(test_symlink_is_scandir)
     return true;
 }
 
+TEST_FUNC(test_symbol_index)
+{
+    auto make_entry = [](long id, const wxString& name, const wxString& scope, const wxString& kind) {
+        TagsSymbolIndex::Entry entry;
+        entry.id = id;
+        entry.name = name;
+        entry.scope = scope;
+        entry.path = scope == "<global>" ? name : scope + "::" + name;
+        entry.kind = kind;
+        return entry;
+    };
+
+    TagsSymbolIndex index;
+    index.UpdateFile("/tmp/a.cpp", { make_entry(1, "GetName", "Foo", "function"),
+                                     make_entry(2, "GetNameLength", "Foo", "function"),
+                                     make_entry(3, "getname", "<global>", "function") });
+    index.UpdateFile("/tmp/b.cpp", { make_entry(4, "GetValue", "Bar", "function"),
+                                     make_entry(5, "Bar", "<global>", "class") });
+    CHECK_SIZE(index.GetCount(), 5);
+
+    std::vector<long> ids;
+    CHECK_SIZE(index.FindByName("getn", true, false, nullptr, nullptr, 100, ids), 3);
+
+    // case sensitive prefix
+    ids.clear();
+    CHECK_SIZE(index.FindByName("GetN", true, true, nullptr, nullptr, 100, ids), 2);
+
+    // exact match is always case sensitive
+    ids.clear();
+    CHECK_SIZE(index.FindByName("getname", false, false, nullptr, nullptr, 100, ids), 1);
+    CHECK_EXPECTED(ids[0], 3);
+
+    // scope and kind filters
+    std::vector<wxString> scopes = { "Foo" };
+    std::vector<wxString> kinds = { "class" };
+    ids.clear();
+    CHECK_SIZE(index.FindByName("Get", true, false, &scopes, nullptr, 100, ids), 2);
+    ids.clear();
+    CHECK_SIZE(index.FindByName("", true, false, nullptr, &kinds, 100, ids), 1);
+    CHECK_EXPECTED(ids[0], 5);
+
+    // limit
+    ids.clear();
+    CHECK_SIZE(index.FindByName("get", true, false, nullptr, nullptr, 1, ids), 1);
+
+    // re-indexing a file replaces its symbols
+    index.UpdateFile("/tmp/a.cpp", { make_entry(6, "SetName", "Foo", "function") });
+    CHECK_SIZE(index.GetCount(), 3);
+    ids.clear();
+    CHECK_SIZE(index.FindByName("getn", true, false, nullptr, nullptr, 100, ids), 0);
+    ids.clear();
+    CHECK_SIZE(index.FindByName("SetName", false, false, nullptr, nullptr, 100, ids), 1);
+    CHECK_EXPECTED(ids[0], 6);
+
+    // workspace symbols: all parts must be found in the path
+    ids.clear();
+    wxArrayString parts;
+    parts.Add("foo");
+    parts.Add("set");
+    CHECK_SIZE(index.FindByPathParts(parts, 100, ids), 1);
+
+    index.RemoveFile("/tmp/b.cpp");
+    CHECK_SIZE(index.GetCount(), 1);
+    return true;
+}
+
+TEST_FUNC(test_symbol_index_updates)
+{
+    auto make_entry = [](long id, const wxString& name, const wxString& scope) {
+        TagsSymbolIndex::Entry entry;
+        entry.id = id;
+        entry.name = name;
+        entry.scope = scope;
+        entry.path = scope + "::" + name;
+        entry.kind = "function";
+        return entry;
+    };
+
+    TagsSymbolIndex index;
+    index.UpdateFile("/tmp/a.cpp", { make_entry(1, "GetName", "Foo"), make_entry(2, "ab", "Foo") });
+    index.UpdateFile("/tmp/b.cpp", { make_entry(3, "GetValue", "Bar") });
+
+    // parts shorter than a trigram
+    std::vector<long> ids;
+    wxArrayString parts;
+    parts.Add("o");
+    parts.Add("ab");
+    CHECK_SIZE(index.FindByPathParts(parts, 100, ids), 1);
+    CHECK_EXPECTED(ids[0], 2);
+
+    // one part with no path containing it
+    ids.clear();
+    parts.clear();
+    parts.Add("bar::");
+    parts.Add("xyz");
+    CHECK_SIZE(index.FindByPathParts(parts, 100, ids), 0);
+
+    // a removed file no longer matches, by name or by path
+    index.RemoveFile("/tmp/b.cpp");
+    ids.clear();
+    CHECK_SIZE(index.FindByName("GetV", true, false, nullptr, nullptr, 100, ids), 0);
+    parts.clear();
+    parts.Add("bar::");
+    CHECK_SIZE(index.FindByPathParts(parts, 100, ids), 0);
+
+    // updating a file over and over with new names must not grow the strings forever
+    const wxString padding(200, 'x');
+    for(long i = 0; i < 20000; ++i) {
+        index.UpdateFile("/tmp/b.cpp", { make_entry(100 + i, wxString() << "Method" << i << padding, "Bar") });
+    }
+    CHECK_SIZE(index.GetCount(), 3);
+    CHECK_BOOL(index.GetStringsBytes() < 4 * 1024 * 1024);
+    CHECK_BOOL(index.GetStringsCount() < 20000);
+
+    // the handles are still valid after the strings were rebuilt
+    ids.clear();
+    CHECK_SIZE(index.FindByName("Method19999", true, true, nullptr, nullptr, 100, ids), 1);
+    CHECK_EXPECTED(ids[0], 100 + 19999);
+    ids.clear();
+    CHECK_SIZE(index.FindByName("method0", true, false, nullptr, nullptr, 100, ids), 0);
+    ids.clear();
+    CHECK_SIZE(index.FindByName("GetName", false, false, nullptr, nullptr, 100, ids), 1);
+    ids.clear();
+    parts.clear();
+    parts.Add("bar::method19999");
+    CHECK_SIZE(index.FindByPathParts(parts, 100, ids), 1);
+    return true;
+}
+
+TEST_FUNC(test_tags_cache)
+{
+    auto make_tag = [](const wxString& name, const wxString& file) {
+        TagEntryPtr tag(new TagEntry());
+        tag->SetName(name);
+        tag->SetFile(file);
+        return tag;
+    };
+
+    TagsStorageSQLiteCache cache;
+    cache.Store("q1", { make_tag("foo", "/tmp/a.cpp") });
+    cache.Store("q2", { make_tag("bar", "/tmp/b.cpp") });
+    // an empty result that depends on a file
+    cache.Store("q3", {}, { "/tmp/a.cpp" });
+    CHECK_SIZE(cache.GetStats().entries, 3);
+
+    std::vector<TagEntryPtr> tags;
+    CHECK_BOOL(cache.Get("q1", tags));
+    CHECK_SIZE(tags.size(), 1);
+    CHECK_BOOL(!cache.Get("q4", tags));
+    CHECK_SIZE(cache.GetStats().hits, 1);
+    CHECK_SIZE(cache.GetStats().misses, 1);
+
+    // re-indexing a.cpp only removes the entries that depend on it
+    cache.InvalidateFile("/tmp/a.cpp");
+    CHECK_BOOL(!cache.Get("q1", tags));
+    CHECK_BOOL(!cache.Get("q3", tags));
+    CHECK_BOOL(cache.Get("q2", tags));
+    CHECK_SIZE(cache.GetStats().invalidations, 2);
+
+    // the least recently used entry is evicted first
+    cache.Clear();
+    cache.Store("q1", { make_tag("foo", "/tmp/a.cpp") });
+    size_t entry_size = cache.GetStats().bytes;
+    cache.Store("q2", { make_tag("bar", "/tmp/a.cpp") });
+    CHECK_BOOL(cache.Get("q1", tags));
+    cache.SetMaxBytes(entry_size + entry_size / 2);
+    CHECK_SIZE(cache.GetStats().entries, 1);
+    CHECK_SIZE(cache.GetStats().evictions, 1);
+    CHECK_BOOL(cache.Get("q1", tags));
+    return true;
+}
+
+TEST_FUNC(test_sqlite_read_pool_thread_exit)
+{
+    wxString path = wxFileName::CreateTempFileName("cl-read-pool");
+    clSqliteReadPool pool(path, 10);
+    CHECK_BOOL(pool.Get() != nullptr);
+
+    // short lived threads: their connections are closed when they exit
+    for(size_t i = 0; i < 4; ++i) {
+        std::thread t([&pool]() { pool.Get(); });
+        t.join();
+    }
+    CHECK_SIZE(pool.GetCount(), 1);
+
+    pool.Close();
+    wxRemoveFile(path);
+    return true;
+}
+
+TEST_FUNC(test_symbol_index_follows_commits)
+{
+    wxFileName db_file(wxFileName::CreateTempFileName("cl-tags-index"));
+    wxString source_file = db_file.GetPath() + "/symbol_index_test.cpp";
+    auto make_tags = [&](const wxString& name) {
+        TagEntryPtr tag(new TagEntry());
+        tag->SetName(name);
+        tag->SetPath(name);
+        tag->SetScope("<global>");
+        tag->SetFile(source_file);
+        tag->SetKind("function");
+        tag->SetLine(1);
+        return std::vector<TagEntryPtr>{ tag };
+    };
+
+    TagsStorageSQLite db;
+    db.OpenDatabase(db_file);
+    db.LoadSymbolIndex();
+    auto index = TagsSymbolIndex::Get(db_file.GetFullPath());
+    CHECK_BOOL(index != nullptr);
+
+    std::vector<long> ids;
+    db.Store(make_tags("CommittedSymbol"), true);
+    CHECK_SIZE(index->FindByName("CommittedSymbol", false, true, nullptr, nullptr, 10, ids), 1);
+
+    // nothing reaches the index until the caller commits
+    db.Begin();
+    db.Store(make_tags("RolledBackSymbol"), false);
+    ids.clear();
+    CHECK_SIZE(index->FindByName("RolledBackSymbol", false, true, nullptr, nullptr, 10, ids), 0);
+    db.Rollback();
+    ids.clear();
+    CHECK_SIZE(index->FindByName("CommittedSymbol", false, true, nullptr, nullptr, 10, ids), 1);
+
+    // deleting the file removes its symbols once committed
+    db.Begin();
+    db.DeleteByFileName({}, source_file, false);
+    CHECK_SIZE(index->GetCount(), 1);
+    db.Commit();
+    CHECK_SIZE(index->GetCount(), 0);
+
+    TagsSymbolIndex::Release(db_file.GetFullPath());
+    wxRemoveFile(db_file.GetFullPath());
+    return true;
+}
+
 TEST_FUNC(test_cxx_expression)
 {
     CxxRemainder remainder;
@@ -779,6 +2087,84 @@ TEST_FUNC(test_ctags_locals)
 }
 #endif
 
+TEST_FUNC(test_ctags_session_json_fields)
+{
+    ENSURE_DB_LOADED();
+    const wxString source = R"(
+#define MAX_SIZE(a, b) ((a) > (b) ? (a) : (b))
+namespace demo {
+template <typename T> class Base {
+public:
+    virtual ~Base() {}
+    virtual T get() const = 0;
+protected:
+    T m_value;
+};
+class Derived : public Base<int> {
+public:
+    int get() const override;
+    static int count;
+};
+enum class Color { kRed, kGreen };
+static int helper(int value)
+{
+    int doubled = value * 2;
+    const char* name = "helper";
+    return doubled + (name != nullptr);
+}
+}
+)";
+    wxString file = wxFileName::CreateTempFileName("ctagsd-tests");
+    CHECK_BOOL(FileUtils::WriteFileContent(file, source));
+
+    // the extension fields we know of
+    const std::vector<wxString> fields = { "access",     "signature", "typeref",        "inherits", "template",
+                                           "properties", "macrodef",  "implementation", "type",     "file" };
+    // the default kinds, and the kinds used to parse the locals
+    for(const wxString& kinds : { wxString(), wxString("lzpvfm") }) {
+        CTagsSession* session = CTagsTester::GetSession(settings.GetCodeliteIndexer(), settings.GetMacroTable(), kinds);
+        if(!session) {
+            cout << "CTagsSession test skipped: codelite-ctags does not support the interactive mode" << endl;
+            break;
+        }
+
+        vector<TagEntryPtr> session_tags;
+        CHECK_BOOL(session->ParseFile(file, [&](TagEntryPtr tag) { session_tags.push_back(tag); }));
+
+        wxString content;
+        CHECK_BOOL(CTagsTester::DoGenerate(file + "\n", settings.GetCodeliteIndexer(), settings.GetMacroTable(), kinds,
+                                           &content));
+        vector<TagEntryPtr> legacy_tags;
+        for(wxString& line : ::wxStringTokenize(content, "\n", wxTOKEN_STRTOK)) {
+            line.Trim(false).Trim();
+            if(!line.empty()) {
+                TagEntryPtr tag(new TagEntry());
+                tag->FromLine(line);
+                legacy_tags.push_back(tag);
+            }
+        }
+
+        CHECK_BOOL(!legacy_tags.empty());
+        CHECK_SIZE(session_tags.size(), legacy_tags.size());
+        for(size_t i = 0; i < legacy_tags.size(); ++i) {
+            TagEntryPtr tag = session_tags[i];
+            TagEntryPtr expected = legacy_tags[i];
+            CHECK_WXSTRING(tag->GetName(), expected->GetName());
+            CHECK_WXSTRING(tag->GetPath(), expected->GetPath());
+            CHECK_WXSTRING(tag->GetFile(), expected->GetFile());
+            CHECK_SIZE(tag->GetLine(), expected->GetLine());
+            CHECK_WXSTRING(tag->GetKind(), expected->GetKind());
+            CHECK_WXSTRING(tag->GetPattern(), expected->GetPattern());
+            CHECK_WXSTRING(tag->GetScope(), expected->GetScope());
+            for(const auto& field : fields) {
+                CHECK_WXSTRING(tag->GetExtField(field), expected->GetExtField(field));
+            }
+        }
+    }
+    wxRemoveFile(file);
+    return true;
+}
+
 TEST_FUNC(test_cxx_code_completion_lsp_location_locals)
 {
     ENSURE_DB_LOADED();
@@ -0,0 +1,46 @@
+#include "GitBlameCache.hpp"
+
+bool GitBlameCache::NeedsBlame(const wxString& fullpath, const wxString& digest) const
+{
+    auto pending = m_pending.find(fullpath);
+    if (pending != m_pending.end() && pending->second == digest) {
+        return false;
+    }
+
+    auto where = m_entries.find(fullpath);
+    return where == m_entries.end() || where->second.digest != digest;
+}
+
+void GitBlameCache::Set(const wxString& fullpath, std::vector<wxString>&& lines)
+{
+    Entry& entry = m_entries[fullpath];
+    auto pending = m_pending.find(fullpath);
+    if (pending != m_pending.end()) {
+        entry.digest = pending->second;
+        m_pending.erase(pending);
+    } else {
+        entry.digest.clear();
+    }
+    entry.lines = std::move(lines);
+}
+
+const std::vector<wxString>* GitBlameCache::Get(const wxString& fullpath) const
+{
+    auto where = m_entries.find(fullpath);
+    if (where == m_entries.end()) {
+        return nullptr;
+    }
+    return &where->second.lines;
+}
+
+void GitBlameCache::Erase(const wxString& fullpath)
+{
+    m_entries.erase(fullpath);
+    m_pending.erase(fullpath);
+}
+
+void GitBlameCache::Clear()
+{
+    m_entries.clear();
+    m_pending.clear();
+}
@@ -0,0 +1,53 @@
+#ifndef GITBLAMECACHE_HPP
+#define GITBLAMECACHE_HPP
+
+#include <unordered_map>
+#include <vector>
+#include <wx/string.h>
+
+/**
+ * @class GitBlameCache
+ * @brief the `git blame` summary of each file (one comment per line), along with a digest of the file content
+ * that was blamed. A file is re-blamed only when its content digest changes
+ */
+class GitBlameCache
+{
+    struct Entry {
+        wxString digest;
+        std::vector<wxString> lines;
+    };
+
+    std::unordered_map<wxString, Entry> m_entries;
+    // files with a `git blame` in progress -> the digest of the content being blamed
+    std::unordered_map<wxString, wxString> m_pending;
+
+public:
+    GitBlameCache() = default;
+    ~GitBlameCache() = default;
+
+    /**
+     * @brief return true if `fullpath` needs to be blamed: its blame is not cached, or was computed for a
+     * different content, and no blame for this content is already in progress
+     */
+    bool NeedsBlame(const wxString& fullpath, const wxString& digest) const;
+
+    /**
+     * @brief a `git blame` for `fullpath` was started
+     */
+    void SetPending(const wxString& fullpath, const wxString& digest) { m_pending[fullpath] = digest; }
+
+    /**
+     * @brief store the blame of `fullpath`, for the content digest that was passed to `SetPending()`
+     */
+    void Set(const wxString& fullpath, std::vector<wxString>&& lines);
+
+    /**
+     * @brief the cached blame lines of `fullpath`, nullptr if there are none
+     */
+    const std::vector<wxString>* Get(const wxString& fullpath) const;
+
+    void Erase(const wxString& fullpath);
+    void Clear();
+};
+
+#endif // GITBLAMECACHE_HPP
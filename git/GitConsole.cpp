@@ -368,8 +368,6 @@ void GitConsole::OnConfigurationChanged(wxCommandEvent& e)
 
 void GitConsole::UpdateTreeView(const wxString& output)
 {
-    Clear();
-    wxVector<wxVariant> cols;
     wxArrayString files = ::wxStringTokenize(output, "\n\r", wxTOKEN_STRTOK);
 
     // parse the output
@@ -393,6 +391,30 @@ void GitConsole::UpdateTreeView(const wxString& output)
         GitFileEntry entry(filename, prefix, m_git->GetRepositoryPath());
         lines.push_back(entry);
     }
+    DoUpdateTreeView(lines);
+}
+
+void GitConsole::UpdateTreeView(const std::vector<GitStatusEntry>& entries)
+{
+    std::vector<GitFileEntry> lines;
+    lines.reserve(entries.size());
+
+    for (const auto& entry : entries) {
+        wxString filename = entry.path;
+        filename.Replace("\\", "/");
+        if (filename.EndsWith("/"))
+            // an untracked directory
+            continue;
+
+        lines.emplace_back(filename, entry.GetShortStatus(), m_git->GetRepositoryPath());
+    }
+    DoUpdateTreeView(lines);
+}
+
+void GitConsole::DoUpdateTreeView(std::vector<GitFileEntry>& lines)
+{
+    Clear();
+    wxVector<wxVariant> cols;
 
     auto sort_cb = [](const GitFileEntry& a, const GitFileEntry& b) {
         const wxString& fpa = a.path;
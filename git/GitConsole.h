@@ -37,6 +37,8 @@
 #include <wx/dataview.h>
 
 class GitPlugin;
+struct GitFileEntry;
+struct GitStatusEntry;
 class GitConsole : public GitConsoleBase
 {
 public:
@@ -47,6 +49,10 @@ public:
     void PrintPrompt();
     bool IsVerbose() const;
     void UpdateTreeView(const wxString& output);
+    /**
+     * @brief update the view from the parsed output of `git status --porcelain=v2`
+     */
+    void UpdateTreeView(const std::vector<GitStatusEntry>& entries);
 
     /**
      * @brief return true if there are any deleted/new/modified items
@@ -156,6 +162,7 @@ protected:
     void OnOutputViewTabChanged(clCommandEvent& event);
 
 private:
+    void DoUpdateTreeView(std::vector<GitFileEntry>& lines);
     wxArrayString GetSelectedUnversionedFiles() const;
     wxArrayString GetSelectedModifiedFiles() const;
 
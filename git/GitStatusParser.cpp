@@ -0,0 +1,165 @@
+#include "GitStatusParser.hpp"
+
+#include <cstring>
+
+namespace
+{
+/// split the first `count` space separated fields of `record`, return the remainder (the path)
+std::string_view skip_fields(std::string_view record, size_t count, std::vector<std::string_view>& fields)
+{
+    fields.clear();
+    for (size_t i = 0; i < count; ++i) {
+        size_t where = record.find(' ');
+        if (where == std::string_view::npos) {
+            fields.push_back(record);
+            return {};
+        }
+        fields.push_back(record.substr(0, where));
+        record.remove_prefix(where + 1);
+    }
+    return record;
+}
+
+wxString from_utf8(std::string_view str) { return wxString::FromUTF8(str.data(), str.length()); }
+} // namespace
+
+wxString GitStatusEntry::GetShortStatus() const
+{
+    switch (kind) {
+    case kUntracked:
+        return "??";
+    case kIgnored:
+        return "!!";
+    default:
+        break;
+    }
+
+    // same as the first column of `git status -s`, once trimmed
+    wxString status;
+    status << (index_status != '.' ? index_status : worktree_status);
+    return status;
+}
+
+wxString GitStatusParser::GetCommandArgs() { return "--no-pager status --porcelain=v2 -z --branch"; }
+
+void GitStatusParser::Reset()
+{
+    m_pending.clear();
+    m_expecting_orig_path = false;
+    m_entries.clear();
+    m_head_oid.clear();
+    m_branch.clear();
+}
+
+void GitStatusParser::Feed(const char* data, size_t length)
+{
+    const char* end = data + length;
+    while (data < end) {
+        const char* nul = (const char*)std::memchr(data, '\0', end - data);
+        if (nul == nullptr) {
+            m_pending.append(data, end - data);
+            return;
+        }
+
+        if (m_pending.empty()) {
+            ParseRecord(std::string_view{ data, (size_t)(nul - data) });
+        } else {
+            m_pending.append(data, nul - data);
+            ParseRecord(m_pending);
+            m_pending.clear();
+        }
+        data = nul + 1;
+    }
+}
+
+void GitStatusParser::Finish()
+{
+    if (!m_pending.empty()) {
+        ParseRecord(m_pending);
+        m_pending.clear();
+    }
+    m_expecting_orig_path = false;
+}
+
+std::vector<GitStatusEntry> GitStatusParser::TakeEntries()
+{
+    std::vector<GitStatusEntry> entries;
+    entries.swap(m_entries);
+    return entries;
+}
+
+void GitStatusParser::ParseRecord(std::string_view record)
+{
+    // the record that follows a rename entry is the original path
+    if (m_expecting_orig_path) {
+        m_expecting_orig_path = false;
+        if (!m_entries.empty()) {
+            m_entries.back().orig_path = from_utf8(record);
+        }
+        return;
+    }
+
+    if (record.length() < 2) {
+        return;
+    }
+
+    // see `git help status`, "Porcelain Format Version 2"
+    std::vector<std::string_view>& fields = m_fields;
+    GitStatusEntry entry;
+    std::string_view path;
+    switch (record[0]) {
+    case '#': {
+        // # branch.oid <commit> | (initial)
+        // # branch.head <branch> | (detached)
+        path = skip_fields(record.substr(2), 1, fields);
+        if (fields[0] == "branch.oid") {
+            m_head_oid = from_utf8(path);
+        } else if (fields[0] == "branch.head") {
+            m_branch = from_utf8(path);
+        }
+        return;
+    }
+    case '1':
+        // 1 <XY> <sub> <mH> <mI> <mW> <hH> <hI> <path>
+        entry.kind = GitStatusEntry::kChanged;
+        path = skip_fields(record, 8, fields);
+        break;
+    case '2':
+        // 2 <XY> <sub> <mH> <mI> <mW> <hH> <hI> <X><score> <path>\0<origPath>
+        entry.kind = GitStatusEntry::kRenamed;
+        path = skip_fields(record, 9, fields);
+        m_expecting_orig_path = true;
+        break;
+    case 'u':
+        // u <XY> <sub> <m1> <m2> <m3> <mW> <h1> <h2> <h3> <path>
+        entry.kind = GitStatusEntry::kUnmerged;
+        path = skip_fields(record, 10, fields);
+        break;
+    case '?':
+        entry.kind = GitStatusEntry::kUntracked;
+        path = record.substr(2);
+        break;
+    case '!':
+        entry.kind = GitStatusEntry::kIgnored;
+        path = record.substr(2);
+        break;
+    default:
+        return;
+    }
+
+    if (path.empty()) {
+        // malformed record
+        m_expecting_orig_path = false;
+        return;
+    }
+
+    if (entry.kind != GitStatusEntry::kUntracked && entry.kind != GitStatusEntry::kIgnored) {
+        std::string_view xy = fields.size() > 1 ? fields[1] : std::string_view{};
+        if (xy.length() == 2) {
+            entry.index_status = xy[0];
+            entry.worktree_status = xy[1];
+        }
+    }
+    entry.path = from_utf8(path);
+    m_entries.push_back(std::move(entry));
+}
@@ -0,0 +1,85 @@
+#ifndef GITSTATUSPARSER_HPP
+#define GITSTATUSPARSER_HPP
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <wx/string.h>
+
+struct GitStatusEntry {
+    enum eKind {
+        kChanged,   // ordinary changed entry
+        kRenamed,   // renamed or copied
+        kUnmerged,  // merge conflict
+        kUntracked, // not tracked by git
+        kIgnored,
+    };
+
+    eKind kind = kChanged;
+    // '.' means: unmodified
+    wxChar index_status = '.';
+    wxChar worktree_status = '.';
+    // relative to the repository root, always with '/' as separator
+    wxString path;
+    // renamed or copied entries only: the path this entry was renamed/copied from
+    wxString orig_path;
+
+    /**
+     * @brief return true if the work tree copy of the file differs from the index (same as `git ls-files -m`)
+     */
+    bool IsModifiedInWorkTree() const { return kind != kUntracked && kind != kIgnored && worktree_status != '.'; }
+
+    /**
+     * @brief the status, as printed by `git status -s` (e.g. "M", "A", "??")
+     */
+    wxString GetShortStatus() const;
+};
+
+/**
+ * @class GitStatusParser
+ * @brief an incremental parser for the output of `git status --porcelain=v2 -z --branch`.
+ * The output can be fed as it arrives from the process, in chunks of any size: complete records are parsed
+ * right away, so the output is never kept in memory as a whole. The paths are NUL terminated, so they do not
+ * need any unquoting
+ */
+class GitStatusParser
+{
+    std::string m_pending; // an incomplete record, waiting for the rest of its bytes
+    bool m_expecting_orig_path = false;
+    std::vector<GitStatusEntry> m_entries;
+    wxString m_head_oid;
+    wxString m_branch;
+    std::vector<std::string_view> m_fields; // reused by every record
+
+    void ParseRecord(std::string_view record);
+
+public:
+    GitStatusParser() = default;
+    ~GitStatusParser() = default;
+
+    /**
+     * @brief the arguments to pass to git
+     */
+    static wxString GetCommandArgs();
+
+    void Reset();
+    /**
+     * @brief parse the next chunk of the output
+     */
+    void Feed(const char* data, size_t length);
+    void Feed(const std::string& data) { Feed(data.data(), data.length()); }
+    /**
+     * @brief the output is complete: parse the last record, if it was not terminated
+     */
+    void Finish();
+
+    const std::vector<GitStatusEntry>& GetEntries() const { return m_entries; }
+    std::vector<GitStatusEntry> TakeEntries();
+    /**
+     * @brief the commit id of HEAD ("(initial)" for a repository without commits)
+     */
+    const wxString& GetHeadOid() const { return m_head_oid; }
+    const wxString& GetBranch() const { return m_branch; }
+};
+
+#endif // GITSTATUSPARSER_HPP
@@ -56,12 +56,14 @@
 #include "gitDiffDlg.h"
 #include "gitSettingsDlg.h"
 #include "gitentry.h"
+#include "md5/wxmd5.h"
 #include "globals.h"
 #include "overlaytool.h"
 #include "procutils.h"
 #include "project.h"
 #include "workspace.h"
 
+#include <algorithm>
 #include <stack>
 #include <unordered_set>
 #include <wx/ffile.h>
@@ -79,6 +81,9 @@
 
 namespace
 {
+// how long to wait after the last file save before refreshing the git status
+constexpr int STATUS_REFRESH_DELAY_MS = 500;
+
 wxString GetDirFromPath(const wxString& path)
 {
     wxString p = path;
@@ -272,6 +277,8 @@ GitPlugin::GitPlugin(IManager* manager)
     m_console = new GitConsole(m_mgr->BookGet(PaneId::SIDE_BAR), this);
     m_mgr->BookAddPage(PaneId::SIDE_BAR, m_console, _("Git"), "git-orange");
     m_progressTimer.SetOwner(this);
+    m_statusRefreshTimer.SetOwner(this);
+    Bind(wxEVT_TIMER, &GitPlugin::OnStatusRefreshTimer, this, m_statusRefreshTimer.GetId());
 
     m_remoteProcess.Bind(wxEVT_CODELITE_REMOTE_FINDPATH, &GitPlugin::OnFindPath, this);
     m_remoteProcess.Bind(wxEVT_CODELITE_REMOTE_FINDPATH_DONE, &GitPlugin::OnFindPath, this);
@@ -582,6 +589,8 @@ void GitPlugin::UnPlug()
     wxTheApp->Bind(wxEVT_MENU, &GitPlugin::OnFolderStashPop, this, XRCID("git_stash_pop_folder"));
     Unbind(wxEVT_ASYNC_PROCESS_OUTPUT, &GitPlugin::OnProcessOutput, this);
     Unbind(wxEVT_ASYNC_PROCESS_TERMINATED, &GitPlugin::OnProcessTerminated, this);
+    m_statusRefreshTimer.Stop();
+    Unbind(wxEVT_TIMER, &GitPlugin::OnStatusRefreshTimer, this, m_statusRefreshTimer.GetId());
 
     m_remoteProcess.Unbind(wxEVT_CODELITE_REMOTE_FINDPATH, &GitPlugin::OnFindPath, this);
     m_remoteProcess.Unbind(wxEVT_CODELITE_REMOTE_FINDPATH_DONE, &GitPlugin::OnFindPath, this);
@@ -1067,10 +1076,21 @@ void GitPlugin::DoAnyFileModified()
         return;
     }
 
-    DoLoadBlameInfo(true);
-    gitAction ga(gitListModified, wxT(""));
-    m_gitActionQueue.push_back(ga);
-    ProcessGitActionQueue();
+    // A "save all" (or a build that touches many files) fires one event per file: restart the timer so the
+    // whole burst is handled by a single status refresh
+    m_statusRefreshTimer.StartOnce(STATUS_REFRESH_DELAY_MS);
+}
+
+void GitPlugin::OnStatusRefreshTimer(wxTimerEvent& event)
+{
+    wxUnusedVar(event);
+    if (m_isRemoteWorkspace || !IsPaneShown()) {
+        return;
+    }
+
+    // the blame cache is keyed by the file content, so this only re-blames the active editor if it changed
+    DoLoadBlameInfo(false);
+    // the status output also provides the list of modified files
     RefreshFileListView();
 }
 void GitPlugin::OnFileSaved(clCommandEvent& e)
@@ -1204,7 +1224,8 @@ void GitPlugin::ProcessGitActionQueue()
         break;
 
     case gitStatus:
-        command_args << "--no-pager status -s";
+        m_statusParser.Reset();
+        command_args << GitStatusParser::GetCommandArgs();
         break;
 
     case gitListAll:
@@ -1434,33 +1455,73 @@ void GitPlugin::FinishGitListAction(const gitAction& ga)
         m_trackedFiles.swap(gitFileSet);
 
     } else if (ga.action == gitListModified) {
-        m_mgr->SetStatusMessage(_("Colouring modified git files..."), 0);
-        // Reset modified files
-        ColourFileTree(m_mgr->GetWorkspaceTree(), m_modifiedFiles, OverlayTool::Bmp_OK);
-        // First get an up to date map of the filepaths/treeitemids
-        // (Trying to cache these results in segfaults when the tree has been modified)
-        std::map<wxString, wxTreeItemId> IDs;
-        CreateFilesTreeIDsMap(IDs);
-
-        // Now filter using the list of modified files, gitFileList, to find which IDs to colour differently
-        wxStringSet_t toColour;
-        for (const auto& filename : gitFileSet) {
-            wxTreeItemId id = IDs[filename];
-            if (id.IsOk()) {
-                DoSetTreeItemImage(m_mgr->GetWorkspaceTree(), id, OverlayTool::Bmp_Modified);
+        DoUpdateModifiedFiles(gitFileSet);
+    }
+    m_mgr->SetStatusMessage("", 0);
+}
 
-            } else {
-                toColour.insert(filename);
-            }
+void GitPlugin::FinishGitStatusAction()
+{
+    m_statusParser.Finish();
+    std::vector<GitStatusEntry> entries = m_statusParser.TakeEntries();
+    m_console->UpdateTreeView(entries);
+
+    // HEAD moved (a commit, a checkout or a pull - possibly made outside of CodeLite): the cached blame is outdated
+    const wxString& headOid = m_statusParser.GetHeadOid();
+    if (!m_headOid.empty() && headOid != m_headOid) {
+        m_blameCache.Clear();
+        DoLoadBlameInfo(false);
+    }
+    m_headOid = headOid;
+
+    clConfig conf("git.conf");
+    GitEntry data;
+    conf.ReadItem(&data);
+
+    if (!(data.GetFlags() & GitEntry::ColourTreeView))
+        return;
+
+    // the work tree changes are exactly what `git ls-files -m` reports
+    wxStringSet_t modifiedFiles;
+    for (const auto& entry : entries) {
+        if (!entry.IsModifiedInWorkTree()) {
+            continue;
         }
+        wxFileName fname(entry.path);
+        fname.MakeAbsolute(m_repositoryDirectory);
+        modifiedFiles.insert(fname.GetFullPath());
+    }
+    DoUpdateModifiedFiles(modifiedFiles);
+}
+
+void GitPlugin::DoUpdateModifiedFiles(wxStringSet_t& modifiedFiles)
+{
+    m_mgr->SetStatusMessage(_("Colouring modified git files..."), 0);
+    // Reset modified files
+    ColourFileTree(m_mgr->GetWorkspaceTree(), m_modifiedFiles, OverlayTool::Bmp_OK);
+    // First get an up to date map of the filepaths/treeitemids
+    // (Trying to cache these results in segfaults when the tree has been modified)
+    std::map<wxString, wxTreeItemId> IDs;
+    CreateFilesTreeIDsMap(IDs);
+
+    // Now filter using the list of modified files, gitFileList, to find which IDs to colour differently
+    wxStringSet_t toColour;
+    for (const auto& filename : modifiedFiles) {
+        wxTreeItemId id = IDs[filename];
+        if (id.IsOk()) {
+            DoSetTreeItemImage(m_mgr->GetWorkspaceTree(), id, OverlayTool::Bmp_Modified);
 
-        if (!toColour.empty()) {
-            ColourFileTree(m_mgr->GetWorkspaceTree(), toColour, OverlayTool::Bmp_Modified);
+        } else {
+            toColour.insert(filename);
         }
+    }
 
-        // Finally, cache the modified-files list: it's used in other functions
-        m_modifiedFiles.swap(gitFileSet);
+    if (!toColour.empty()) {
+        ColourFileTree(m_mgr->GetWorkspaceTree(), toColour, OverlayTool::Bmp_Modified);
     }
+
+    // Finally, cache the modified-files list: it's used in other functions
+    m_modifiedFiles.swap(modifiedFiles);
     m_mgr->SetStatusMessage("", 0);
 }
 
@@ -1688,8 +1749,7 @@ void GitPlugin::OnProcessTerminated(clProcessEvent& event)
         }
     } break;
     case gitStatus: {
-        m_console->UpdateTreeView(m_commandOutput);
-        FinishGitListAction(ga);
+        FinishGitStatusAction();
     } break;
     case gitListRemotes: {
         wxArrayString gitList = wxStringTokenize(m_commandOutput, wxT("\n"));
@@ -1872,7 +1932,22 @@ void GitPlugin::OnProcessOutput(clProcessEvent& event)
     if (ga.action == gitPush || ga.action == gitPull) {
         m_console->AddText(output);
     }
-    m_commandOutput.Append(output);
+
+    if (ga.action == gitStatus) {
+        // The status is parsed as it arrives. Only the first chunk is kept, it is all that the "fatal" / "error"
+        // checks need once the process terminates
+        const std::string& raw = event.GetOutputRaw();
+        if (raw.empty()) {
+            m_statusParser.Feed(output.ToStdString(wxConvUTF8));
+        } else {
+            m_statusParser.Feed(raw);
+        }
+        if (m_commandOutput.empty()) {
+            m_commandOutput = output;
+        }
+    } else {
+        m_commandOutput.Append(output);
+    }
 
     // Handle password required
     wxString tmpOutput = output;
@@ -2137,7 +2212,7 @@ void GitPlugin::OnWorkspaceClosed(clWorkspaceEvent& e)
 {
     e.Skip();
     m_isEnabled = false;
-    m_blameMap.clear();
+    m_blameCache.Clear();
     WorkspaceClosed();
     m_lastBlameMessage.clear();
     ClearCodeLiteRemoteInfo();
@@ -2167,7 +2242,7 @@ void GitPlugin::DoCleanup()
     m_filesSelected.Clear();
     m_selectedFolder.Clear();
     // clear blame info
-    m_blameMap.clear();
+    m_blameCache.Clear();
     clGetManager()->GetNavigationBar()->ClearLabel();
     m_lastBlameMessage.clear();
 }
@@ -2243,8 +2318,23 @@ void GitPlugin::UndoAddFiles(const wxArrayString& files)
     RefreshFileListView();
 }
 
+bool GitPlugin::IsActionQueued(int action) const
+{
+    auto iter = m_gitActionQueue.begin();
+    if (m_process && iter != m_gitActionQueue.end()) {
+        // the front action is already running: its result might be outdated
+        ++iter;
+    }
+    return std::any_of(iter, m_gitActionQueue.end(), [action](const gitAction& ga) { return ga.action == action; });
+}
+
 void GitPlugin::RefreshFileListView()
 {
+    if (IsActionQueued(gitStatus)) {
+        // the queued status will see the latest changes as well
+        return;
+    }
+
     gitAction ga;
     ga.action = gitStatus;
     m_gitActionQueue.push_back(ga);
@@ -2960,24 +3050,31 @@ void GitPlugin::DoLoadBlameInfo(bool clearCache)
 
     // use the remote path if available
     wxString fullpath = editor->GetRemotePathOrLocal();
-    if (m_blameMap.count(fullpath) && !clearCache) {
+    wxString digest = GetBlameDigest(editor);
+    if (!clearCache && !m_blameCache.NeedsBlame(fullpath, digest)) {
         return;
     }
 
-    m_blameMap.erase(fullpath);
+    m_blameCache.SetPending(fullpath, digest);
     gitAction ga(gitBlameSummary, fullpath);
     m_gitActionQueue.push_back(ga);
     ProcessGitActionQueue();
 }
 
+wxString GitPlugin::GetBlameDigest(IEditor* editor) const
+{
+    // `git blame` reads the file from the disk, so this is the content it blames. Remote files are not
+    // accessible from here: use the editor content instead (it matches the file once saved)
+    if (editor->IsRemoteFile()) {
+        return wxMD5::GetDigest(editor->GetEditorText());
+    }
+    return wxMD5::GetDigest(editor->GetFileName());
+}
+
 void GitPlugin::DoUpdateBlameInfo(const wxString& info, const wxString& fullpath)
 {
     // parse the git blame output
-    if (m_blameMap.count(fullpath)) {
-        m_blameMap.erase(fullpath);
-    }
-    m_blameMap.insert({fullpath, {}});
-    auto& V = m_blameMap[fullpath];
+    std::vector<wxString> V;
     wxArrayString lines = ::wxStringTokenize(info, "\n", wxTOKEN_RET_DELIMS);
     V.reserve(lines.size());
     for (wxString& line : lines) {
@@ -3000,6 +3097,7 @@ void GitPlugin::DoUpdateBlameInfo(const wxString& info, const wxString& fullpath
         }
         V.emplace_back(comment);
     }
+    m_blameCache.Set(fullpath, std::move(V));
 }
 
 void GitPlugin::OnUpdateNavBar(clCodeCompletionEvent& event)
@@ -3016,17 +3114,17 @@ void GitPlugin::OnUpdateNavBar(clCodeCompletionEvent& event)
 
     wxString fullpath = editor->GetRemotePathOrLocal();
     LOG_IF_TRACE { clDEBUG1() << "Checking blame info for file:" << fullpath << clEndl; }
-    auto where = m_blameMap.find(fullpath);
+    const std::vector<wxString>* blame = m_blameCache.Get(fullpath);
 
-    if (where == m_blameMap.end()) {
+    if (blame == nullptr) {
         LOG_IF_TRACE { clDEBUG1() << "Could not get git blame for file:" << fullpath << clEndl; }
         clGetManager()->GetNavigationBar()->ClearLabel();
         return;
     }
 
     size_t lineNumber = editor->GetCurrentLine();
-    if (lineNumber < where->second.size()) {
-        const wxString& newmsg = where->second[lineNumber];
+    if (lineNumber < blame->size()) {
+        const wxString& newmsg = (*blame)[lineNumber];
         if (m_lastBlameMessage != newmsg) {
             m_lastBlameMessage = newmsg;
             clGetManager()->GetNavigationBar()->SetLabel(newmsg);
@@ -3041,7 +3139,7 @@ void GitPlugin::OnEditorClosed(wxCommandEvent& event)
 
     IEditor* editor = (IEditor*)event.GetClientData();
     CHECK_PTR_RET(editor);
-    m_blameMap.erase(editor->GetFileName().GetFullPath());
+    m_blameCache.Erase(editor->GetFileName().GetFullPath());
     m_lastBlameMessage.clear();
 }
 
@@ -3050,7 +3148,7 @@ void GitPlugin::OnGitActionDone(clSourceControlEvent& event)
     // whenever a git action is performed, we clear the blame info
     // and reload it for the current file
     event.Skip();
-    m_blameMap.clear();
+    m_blameCache.Clear();
     m_lastBlameMessage.clear();
     DoLoadBlameInfo(false);
 }
@@ -35,6 +35,8 @@
 
 #include "AsyncProcess/asyncprocess.h"
 #include "AsyncProcess/processreaderthread.h"
+#include "GitBlameCache.hpp"
+#include "GitStatusParser.hpp"
 #include "ai/ResponseCollector.hpp"
 #include "clCodeLiteRemoteProcess.hpp"
 #include "clResult.hpp"
@@ -176,8 +178,12 @@ class GitPlugin : public IPlugin
     wxArrayString m_filesSelected;
     wxString m_selectedFolder;
     clCommandProcessor* m_commandProcessor;
-    std::unordered_map<wxString, std::vector<wxString>>
-        m_blameMap; // contains file: comment per line (extracted from the 'git blame' info)
+    GitBlameCache m_blameCache; // contains file: comment per line (extracted from the 'git blame' info)
+    // file saves and external modifications restart this timer, the status is refreshed once it fires
+    wxTimer m_statusRefreshTimer;
+    // parses the output of the running `git status` as it arrives
+    GitStatusParser m_statusParser;
+    wxString m_headOid;
     size_t m_configFlags = 0;
     wxString m_lastBlameMessage;
     bool m_isRemoteWorkspace = false;
@@ -229,10 +235,27 @@ private:
     void DoLoadBlameInfo(bool clearCache);
     void DoUpdateBlameInfo(const wxString& info, const wxString& fullpath);
     void DoAnyFileModified();
+    /**
+     * @brief return a digest of the content of the file opened in `editor`, as seen by `git blame`
+     */
+    wxString GetBlameDigest(IEditor* editor) const;
+    /**
+     * @brief return true if `action` is waiting in the queue (the running action, if any, is not checked)
+     */
+    bool IsActionQueued(int action) const;
+    /**
+     * @brief update the console and the tree view from the parsed `git status` output
+     */
+    void FinishGitStatusAction();
+    /**
+     * @brief mark `modifiedFiles` as modified in the workspace tree and keep them as the modified files list
+     */
+    void DoUpdateModifiedFiles(wxStringSet_t& modifiedFiles);
     DECLARE_EVENT_TABLE()
 
     // Event handlers
     void OnProgressTimer(wxTimerEvent& Event);
+    void OnStatusRefreshTimer(wxTimerEvent& event);
     void OnProcessTerminated(clProcessEvent& event);
     void OnProcessOutput(clProcessEvent& event);
     void OnFileMenu(clContextMenuEvent& event);